@@ -10,8 +10,10 @@
 #include "zProcMaps.h"
 #include "zProcInfo.h"
 #include "zJson.h"
+#include "zJsonWriter.h"
 #include "zBinder.h"
 #include "zShell.h"
+#include "zJniCache.h"
 
 
 // 0 zConfig
@@ -32,6 +34,11 @@ void __attribute__((constructor)) init_(void){
     string processName = get_process_name();
     if(string_end_with(processName.c_str(), ".Server")){
     }else{
+        // 工作线程足够时预留一个给高优先级检测，避免排在耗时的低优先级扫描之后
+        zThreadPool* pool = zThreadPool::getInstance();
+        if (pool != nullptr && pool->getWorkerCount() >= 4) {
+            pool->setReservedWorkers(1);
+        }
         zThreadPool::getInstance()->addTask("round_tasks", zManager::getInstance(), &zManager::round_tasks);
     }
     LOGI("init_ over");
@@ -47,6 +54,22 @@ extern "C" JNIEXPORT
 jint JNI_OnLoad(JavaVM* vm, void* reserved) {
     LOGI("JNI_OnLoad called");
 
+    // 预先解析常用的类，JNI_OnLoad 中的 FindClass 可以找到应用自己的类，子线程中只能找到系统类
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) == JNI_OK && env != nullptr) {
+        size_t count = zJniCache::getInstance()->init(env, {
+                "com/example/overt/NativeUpdateBus",
+                "android/content/Context",
+                "android/content/Intent",
+                "android/content/IntentFilter",
+                "android/os/BatteryManager",
+                "android/provider/Settings$Global",
+                "android/provider/Settings$Secure",
+                "java/lang/System",
+        });
+        LOGI("JNI_OnLoad: cached %zu classes", count);
+    }
+
     LOGI("JNI_OnLoad over");
     return JNI_VERSION_1_6;
 }
@@ -68,8 +91,9 @@ Java_com_example_overt_ServerStarter_getSharedMemoryFd(JNIEnv *env, jclass clazz
 std::string fdListenerCallback(std::string msg){
     if(msg == "get_isoloated_process_info"){
         map<string, map<string, string>> info = get_proc_info();
-        zJson json = info;
-        return json.dump().c_str();
+        // 直接序列化，不构造 zJson 的 DOM；消息循环在一个线程上，缓冲区反复使用
+        static zJsonWriter writer;
+        return writer.dumpInfo(info).c_str();
     }
     return "";
 }
@@ -87,4 +111,52 @@ Java_com_example_overt_Server_startFdListener(JNIEnv *env, jobject thiz, jint fd
 
     LOGI("Fd listener started successfully");
     return 0;
-}
\ No newline at end of file
+}
+/**
+ * Java层发现增量不连续时请求完整同步
+ * 在线程池中发送，不阻塞调用的主线程
+ * @param title 检测类别，为空时同步所有类别
+ */
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_overt_NativeUpdateBus_requestResync(JNIEnv *env, jclass clazz, jstring title) {
+    string title_str;
+    if (title != nullptr) {
+        const char* chars = env->GetStringUTFChars(title, nullptr);
+        if (chars != nullptr) {
+            title_str = chars;
+            env->ReleaseStringUTFChars(title, chars);
+        }
+    }
+    LOGI("requestResync: %s", title_str.empty() ? "all" : title_str.c_str());
+    zThreadPool::getInstance()->addTask("resync_java", zManager::getInstance(), &zManager::resync_java, title_str);
+}
+
+/**
+ * 检测的当前调度（JSON），用于查看各检测的间隔、消耗、推迟与失败次数
+ */
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_example_overt_NativeUpdateBus_getScheduleInfo(JNIEnv *env, jclass clazz) {
+    string schedule_json = zManager::getInstance()->get_schedule_json();
+    return env->NewStringUTF(schedule_json.c_str());
+}
+
+/**
+ * 设置批量通知的时间窗口（毫秒），0 表示每次更新立即通知
+ */
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_overt_NativeUpdateBus_setBatchWindow(JNIEnv *env, jclass clazz, jint window_ms) {
+    zManager::getInstance()->set_notice_batch_window(window_ms);
+}
+
+/**
+ * 各检测的开销统计（JSON），不受 "perf_info" 卡片更新间隔的限制，返回当前的统计
+ */
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_example_overt_NativeUpdateBus_getPerfInfo(JNIEnv *env, jclass clazz) {
+    string perf_json = zManager::getInstance()->get_perf_json();
+    return env->NewStringUTF(perf_json.c_str());
+}
@@ -10,6 +10,7 @@
 #include "zManager.h"
 #include "zSslInfo.h"
 #include "zJson.h"
+#include "zJsonWriter.h"
 #include "zRootStateInfo.h"
 #include "zProcInfo.h"
 #include "zSystemPropInfo.h"
@@ -23,8 +24,13 @@
 #include "zSslInfo.h"
 #include "zLocalNetworkInfo.h"
 #include "zThreadPool.h"
+#include "zTaskGraph.h"
+#include "zProcMaps.h"
+#include "zTriggerScheduler.h"
 #include "zLogcatInfo.h"
 #include "zJavaVm.h"
+#include "zJniCache.h"
+#include "zDetectorPerf.h"
 #include "zSignatureInfo.h"
 #include "zSideChannelInfo.h"
 #include "zIsoloatedProcess.h"
@@ -33,6 +39,7 @@
 #include <mutex>
 #include <thread>
 #include <cmath>
+#include <algorithm>
 
 
 /**
@@ -42,14 +49,6 @@
  */
 zManager* zManager::instance = nullptr;
 
-/**
- * 设备信息存储Map初始化
- * 三层嵌套的Map结构，用于存储所有检测结果
- * 结构：检测类别 -> 检测项目 -> 属性名 -> 属性值
- * 线程安全：通过shared_mutex保护
- */
-map<string, map<string, map<string, string>>> zManager::device_info;
-
 /**
  * 获取单例实例
  * 采用线程安全的懒加载模式，首次调用时创建实例
@@ -104,50 +103,118 @@ zManager::zManager() {
  */
 zManager::~zManager() {
     LOGD("Destructor called");
-    // 清理代码可以在这里添加
+    // 停止批量通知线程，未发送的通知丢弃，Java 层之后可以请求完整同步
+    {
+        std::lock_guard<std::mutex> lock(pending_notices_mutex);
+        notice_batch_stop = true;
+    }
+    pending_notices_cv.notify_all();
+    if (notice_batch_thread.joinable()) {
+        notice_batch_thread.join();
+    }
 }
 
 /**
  * 获取所有设备信息
- * 使用读锁保证线程安全，允许多个线程同时读取
+ * 从当前快照复制一份，需要可修改副本时使用；只读取时使用 get_device_info_snapshot
  * @return 三层嵌套的Map，包含所有收集到的设备信息
  */
 map<string, map<string, map<string, string>>> zManager::get_device_info() const{
     LOGD("get_device_info called");
-    // 使用共享读锁，允许多个线程同时读取
-    std::shared_lock<std::shared_mutex> lock(device_info_mtx_);
-    LOGI("get_device_info: device_info size=%zu", device_info.size());
-    return device_info;
+    zInfoStore::SnapshotPtr snapshot = device_info.getSnapshot();
+    LOGI("get_device_info: device_info size=%zu", snapshot->size());
+    return zInfoStore::toMap(*snapshot);
+};
+
+zInfoStore::SnapshotPtr zManager::get_device_info_snapshot() const{
+    return device_info.getSnapshot();
+};
+
+string zManager::get_device_info_json() const{
+    zInfoStore::SnapshotPtr snapshot = device_info.getSnapshot();
+    zJsonWriter writer;
+    return writer.dumpDeviceInfo(*snapshot);
 };
 
 /**
  * 更新设备信息
- * 使用写锁保证线程安全，确保数据一致性
+ * 生成新快照后原子替换，正在读取旧快照的线程不受影响
  * @param key 信息类别（如"task_info", "maps_info"等）
  * @param value 该类别下的具体信息
  */
 void zManager::update_device_info(const string& key, const map<string, map<string, string>>& value){
     LOGD("update_device_info called, key=%s", key.c_str());
-    // 使用独占写锁，确保更新操作的原子性
-    std::unique_lock<std::shared_mutex> lock(device_info_mtx_);
-    device_info[key] = value;
+    device_info.set(key, value);
     LOGI("update_device_info: updated key=%s", key.c_str());
 };
 
+/**
+ * 增量更新设备信息
+ * 差异在 zInfoStore 的写入互斥内计算，避免两次更新交错时基于过期的结果计算差异
+ */
+bool zManager::update_device_info(const string& key, const map<string, map<string, string>>& value,
+                                  zInfoDiff& diff, uint64_t& version){
+    LOGD("update_device_info called, key=%s", key.c_str());
+    bool changed = device_info.update(key, value, &diff, &version);
+    LOGI("update_device_info: key=%s version=%llu added=%zu changed=%zu removed=%zu", key.c_str(),
+         (unsigned long long) version, diff.added.size(), diff.changed.size(), diff.removed.size());
+    return changed;
+};
+
 map<string, map<string, string>> zManager::get_info(const string& key){
     LOGD("get_info called, key=%s", key.c_str());
-    // 只读查询，使用共享锁并避免 operator[] 导致的隐式插入
-    std::shared_lock<std::shared_mutex> lock(device_info_mtx_);
-    auto it = device_info.find(key);
-    if (it == device_info.end()) {
+    zInfoStore::InfoPtr info = device_info.get(key);
+    if (!info) {
         LOGI("get_info: key not found=%s", key.c_str());
         return {};
     }
     LOGI("get_info: fetched key=%s", key.c_str());
-    return it->second;
+    return *info;
+};
+
+map<string, map<string, string>> zManager::get_info(const string& key, uint64_t& version){
+    zInfoStore::InfoPtr info = device_info.get(key, &version);
+    if (!info) {
+        return {};
+    }
+    return *info;
+};
+
+zInfoStore::InfoPtr zManager::get_info_ptr(const string& key, uint64_t& version) const{
+    return device_info.get(key, &version);
 };
 
 
+map<string, map<string, string>> zManager::get_schedule_info() const {
+    map<string, map<string, string>> schedule_info;
+    uint64_t now = zTask::getMonotonicNs();
+    for (const auto& item : detector_scheduler.getSchedule()) {
+        const zTriggerScheduler::DetectorStats& stats = item.second;
+        map<string, string>& info = schedule_info[item.first];
+        info["runs"] = to_string(stats.runs);
+        info["interval_ms"] = to_string(stats.effectiveStaleMs);
+        info["next_due_ms"] = to_string(stats.nextDueNs > now ? (stats.nextDueNs - now) / 1000000 : 0);
+        info["cost_us"] = to_string(stats.costNs / 1000);
+        info["stable_runs"] = to_string(stats.stableRuns);
+        info["changes"] = to_string(stats.changes);
+        info["deferrals"] = to_string(stats.deferrals);
+        info["failures"] = to_string(stats.failures);
+    }
+    zTriggerScheduler::BudgetUsage usage = detector_scheduler.getBudgetUsage();
+    map<string, string>& budget_info = schedule_info["cpu_budget"];
+    budget_info["budget_us"] = to_string(usage.budgetNs / 1000);
+    budget_info["window_ms"] = to_string(usage.windowMs);
+    budget_info["used_us"] = to_string(usage.usedNs / 1000);
+    budget_info["in_flight_us"] = to_string(usage.inFlightNs / 1000);
+    budget_info["deferrals"] = to_string(usage.deferrals);
+    return schedule_info;
+}
+
+string zManager::get_schedule_json() const {
+    zJsonWriter writer;
+    return writer.dumpInfo(get_schedule_info());
+}
+
 /**
  * 统一的更新和通知方法
  * 封装所有信息收集、存储和通知的通用逻辑
@@ -156,26 +223,188 @@ map<string, map<string, string>> zManager::get_info(const string& key){
  * 1. 调用信息收集函数获取数据
  * 2. 更新设备信息存储
  * 3. 通知Java层更新UI
- * 4. 统一的异常处理
+ * 4. 统一的异常处理，检测抛出异常时向调度器报告失败
+ * 5. 统计检测的耗时、CPU 时间、内存分配与系统调用
  * 
  * @param key 信息类别标识（如"proc_info"、"root_state_info"等）
  * @param get_info_func 获取信息的函数指针
  */
 void zManager::update_info(const string& key, map<string, map<string, string>> (*get_info_func)()) {
     LOGD("update_info called, key=%s", key.c_str());
+    // 统计本次检测的耗时、CPU 时间、内存分配与系统调用
+    zDetectorPerf::Scope perf_scope(detector_perf, key);
+    bool changed = false;
+    bool failed = true;
     try {
         // 调用信息收集函数
         map<string, map<string, string>> info = get_info_func();
-        // 更新设备信息
-        update_device_info(key, info);
-        // 通知Java层
-        notice_java(key);
-        LOGI("update_info: successfully updated and notified for key=%s", key.c_str());
+        // 开销只统计检测本身，不包括更新设备信息与通知Java层
+        perf_scope.finish();
+        // 更新设备信息并通知Java层
+        // 结果是否变化也决定调度器拉长还是恢复该检测的最长间隔
+        changed = publish_info(key, info);
+        failed = false;
     } catch (const std::exception& e) {
         LOGE("update_info: exception for key=%s: %s", key.c_str(), e.what());
     } catch (...) {
         LOGE("update_info: unknown exception for key=%s", key.c_str());
     }
+    // 检测抛出异常时不知道结果是否变化，按失败报告，不拉长最长间隔
+    uint64_t cpu_ns = perf_scope.finish().cpuNs;
+    if (failed) {
+        detector_scheduler.reportFailure(key, cpu_ns);
+    } else {
+        detector_scheduler.reportResult(key, changed, cpu_ns);
+    }
+    publish_perf_info();
+}
+
+/**
+ * 更新设备信息，有变化时通知Java层
+ * 差异不比完整结果小（第一次检测、结果整体替换）时发送完整结果，否则只发送差异
+ * 第一次检测的结果为空时差异也为空，同样算作变化并发送完整（空）结果，Java 层因此得到该类别的版本号
+ * @return 结果是否变化
+ */
+bool zManager::publish_info(const string& key, const map<string, map<string, string>>& info) {
+    // 更新设备信息，同时得到与上次结果的差异
+    zInfoDiff diff;
+    uint64_t version = 0;
+    bool changed = update_device_info(key, info, diff, version);
+    if (!changed) {
+        LOGI("update_info: unchanged, skip notice for key=%s", key.c_str());
+    } else if (notice_batch_window_ms.load() > 0) {
+        // 与窗口内其它检测的更新合并为一次通知
+        queue_notice(key, diff.size() >= info.size() ? nullptr : &diff, version);
+        LOGI("update_info: successfully updated and queued notice for key=%s", key.c_str());
+    } else if (diff.size() >= info.size()) {
+        notice_java(key);
+        LOGI("update_info: successfully updated and notified for key=%s", key.c_str());
+    } else {
+        // 通知Java层
+        notice_java_delta(key, diff, version);
+        LOGI("update_info: successfully updated and notified delta for key=%s", key.c_str());
+    }
+    return changed;
+}
+
+/**
+ * 把检测的开销统计作为 "perf_info" 卡片更新到设备信息
+ * 统计在每次检测后都会变化，按 perf_publish_interval_ms 限制更新频率，多个线程同时到期时只有一个更新
+ */
+void zManager::publish_perf_info() {
+    uint64_t now = zTask::getMonotonicNs();
+    uint64_t last = last_perf_publish_ns.load();
+    if (last != 0 && now - last < (uint64_t) perf_publish_interval_ms * 1000000ULL) {
+        return;
+    }
+    if (!last_perf_publish_ns.compare_exchange_strong(last, now)) {
+        return;
+    }
+    try {
+        publish_info("perf_info", detector_perf.toInfo());
+    } catch (const std::exception& e) {
+        LOGE("publish_perf_info: exception: %s", e.what());
+    } catch (...) {
+        LOGE("publish_perf_info: unknown exception");
+    }
+}
+
+string zManager::get_perf_json() const {
+    return detector_perf.toJson();
+}
+
+/**
+ * 检测任务的调度优先级
+ * - 高：注入、hook 类检测（linker_info、proc_info、side_channel_info），需要尽快拿到结果
+ * - 低：耗时长的批量扫描（包、日志、类、证书、网络、端口），可以在空闲时执行
+ * - 其它为普通
+ */
+static zTask::Priority get_task_priority(const string& task_name) {
+    static const vector<string> high_priority_tasks = {
+        "linker_info", "proc_info", "side_channel_info",
+    };
+    static const vector<string> low_priority_tasks = {
+        "package_info", "logcat_info", "class_info", "ssl_info", "local_network_info", "port_info",
+    };
+    for (const string& name : high_priority_tasks) {
+        if (name == task_name) {
+            return zTask::PRIORITY_HIGH;
+        }
+    }
+    for (const string& name : low_priority_tasks) {
+        if (name == task_name) {
+            return zTask::PRIORITY_LOW;
+        }
+    }
+    return zTask::PRIORITY_NORMAL;
+}
+
+/**
+ * 检测任务依赖的共享输入（zTaskGraph 输入节点），每轮只计算一次
+ * - proc_maps：/proc/self/maps 快照，proc_info（maps 完整性）与 linker_info（内存 so 的 CRC）共用
+ */
+static vector<string> get_task_inputs(const string& task_name) {
+    if (task_name == "proc_info" || task_name == "linker_info") {
+        return {zProcMaps::ROUND_INPUT_NAME};
+    }
+    return {};
+}
+
+/**
+ * 检测任务的触发条件：关心的变化与最长间隔，没有变化时到最长间隔才重新执行
+ * - maps 变化（加载了新的 so、dex）：注入、hook、类加载相关的检测
+ * - 文件变化：su 文件所在目录、外部存储中其它应用的数据目录
+ * - 系统属性变化：属性、设置、TEE 相关的检测
+ * - 网络变化：网络、证书、时间相关的检测
+ * 侧信道、端口等没有事件来源的检测只按最长间隔执行
+ * @param min_interval_ms 同一检测两次执行的最小间隔，频繁的变化合并为一次执行
+ */
+static zTriggerScheduler::Triggers get_task_triggers(const string& task_name, uint64_t min_interval_ms) {
+    const uint64_t minute_ms = 60 * 1000;
+    zTriggerScheduler::Triggers triggers;
+    triggers.minIntervalMs = min_interval_ms;
+    triggers.maxStaleMs = 10 * minute_ms;
+
+    if (task_name == "linker_info" || task_name == "proc_info") {
+        triggers.maps = true;
+        triggers.maxStaleMs = minute_ms;
+    } else if (task_name == "class_loader_info" || task_name == "class_info") {
+        triggers.maps = true;
+        triggers.maxStaleMs = 5 * minute_ms;
+    } else if (task_name == "side_channel_info" || task_name == "port_info") {
+        triggers.maxStaleMs = minute_ms;
+    } else if (task_name == "root_state_info") {
+        triggers.paths = {"/sbin/su", "/system/bin/su", "/system/xbin/su", "/data/local/tmp"};
+        triggers.property = true;
+    } else if (task_name == "package_info") {
+        triggers.paths = {"/storage/emulated/0/Android/data"};
+    } else if (task_name == "system_prop_info" || task_name == "system_setting_info") {
+        triggers.property = true;
+        triggers.maxStaleMs = 2 * minute_ms;
+    } else if (task_name == "tee_info") {
+        // 证书链与设备绑定，重新获取的代价大
+        triggers.property = true;
+        triggers.maxStaleMs = 60 * minute_ms;
+    } else if (task_name == "local_network_info") {
+        triggers.network = true;
+        triggers.maxStaleMs = 5 * minute_ms;
+    } else if (task_name == "ssl_info" || task_name == "time_info") {
+        triggers.network = true;
+        triggers.maxStaleMs = 30 * minute_ms;
+    } else if (task_name == "logcat_info" || task_name == "sensor_info") {
+        triggers.maxStaleMs = 5 * minute_ms;
+    } else if (task_name == "signature_info" || task_name == "finger_info") {
+        triggers.maxStaleMs = 30 * minute_ms;
+    }
+
+    // 结果稳定时最长间隔逐步拉长到 4 倍（TEE、签名、包列表等昂贵且稳定的检测最多拉长到 8 倍），
+    // 注入、hook 类检测保持固定间隔
+    if (task_name == "tee_info" || task_name == "signature_info" || task_name == "package_info") {
+        triggers.maxBackoffMs = triggers.maxStaleMs * 8;
+    } else if (task_name != "linker_info" && task_name != "proc_info" && task_name != "side_channel_info") {
+        triggers.maxBackoffMs = triggers.maxStaleMs * 4;
+    }
+    return triggers;
 }
 
 /**
@@ -205,15 +434,17 @@ void zManager::update_info(const string& key, map<string, map<string, string>> (
  * - side_channel_info: 侧信道检测
  * 
  * 执行机制：
- * - 无限循环，持续监控任务状态
- * - 检查任务是否已在线程池中运行
- * - 未运行的任务会被添加到线程池
- * - 每个周期后等待指定时间间隔
+ * - 每个检测声明触发条件（get_task_triggers），由 zTriggerScheduler 等待文件、网络、系统属性、maps 的变化
+ * - 只有发生变化或超过最长间隔的检测才执行，没有变化时不占用 CPU
+ * - 同一检测两次执行至少间隔 time_interval 秒，仍在线程池中运行的检测等它结束后再执行
+ * - 结果连续不变的检测拉长最长间隔，变化后恢复；每分钟的 CPU 消耗超过 cpu_budget_ms_per_minute 时推迟最贵的检测
+ * - 调度状态可以通过 get_schedule_info 查看
+ * - 同一时刻到期的检测组成一轮任务图（zTaskGraph），共享输入先计算一次，再扇出给依赖它的任务并行执行
  * 
  * 异常处理：
- * - 捕获标准异常和未知异常
- * - 异常时短暂等待后继续执行
- * - 确保任务管理循环不会因异常而停止
+ * - 单个检测的异常在 update_info 中捕获
+ * - 组织任务图的异常被捕获，不影响下一次调度
+ * - 派发后没有执行的检测（共享输入失败被跳过、组织任务图时抛出异常）向调度器报告失败
  */
 void zManager::round_tasks(){
     LOGI("add_tasks: starting periodic task management loop");
@@ -243,35 +474,217 @@ void zManager::round_tasks(){
     };
     LOGI("add_tasks: initialized %zu periodic tasks", periodic_tasks.size());
     
-    // 主循环：持续监控和管理任务
-    while (true) {
+    for (const auto& task : periodic_tasks) {
+        detector_scheduler.addDetector(task.first, get_task_triggers(task.first, (uint64_t) time_interval * 1000));
+    }
+    detector_scheduler.setCpuBudget((uint64_t) cpu_budget_ms_per_minute * 1000000, 60 * 1000);
+    detector_scheduler.setBusyProbe([](const string& task_name) {
+        return zThreadPool::getInstance()->hasTaskName(task_name);
+    });
+
+    // 到期的检测组成一轮任务图
+    detector_scheduler.setDispatcher([this, periodic_tasks](const vector<string>& task_names) {
+        // 还没有开始执行的检测，执行时移除；因共享输入失败被跳过、没有加入任务图的检测在本轮结束后报告失败，
+        // 否则调度器一直认为它们在运行
+        struct RoundPending {
+            std::mutex mutex;
+            vector<string> names;
+
+            bool start(const string& name) {
+                std::lock_guard<std::mutex> lock(mutex);
+                vector<string>::iterator it = std::find(names.begin(), names.end(), name);
+                if (it == names.end()) {
+                    return false;
+                }
+                names.erase(it);
+                return true;
+            }
+
+            vector<string> take() {
+                std::lock_guard<std::mutex> lock(mutex);
+                vector<string> result;
+                result.swap(names);
+                return result;
+            }
+        };
+        std::shared_ptr<RoundPending> pending = std::make_shared<RoundPending>();
+        pending->names = task_names;
+        auto report_not_run = [this, pending]() {
+            vector<string> not_run = pending->take();
+            for (const string& task_name : not_run) {
+                LOGW("add_tasks: task %s was dispatched but did not run", task_name.c_str());
+                detector_scheduler.reportFailure(task_name);
+            }
+        };
+
         try {
-            // 检查每个任务是否需要执行
-            for(const auto& task : periodic_tasks) {
+            zTaskGraph round_graph;
+            for (const auto& task : periodic_tasks) {
                 const string& task_name = task.first;
-                // 如果任务未在线程池中运行，则添加任务
-                if(!zThreadPool::getInstance()->hasTaskName(task_name)){
-                    // 使用 lambda 包装，调用统一的 update_info 方法
-                    zThreadPool::getInstance()->addTask(task_name, [task_name, get_func = task.second]() {
-                        zManager::getInstance()->update_info(task_name, get_func);
-                    });
+                if (std::find(task_names.begin(), task_names.end(), task_name) == task_names.end()) {
+                    continue;
+                }
+                // 本轮需要的共享输入按需加入，没有任务依赖时不计算
+                vector<string> inputs = get_task_inputs(task_name);
+                for (const string& input : inputs) {
+                    if (input == zProcMaps::ROUND_INPUT_NAME && !round_graph.hasNode(input)) {
+                        round_graph.addInput<zProcMaps>(input, []() {
+                            return std::make_shared<zProcMaps>();
+                        }, {}, zTask::PRIORITY_HIGH);
+                    }
                 }
+                // 使用 lambda 包装，调用统一的 update_info 方法
+                round_graph.addNode(task_name, [this, pending, task_name, get_func = task.second]() {
+                    // 失败已经报告过的检测（派发时的异常）不再执行
+                    if (pending->start(task_name)) {
+                        update_info(task_name, get_func);
+                    }
+                }, inputs, get_task_priority(task_name));
             }
-            // 等待一段时间后再次检查
-            LOGD("add_tasks: waiting %d seconds before next cycle", time_interval);
-            sleep(time_interval);
+            LOGD("add_tasks: dispatch %zu triggered tasks", task_names.size());
+            // 不等待本轮结束，仍在运行的任务由 busy 检查推迟
+            round_graph.run(zThreadPool::getInstance()).then("report_not_run", report_not_run);
         } catch (const std::exception& e) {
             LOGE("add_tasks: exception occurred: %s", e.what());
-            sleep(5); // 发生异常时短暂等待
+            report_not_run();
         } catch (...) {
             LOGE("add_tasks: unknown exception occurred");
-            sleep(5); // 发生异常时短暂等待
+            report_not_run();
         }
-    }
+    });
+
+    // 阻塞等待变化并派发检测
+    detector_scheduler.run();
     LOGI("add_tasks: periodic task management loop stopped");
 };
 
 
+static const char* UPDATE_BUS_CLASS = "com/example/overt/NativeUpdateBus";
+
+/**
+ * 从缓存获取 NativeUpdateBus 的类与静态方法，只在第一次调用时解析
+ * @return 找不到类或方法时返回false
+ */
+static bool get_update_bus_method(JNIEnv* env, const char* method_name, const char* signature,
+                                  jclass& bus_class, jmethodID& method_id) {
+    bus_class = zJniCache::getInstance()->getClass(env, UPDATE_BUS_CLASS);
+    if (bus_class == nullptr) {
+        LOGE("notice_java: NativeUpdateBus class is null");
+        return false;
+    }
+    method_id = zJniCache::getInstance()->getStaticMethodId(env, UPDATE_BUS_CLASS, method_name, signature);
+    if (method_id == nullptr) {
+        LOGE("notice_java: method_id %s is null in NativeUpdateBus", method_name);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * 检查并清除 Java 方法抛出的异常
+ * @return 没有异常时返回true
+ */
+static bool check_update_bus_exception(JNIEnv* env) {
+    if (env->ExceptionCheck()) {
+        LOGE("notice_java: Exception occurred during Java method call");
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * 调用 NativeUpdateBus 的静态方法，参数为（标题，版本号，JSON 数据）
+ * @return 调用是否成功
+ */
+static bool call_update_bus(const char* method_name, const string& title, uint64_t version, const string& data) {
+    // 获取JNI环境
+    JNIEnv *env = zJavaVm::getInstance()->getEnv();
+    if(env == nullptr){
+        LOGE("notice_java: env is null");
+        return false;
+    }
+
+    // 方法签名：(Ljava/lang/String;JLjava/lang/String;)V
+    // 参数：标题字符串，版本号，数据字符串
+    // 类是 zJniCache 持有的全局引用，不需要释放
+    jclass bus_class = nullptr;
+    jmethodID method_id = nullptr;
+    if (!get_update_bus_method(env, method_name, "(Ljava/lang/String;JLjava/lang/String;)V", bus_class, method_id)) {
+        return false;
+    }
+
+    // 创建Java字符串对象
+    jstring title_jstr = env->NewStringUTF(title.c_str());
+    jstring data_jstr = title_jstr == nullptr ? nullptr : env->NewStringUTF(data.c_str());
+    if (data_jstr == nullptr) {
+        LOGE("notice_java: Failed to create string for title: %s", title.c_str());
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+        }
+        if (title_jstr != nullptr) {
+            env->DeleteLocalRef(title_jstr);
+        }
+        return false;
+    }
+
+    // 调用Java层方法通知信息更新完成
+    LOGI("notice_java: calling %s for title: %s version: %llu", method_name, title.c_str(), (unsigned long long) version);
+    env->CallStaticVoidMethod(bus_class, method_id, title_jstr, (jlong) version, data_jstr);
+
+    // 检查是否抛出异常
+    bool ok = check_update_bus_exception(env);
+
+    // 清理JNI局部引用，防止内存泄漏
+    env->DeleteLocalRef(title_jstr);
+    env->DeleteLocalRef(data_jstr);
+    return ok;
+}
+
+/**
+ * 调用 NativeUpdateBus.onCardInfoBatch，参数为一批通知组成的 JSON 数组
+ * @return 调用是否成功
+ */
+static bool call_update_bus_batch(const string& batch) {
+    JNIEnv *env = zJavaVm::getInstance()->getEnv();
+    if(env == nullptr){
+        LOGE("notice_java: env is null");
+        return false;
+    }
+
+    jclass bus_class = nullptr;
+    jmethodID method_id = nullptr;
+    if (!get_update_bus_method(env, "onCardInfoBatch", "(Ljava/lang/String;)V", bus_class, method_id)) {
+        return false;
+    }
+
+    jstring batch_jstr = env->NewStringUTF(batch.c_str());
+    if (batch_jstr == nullptr) {
+        LOGE("notice_java: Failed to create string for batch");
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+        }
+        return false;
+    }
+
+    env->CallStaticVoidMethod(bus_class, method_id, batch_jstr);
+    bool ok = check_update_bus_exception(env);
+    env->DeleteLocalRef(batch_jstr);
+    return ok;
+}
+
+/**
+ * 通知Java层的调用互斥，保证同一类别的完整结果与增量按版本号顺序到达
+ */
+static std::mutex notice_java_mutex;
+
+/**
+ * 通知用的 JSON 输出缓冲区，由 notice_java_mutex 保护，反复使用不再分配内存
+ * 直接从快照中的结果序列化，不构造 zJson 的 DOM
+ */
+static zJsonWriter notice_json_writer;
+
 /**
  * 通知Java层更新UI
  * 功能说明：
@@ -279,6 +692,7 @@ void zManager::round_tasks(){
  * 2. 通过JNI调用Java层的静态方法
  * 3. 实现Native层到Java层的数据通信
  * 4. 触发UI更新显示最新的检测结果
+ * 5. 发送完整结果与版本号，Java 层之后的增量以此为基础
  * @param title 检测类型标题，用于标识检测结果
  */
 void zManager::notice_java(string title){
@@ -286,97 +700,169 @@ void zManager::notice_java(string title){
 
     // 添加线程安全保护
     // 使用静态互斥锁确保多线程环境下的安全调用
-    static std::mutex notice_java_mutex;
     std::lock_guard<std::mutex> lock(notice_java_mutex);
 
-    LOGI("notice_java: lock by %s ", title.c_str());
+    // 从当前快照获取设备信息与版本号，不复制数据
+    uint64_t version = 0;
+    zInfoStore::InfoPtr card_data = get_info_ptr(title, version);
 
-    // 获取JNI环境
-    JNIEnv *env = zJavaVm::getInstance()->getEnv();
-    if(env == nullptr){
-        LOGE("notice_java: env is null");
-        return;
+    // 将C++数据直接序列化为JSON，输出与 zJson dump 相同
+    const string& card_data_str = card_data ? notice_json_writer.dumpInfo(*card_data)
+                                            : notice_json_writer.dumpInfo(map<string, map<string, string>>());
+    LOGD("card_data_str:%s", card_data_str.c_str());
+
+    if (call_update_bus("onCardInfoUpdated", title, version, card_data_str)) {
+        LOGI("notice_java: completed successfully for title: %s", title.c_str());
     }
+}
 
-    // 查找NativeUpdateBus类
-    jclass activity_class = zJavaVm::getInstance()->findClass("com/example/overt/NativeUpdateBus");
-    jstring title_jstr = nullptr;
-    jstring card_data_jstr = nullptr;
-    if (activity_class == nullptr) {
-        LOGE("notice_java: activity_class is null");
-        return;
+void zManager::notice_java_delta(const string& title, const zInfoDiff& diff, uint64_t version){
+    LOGI("notice_java_delta: %s version %llu", title.c_str(), (unsigned long long) version);
+    std::lock_guard<std::mutex> lock(notice_java_mutex);
+    string delta_str = diff.toJson();
+    LOGD("delta_str:%s", delta_str.c_str());
+    if (call_update_bus("onCardInfoDelta", title, version, delta_str)) {
+        LOGI("notice_java_delta: completed successfully for title: %s", title.c_str());
     }
+}
 
-    // 获取Java层回调方法ID
-    // 方法签名：(Ljava/lang/String;Ljava/lang/String;)V
-    // 参数：标题字符串，数据字符串
-    // 返回：void
-    jmethodID method_id = env->GetStaticMethodID(activity_class, "onCardInfoUpdated", "(Ljava/lang/String;Ljava/lang/String;)V");
-    if (method_id == nullptr){
-        LOGE("notice_java: method_id onCardInfoUpdated is null in NativeUpdateBus");
-        env->DeleteLocalRef(activity_class);
-        return;
+void zManager::resync_java(const string& title){
+    LOGI("resync_java: %s", title.empty() ? "all" : title.c_str());
+    vector<string> titles;
+    if (!title.empty()) {
+        titles.push_back(title);
+    } else {
+        zInfoStore::SnapshotPtr snapshot = device_info.getSnapshot();
+        for (auto it = snapshot->begin(); it != snapshot->end(); ++it) {
+            titles.push_back(it->first);
+        }
     }
+    bool batch = notice_batch_window_ms.load() > 0;
+    for (const string& key : titles) {
+        // 批量模式下所有类别的完整结果合并为一次调用
+        if (batch) {
+            queue_notice(key, nullptr, 0);
+        } else {
+            notice_java(key);
+        }
+    }
+}
 
-    // 使用读锁安全地获取设备信息
-    map<string, map<string, string>> card_data = get_info(title);
+void zManager::queue_notice(const string& title, const zInfoDiff* diff, uint64_t version){
+    {
+        std::lock_guard<std::mutex> lock(pending_notices_mutex);
+        if (notice_batch_stop) {
+            return;
+        }
+        map<string, PendingNotice>::iterator it = pending_notices.find(title);
+        if (it == pending_notices.end()) {
+            PendingNotice& notice = pending_notices[title];
+            notice.full = diff == nullptr;
+            notice.version = version;
+            if (diff != nullptr) {
+                notice.delta = diff->toJson();
+            }
+        } else {
+            // 窗口内同一类别多次更新，合并为发送时的完整结果
+            it->second.full = true;
+            it->second.delta.clear();
+        }
+        if (!notice_batch_thread.joinable()) {
+            notice_batch_thread = std::thread(&zManager::notice_batch_loop, this);
+        }
+    }
+    pending_notices_cv.notify_one();
+}
 
-    // 将C++数据转换为JSON格式
-    zJson card_data_json = card_data;
-    string card_data_str = card_data_json.dump();
-    LOGE("card_data_str:%s", card_data_str.c_str());
+void zManager::set_notice_batch_window(int window_ms){
+    LOGI("set_notice_batch_window: %d ms", window_ms);
+    notice_batch_window_ms.store(window_ms > 0 ? window_ms : 0);
+    // 已经在等待的通知按新窗口发送，窗口为 0 时立即发送
+    pending_notices_cv.notify_all();
+}
 
-    // 创建Java字符串对象 - 标题
-    title_jstr = env->NewStringUTF(title.c_str());
-    if (title_jstr == nullptr) {
-        LOGE("notice_java: Failed to create title string");
-        if (env->ExceptionCheck()) {
-            env->ExceptionClear();
+void zManager::notice_batch_loop(){
+    LOGI("notice_batch_loop: started");
+    std::unique_lock<std::mutex> lock(pending_notices_mutex);
+    while (!notice_batch_stop) {
+        if (pending_notices.empty()) {
+            pending_notices_cv.wait(lock);
+            continue;
         }
-        env->DeleteLocalRef(activity_class);
-        return;
+        // 窗口从第一个待发送的通知开始计算
+        std::chrono::steady_clock::time_point deadline =
+                std::chrono::steady_clock::now() + std::chrono::milliseconds(notice_batch_window_ms.load());
+        while (!notice_batch_stop && std::chrono::steady_clock::now() < deadline) {
+            pending_notices_cv.wait_until(lock, deadline);
+            int window_ms = notice_batch_window_ms.load();
+            deadline = std::min(deadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(window_ms));
+        }
+        if (notice_batch_stop) {
+            break;
+        }
+        map<string, PendingNotice> batch;
+        batch.swap(pending_notices);
+        lock.unlock();
+        send_notice_batch(batch);
+        lock.lock();
     }
+    LOGI("notice_batch_loop: stopped");
+}
 
-    // 创建Java字符串对象 - 数据
-    card_data_jstr = env->NewStringUTF(card_data_str.c_str());
-    if (card_data_jstr == nullptr) {
-        LOGE("notice_java: Failed to create data string");
-        if (env->ExceptionCheck()) {
-            env->ExceptionClear();
-        }
-        env->DeleteLocalRef(title_jstr);
-        env->DeleteLocalRef(activity_class);
+void zManager::send_notice_batch(const map<string, PendingNotice>& batch){
+    if (batch.empty()) {
         return;
     }
+    // 与单独通知共用互斥，保证同一类别的通知按版本号顺序到达
+    std::lock_guard<std::mutex> lock(notice_java_mutex);
 
-    // 调用Java层方法通知信息更新完成
-    LOGI("notice_java: calling onCardInfoUpdated for title: %s", title.c_str());
-    env->CallStaticVoidMethod(activity_class, method_id, title_jstr, card_data_jstr);
-
-    // 检查是否抛出异常
-    if (env->ExceptionCheck()) {
-        LOGE("notice_java: Exception occurred during Java method call");
-        env->ExceptionDescribe();
-        env->ExceptionClear();
+    // 增量已经是 JSON，直接拼接；完整结果直接序列化，都不经过 DOM
+    zJsonWriter& writer = notice_json_writer;
+    writer.clear();
+    writer.writeRaw("[", 1);
+    size_t count = 0;
+    for (auto it = batch.begin(); it != batch.end(); ++it) {
+        const string& title = it->first;
+        const PendingNotice& notice = it->second;
+        uint64_t version = notice.version;
+        zInfoStore::InfoPtr card_data;
+        if (notice.full) {
+            card_data = get_info_ptr(title, version);
+        }
+        if (count++ > 0) {
+            writer.writeRaw(",", 1);
+        }
+        writer.writeRaw("{\"title\":").writeString(title);
+        writer.writeRaw(",\"version\":").writeUint(version);
+        if (notice.full) {
+            writer.writeRaw(",\"type\":\"full\",\"data\":");
+            if (card_data) {
+                writer.writeInfo(*card_data);
+            } else {
+                writer.writeRaw("{}", 2);
+            }
+        } else {
+            writer.writeRaw(",\"type\":\"delta\",\"data\":").writeRaw(notice.delta);
+        }
+        writer.writeRaw("}", 1);
     }
+    writer.writeRaw("]", 1);
+    const string& batch_str = writer.getBuffer();
+    LOGD("batch_str:%s", batch_str.c_str());
 
-    // 清理JNI局部引用，防止内存泄漏
-    env->DeleteLocalRef(title_jstr);
-    env->DeleteLocalRef(card_data_jstr);
-    env->DeleteLocalRef(activity_class);
-
-    LOGI("notice_java: completed successfully for title: %s", title.c_str());
+    if (call_update_bus_batch(batch_str)) {
+        LOGI("send_notice_batch: completed successfully for %zu titles", count);
+    }
 }
 
 /**
  * 清空所有设备信息
- * 使用写锁保证线程安全
+ * 替换为空快照，正在读取旧快照的线程不受影响
  * 通常在信息返回给Java层后调用，避免重复返回
  */
 void zManager::clear_device_info(){
     LOGD("clear_device_info called");
-    // 使用独占写锁，确保清空操作的原子性
-    std::unique_lock<std::shared_mutex> lock(device_info_mtx_);
+    // 替换为空快照，版本号保留
     device_info.clear();
     LOGI("clear_device_info");
 };
@@ -6,11 +6,18 @@
 #define OVERT_ZMANAGER_H
 
 #include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
 #include <jni.h>
 #include "zLibc.h"
 #include "zLibcUtil.h"
 #include "zStd.h"
 #include "zStdUtil.h"
+#include "zTriggerScheduler.h"
+#include "zInfoDiff.h"
+#include "zInfoStore.h"
+#include "zDetectorPerf.h"
 
 /**
  * 设备信息管理器类 - Overt安全检测工具的核心管理器
@@ -25,7 +32,7 @@
  * 
  * 设计特点：
  * - 单例模式：确保全局唯一，避免资源冲突
- * - 线程安全：使用读写锁保护数据访问
+ * - 线程安全：设备信息使用写时复制快照，读取不加锁
  * - 模块化：支持多种检测模块的集成
  * - 异步处理：支持后台任务执行
  * - 内存优化：智能管理检测数据生命周期
@@ -35,9 +42,8 @@
  * 例如：device_info["root_state_info"]["su文件检测"]["risk"] = "error"
  * 
  * 线程安全机制：
- * - 使用std::shared_mutex实现读写锁
- * - 读操作使用共享锁，允许多线程并发读取
- * - 写操作使用独占锁，确保数据一致性
+ * - 设备信息使用写时复制快照（zInfoStore），读操作取得快照引用，不加锁、不复制
+ * - 写操作串行执行，生成新快照后原子替换，确保数据一致性
  * 
  * 生命周期管理：
  * - 在Native库加载时自动创建
@@ -79,10 +85,35 @@ private:
     
     /**
      * 任务执行间隔时间（秒）
-     * 控制各个检测任务的执行频率
+     * 同一检测两次执行的最小间隔，检测只在触发条件满足（变化或超过最长间隔）时执行
      * 默认10秒，可根据需要调整
      */
     int time_interval = 10;
+
+    /**
+     * 检测每分钟可以消耗的 CPU 时间（毫秒）
+     * 超出时推迟估计消耗最大的检测，默认 3 秒，约为单核的 5%
+     */
+    int cpu_budget_ms_per_minute = 3000;
+
+    /**
+     * 检测调度器
+     * 按变化触发检测，结果稳定时拉长检测的最长间隔，并按 cpu_budget_ms_per_minute 限制 CPU 消耗
+     */
+    zTriggerScheduler detector_scheduler;
+
+    /**
+     * 检测的开销统计：耗时、线程 CPU 时间、内存分配次数、系统调用次数（近似）
+     * 每个检测按最近的执行计算百分位数，作为 "perf_info" 卡片放入设备信息
+     */
+    zDetectorPerf detector_perf;
+
+    /**
+     * "perf_info" 卡片的最短更新间隔（毫秒）
+     * 开销统计每次检测后都会变化，限制更新频率避免频繁通知Java层
+     */
+    int perf_publish_interval_ms = 30000;
+    std::atomic<uint64_t> last_perf_publish_ns{0};
     
     // ==================== 任务状态管理 ====================
     
@@ -121,16 +152,47 @@ private:
      * 示例结构：
      * device_info["root_state_info"]["su文件检测"]["risk"] = "error"
      * device_info["root_state_info"]["su文件检测"]["explain"] = "检测到su文件"
+     *
+     * 写时复制：每次更新生成新的不可变快照并原子替换，读取只取得快照的引用，
+     * 不复制数据也不加读写锁；没有变化的类别结果在快照之间共享
+     * 每个类别带版本号，结果变化一次加一，Java 层按版本号检查增量是否连续，不连续时请求完整同步
      */
-    static map<string, map<string, map<string, string>>> device_info;
+    zInfoStore device_info;
+
+    // ==================== Java 层通知 ====================
 
     /**
-     * 设备信息读写锁
-     * 使用shared_mutex实现读写锁机制：
-     * - 读操作使用共享锁，允许多线程并发读取
-     * - 写操作使用独占锁，确保数据一致性
+     * 批量通知的时间窗口（毫秒）
+     * 大于 0 时，窗口内各检测的结果更新合并为一次 NativeUpdateBus.onCardInfoBatch 调用；
+     * 为 0（默认）时每次更新立即单独通知；Java 层通过 NativeUpdateBus.setBatchWindow 开启
      */
-    mutable std::shared_mutex device_info_mtx_;
+    std::atomic<int> notice_batch_window_ms{0};
+
+    /**
+     * 等待批量发送的通知
+     * 同一类别在窗口内多次更新时合并为一次完整结果，发送时再读取最新结果与版本号
+     */
+    struct PendingNotice {
+        bool full = false;
+        uint64_t version = 0;   // 增量应用之后的版本号
+        string delta;           // full 为 false 时的增量 JSON
+    };
+
+    map<string, PendingNotice> pending_notices;
+    std::mutex pending_notices_mutex;
+    std::condition_variable pending_notices_cv;
+    std::thread notice_batch_thread;    // 第一次加入批量通知时启动
+    bool notice_batch_stop = false;
+
+    /**
+     * 批量通知线程：第一个通知到达后等待一个窗口，把期间积累的通知一起发送
+     */
+    void notice_batch_loop();
+
+    /**
+     * 把一批通知组成 JSON 数组，一次调用 NativeUpdateBus.onCardInfoBatch
+     */
+    void send_notice_batch(const map<string, PendingNotice>& batch);
 
 public:
     // ==================== 单例模式接口 ====================
@@ -183,40 +245,65 @@ public:
      * 
      * 功能说明：
      * 1. 返回完整的设备信息存储结构
-     * 2. 使用读锁保护，支持并发读取
-     * 3. 返回引用，避免数据拷贝
+     * 2. 从当前快照复制，不加锁
+     * 3. 只读取时使用 get_device_info_snapshot，避免数据拷贝
      * 
      * 线程安全：
-     * - 使用共享读锁，允许多线程并发读取
-     * - 不会阻塞其他读操作
+     * - 快照不可变，允许多线程并发读取
+     * - 不会阻塞读写操作
      * 
-     * @return 三层嵌套Map的常量引用，包含所有检测结果
+     * @return 三层嵌套Map的副本，包含所有检测结果
      */
     map<string, map<string, map<string, string>>> get_device_info() const;
 
+    /**
+     * 获取所有设备信息的快照
+     * O(1)，不复制数据；快照不可变，可以在任意线程持有并遍历
+     */
+    zInfoStore::SnapshotPtr get_device_info_snapshot() const;
+
+    /**
+     * 所有设备信息的 JSON，{类别:{项目:{属性:值}}}
+     * 从快照直接序列化，与 zJson(get_device_info()).dump() 相同，但不复制数据、不构造 DOM
+     */
+    string get_device_info_json() const;
+
     /**
      * 更新设备信息
      * 
      * 功能说明：
      * 1. 更新指定类别的设备信息
-     * 2. 使用写锁保护，确保数据一致性
+     * 2. 生成新快照后原子替换，确保数据一致性
      * 3. 支持增量更新和全量替换
      * 
      * 线程安全：
-     * - 使用独占写锁，确保更新原子性
-     * - 会阻塞其他读写操作
+     * - 写操作串行执行，确保更新原子性
+     * - 不会阻塞读操作
      * 
      * @param key 信息类别标识（如"root_state_info"、"proc_info"）
      * @param value 该类别下的具体信息，二层嵌套Map
      */
     void update_device_info(const string& key, const map<string, map<string, string>>& value);
 
+    /**
+     * 增量更新设备信息
+     * 在写入互斥内计算与当前结果的差异，有变化时才替换并把版本号加一
+     *
+     * @param key 信息类别标识
+     * @param value 新的检测结果
+     * @param diff 返回与上次结果的差异
+     * @param version 返回更新后的版本号（没有变化时为当前版本号）
+     * @return 结果是否变化
+     */
+    bool update_device_info(const string& key, const map<string, map<string, string>>& value,
+                            zInfoDiff& diff, uint64_t& version);
+
     /**
      * 获取指定类别的设备信息
      * 
      * 功能说明：
      * 1. 根据类别键获取对应的设备信息
-     * 2. 使用写锁保护，确保数据一致性
+     * 2. 从当前快照读取，不加锁
      * 3. 返回数据副本，避免外部修改
      * 
      * @param key 信息类别标识
@@ -224,6 +311,30 @@ public:
      */
     map<string, map<string, string>> get_info(const string& key);
 
+    /**
+     * 获取指定类别的设备信息及其版本号，两者来自同一个快照
+     */
+    map<string, map<string, string>> get_info(const string& key, uint64_t& version);
+
+    /**
+     * 获取指定类别结果的快照引用及其版本号，不复制数据
+     * @return 类别不存在时返回nullptr
+     */
+    zInfoStore::InfoPtr get_info_ptr(const string& key, uint64_t& version) const;
+
+    /**
+     * 获取检测的当前调度
+     * 每个检测一项：生效的最长间隔、距下次到期的时间、估计 CPU 消耗、推迟与失败次数等，
+     * "cpu_budget" 项为预算与窗口内的使用量
+     * @return 检测名称 -> 属性 -> 值
+     */
+    map<string, map<string, string>> get_schedule_info() const;
+
+    /**
+     * get_schedule_info 的 JSON，{检测名称:{属性:值}}，通过 NativeUpdateBus.getScheduleInfo 提供给Java层
+     */
+    string get_schedule_json() const;
+
     /**
      * 清空所有设备信息
      * 
@@ -238,7 +349,7 @@ public:
      * - 重置检测状态
      * 
      * 线程安全：
-     * - 使用独占写锁，确保清空操作原子性
+     * - 原子替换为空快照，已经取得的快照不受影响
      */
     void clear_device_info();
 
@@ -255,7 +366,41 @@ public:
     void raise_thread_priority(int sched_priority = 0);
 
     void update_test_info();
+    /**
+     * 把指定类别的完整结果与版本号通知Java层（NativeUpdateBus.onCardInfoUpdated）
+     */
     void notice_java(string title);
+
+    /**
+     * 只把变化的部分通知Java层（NativeUpdateBus.onCardInfoDelta）
+     * @param version 应用差异之后的版本号，Java 层当前版本为 version - 1 时才能直接应用
+     */
+    void notice_java_delta(const string& title, const zInfoDiff& diff, uint64_t version);
+
+    /**
+     * 完整同步：把指定类别（为空时为所有类别）的完整结果与版本号发送给Java层
+     * Java 层发现增量不连续或解析失败时通过 NativeUpdateBus.requestResync 调用
+     */
+    void resync_java(const string& title);
+
+    /**
+     * 加入批量通知，窗口结束时与其它通知一起发送
+     * @param diff 增量，为nullptr时发送完整结果
+     * @param version 应用增量之后的版本号
+     */
+    void queue_notice(const string& title, const zInfoDiff* diff, uint64_t version);
+
+    /**
+     * 设置批量通知的时间窗口，0 表示每次更新立即通知
+     */
+    void set_notice_batch_window(int window_ms);
+
+    /**
+     * 各检测的开销统计（JSON，时间单位 us）：
+     * {检测名称:{"runs","samples","total_cpu_us","wall":{p50_us,p90_us,p99_us,max_us},"cpu":{...},"allocs":{p50,...},"syscalls":{...}}}
+     * 通过 NativeUpdateBus.getPerfInfo 提供给Java层
+     */
+    string get_perf_json() const;
     void round_tasks();
 
 private:
@@ -268,12 +413,24 @@ private:
      * 2. 更新设备信息存储
      * 3. 通知Java层更新UI
      * 4. 统一的异常处理
+     * 5. 统计检测的耗时、CPU 时间、内存分配与系统调用
      * 
      * @param key 信息类别标识（如"proc_info"、"root_state_info"等）
      * @param get_info_func 获取信息的函数指针
      */
     void update_info(const string& key, map<string, map<string, string>> (*get_info_func)());
 
+    /**
+     * 更新指定类别的设备信息，有变化时通知Java层（立即或加入批量通知）
+     * @return 结果是否变化
+     */
+    bool publish_info(const string& key, const map<string, map<string, string>>& info);
+
+    /**
+     * 按 perf_publish_interval_ms 把 detector_perf 的统计更新为 "perf_info" 卡片
+     */
+    void publish_perf_info();
+
 };
 
 #endif //OVERT_ZMANAGER_H
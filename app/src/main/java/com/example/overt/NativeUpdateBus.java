@@ -4,7 +4,12 @@ import android.os.Handler;
 import android.os.Looper;
 import android.util.Log;
 
+import org.json.JSONArray;
+import org.json.JSONException;
+import org.json.JSONObject;
+
 import java.util.ArrayList;
+import java.util.Iterator;
 import java.util.LinkedHashMap;
 import java.util.List;
 import java.util.Map;
@@ -12,6 +17,8 @@ import java.util.Map;
 /**
  * Native -> UI 更新总线。
  * 所有分发都在主线程执行，避免直接静态持有 Activity。
+ * Native 层在检测结果变化时只发送增量（onCardInfoDelta），由这里合并为完整结果再分发；
+ * 每个检测项带版本号，增量不连续时请求 Native 层完整同步（onCardInfoUpdated）。
  */
 public final class NativeUpdateBus {
     private static final String TAG = "overt_" + NativeUpdateBus.class.getSimpleName();
@@ -19,6 +26,7 @@ public final class NativeUpdateBus {
 
     private static final List<Listener> LISTENERS = new ArrayList<>();
     private static final LinkedHashMap<String, String> LATEST_UPDATES = new LinkedHashMap<>();
+    private static final Map<String, Long> LATEST_VERSIONS = new LinkedHashMap<>();
 
     public interface Listener {
         void onCardInfoUpdated(String title, String newCardInfo);
@@ -58,20 +66,157 @@ public final class NativeUpdateBus {
     }
 
     /**
-     * 由 Native 层通过 JNI 调用。
+     * 由 Native 层通过 JNI 调用，携带完整结果。
      */
-    public static void onCardInfoUpdated(String title, String newCardInfo) {
+    public static void onCardInfoUpdated(String title, long version, String newCardInfo) {
         runOnMainThread(new Runnable() {
             @Override
             public void run() {
-                LATEST_UPDATES.put(title, newCardInfo);
-                for (Listener listener : LISTENERS) {
-                    dispatchToListener(listener, title, newCardInfo);
+                handleFull(title, version, newCardInfo);
+            }
+        });
+    }
+
+    /**
+     * 由 Native 层通过 JNI 调用，携带相对上一版本的增量：
+     * {"added":{项目:{属性:值}},"changed":{项目:{属性:值}},"removed":[项目]}
+     */
+    public static void onCardInfoDelta(String title, long version, String delta) {
+        runOnMainThread(new Runnable() {
+            @Override
+            public void run() {
+                handleDelta(title, version, delta);
+            }
+        });
+    }
+
+    /**
+     * 由 Native 层通过 JNI 调用，批量通知模式下一个时间窗口内的所有更新合并为一次调用：
+     * [{"title":检测项,"version":版本号,"type":"full"|"delta","data":{...}}]
+     * 按数组顺序逐项处理，与分别调用 onCardInfoUpdated / onCardInfoDelta 等价。
+     */
+    public static void onCardInfoBatch(String batch) {
+        runOnMainThread(new Runnable() {
+            @Override
+            public void run() {
+                JSONArray updates;
+                try {
+                    updates = new JSONArray(batch);
+                } catch (JSONException e) {
+                    Log.e(TAG, "Failed to parse batch", e);
+                    requestResyncSafely("");
+                    return;
+                }
+                for (int i = 0; i < updates.length(); i++) {
+                    JSONObject update = updates.optJSONObject(i);
+                    if (update == null) {
+                        continue;
+                    }
+                    String title = update.optString("title");
+                    long version = update.optLong("version");
+                    JSONObject data = update.optJSONObject("data");
+                    if (data == null) {
+                        requestResyncSafely(title);
+                        continue;
+                    }
+                    if ("delta".equals(update.optString("type"))) {
+                        handleDelta(title, version, data.toString());
+                    } else {
+                        handleFull(title, version, data.toString());
+                    }
                 }
             }
         });
     }
 
+    private static void handleFull(String title, long version, String cardInfo) {
+        Long current = LATEST_VERSIONS.get(title);
+        if (current != null && version < current) {
+            // 已经应用了更新的增量
+            return;
+        }
+        publish(title, version, cardInfo);
+    }
+
+    private static void handleDelta(String title, long version, String delta) {
+        Long current = LATEST_VERSIONS.get(title);
+        long currentVersion = current == null ? 0 : current;
+        if (version <= currentVersion) {
+            return;
+        }
+        if (version != currentVersion + 1) {
+            Log.w(TAG, "Delta version gap for title=" + title + ": " + currentVersion + " -> " + version);
+            requestResyncSafely(title);
+            return;
+        }
+        try {
+            String latest = LATEST_UPDATES.get(title);
+            JSONObject card = latest == null ? new JSONObject() : new JSONObject(latest);
+            applyDelta(card, new JSONObject(delta));
+            publish(title, version, card.toString());
+        } catch (JSONException e) {
+            Log.e(TAG, "Failed to apply delta for title=" + title, e);
+            requestResyncSafely(title);
+        }
+    }
+
+    private static void applyDelta(JSONObject card, JSONObject delta) throws JSONException {
+        JSONArray removed = delta.optJSONArray("removed");
+        if (removed != null) {
+            for (int i = 0; i < removed.length(); i++) {
+                card.remove(removed.getString(i));
+            }
+        }
+        String[] sections = {"added", "changed"};
+        for (String section : sections) {
+            JSONObject items = delta.optJSONObject(section);
+            if (items == null) {
+                continue;
+            }
+            Iterator<String> keys = items.keys();
+            while (keys.hasNext()) {
+                String key = keys.next();
+                card.put(key, items.getJSONObject(key));
+            }
+        }
+    }
+
+    private static void publish(String title, long version, String cardInfo) {
+        LATEST_UPDATES.put(title, cardInfo);
+        LATEST_VERSIONS.put(title, version);
+        for (Listener listener : LISTENERS) {
+            dispatchToListener(listener, title, cardInfo);
+        }
+    }
+
+    private static void requestResyncSafely(String title) {
+        try {
+            requestResync(title);
+        } catch (UnsatisfiedLinkError e) {
+            Log.e(TAG, "requestResync unavailable for title=" + title, e);
+        }
+    }
+
+    /**
+     * 请求 Native 层重新发送完整结果，title 为空时同步所有检测项。
+     */
+    private static native void requestResync(String title);
+
+    /**
+     * Native 层检测调度的 JSON：每个检测的最长间隔、距下次到期时间、估计 CPU 消耗、推迟与失败次数，以及 CPU 预算使用量。
+     */
+    public static native String getScheduleInfo();
+
+    /**
+     * Native 层各检测的开销统计 JSON：执行次数、耗时与 CPU 时间的百分位数（us）、内存分配与系统调用次数。
+     */
+    public static native String getPerfInfo();
+
+    /**
+     * 设置 Native 层批量通知的时间窗口（毫秒）：窗口内的更新合并为一次 onCardInfoBatch，0（默认）表示每次更新立即通知。
+     */
+    public static native void setBatchWindow(int windowMs);
+
     private static void dispatchToListener(Listener listener, String title, String newCardInfo) {
         try {
             listener.onCardInfoUpdated(title, newCardInfo);
@@ -1,9 +1,11 @@
 #include "zBinder.h"
 #include "zLog.h"
+#include "zCancelToken.h"
 #include <android/sharedmem.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <cstring>
+#include <climits>
 #include <linux/futex.h>
 #include <mutex>
 #include <thread>
@@ -14,12 +16,12 @@
 zBinder* zBinder::instance = nullptr;
 
 // Futex 辅助函数
-static int futex_wait(volatile int* addr, int val) {
-    return syscall(__NR_futex, addr, FUTEX_WAIT, val, NULL, NULL, 0);
+static int futex_wait(volatile int* addr, int val, const struct timespec* timeout = NULL) {
+    return syscall(__NR_futex, addr, FUTEX_WAIT, val, timeout, NULL, 0);
 }
 
-static int futex_wake(volatile int* addr) {
-    return syscall(__NR_futex, addr, FUTEX_WAKE, 1, NULL, NULL, 0);
+static int futex_wake(volatile int* addr, int count = 1) {
+    return syscall(__NR_futex, addr, FUTEX_WAKE, count, NULL, NULL, 0);
 }
 
 /**
@@ -125,9 +127,9 @@ int zBinder::mapSharedMemory(int fd) {
     return 0;
 }
 
-void zBinder::waitForReady(int target_value) {
+bool zBinder::waitForReady(int target_value) {
     if (m_ptr == nullptr) {
-        return;
+        return false;
     }
     
     ShmLayout* layout = static_cast<ShmLayout*>(m_ptr);
@@ -135,7 +137,7 @@ void zBinder::waitForReady(int target_value) {
     
     // 快速路径：如果已经就绪，直接返回
     if (ready == target_value) {
-        return;
+        return true;
     }
     
     // 第一阶段：短时间自旋等待
@@ -143,22 +145,34 @@ void zBinder::waitForReady(int target_value) {
     while (spin_count < 1000 && ready != target_value) {
         ready = layout->ready.load(std::memory_order_acquire);
         if (ready == target_value) {
-            return;
+            return true;
         }
         __asm__ __volatile__("yield" ::: "memory");
         spin_count++;
     }
     
     // 第二阶段：使用 futex 阻塞等待
+    // 在线程池任务中等待时响应取消：取消回调唤醒 futex；回调可能发生在检查之后、进入等待之前，
+    // 因此有令牌时每次最多等待 100ms 再检查
     volatile int* ready_ptr = reinterpret_cast<volatile int*>(&layout->ready);
+    zCancelToken token = zCancelToken::current();
+    zCancelCallback wake_on_cancel(token, [ready_ptr]() {
+        futex_wake(ready_ptr, INT_MAX);
+    });
+    struct timespec cancel_check_interval = {0, 100 * 1000 * 1000};
     while (ready != target_value) {
+        if (token.isCancelled()) {
+            LOGW("waitForReady: cancelled (%s) while waiting for %d", token.getReason().c_str(), target_value);
+            return false;
+        }
         int current = layout->ready.load(std::memory_order_acquire);
         if (current == target_value) {
             break;
         }
-        futex_wait(ready_ptr, current);
+        futex_wait(ready_ptr, current, token.isValid() ? &cancel_check_interval : NULL);
         ready = layout->ready.load(std::memory_order_acquire);
     }
+    return true;
 }
 
 void zBinder::wakeWaiter() {
@@ -188,7 +202,10 @@ int zBinder::sendMsg(const char* message) {
     int ready = layout->ready.load(std::memory_order_acquire);
     if (ready == 1) {
         // 消息已发送但还没收到回复，等待回复
-        waitForReady(2);
+        if (!waitForReady(2)) {
+            LOGE("sendMsg: cancelled while waiting for previous reply");
+            return -1;
+        }
     }
     
     // 重置状态并写入消息
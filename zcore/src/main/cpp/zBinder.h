@@ -160,7 +160,8 @@ private:
     std::function<std::string(std::string)> m_message_callback;
     
     // 内部辅助函数
-    void waitForReady(int target_value);
+    // 等待 ready 变为 target_value，在线程池任务中被取消时返回false
+    bool waitForReady(int target_value);
     void wakeWaiter();
     
     // 消息循环线程函数
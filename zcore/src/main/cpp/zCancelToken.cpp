@@ -0,0 +1,183 @@
+//
+// Created by lxz on 2025/11/29.
+// zCancelToken 实现 - 任务的协作式取消令牌
+//
+
+#include <poll.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <chrono>
+
+#include "zCancelToken.h"
+
+// 当前线程正在执行的任务的令牌
+static thread_local zCancelToken tls_current_token;
+
+zCancelToken::State::~State() {
+    if (eventFd >= 0) {
+        close(eventFd);
+    }
+}
+
+zCancelToken zCancelToken::create() {
+    return zCancelToken(std::make_shared<State>());
+}
+
+string zCancelToken::getReason() const {
+    if (!m_state) {
+        return "";
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->reason;
+}
+
+bool zCancelToken::cancel(const string& reason) const {
+    if (!m_state) {
+        return false;
+    }
+
+    vector<pair<uint64_t, std::function<void()>>> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (m_state->cancelled.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        m_state->reason = reason;
+        m_state->cancelled.store(true, std::memory_order_release);
+        pending.swap(m_state->callbacks);
+        m_state->runningCallbacks = !pending.empty();
+        m_state->callbackThread = std::this_thread::get_id();
+        if (m_state->eventFd >= 0) {
+            eventfd_write(m_state->eventFd, 1);
+        }
+        m_state->cv.notify_all();
+    }
+
+    LOGD("zCancelToken: cancelled (%s), %zu callbacks", reason.c_str(), pending.size());
+    if (pending.empty()) {
+        return true;
+    }
+
+    // 回调在锁外执行，回调中可以再访问令牌
+    for (size_t i = 0; i < pending.size(); i++) {
+        try {
+            pending[i].second();
+        } catch (...) {
+            LOGE("zCancelToken: cancel callback %llu threw an exception", (unsigned long long) pending[i].first);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    m_state->runningCallbacks = false;
+    m_state->cv.notify_all();
+    return true;
+}
+
+uint64_t zCancelToken::registerCallback(std::function<void()> callback) const {
+    if (!m_state || !callback) {
+        return 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (!m_state->cancelled.load(std::memory_order_relaxed)) {
+            uint64_t callbackId = m_state->nextCallbackId++;
+            m_state->callbacks.push_back(pair<uint64_t, std::function<void()>>(callbackId, callback));
+            return callbackId;
+        }
+    }
+    callback();
+    return 0;
+}
+
+void zCancelToken::unregisterCallback(uint64_t callbackId) const {
+    if (!m_state || callbackId == 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    vector<pair<uint64_t, std::function<void()>>>& callbacks = m_state->callbacks;
+    for (size_t i = 0; i < callbacks.size(); i++) {
+        if (callbacks[i].first == callbackId) {
+            callbacks.erase(callbacks.begin() + i);
+            return;
+        }
+    }
+
+    // 不在列表中：已经被 cancel 取走，等待回调执行完（回调内注销自己时不等待）
+    m_state->cv.wait(lock, [this]() {
+        return !m_state->runningCallbacks || m_state->callbackThread == std::this_thread::get_id();
+    });
+}
+
+bool zCancelToken::waitCancelled(uint64_t timeoutMs) const {
+    if (!m_state) {
+        usleep(timeoutMs * 1000);
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    return m_state->cv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() {
+        return m_state->cancelled.load(std::memory_order_relaxed);
+    });
+}
+
+int zCancelToken::waitFd(int fd, short events, int timeoutMs) const {
+    struct pollfd fds[2];
+    fds[0].fd = fd;
+    fds[0].events = events;
+    fds[0].revents = 0;
+    nfds_t count = 1;
+
+    if (m_state) {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (m_state->cancelled.load(std::memory_order_relaxed)) {
+            errno = ECANCELED;
+            return -1;
+        }
+        if (m_state->eventFd < 0) {
+            m_state->eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        }
+        if (m_state->eventFd >= 0) {
+            fds[1].fd = m_state->eventFd;
+            fds[1].events = POLLIN;
+            fds[1].revents = 0;
+            count = 2;
+        }
+    }
+
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+        int ret = poll(fds, count, timeoutMs);
+        if (ret < 0 && errno == EINTR) {
+            // 被信号打断，按剩余时间继续等待
+            if (timeoutMs >= 0) {
+                int64_t remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+                timeoutMs = remaining > 0 ? (int) remaining : 0;
+            }
+            continue;
+        }
+        if (isCancelled()) {
+            errno = ECANCELED;
+            return -1;
+        }
+        if (ret <= 0) {
+            return ret;
+        }
+        return fds[0].revents;
+    }
+}
+
+zCancelToken zCancelToken::current() {
+    return tls_current_token;
+}
+
+bool zCancelToken::isCurrentCancelled() {
+    return tls_current_token.isCancelled();
+}
+
+zCancelScope::zCancelScope(const zCancelToken& token) : m_previous(tls_current_token) {
+    tls_current_token = token;
+}
+
+zCancelScope::~zCancelScope() {
+    tls_current_token = m_previous;
+}
@@ -0,0 +1,149 @@
+//
+// Created by lxz on 2025/11/29.
+// zCancelToken - 任务的协作式取消令牌
+//
+
+#ifndef OVERT_ZCANCELTOKEN_H
+#define OVERT_ZCANCELTOKEN_H
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+#include "zLog.h"
+#include "zStd.h"
+
+/**
+ * 协作式取消令牌
+ * 线程不能被强制终止，取消只是一个标记：任务函数轮询 isCancelled，
+ * 或者注册回调（杀掉子进程、关闭 socket、唤醒 futex），让阻塞中的调用尽快返回
+ *
+ * 令牌之间共享同一个状态，拷贝开销只是一个 shared_ptr；默认构造的空令牌永远不会被取消
+ * 线程池执行任务时把任务的令牌设为当前线程的令牌，zcore 中的阻塞调用（runShell、zHttps 连接与读写、
+ * zBinder 等待）通过 current() 取得令牌，不需要修改接口
+ */
+class zCancelToken {
+private:
+    struct State {
+        std::atomic<bool> cancelled{false};
+        std::mutex mutex;
+        std::condition_variable cv;
+        string reason;
+
+        vector<pair<uint64_t, std::function<void()>>> callbacks;
+        uint64_t nextCallbackId = 1;
+
+        // cancel 正在执行回调，unregisterCallback 需要等待回调结束
+        bool runningCallbacks = false;
+        std::thread::id callbackThread;
+
+        // waitFd 使用的 eventfd，第一次使用时创建，取消时写入
+        int eventFd = -1;
+
+        ~State();
+    };
+
+    std::shared_ptr<State> m_state;
+
+    explicit zCancelToken(const std::shared_ptr<State>& state) : m_state(state) {}
+
+public:
+    // 空令牌，isValid 返回false，永远不会被取消
+    zCancelToken() {}
+
+    /**
+     * 创建新的可取消令牌
+     */
+    static zCancelToken create();
+
+    bool isValid() const { return m_state != nullptr; }
+
+    bool isCancelled() const {
+        return m_state && m_state->cancelled.load(std::memory_order_acquire);
+    }
+
+    // 取消原因，未取消时为空
+    string getReason() const;
+
+    /**
+     * 取消，在当前线程上依次执行已注册的回调
+     * @return 是否是第一次取消，空令牌返回false
+     */
+    bool cancel(const string& reason = "cancelled") const;
+
+    /**
+     * 注册取消回调，已经取消时立即在当前线程调用
+     * 回调应该很短（kill、shutdown、futex 唤醒），不能阻塞
+     * @return 回调ID，用于 unregisterCallback；空令牌或已取消时返回 0
+     */
+    uint64_t registerCallback(std::function<void()> callback) const;
+
+    /**
+     * 注销回调，回调正在其它线程执行时等待其结束
+     * 返回后回调不会再被调用，可以安全释放回调引用的资源（例如 waitpid 回收子进程）
+     */
+    void unregisterCallback(uint64_t callbackId) const;
+
+    /**
+     * 休眠最多 timeoutMs 毫秒，被取消时提前返回
+     * @return 是否已被取消
+     */
+    bool waitCancelled(uint64_t timeoutMs) const;
+
+    /**
+     * 等待 fd 就绪，同时等待取消，用于替代 poll / select
+     * @return 大于 0 为 fd 的 revents，0 为超时，-1 为出错；被取消时返回 -1，errno 为 ECANCELED
+     */
+    int waitFd(int fd, short events, int timeoutMs) const;
+
+    /**
+     * 当前线程正在执行的任务的令牌，不在任务中时返回空令牌
+     */
+    static zCancelToken current();
+
+    static bool isCurrentCancelled();
+
+    friend class zCancelScope;
+};
+
+/**
+ * 设置当前线程的取消令牌，析构时恢复之前的令牌
+ */
+class zCancelScope {
+private:
+    zCancelToken m_previous;
+
+public:
+    explicit zCancelScope(const zCancelToken& token);
+
+    ~zCancelScope();
+
+    zCancelScope(const zCancelScope&) = delete;
+    zCancelScope& operator=(const zCancelScope&) = delete;
+};
+
+/**
+ * 作用域内注册的取消回调，析构时注销
+ */
+class zCancelCallback {
+private:
+    zCancelToken m_token;
+    uint64_t m_callbackId;
+
+public:
+    zCancelCallback(const zCancelToken& token, std::function<void()> callback)
+        : m_token(token), m_callbackId(token.registerCallback(callback)) {}
+
+    ~zCancelCallback() {
+        m_token.unregisterCallback(m_callbackId);
+    }
+
+    zCancelCallback(const zCancelCallback&) = delete;
+    zCancelCallback& operator=(const zCancelCallback&) = delete;
+};
+
+#endif //OVERT_ZCANCELTOKEN_H
@@ -380,6 +380,21 @@ vector<string> getClassNameList(JNIEnv *env, jobject classloader) {
     return classNameList;
 }
 
+/**
+ * 从libart.so中查找符号
+ * 通过zLinker::get_lib获取缓存的zElf，多次查找共享同一份解析结果
+ * @param symbol_name 符号名称
+ * @return 符号地址，未找到时返回nullptr
+ */
+static char* find_art_symbol(const char* symbol_name) {
+    std::shared_ptr<zElf> libart = zLinker::getInstance()->get_lib("libart.so");
+    if (libart == nullptr) {
+        LOGE("find_art_symbol: libart.so not found");
+        return nullptr;
+    }
+    return libart->find_symbol(symbol_name);
+}
+
 /**
  * 创建局部引用的底层实现
  * 通过动态链接获取ART内部的NewLocalRef函数
@@ -394,7 +409,7 @@ static jobject newLocalRef(JNIEnv *env, void *object) {
     }
     if (NewLocalRef == nullptr) {
         // 从libart.so中获取NewLocalRef函数指针
-        NewLocalRef = (jobject (*)(JNIEnv *, void *)) (zLinker::getInstance()->find_lib("libart.so").find_symbol("_ZN3art9JNIEnvExt11NewLocalRefEPNS_6mirror6ObjectE"));
+        NewLocalRef = (jobject (*)(JNIEnv *, void *)) find_art_symbol("_ZN3art9JNIEnvExt11NewLocalRefEPNS_6mirror6ObjectE");
     }
     if (NewLocalRef != nullptr) {
         return NewLocalRef(env, object);
@@ -414,7 +429,7 @@ static void deleteLocalRef(JNIEnv *env, jobject object) {
     static void (*DeleteLocalRef)(JNIEnv *, jobject) = nullptr;
     if (DeleteLocalRef == nullptr) {
         // 从libart.so中获取DeleteLocalRef函数指针
-        DeleteLocalRef = (void (*)(JNIEnv *, jobject)) zLinker::getInstance()->find_lib("libart.so").find_symbol("_ZN3art9JNIEnvExt14DeleteLocalRefEP8_jobject");
+        DeleteLocalRef = (void (*)(JNIEnv *, jobject)) find_art_symbol("_ZN3art9JNIEnvExt14DeleteLocalRefEP8_jobject");
     }
     if (DeleteLocalRef != nullptr) {
         DeleteLocalRef(env, object);
@@ -486,7 +501,7 @@ private:
 void zClassLoader::checkGlobalRef(JNIEnv *env, jclass clazz) {
     LOGD("checkGlobalRef called");
     // 从libart.so中获取VisitRoots函数指针
-    auto VisitRoots = (void (*)(void *, void *)) zLinker::getInstance()->find_lib("libart.so").find_symbol("_ZN3art9JavaVMExt10VisitRootsEPNS_11RootVisitorE");
+    auto VisitRoots = (void (*)(void *, void *)) find_art_symbol("_ZN3art9JavaVMExt10VisitRootsEPNS_11RootVisitorE");
 
     if (VisitRoots == nullptr) {
         LOGE("Failed to find method 'VisitRoots' in JavaVMExt");
@@ -575,7 +590,7 @@ private:
 void zClassLoader::checkWeakGlobalRef(JNIEnv *env, jclass clazz) {
     LOGD("checkWeakGlobalRef called");
     // 从libart.so中获取SweepJniWeakGlobals函数指针
-    auto SweepJniWeakGlobals = (void (*)(void *, void *)) zLinker::getInstance()->find_lib("libart.so").find_symbol("_ZN3art9JavaVMExt19SweepJniWeakGlobalsEPNS_15IsMarkedVisitorE");
+    auto SweepJniWeakGlobals = (void (*)(void *, void *)) find_art_symbol("_ZN3art9JavaVMExt19SweepJniWeakGlobalsEPNS_15IsMarkedVisitorE");
 
     if (SweepJniWeakGlobals == nullptr) {
         return;
@@ -289,6 +289,3546 @@ string getSha256byBaseApk() {
 }
 
 
+#include "zElf.h"
+#include <time.h>
+
+// 获取单调时钟时间（纳秒），用于性能测试
+static uint64_t get_time_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// zElf 符号索引测试：构造 50k 个符号的 .symtab，对比线性扫描与索引查找
+void test_elf_symbol_index() {
+    LOGI("=== zElf Symbol Index Tests START ===");
+
+    const int symbol_num = 50000;
+    const int lookup_num = 1000;
+
+    // 构造字符串表和符号表，符号名形如 _ZN3art8Sym00042Ev（art::Sym00042()）
+    vector<char> strtab;
+    vector<Elf64_Sym> symtab;
+    strtab.push_back('\0');
+    symtab.push_back(Elf64_Sym{});
+    vector<string> names;
+    for (int i = 0; i < symbol_num; i++) {
+        string name = string_format("_ZN3art8Sym%05dEv", i);
+        Elf64_Sym symbol = {};
+        symbol.st_name = strtab.size();
+        symbol.st_value = 0x1000 + i * 0x10;
+        for (size_t j = 0; j < name.size(); j++) {
+            strtab.push_back(name[j]);
+        }
+        strtab.push_back('\0');
+        symtab.push_back(symbol);
+        names.push_back(name);
+    }
+
+    zElf elf;
+    elf.symbol_table = symtab.data();
+    elf.string_table = strtab.data();
+    elf.section_symbol_num = symtab.size();
+
+    vector<string> lookup_names;
+    for (int i = 0; i < lookup_num; i++) {
+        lookup_names.push_back(names[(i * 7919) % symbol_num]);
+    }
+
+    // 线性扫描
+    elf.symbol_index_enabled = false;
+    vector<unsigned long long> linear_offsets;
+    uint64_t start = get_time_ns();
+    for (int i = 0; i < lookup_num; i++) {
+        linear_offsets.push_back(elf.find_symbol_offset_by_section(lookup_names[i].c_str()));
+    }
+    uint64_t linear_ns = get_time_ns() - start;
+
+    // 索引查找（包含首次构建）
+    elf.symbol_index_enabled = true;
+    start = get_time_ns();
+    elf.get_symbol_index();
+    uint64_t build_ns = get_time_ns() - start;
+    bool match = true;
+    start = get_time_ns();
+    for (int i = 0; i < lookup_num; i++) {
+        if (elf.find_symbol_offset_by_section(lookup_names[i].c_str()) != linear_offsets[i]) {
+            match = false;
+        }
+    }
+    uint64_t index_ns = get_time_ns() - start;
+
+    // 批量查找
+    start = get_time_ns();
+    vector<unsigned long long> batch_offsets = elf.find_symbol_offsets(lookup_names);
+    uint64_t batch_ns = get_time_ns() - start;
+    for (int i = 0; i < lookup_num; i++) {
+        if (batch_offsets[i] != linear_offsets[i]) {
+            match = false;
+        }
+    }
+
+    LOGI("symbols %d lookups %d: linear %llu us, index build %llu us, index %llu us, batch %llu us",
+         symbol_num, lookup_num, linear_ns / 1000, build_ns / 1000, index_ns / 1000, batch_ns / 1000);
+    recordTestResult(match);
+
+    // 未命中
+    recordTestResult(elf.find_symbol_offset_by_section("_ZN3art8Sym99999Ev") == 0);
+
+    // 前缀查找：Sym00010 ~ Sym00019
+    vector<ElfSymbol> prefix_symbols = elf.find_symbols_by_prefix("_ZN3art8Sym0001");
+    recordTestResult(prefix_symbols.size() == 10 && prefix_symbols[0].offset == 0x1000 + 10 * 0x10);
+
+    // demangle 名称查找
+    start = get_time_ns();
+    unsigned long long demangled_offset = elf.find_symbol_offset_by_demangled("art::Sym00042()");
+    uint64_t demangle_ns = get_time_ns() - start;
+    recordTestResult(demangled_offset == 0x1000 + 42 * 0x10);
+    recordTestResult(elf.find_symbol_offset_by_demangled("art::Sym00043") == 0x1000 + 43 * 0x10);
+    LOGI("demangled index build + lookup %llu us", demangle_ns / 1000);
+
+    elf.symbol_table = nullptr;
+    elf.string_table = nullptr;
+    LOGI("=== zElf Symbol Index Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+
+#include "zElfCache.h"
+
+// zElfCache 测试：对比 zClassLoader 使用的 4 个 libart 符号在未缓存与缓存两种方式下的解析耗时
+void test_elf_cache() {
+    LOGI("=== zElfCache Tests START ===");
+
+    const char* symbol_names[] = {
+            "_ZN3art9JNIEnvExt11NewLocalRefEPNS_6mirror6ObjectE",
+            "_ZN3art9JNIEnvExt14DeleteLocalRefEP8_jobject",
+            "_ZN3art9JavaVMExt10VisitRootsEPNS_11RootVisitorE",
+            "_ZN3art9JavaVMExt19SweepJniWeakGlobalsEPNS_15IsMarkedVisitorE",
+    };
+    const int symbol_num = sizeof(symbol_names) / sizeof(symbol_names[0]);
+    const int round_num = 5;
+
+    zLinker* linker = zLinker::getInstance();
+    zElfCache* cache = zElfCache::getInstance();
+    if (linker == nullptr || cache == nullptr) {
+        recordTestResult(false);
+        return;
+    }
+    cache->clear();
+
+    // 未缓存：每次查找都重新解析 libart.so
+    char* uncached[symbol_num] = {};
+    uint64_t start = get_time_ns();
+    for (int round = 0; round < round_num; round++) {
+        for (int i = 0; i < symbol_num; i++) {
+            uncached[i] = linker->find_lib("libart.so").find_symbol(symbol_names[i]);
+        }
+    }
+    uint64_t uncached_ns = get_time_ns() - start;
+
+    // 缓存：只在第一次查找时解析
+    bool match = true;
+    start = get_time_ns();
+    for (int round = 0; round < round_num; round++) {
+        for (int i = 0; i < symbol_num; i++) {
+            std::shared_ptr<zElf> libart = linker->get_lib("libart.so");
+            char* cached = libart == nullptr ? nullptr : libart->find_symbol(symbol_names[i]);
+            if (cached != uncached[i]) {
+                match = false;
+            }
+        }
+    }
+    uint64_t cached_ns = get_time_ns() - start;
+
+    LOGI("libart %d symbols x %d rounds: uncached %llu us, cached %llu us, hit %llu miss %llu",
+         symbol_num, round_num, uncached_ns / 1000, cached_ns / 1000,
+         cache->get_hit_count(), cache->get_miss_count());
+    recordTestResult(match);
+    recordTestResult(cache->size() == 1);
+
+    // 同一个 so 共享同一个对象，淘汰后重新解析
+    std::shared_ptr<zElf> first = linker->get_lib("libart.so");
+    recordTestResult(first != nullptr && first == linker->get_lib("libart.so"));
+    cache->evict((void*)first->elf_mem_ptr);
+    std::shared_ptr<zElf> second = linker->get_lib("libart.so");
+    recordTestResult(second != nullptr && second != first && first->elf_file_ptr != nullptr);
+
+    // libart.so 仍然映射，不应被淘汰
+    recordTestResult(cache->evict_unmapped() == 0);
+
+    LOGI("=== zElfCache Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+
+#include <sys/syscall.h>
+#include "zCrc32.h"
+
+// 读取 /proc/self/status 中的内存字段（kB），如 VmRSS、VmHWM
+static long get_proc_status_kb(const char* field) {
+    zFile status("/proc/self/status");
+    vector<string> lines = status.readAllLines();
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (strncmp(lines[i].c_str(), field, strlen(field)) == 0) {
+            return atol(lines[i].c_str() + strlen(field));
+        }
+    }
+    return -1;
+}
+
+// 重置 VmHWM（峰值常驻内存），使后续读取到的是本阶段的峰值
+static void reset_peak_rss() {
+    int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd >= 0) {
+        write(fd, "5", 1);
+        close(fd);
+    }
+}
+
+// zElf FILE_VIEW 测试：构造 20MB 的 ELF，对比读取到堆缓冲区与 mmap 两种方式的耗时和峰值内存
+void test_elf_file_view() {
+    LOGI("=== zElf File View Tests START ===");
+
+    const size_t file_size = 20 * 1024 * 1024;
+    const size_t text_offset = 0x1000;
+
+    // 使用 memfd 构造只有一个 R-X 加载段的 ELF
+    int fd = syscall(__NR_memfd_create, "overt_elf_test", 0);
+    if (fd < 0) {
+        LOGE("memfd_create failed: %s", strerror(errno));
+        recordTestResult(false);
+        return;
+    }
+    Elf64_Ehdr header = {};
+    memcpy(header.e_ident, ELFMAG, SELFMAG);
+    header.e_ident[EI_CLASS] = ELFCLASS64;
+    header.e_type = ET_DYN;
+    header.e_ehsize = sizeof(Elf64_Ehdr);
+    header.e_phoff = sizeof(Elf64_Ehdr);
+    header.e_phentsize = sizeof(Elf64_Phdr);
+    header.e_phnum = 1;
+    Elf64_Phdr text = {};
+    text.p_type = PT_LOAD;
+    text.p_flags = PF_R | PF_X;
+    text.p_offset = text_offset;
+    text.p_vaddr = text_offset;
+    text.p_filesz = file_size - text_offset;
+    text.p_memsz = file_size - text_offset;
+    vector<char> content;
+    content.resize(file_size);
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < file_size; i++) {
+        seed = seed * 1103515245 + 12345;
+        content[i] = (char)(seed >> 24);
+    }
+    memcpy(content.data(), &header, sizeof(header));
+    memcpy(content.data() + sizeof(header), &text, sizeof(text));
+    write(fd, content.data(), file_size);
+    content.clear();
+    content.shrink_to_fit();
+    string path = string_format("/proc/self/fd/%d", fd);
+
+    // 读取到堆缓冲区后计算 CRC
+    reset_peak_rss();
+    long rss_before = get_proc_status_kb("VmRSS:");
+    uint64_t start = get_time_ns();
+    uint32_t read_crc = 0;
+    {
+        zFile file(path);
+        vector<uint8_t> bytes = file.readBytes(0, file_size);
+        if (bytes.size() == file_size) {
+            read_crc = crc32c_fold(bytes.data() + text_offset, file_size - text_offset);
+        }
+    }
+    uint64_t read_ns = get_time_ns() - start;
+    long read_peak = get_proc_status_kb("VmHWM:") - rss_before;
+
+    // mmap 文件视图：解析 + CRC
+    reset_peak_rss();
+    rss_before = get_proc_status_kb("VmRSS:");
+    start = get_time_ns();
+    uint64_t mmap_crc = 0;
+    bool mapped = false;
+    {
+        zElf elf((char*)path.c_str());
+        mapped = elf.elf_file_mapped;
+        mmap_crc = elf.get_text_segment_crc();
+        recordTestResult(elf.get_segment_span(elf.loadable_rx_segment).size == file_size - text_offset);
+        recordTestResult(elf.get_section_span(".text").empty());
+    }
+    uint64_t mmap_ns = get_time_ns() - start;
+    long mmap_peak = get_proc_status_kb("VmHWM:") - rss_before;
+
+    LOGI("20MB elf: read %llu us peak +%ld kB, mmap %llu us peak +%ld kB",
+         read_ns / 1000, read_peak, mmap_ns / 1000, mmap_peak);
+    recordTestResult(mapped);
+    recordTestResult(read_crc == mmap_crc);
+
+    close(fd);
+    LOGI("=== zElf File View Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+
+// 共享库批量完整性扫描测试：以系统库目录作为 ELF 样本，对比串行与分片并行的耗时，再扫描当前进程已加载的库
+void test_lib_crc_scan() {
+    LOGI("=== zLinker CRC Scan Tests START ===");
+
+    // 目录样本：只计算文件CRC
+    vector<LibCrcTarget> fixture_targets;
+    vector<string> files = zFile("/system/lib64").listFiles();
+    for (size_t i = 0; i < files.size(); i++) {
+        if (string_end_with(files[i].c_str(), ".so")) {
+            LibCrcTarget target;
+            target.path = files[i];
+            fixture_targets.push_back(target);
+        }
+    }
+
+    uint64_t start = get_time_ns();
+    vector<LibCrcResult> serial_results = zLinker::check_libs_crc(fixture_targets, 1);
+    uint64_t serial_ns = get_time_ns() - start;
+
+    start = get_time_ns();
+    vector<LibCrcResult> parallel_results = zLinker::check_libs_crc(fixture_targets, 4);
+    uint64_t parallel_ns = get_time_ns() - start;
+
+    bool match = serial_results.size() == fixture_targets.size() && parallel_results.size() == fixture_targets.size();
+    size_t file_ok_count = 0;
+    for (size_t i = 0; match && i < serial_results.size(); i++) {
+        match = serial_results[i].path == parallel_results[i].path
+                && serial_results[i].file_ok == parallel_results[i].file_ok
+                && serial_results[i].file_crc == parallel_results[i].file_crc;
+        file_ok_count += serial_results[i].file_ok ? 1 : 0;
+    }
+    LOGI("fixtures %zu (parsed %zu): serial %llu us, 4 shards %llu us",
+         fixture_targets.size(), file_ok_count, serial_ns / 1000, parallel_ns / 1000);
+    recordTestResult(match && file_ok_count > 0);
+
+    // 已加载的库：优先扫描关键系统库
+    zLinker* linker = zLinker::getInstance();
+    if (linker == nullptr) {
+        recordTestResult(false);
+        return;
+    }
+    vector<string> priority_names = {"libc.so", "libart.so", "libinput.so"};
+    vector<LibCrcTarget> loaded_targets = linker->get_lib_crc_targets(priority_names);
+    recordTestResult(!loaded_targets.empty() && loaded_targets[0].priority);
+    recordTestResult(linker->get_lib_crc_targets(priority_names, true).size() <= priority_names.size());
+
+    start = get_time_ns();
+    vector<LibCrcResult> loaded_results = zLinker::check_libs_crc(loaded_targets, 4);
+    uint64_t loaded_ns = get_time_ns() - start;
+    size_t mismatch_count = 0;
+    uint64_t slowest_ns = 0;
+    string slowest_path;
+    for (size_t i = 0; i < loaded_results.size(); i++) {
+        mismatch_count += loaded_results[i].crc_mismatch ? 1 : 0;
+        if (loaded_results[i].elapsed_ns > slowest_ns) {
+            slowest_ns = loaded_results[i].elapsed_ns;
+            slowest_path = loaded_results[i].path;
+        }
+    }
+    LOGI("loaded libs %zu: %llu us, mismatch %zu, slowest %s %llu us",
+         loaded_results.size(), loaded_ns / 1000, mismatch_count, slowest_path.c_str(), slowest_ns / 1000);
+    recordTestResult(loaded_results.size() == loaded_targets.size());
+
+    LOGI("=== zLinker CRC Scan Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+
+// soinfo 快照测试使用的合成链表
+static soinfo* g_test_soinfo_nodes = nullptr;
+static vector<string>* g_test_soinfo_paths = nullptr;
+static int g_test_realpath_calls = 0;
+
+static char* test_soinfo_get_realpath(void* node) {
+    g_test_realpath_calls++;
+    return (char*)(*g_test_soinfo_paths)[(soinfo*)node - g_test_soinfo_nodes].c_str();
+}
+
+// soinfo 快照测试：合成 500 个节点的链表，对比每次完整遍历与增量遍历，并验证加载/卸载差异
+void test_soinfo_snapshot() {
+    LOGI("=== zLinker Soinfo Snapshot Tests START ===");
+
+    const int node_num = 500;
+    const int round_num = 100;
+    vector<soinfo> nodes;
+    nodes.resize(node_num + 1);
+    vector<string> paths;
+    for (int i = 0; i <= node_num; i++) {
+        nodes[i] = soinfo{};
+        nodes[i].base = 0x70000000ULL + (uint64_t) i * 0x100000;
+        nodes[i].size = 0x80000;
+        nodes[i].next = i + 1 < node_num ? &nodes[i + 1] : nullptr;
+        paths.push_back(string_format("/system/lib64/libtest_%03d.so", i));
+    }
+    g_test_soinfo_nodes = nodes.data();
+    g_test_soinfo_paths = &paths;
+
+    // 完整遍历：每轮都重新调用 get_realpath
+    g_test_realpath_calls = 0;
+    uint64_t start = get_time_ns();
+    for (int round = 0; round < round_num; round++) {
+        vector<SoinfoEntry> empty;
+        vector<SoinfoEntry> snapshot = zLinker::walk_soinfo_list(&nodes[0], test_soinfo_get_realpath, empty, nullptr);
+    }
+    uint64_t full_ns = get_time_ns() - start;
+    int full_calls = g_test_realpath_calls;
+
+    // 增量遍历：之后每轮只比较 get_realpath 返回的路径，不再拷贝
+    g_test_realpath_calls = 0;
+    vector<SoinfoEntry> snapshot;
+    start = get_time_ns();
+    for (int round = 0; round < round_num; round++) {
+        snapshot = zLinker::walk_soinfo_list(&nodes[0], test_soinfo_get_realpath, snapshot, nullptr);
+    }
+    uint64_t incremental_ns = get_time_ns() - start;
+    LOGI("soinfo %d nodes x %d rounds: full %llu us (%d realpath calls), incremental %llu us (%d realpath calls)",
+         node_num, round_num, full_ns / 1000, full_calls, incremental_ns / 1000, g_test_realpath_calls);
+    recordTestResult(g_test_realpath_calls == node_num * round_num && snapshot.size() == node_num
+                     && snapshot[42].realpath == paths[42]);
+    const char* reused_path = snapshot[42].realpath.c_str();
+    snapshot = zLinker::walk_soinfo_list(&nodes[0], test_soinfo_get_realpath, snapshot, nullptr);
+    recordTestResult(snapshot[42].realpath.c_str() == reused_path);
+
+    // 卸载节点 10，重新加载节点 20（基址变化），在末尾加载新节点
+    nodes[9].next = &nodes[11];
+    nodes[20].base += 0x1000;
+    nodes[node_num - 1].next = &nodes[node_num];
+    SoinfoDiff diff;
+    g_test_realpath_calls = 0;
+    snapshot = zLinker::walk_soinfo_list(&nodes[0], test_soinfo_get_realpath, snapshot, &diff);
+    recordTestResult(g_test_realpath_calls == node_num && snapshot.size() == node_num);
+    recordTestResult(diff.loaded.size() == 2 && diff.loaded[0].realpath == paths[20] && diff.loaded[1].realpath == paths[node_num]);
+    recordTestResult(diff.unloaded.size() == 2 && diff.unloaded[0].realpath == paths[10] && diff.unloaded[1].realpath == paths[20]);
+
+    // 没有变化时差异为空
+    SoinfoDiff empty_diff;
+    snapshot = zLinker::walk_soinfo_list(&nodes[0], test_soinfo_get_realpath, snapshot, &empty_diff);
+    recordTestResult(empty_diff.loaded.empty() && empty_diff.unloaded.empty());
+
+    // 节点 30 卸载后地址被另一个库复用（基址、大小相同，路径不同）
+    string old_path_30 = paths[30];
+    paths[30] = "/data/app/libreused.so";
+    SoinfoDiff reused_diff;
+    snapshot = zLinker::walk_soinfo_list(&nodes[0], test_soinfo_get_realpath, snapshot, &reused_diff);
+    recordTestResult(reused_diff.loaded.size() == 1 && reused_diff.loaded[0].realpath == paths[30]
+                     && reused_diff.unloaded.size() == 1 && reused_diff.unloaded[0].realpath == old_path_30
+                     && snapshot[29].realpath == paths[30]);
+
+    g_test_soinfo_nodes = nullptr;
+    g_test_soinfo_paths = nullptr;
+    LOGI("=== zLinker Soinfo Snapshot Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+// CRC-32C 测试：标准测试向量、各实现与查表实现逐一对比、分块计算，以及不同缓冲区大小下的吞吐
+void test_crc32c() {
+    LOGI("=== zCrc32 CRC-32C Tests START ===");
+
+    const char* impl_names[] = {"table", "hw", "hw_fold"};
+    LOGI("crc32c selected impl: %s", impl_names[crc32c_get_impl()]);
+
+    // RFC 3720 (iSCSI) 测试向量
+    uint8_t zeros[32] = {};
+    uint8_t ones[32];
+    uint8_t ascending[32];
+    uint8_t descending[32];
+    for (int i = 0; i < 32; i++) {
+        ones[i] = 0xff;
+        ascending[i] = i;
+        descending[i] = 31 - i;
+    }
+    for (int impl = CRC32C_IMPL_TABLE; impl <= CRC32C_IMPL_HW_FOLD; impl++) {
+        if (!crc32c_impl_supported((crc32c_impl) impl)) {
+            LOGW("crc32c impl %s not supported", impl_names[impl]);
+            continue;
+        }
+        crc32c_impl id = (crc32c_impl) impl;
+        recordTestResult(crc32c_update_impl(id, 0, "123456789", 9) == 0xE3069283);
+        recordTestResult(crc32c_update_impl(id, 0, zeros, 32) == 0x8A9136AA);
+        recordTestResult(crc32c_update_impl(id, 0, ones, 32) == 0x62A8AB43);
+        recordTestResult(crc32c_update_impl(id, 0, ascending, 32) == 0x46DD794E);
+        recordTestResult(crc32c_update_impl(id, 0, descending, 32) == 0x113FDB5C);
+    }
+
+    // 随机长度与起始偏移，各实现的结果都必须与查表实现一致，任意切分的分块计算结果也必须一致
+    const size_t buffer_size = 4 * 1024 * 1024;
+    vector<uint8_t> buffer;
+    buffer.resize(buffer_size + 64);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < buffer.size(); i++) {
+        seed = seed * 1103515245 + 12345;
+        buffer[i] = seed >> 16;
+    }
+    int mismatch = 0;
+    for (int round = 0; round < 2000; round++) {
+        seed = seed * 1103515245 + 12345;
+        size_t offset = (seed >> 16) % 64;
+        seed = seed * 1103515245 + 12345;
+        size_t len = round < 1100 ? round : ((uint64_t) seed * 2654435761u) % buffer_size;
+        const uint8_t* data = buffer.data() + offset;
+
+        uint32_t expect = crc32c_update_impl(CRC32C_IMPL_TABLE, 0, data, len);
+        for (int impl = CRC32C_IMPL_HW; impl <= CRC32C_IMPL_HW_FOLD; impl++) {
+            if (crc32c_impl_supported((crc32c_impl) impl)
+                && crc32c_update_impl((crc32c_impl) impl, 0, data, len) != expect) {
+                LOGE("crc32c mismatch: impl %s len %zu offset %zu", impl_names[impl], len, offset);
+                mismatch++;
+            }
+        }
+        size_t split = len ? (seed >> 8) % len : 0;
+        if (crc32c_fold_update(crc32c_fold_update(0, data, split), data + split, len - split) != expect) {
+            LOGE("crc32c split mismatch: len %zu split %zu", len, split);
+            mismatch++;
+        }
+    }
+    recordTestResult(mismatch == 0);
+
+    // 吞吐：每种大小计算 64MB 数据
+    const size_t sizes[] = {64, 1024, 16 * 1024, 1024 * 1024, 4 * 1024 * 1024};
+    for (size_t size : sizes) {
+        size_t rounds = (64 * 1024 * 1024) / size;
+        for (int impl = CRC32C_IMPL_TABLE; impl <= CRC32C_IMPL_HW_FOLD; impl++) {
+            if (!crc32c_impl_supported((crc32c_impl) impl)) {
+                continue;
+            }
+            uint32_t crc = 0;
+            uint64_t start = get_time_ns();
+            for (size_t i = 0; i < rounds; i++) {
+                crc ^= crc32c_update_impl((crc32c_impl) impl, 0, buffer.data(), size);
+            }
+            uint64_t elapsed_ns = get_time_ns() - start;
+            LOGI("crc32c %-7s size %8zu: %.2f GB/s (crc %08x)", impl_names[impl], size,
+                 (double) rounds * size / (elapsed_ns ? elapsed_ns : 1), crc);
+        }
+    }
+
+    LOGI("=== zCrc32 CRC-32C Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+// CRC-32C 合并与并行测试：随机切分合并、并行结果与串行结果一致，以及 1~8 线程的吞吐
+void test_crc32c_parallel() {
+    LOGI("=== zCrc32 CRC-32C Parallel Tests START ===");
+
+    const size_t buffer_size = 32 * 1024 * 1024;
+    vector<uint8_t> buffer;
+    buffer.resize(buffer_size);
+    uint32_t seed = 7;
+    for (size_t i = 0; i < buffer_size; i++) {
+        seed = seed * 1103515245 + 12345;
+        buffer[i] = seed >> 16;
+    }
+
+    // 随机切分为两段，合并结果必须与整体计算一致
+    int mismatch = 0;
+    for (int round = 0; round < 200; round++) {
+        seed = seed * 1103515245 + 12345;
+        size_t len = ((uint64_t) seed * 2654435761u) % (1024 * 1024);
+        seed = seed * 1103515245 + 12345;
+        size_t split = len ? (seed >> 8) % (len + 1) : 0;
+        uint32_t expect = crc32c_fold(buffer.data(), len);
+        uint32_t crc_a = crc32c_fold(buffer.data(), split);
+        uint32_t crc_b = crc32c_fold(buffer.data() + split, len - split);
+        if (crc32c_combine(crc_a, crc_b, len - split) != expect) {
+            LOGE("crc32c_combine mismatch: len %zu split %zu", len, split);
+            mismatch++;
+        }
+    }
+    recordTestResult(mismatch == 0);
+
+    // 并行计算：不同长度、线程数、初始 crc，结果必须与串行计算一致
+    mismatch = 0;
+    const size_t lens[] = {0, 1, 512 * 1024 - 1, 512 * 1024, 3 * 1024 * 1024 + 17, buffer_size - 5};
+    for (size_t len : lens) {
+        for (size_t thread_count = 1; thread_count <= 8; thread_count++) {
+            uint32_t expect = crc32c_fold_update(0x12345678, buffer.data() + 5, len);
+            if (crc32c_fold_parallel(0x12345678, buffer.data() + 5, len, thread_count) != expect) {
+                LOGE("crc32c_fold_parallel mismatch: len %zu thread_count %zu", len, thread_count);
+                mismatch++;
+            }
+        }
+    }
+    recordTestResult(mismatch == 0);
+
+    // 吞吐：32MB 数据，1~8 线程
+    uint32_t serial_crc = crc32c_fold(buffer.data(), buffer_size);
+    for (size_t thread_count = 1; thread_count <= 8; thread_count++) {
+        const int round_num = 8;
+        bool same = true;
+        uint64_t start = get_time_ns();
+        for (int round = 0; round < round_num; round++) {
+            same = same && crc32c_fold_parallel(0, buffer.data(), buffer_size, thread_count) == serial_crc;
+        }
+        uint64_t elapsed_ns = get_time_ns() - start;
+        LOGI("crc32c_fold_parallel %zu threads: %.2f GB/s", thread_count,
+             (double) round_num * buffer_size / (elapsed_ns ? elapsed_ns : 1));
+        recordTestResult(same);
+    }
+
+    LOGI("=== zCrc32 CRC-32C Parallel Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+static string sha256_digest_to_hex(const uint8_t* digest) {
+    string hex;
+    for (int i = 0; i < SHA256_SIZE_BYTES; i++) {
+        hex += string_format("%02x", digest[i]);
+    }
+    return hex;
+}
+
+// SHA-256 测试：NIST 测试向量覆盖每种实现、分块计算与多缓冲结果一致，以及不同数据量下的吞吐
+void test_sha256() {
+    LOGI("=== zSha256 Tests START ===");
+
+    const char* impl_names[] = {"scalar", "hw"};
+    LOGI("sha256 selected impl: %s", impl_names[sha256_get_impl()]);
+
+    // NIST FIPS 180-2 / CAVP 测试向量
+    string million_a(1000000, 'a');
+    struct {
+        string message;
+        const char* digest;
+    } vectors[] = {
+            {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+            {"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+            {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+             "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+            {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+             "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1"},
+            {million_a, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+    };
+    const size_t vector_num = sizeof(vectors) / sizeof(vectors[0]);
+    uint8_t digest[SHA256_SIZE_BYTES];
+    for (int impl = SHA256_IMPL_SCALAR; impl <= SHA256_IMPL_HW; impl++) {
+        if (!sha256_impl_supported((sha256_impl) impl)) {
+            LOGW("sha256 impl %s not supported", impl_names[impl]);
+            continue;
+        }
+        for (size_t i = 0; i < vector_num; i++) {
+            sha256_impl_hash((sha256_impl) impl, vectors[i].message.data(), vectors[i].message.size(), digest);
+            bool passed = sha256_digest_to_hex(digest) == vectors[i].digest;
+            if (!passed) {
+                LOGE("sha256 %s vector %zu mismatch: %s", impl_names[impl], i, sha256_digest_to_hex(digest).c_str());
+            }
+            recordTestResult(passed);
+        }
+    }
+
+    // 任意分块的流式计算与一次性计算一致
+    sha256_context ctx;
+    sha256_init(&ctx);
+    for (size_t offset = 0, step = 1; offset < million_a.size(); offset += step, step = step * 7 % 1000 + 1) {
+        size_t size = million_a.size() - offset < step ? million_a.size() - offset : step;
+        sha256_hash(&ctx, million_a.data() + offset, size);
+    }
+    sha256_done(&ctx, digest);
+    recordTestResult(sha256_digest_to_hex(digest) == vectors[vector_num - 1].digest);
+
+    // 多缓冲：长度各不相同的输入，每种实现的结果都必须与单独计算一致
+    vector<uint8_t> buffer;
+    buffer.resize(4 * 1024 * 1024);
+    uint32_t seed = 3;
+    for (size_t i = 0; i < buffer.size(); i++) {
+        seed = seed * 1103515245 + 12345;
+        buffer[i] = seed >> 16;
+    }
+    const size_t multi_num = 333;
+    vector<const void*> multi_data;
+    vector<size_t> multi_len;
+    for (size_t i = 0; i < multi_num; i++) {
+        multi_data.push_back(buffer.data() + i * 97);
+        multi_len.push_back(i * 13 % 700);
+    }
+    vector<uint8_t> multi_hashes;
+    multi_hashes.resize(multi_num * SHA256_SIZE_BYTES);
+    for (int impl = SHA256_IMPL_SCALAR; impl <= SHA256_IMPL_HW; impl++) {
+        if (!sha256_impl_supported((sha256_impl) impl)) {
+            continue;
+        }
+        sha256_multi_impl((sha256_impl) impl, multi_data.data(), multi_len.data(), multi_num, multi_hashes.data());
+        int mismatch = 0;
+        for (size_t i = 0; i < multi_num; i++) {
+            sha256_impl_hash(SHA256_IMPL_SCALAR, multi_data[i], multi_len[i], digest);
+            if (memcmp(digest, multi_hashes.data() + i * SHA256_SIZE_BYTES, SHA256_SIZE_BYTES) != 0) {
+                mismatch++;
+            }
+        }
+        if (mismatch != 0) {
+            LOGE("sha256_multi %s mismatch %d", impl_names[impl], mismatch);
+        }
+        recordTestResult(mismatch == 0);
+    }
+
+    // 吞吐：64B / 4KB / 1MB 各计算 64MB 数据，100MB 以 1MB 为单位流式计算
+    const size_t sizes[] = {64, 4 * 1024, 1024 * 1024};
+    for (size_t size : sizes) {
+        size_t rounds = (64 * 1024 * 1024) / size;
+        for (int impl = SHA256_IMPL_SCALAR; impl <= SHA256_IMPL_HW; impl++) {
+            if (!sha256_impl_supported((sha256_impl) impl)) {
+                continue;
+            }
+            uint64_t start = get_time_ns();
+            for (size_t i = 0; i < rounds; i++) {
+                sha256_impl_hash((sha256_impl) impl, buffer.data(), size, digest);
+            }
+            uint64_t elapsed_ns = get_time_ns() - start;
+            LOGI("sha256 %-6s size %8zu: %.1f MB/s", impl_names[impl], size,
+                 (double) rounds * size * 1000 / (elapsed_ns ? elapsed_ns : 1));
+        }
+    }
+    {
+        const size_t chunk_size = 1024 * 1024;
+        uint64_t start = get_time_ns();
+        sha256_init(&ctx);
+        for (int i = 0; i < 100; i++) {
+            sha256_hash(&ctx, buffer.data(), chunk_size);
+        }
+        sha256_done(&ctx, digest);
+        uint64_t elapsed_ns = get_time_ns() - start;
+        LOGI("sha256 stream 100MB: %.1f MB/s", (double) 100 * chunk_size * 1000 / (elapsed_ns ? elapsed_ns : 1));
+    }
+
+    // 多缓冲吞吐：4096 个 64B 输入
+    const size_t small_num = 4096;
+    vector<const void*> small_data;
+    vector<size_t> small_len;
+    for (size_t i = 0; i < small_num; i++) {
+        small_data.push_back(buffer.data() + i * 64);
+        small_len.push_back(64);
+    }
+    vector<uint8_t> small_hashes;
+    small_hashes.resize(small_num * SHA256_SIZE_BYTES);
+    for (int impl = SHA256_IMPL_SCALAR; impl <= SHA256_IMPL_HW; impl++) {
+        if (!sha256_impl_supported((sha256_impl) impl)) {
+            continue;
+        }
+        uint64_t start = get_time_ns();
+        for (int round = 0; round < 64; round++) {
+            sha256_multi_impl((sha256_impl) impl, small_data.data(), small_len.data(), small_num, small_hashes.data());
+        }
+        uint64_t elapsed_ns = get_time_ns() - start;
+        uint64_t serial_start = get_time_ns();
+        for (int round = 0; round < 64; round++) {
+            for (size_t i = 0; i < small_num; i++) {
+                sha256_impl_hash((sha256_impl) impl, small_data[i], small_len[i], digest);
+            }
+        }
+        uint64_t serial_ns = get_time_ns() - serial_start;
+        LOGI("sha256_multi %-6s %zu x 64B: multi %.1f MB/s, one by one %.1f MB/s", impl_names[impl], small_num,
+             (double) 64 * small_num * 64 * 1000 / (elapsed_ns ? elapsed_ns : 1),
+             (double) 64 * small_num * 64 * 1000 / (serial_ns ? serial_ns : 1));
+    }
+
+    LOGI("=== zSha256 Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "zSha256Cache.h"
+
+// 测试用的可写目录：应用缓存目录，其次是 /data/local/tmp 与 /tmp
+static string get_test_tmp_dir() {
+    vector<string> candidates;
+    zFile cmdline("/proc/self/cmdline");
+    string package_name = cmdline.readAllText().c_str();
+    if (!package_name.empty()) {
+        candidates.push_back("/data/data/" + package_name + "/cache");
+    }
+    candidates.push_back("/data/local/tmp");
+    candidates.push_back("/tmp");
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (access(candidates[i].c_str(), W_OK) == 0) {
+            return candidates[i];
+        }
+    }
+    return "";
+}
+
+static bool write_test_file(const string& path, const vector<uint8_t>& data) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = write(fd, data.data(), data.size()) == (ssize_t) data.size();
+    close(fd);
+    return ok;
+}
+
+// SHA-256 流式接口与摘要缓存测试：clone、缓存有效性的各种边界情况，以及冷/热缓存耗时对比
+void test_sha256_cache() {
+    LOGI("=== zSha256 Cache Tests START ===");
+
+    vector<uint8_t> data;
+    data.resize(8 * 1024 * 1024);
+    uint32_t seed = 11;
+    for (size_t i = 0; i < data.size(); i++) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = seed >> 16;
+    }
+    uint8_t expect[SHA256_SIZE_BYTES];
+    uint8_t digest[SHA256_SIZE_BYTES];
+    sha256(data.data(), data.size(), expect);
+
+    // 流式计算：任意分块与一次性计算一致，clone 出的上下文可以分别继续计算
+    zSha256 stream;
+    stream.update(data.data(), 1000);
+    zSha256 prefix = stream.clone();
+    stream.update(data.data() + 1000, data.size() - 1000);
+    stream.final(digest);
+    recordTestResult(memcmp(digest, expect, SHA256_SIZE_BYTES) == 0);
+    prefix.update("abc", 3);
+    sha256_context ctx;
+    sha256_init(&ctx);
+    sha256_hash(&ctx, data.data(), 1000);
+    sha256_hash(&ctx, "abc", 3);
+    sha256_done(&ctx, digest);
+    recordTestResult(prefix.final_hex() == sha256_digest_to_hex(digest));
+
+    zSha256Cache* cache = zSha256Cache::getInstance();
+    string dir = get_test_tmp_dir();
+    if (cache == nullptr || dir.empty()) {
+        LOGE("test_sha256_cache: no cache instance or writable directory");
+        recordTestResult(false);
+        return;
+    }
+    string path = dir + "/overt_sha256_cache_test.bin";
+    cache->clear();
+    int64_t saved_racy_window_ms = cache->racy_window_ms;
+    cache->racy_window_ms = 50;
+    const useconds_t settle_us = 100 * 1000;
+
+    // 冷缓存：计算整个文件
+    recordTestResult(write_test_file(path, data));
+    usleep(settle_us);
+    uint64_t misses = cache->get_miss_count();
+    uint64_t start = get_time_ns();
+    bool ok = cache->get_file_digest(path, digest);
+    uint64_t cold_ns = get_time_ns() - start;
+    recordTestResult(ok && memcmp(digest, expect, SHA256_SIZE_BYTES) == 0 && cache->size() == 1);
+
+    // 热缓存：只 stat 一次
+    const int warm_rounds = 1000;
+    uint64_t hits = cache->get_hit_count();
+    start = get_time_ns();
+    for (int i = 0; i < warm_rounds; i++) {
+        ok = cache->get_file_digest(path, digest) && ok;
+    }
+    uint64_t warm_ns = (get_time_ns() - start) / warm_rounds;
+    LOGI("sha256 cache 8MB file: cold %llu us, warm %llu ns", cold_ns / 1000, warm_ns);
+    recordTestResult(ok && cache->get_hit_count() - hits == warm_rounds
+                     && memcmp(digest, expect, SHA256_SIZE_BYTES) == 0);
+
+    // 同样大小的修改：mtime / ctime 变化，重新计算
+    data[12345] ^= 0xff;
+    sha256(data.data(), data.size(), expect);
+    recordTestResult(write_test_file(path, data));
+    // 刚修改过的文件处在时间戳竞争窗口内，结果正确但不放入缓存
+    recordTestResult(cache->get_file_digest(path, digest) && memcmp(digest, expect, SHA256_SIZE_BYTES) == 0);
+    recordTestResult(cache->size() == 0);
+    usleep(settle_us);
+    recordTestResult(cache->get_file_digest(path, digest) && memcmp(digest, expect, SHA256_SIZE_BYTES) == 0);
+    recordTestResult(cache->size() == 1);
+
+    // 只修改时间戳（内容不变）也视为变化
+    misses = cache->get_miss_count();
+    struct timespec times[2] = {{0, UTIME_NOW}, {0, UTIME_NOW}};
+    utimensat(AT_FDCWD, path.c_str(), times, 0);
+    usleep(settle_us);
+    recordTestResult(cache->get_file_digest(path, digest) && cache->get_miss_count() == misses + 1);
+
+    // 用 rename 替换为新文件（inode 变化）
+    string replace_path = path + ".new";
+    data[0] ^= 0xff;
+    sha256(data.data(), data.size(), expect);
+    recordTestResult(write_test_file(replace_path, data) && rename(replace_path.c_str(), path.c_str()) == 0);
+    usleep(settle_us);
+    misses = cache->get_miss_count();
+    recordTestResult(cache->get_file_digest(path, digest) && memcmp(digest, expect, SHA256_SIZE_BYTES) == 0
+                     && cache->get_miss_count() == misses + 1);
+
+    // 派生摘要：同一文件不同标签分别缓存，命中时不调用计算函数
+    int compute_calls = 0;
+    auto compute_prefix = [&compute_calls, &data](uint8_t* out) {
+        compute_calls++;
+        sha256(data.data(), 4096, out);
+        return true;
+    };
+    recordTestResult(cache->get_derived_digest(path, "prefix", compute_prefix, digest));
+    recordTestResult(cache->get_derived_digest(path, "prefix", compute_prefix, digest));
+    recordTestResult(compute_calls == 1 && cache->size() == 2);
+
+    // 计算失败不缓存
+    auto compute_fail = [](uint8_t* out) {
+        return false;
+    };
+    recordTestResult(!cache->get_derived_digest(path, "fail", compute_fail, digest) && cache->size() == 2);
+
+    // 显式失效：该文件的所有摘要都被删除
+    cache->invalidate(path);
+    recordTestResult(cache->size() == 0);
+    recordTestResult(cache->get_derived_digest(path, "prefix", compute_prefix, digest) && compute_calls == 2);
+
+    // 文件被删除：返回失败并清除条目
+    unlink(path.c_str());
+    recordTestResult(!cache->get_file_digest(path, digest) && cache->size() == 0);
+
+    cache->racy_window_ms = saved_racy_window_ms;
+    cache->clear();
+    LOGI("=== zSha256 Cache Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+#include <thread>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include "zThreadPool.h"
+
+// 等待计数器达到目标值，超时返回false
+struct TestLatch {
+    std::atomic<size_t> count{0};
+    size_t target = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    void arrive() {
+        if (count.fetch_add(1) + 1 == target) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_all();
+        }
+    }
+
+    bool wait(int timeout_ms) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() {
+            return count.load() >= target;
+        });
+    }
+};
+
+// 线程池压力测试与基准：10 万个小任务（多线程提交、任务内嵌套提交）的吞吐，以及空闲时的派发延迟
+void test_thread_pool() {
+    LOGI("=== zThreadPool Tests START ===");
+
+    zThreadPool* pool = zThreadPool::getInstance();
+    recordTestResult(pool != nullptr);
+    if (pool == nullptr) {
+        return;
+    }
+    LOGI("thread pool workers: %zu", pool->getWorkerCount());
+
+    // 压力：4 个线程并发提交 10 万个小任务，每个任务执行且只执行一次
+    const size_t task_num = 100000;
+    const size_t producer_num = 4;
+    std::shared_ptr<TestLatch> latch = std::make_shared<TestLatch>();
+    latch->target = task_num;
+    std::shared_ptr<std::atomic<uint64_t>> sum = std::make_shared<std::atomic<uint64_t>>(0);
+    uint64_t start = get_time_ns();
+    vector<std::thread*> producers;
+    for (size_t p = 0; p < producer_num; p++) {
+        producers.push_back(new std::thread([pool, latch, sum, p, task_num, producer_num]() {
+            for (size_t i = p; i < task_num; i += producer_num) {
+                pool->addTask("tiny_task", [latch, sum, i]() {
+                    sum->fetch_add(i);
+                    latch->arrive();
+                });
+            }
+        }));
+    }
+    for (size_t p = 0; p < producer_num; p++) {
+        producers[p]->join();
+        delete producers[p];
+    }
+    bool finished = latch->wait(120000);
+    uint64_t elapsed_ns = get_time_ns() - start;
+    LOGI("thread pool %zu tiny tasks: %.1f ms, %.0f tasks/s", task_num, elapsed_ns / 1e6,
+         task_num * 1e9 / (elapsed_ns ? elapsed_ns : 1));
+    recordTestResult(finished && latch->count.load() == task_num);
+    recordTestResult(sum->load() == (uint64_t) task_num * (task_num - 1) / 2);
+
+    // 任务内嵌套提交：1000 个任务各自再提交 10 个子任务
+    const size_t parent_num = 1000;
+    const size_t child_num = 10;
+    std::shared_ptr<TestLatch> nested_latch = std::make_shared<TestLatch>();
+    nested_latch->target = parent_num * (child_num + 1);
+    start = get_time_ns();
+    for (size_t i = 0; i < parent_num; i++) {
+        pool->addTask("parent_task", [pool, nested_latch, child_num]() {
+            for (size_t c = 0; c < child_num; c++) {
+                pool->addTask("child_task", [nested_latch]() {
+                    nested_latch->arrive();
+                });
+            }
+            nested_latch->arrive();
+        });
+    }
+    finished = nested_latch->wait(60000);
+    elapsed_ns = get_time_ns() - start;
+    LOGI("thread pool nested %zu tasks: %.1f ms", nested_latch->target, elapsed_ns / 1e6);
+    recordTestResult(finished && nested_latch->count.load() == nested_latch->target);
+
+    // 派发延迟：线程池空闲时提交单个任务，从提交到开始执行的时间
+    const int latency_rounds = 2000;
+    vector<uint64_t> latencies;
+    for (int round = 0; round < latency_rounds; round++) {
+        std::shared_ptr<TestLatch> one = std::make_shared<TestLatch>();
+        one->target = 1;
+        std::shared_ptr<std::atomic<uint64_t>> started_ns = std::make_shared<std::atomic<uint64_t>>(0);
+        uint64_t submit_ns = get_time_ns();
+        pool->addTask("latency_task", [one, started_ns]() {
+            started_ns->store(get_time_ns());
+            one->arrive();
+        });
+        if (!one->wait(5000)) {
+            break;
+        }
+        latencies.push_back(started_ns->load() - submit_ns);
+    }
+    recordTestResult(latencies.size() == (size_t) latency_rounds);
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        uint64_t total_ns = 0;
+        for (uint64_t latency : latencies) {
+            total_ns += latency;
+        }
+        LOGI("thread pool dispatch latency: avg %.1f us, p50 %.1f us, p99 %.1f us",
+             total_ns / 1e3 / latencies.size(), latencies[latencies.size() / 2] / 1e3,
+             latencies[latencies.size() * 99 / 100] / 1e3);
+    }
+
+    LOGI("=== zThreadPool Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+// 固定计算量，模拟检测任务（按迭代次数而不是时间，CPU 被抢占时计算量不变）
+static uint32_t simulate_detector_work(uint32_t iterations) {
+    volatile uint32_t seed = 1;
+    for (uint32_t i = 0; i < iterations; i++) {
+        seed = seed * 1103515245 + 12345;
+    }
+    return seed;
+}
+
+// 任务完成句柄测试：wait / waitFor / then / whenAll / whenAny、异常与工作线程内等待，以及 19 个检测任务扇出扇入的基准
+void test_task_future() {
+    LOGI("=== zTaskFuture Tests START ===");
+
+    zThreadPool* pool = zThreadPool::getInstance();
+    recordTestResult(pool != nullptr);
+    if (pool == nullptr) {
+        return;
+    }
+
+    // 正常结束
+    std::shared_ptr<std::atomic<int>> value = std::make_shared<std::atomic<int>>(0);
+    zTaskFuture future = pool->addTaskFuture("future_task", [value]() {
+        value->store(1);
+    });
+    future.wait();
+    recordTestResult(future.isReady() && !future.isFailed() && value->load() == 1);
+
+    // 抛出异常的任务以失败完成
+    zTaskFuture failed = pool->addTaskFuture("throw_task", []() {
+        throw std::runtime_error("test");
+    });
+    failed.wait();
+    recordTestResult(failed.isFailed());
+
+    // waitFor 超时
+    zTaskFuture slow = pool->addTaskFuture("slow_task", []() {
+        usleep(200 * 1000);
+    });
+    bool early = slow.waitFor(10);
+    recordTestResult(!early && !slow.isReady());
+    recordTestResult(slow.waitFor(5000) && !slow.isFailed());
+
+    // then：后续任务在前一个任务完成后执行
+    std::shared_ptr<std::atomic<int>> order = std::make_shared<std::atomic<int>>(0);
+    zTaskFuture first = pool->addTaskFuture("then_first", [order]() {
+        usleep(20 * 1000);
+        int expected = 0;
+        order->compare_exchange_strong(expected, 1);
+    });
+    zTaskFuture second = first.then([order]() {
+        int expected = 1;
+        order->compare_exchange_strong(expected, 2);
+    });
+    recordTestResult(second.waitFor(5000) && order->load() == 2);
+
+    // 已完成句柄上的 then 也会执行
+    zTaskFuture ready_then = zTaskFuture::makeReady().then([order]() {
+        order->fetch_add(1);
+    });
+    recordTestResult(ready_then.waitFor(5000) && order->load() == 3);
+
+    // whenAll：全部完成后完成，任意一个失败则失败
+    std::shared_ptr<std::atomic<int>> count = std::make_shared<std::atomic<int>>(0);
+    vector<zTaskFuture> futures;
+    for (int i = 0; i < 19; i++) {
+        futures.push_back(pool->addTaskFuture("all_task", [count, i]() {
+            usleep((i % 5) * 1000);
+            count->fetch_add(1);
+        }));
+    }
+    zTaskFuture all = zTaskFuture::whenAll(futures);
+    recordTestResult(all.waitFor(5000) && !all.isFailed() && count->load() == 19);
+    futures.push_back(failed);
+    recordTestResult(zTaskFuture::whenAll(futures).isFailed());
+    recordTestResult(zTaskFuture::whenAll(vector<zTaskFuture>()).isReady());
+
+    // whenAny：最先完成的一个决定结果，不等待慢任务
+    vector<zTaskFuture> any_futures;
+    any_futures.push_back(pool->addTaskFuture("any_fast", []() {
+    }));
+    any_futures.push_back(pool->addTaskFuture("any_slow", []() {
+        usleep(300 * 1000);
+    }));
+    zTaskFuture any = zTaskFuture::whenAny(any_futures);
+    recordTestResult(any.waitFor(200) && !any.isFailed() && !any_futures[1].isReady());
+    any_futures[1].wait();
+
+    // 工作线程内等待自己提交的子任务：等待期间协助执行，线程池只有一个工作线程时也不会死锁
+    zTaskFuture parent = pool->addTaskFuture("nested_parent", [pool, count]() {
+        vector<zTaskFuture> children;
+        for (int i = 0; i < 8; i++) {
+            children.push_back(pool->addTaskFuture("nested_child", [count]() {
+                count->fetch_add(1);
+            }));
+        }
+        zTaskFuture::whenAll(children).wait();
+    });
+    recordTestResult(parent.waitFor(5000) && !parent.isFailed() && count->load() == 19 + 8);
+
+    // 基准：19 个检测任务扇出扇入，任务为空（只测调度开销）与每个约 1ms 计算量两种情况
+    // 对比 zManager 现有方式：用 hasTaskName 轮询（1ms 间隔）等待全部结束
+    const int detector_num = 19;
+    const int round_num = 30;
+    const uint32_t work_iterations[] = {0, 1000000};
+    for (uint32_t iterations : work_iterations) {
+        uint64_t poll_ns = 0;
+        uint64_t future_ns = 0;
+        for (int round = 0; round < round_num; round++) {
+            uint64_t start = get_time_ns();
+            for (int i = 0; i < detector_num; i++) {
+                pool->addTask(string_format("poll_detector_%d", i), [iterations]() {
+                    simulate_detector_work(iterations);
+                });
+            }
+            for (int i = 0; i < detector_num; i++) {
+                while (pool->hasTaskName(string_format("poll_detector_%d", i))) {
+                    usleep(1000);
+                }
+            }
+            poll_ns += get_time_ns() - start;
+
+            start = get_time_ns();
+            vector<zTaskFuture> detectors;
+            for (int i = 0; i < detector_num; i++) {
+                detectors.push_back(pool->addTaskFuture(string_format("future_detector_%d", i), [iterations]() {
+                    simulate_detector_work(iterations);
+                }));
+            }
+            zTaskFuture::whenAll(detectors).wait();
+            future_ns += get_time_ns() - start;
+        }
+        LOGI("fan-out/fan-in %d detectors (%u iterations): hasTaskName polling %.3f ms/round, whenAll %.3f ms/round",
+             detector_num, iterations, poll_ns / 1e6 / round_num, future_ns / 1e6 / round_num);
+    }
+    recordTestResult(true);
+
+    LOGI("=== zTaskFuture Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+// 优先级测试：类别顺序与类别内 EDF 顺序，以及低优先级队列饱和时高优先级任务的排队延迟有上界
+void test_task_priority() {
+    LOGI("=== zThreadPool Priority Tests START ===");
+
+    zThreadPool* pool = zThreadPool::getInstance();
+    recordTestResult(pool != nullptr);
+    if (pool == nullptr) {
+        return;
+    }
+    size_t worker_count = pool->getWorkerCount();
+    pool->setReservedWorkers(0);
+
+    // 阻塞所有工作线程，排好队后只放开一个，由它按调度顺序依次执行
+    std::shared_ptr<std::atomic<size_t>> blocked = std::make_shared<std::atomic<size_t>>(0);
+    std::shared_ptr<std::atomic<size_t>> released = std::make_shared<std::atomic<size_t>>(0);
+    for (size_t i = 0; i < worker_count; i++) {
+        pool->addTask("priority_blocker", [blocked, released]() {
+            size_t index = blocked->fetch_add(1);
+            while (released->load() <= index) {
+                usleep(1000);
+            }
+        });
+    }
+    uint64_t wait_start = get_time_ns();
+    while (blocked->load() < worker_count && get_time_ns() - wait_start < 5000000000ULL) {
+        usleep(1000);
+    }
+    recordTestResult(blocked->load() == worker_count);
+
+    std::shared_ptr<std::mutex> order_mutex = std::make_shared<std::mutex>();
+    std::shared_ptr<vector<string>> order = std::make_shared<vector<string>>();
+    auto record = [order_mutex, order](const string& name) {
+        return [order_mutex, order, name]() {
+            std::lock_guard<std::mutex> lock(*order_mutex);
+            order->push_back(name);
+        };
+    };
+    vector<zTaskFuture> ordered;
+    ordered.push_back(pool->addTaskFuture("low_30", record("low_30"), zTask::PRIORITY_LOW, 30));
+    ordered.push_back(pool->addTaskFuture("low_10", record("low_10"), zTask::PRIORITY_LOW, 10));
+    ordered.push_back(pool->addTaskFuture("normal", record("normal")));
+    ordered.push_back(pool->addTaskFuture("low_none", record("low_none"), zTask::PRIORITY_LOW));
+    ordered.push_back(pool->addTaskFuture("high", record("high"), zTask::PRIORITY_HIGH));
+    released->store(1);
+    bool finished = zTaskFuture::whenAll(ordered).waitFor(5000);
+    released->store(worker_count + 1);
+
+    string order_text;
+    for (size_t i = 0; i < order->size(); i++) {
+        order_text += (i ? "," : "") + (*order)[i];
+    }
+    LOGI("priority order: %s", order_text.c_str());
+    recordTestResult(finished && order_text == "high,normal,low_10,low_30,low_none");
+
+    // 低优先级队列饱和：300 个约 2ms 的任务，期间每 5ms 提交一个高优先级任务
+    bool reserved = worker_count >= 2 && pool->setReservedWorkers(1);
+    pool->resetClassStats();
+
+    vector<zTaskFuture> bulk;
+    for (int i = 0; i < 300; i++) {
+        bulk.push_back(pool->addTaskFuture("bulk_low", []() {
+            simulate_detector_work(1000000);
+        }, zTask::PRIORITY_LOW));
+    }
+
+    // 排在低优先级队列末尾的对照任务
+    std::shared_ptr<std::atomic<uint64_t>> low_probe_wait = std::make_shared<std::atomic<uint64_t>>(0);
+    uint64_t low_probe_submit = get_time_ns();
+    zTaskFuture low_probe = pool->addTaskFuture("low_probe", [low_probe_wait, low_probe_submit]() {
+        low_probe_wait->store(get_time_ns() - low_probe_submit);
+    }, zTask::PRIORITY_LOW);
+
+    const int high_num = 20;
+    std::shared_ptr<vector<uint64_t>> high_waits = std::make_shared<vector<uint64_t>>((size_t) high_num, (uint64_t) 0);
+    vector<zTaskFuture> high_futures;
+    for (int i = 0; i < high_num; i++) {
+        uint64_t submit = get_time_ns();
+        high_futures.push_back(pool->addTaskFuture("high_probe", [high_waits, i, submit]() {
+            (*high_waits)[i] = get_time_ns() - submit;
+        }, zTask::PRIORITY_HIGH));
+        usleep(5000);
+    }
+    finished = zTaskFuture::whenAll(high_futures).waitFor(10000);
+    zTaskClassStats low_stats = pool->getClassStats(zTask::PRIORITY_LOW);
+    zTaskClassStats high_stats = pool->getClassStats(zTask::PRIORITY_HIGH);
+
+    uint64_t high_max_wait = 0;
+    for (int i = 0; i < high_num; i++) {
+        high_max_wait = (*high_waits)[i] > high_max_wait ? (*high_waits)[i] : high_max_wait;
+    }
+    LOGI("priority saturated low queue (reserved worker %d): low queue depth %zu, high wait avg %.2f ms max %.2f ms",
+         reserved, low_stats.queueDepth,
+         high_stats.waitCount ? high_stats.waitTotalNs / 1e6 / high_stats.waitCount : 0.0, high_max_wait / 1e6);
+    recordTestResult(finished && high_stats.waitCount >= (uint64_t) high_num);
+    recordTestResult(low_stats.queueDepth > 0);
+    recordTestResult(high_max_wait < 50 * 1000000ULL);
+
+    zTaskFuture::whenAll(bulk).wait();
+    low_probe.wait();
+    low_stats = pool->getClassStats(zTask::PRIORITY_LOW);
+    LOGI("priority low probe wait %.2f ms, low wait avg %.2f ms max %.2f ms",
+         low_probe_wait->load() / 1e6, low_stats.waitCount ? low_stats.waitTotalNs / 1e6 / low_stats.waitCount : 0.0,
+         low_stats.waitMaxNs / 1e6);
+    recordTestResult(low_probe_wait->load() > high_max_wait);
+
+    pool->setReservedWorkers(0);
+    LOGI("=== zThreadPool Priority Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+#include <poll.h>
+#include <errno.h>
+#include "zShell.h"
+
+// 取消与超时测试：取消排队中与执行中的任务、协作式超时、故意挂起（忽略取消）的任务占住全部工作线程、
+// 阻塞在 runShell / waitFd 上的任务被取消
+void test_task_cancel() {
+    LOGI("=== zTask Cancel Tests START ===");
+
+    zThreadPool* pool = zThreadPool::getInstance();
+    recordTestResult(pool != nullptr);
+    if (pool == nullptr) {
+        return;
+    }
+    size_t worker_count = pool->getWorkerCount();
+
+    // 令牌本身：回调、已取消后注册立即执行、注销后不再执行、waitCancelled
+    zCancelToken token = zCancelToken::create();
+    std::shared_ptr<std::atomic<int>> calls = std::make_shared<std::atomic<int>>(0);
+    uint64_t removed = token.registerCallback([calls]() { calls->fetch_add(100); });
+    token.registerCallback([calls]() { calls->fetch_add(1); });
+    token.unregisterCallback(removed);
+    recordTestResult(!token.waitCancelled(1));
+    recordTestResult(token.cancel("test") && !token.cancel("again") && calls->load() == 1);
+    token.registerCallback([calls]() { calls->fetch_add(1); });
+    recordTestResult(token.isCancelled() && token.getReason() == "test" && calls->load() == 2 && token.waitCancelled(1000));
+    recordTestResult(!zCancelToken().cancel() && !zCancelToken().isCancelled());
+
+    // 排队中的任务被取消：句柄立即失败，任务函数不执行
+    std::shared_ptr<std::atomic<size_t>> blocked = std::make_shared<std::atomic<size_t>>(0);
+    std::shared_ptr<std::atomic<bool>> release = std::make_shared<std::atomic<bool>>(false);
+    vector<zTaskFuture> blockers;
+    for (size_t i = 0; i < worker_count; i++) {
+        blockers.push_back(pool->addTaskFuture("cancel_blocker", [blocked, release]() {
+            blocked->fetch_add(1);
+            while (!release->load()) {
+                usleep(1000);
+            }
+        }));
+    }
+    uint64_t wait_start = get_time_ns();
+    while (blocked->load() < worker_count && get_time_ns() - wait_start < 5000000000ULL) {
+        usleep(1000);
+    }
+    std::shared_ptr<std::atomic<bool>> ran = std::make_shared<std::atomic<bool>>(false);
+    uint64_t cancelled_before = pool->getCancelledTaskCount();
+    zTaskFuture queued = pool->addTaskFuture("cancel_queued", [ran]() {
+        ran->store(true);
+    });
+    recordTestResult(queued.cancel() && queued.isReady() && queued.isFailed() && queued.isCancelled());
+    release->store(true);
+    zTaskFuture::whenAll(blockers).wait();
+    zTaskFuture after_queued = pool->addTaskFuture("cancel_after_queued", []() {});
+    after_queued.wait();
+    recordTestResult(!ran->load() && pool->getCancelledTaskCount() == cancelled_before + 1);
+
+    // 执行中的任务轮询令牌
+    std::shared_ptr<std::atomic<bool>> started = std::make_shared<std::atomic<bool>>(false);
+    std::shared_ptr<std::atomic<bool>> exited = std::make_shared<std::atomic<bool>>(false);
+    zTaskFuture polling = pool->addTaskFuture("cancel_polling", [started, exited]() {
+        started->store(true);
+        while (!zCancelToken::isCurrentCancelled()) {
+            usleep(1000);
+        }
+        exited->store(true);
+    });
+    while (!started->load()) {
+        usleep(1000);
+    }
+    polling.cancel();
+    recordTestResult(polling.isFailed());
+    wait_start = get_time_ns();
+    while (!exited->load() && get_time_ns() - wait_start < 5000000000ULL) {
+        usleep(1000);
+    }
+    recordTestResult(exited->load());
+
+    // 协作式超时：任务在令牌上等待 10s，50ms 超时后返回
+    uint64_t timed_out_before = pool->getTimedOutTaskCount();
+    uint64_t start = get_time_ns();
+    zTaskFuture timed = pool->addTaskFuture("cancel_timeout", []() {
+        zCancelToken::current().waitCancelled(10000);
+    }, zTask::PRIORITY_NORMAL, 0, 50);
+    bool finished = timed.waitFor(5000);
+    uint64_t timeout_ns = get_time_ns() - start;
+    LOGI("cancel cooperative timeout: future failed after %.1f ms (timeout 50 ms)", timeout_ns / 1e6);
+    recordTestResult(finished && timed.isFailed() && timeout_ns < 1000000000ULL);
+    recordTestResult(pool->getTimedOutTaskCount() == timed_out_before + 1);
+
+    // 默认任务函数（5 x 500ms）响应超时
+    start = get_time_ns();
+    zTask* default_task = new zTask("cancel_default_task");
+    default_task->setTimeoutMs(100);
+    pool->addTask(default_task);
+    wait_start = get_time_ns();
+    while (pool->hasTaskName("cancel_default_task") && get_time_ns() - wait_start < 5000000000ULL) {
+        usleep(1000);
+    }
+    LOGI("cancel default task: finished after %.1f ms (uncancelled 2500 ms)", (get_time_ns() - start) / 1e6);
+    recordTestResult(get_time_ns() - start < 1500000000ULL);
+
+    // 阻塞在 waitFd 上（管道没有数据）的任务被取消
+    int pipefd[2];
+    if (pipe(pipefd) == 0) {
+        std::shared_ptr<std::atomic<int>> wait_errno = std::make_shared<std::atomic<int>>(0);
+        start = get_time_ns();
+        zTaskFuture fd_wait = pool->addTaskFuture("cancel_wait_fd", [pipefd, wait_errno]() {
+            if (zCancelToken::current().waitFd(pipefd[0], POLLIN, 10000) < 0) {
+                wait_errno->store(errno);
+            }
+        }, zTask::PRIORITY_NORMAL, 0, 50);
+        fd_wait.wait();
+        usleep(20 * 1000);
+        LOGI("cancel waitFd: cancelled after %.1f ms", (get_time_ns() - start) / 1e6);
+        recordTestResult(fd_wait.isFailed() && wait_errno->load() == ECANCELED);
+        close(pipefd[0]);
+        close(pipefd[1]);
+    }
+
+    // 阻塞在 runShell 上的任务：超时后杀掉命令，任务函数尽快返回
+    std::shared_ptr<std::atomic<uint64_t>> shell_ns = std::make_shared<std::atomic<uint64_t>>(0);
+    start = get_time_ns();
+    zTaskFuture shell = pool->addTaskFuture("cancel_shell", [shell_ns, start]() {
+        runShell("sleep 30");
+        shell_ns->store(get_time_ns() - start);
+    }, zTask::PRIORITY_NORMAL, 0, 100);
+    shell.wait();
+    wait_start = get_time_ns();
+    while (shell_ns->load() == 0 && get_time_ns() - wait_start < 5000000000ULL) {
+        usleep(1000);
+    }
+    LOGI("cancel runShell(\"sleep 30\"): returned after %.1f ms (timeout 100 ms)", shell_ns->load() / 1e6);
+    recordTestResult(shell.isFailed() && shell_ns->load() > 0 && shell_ns->load() < 2000000000ULL);
+
+    // 故意挂起、忽略取消的任务占住全部工作线程：句柄在超时后失败，宽限期后工作线程被替换，新任务照常执行
+    std::shared_ptr<std::atomic<size_t>> hung_started = std::make_shared<std::atomic<size_t>>(0);
+    std::shared_ptr<std::atomic<bool>> hung_release = std::make_shared<std::atomic<bool>>(false);
+    std::shared_ptr<std::atomic<size_t>> hung_followups = std::make_shared<std::atomic<size_t>>(0);
+    vector<zTaskFuture> hung;
+    start = get_time_ns();
+    for (size_t i = 0; i < worker_count; i++) {
+        hung.push_back(pool->addTaskFuture("cancel_hung", [pool, hung_started, hung_release, hung_followups]() {
+            hung_started->fetch_add(1);
+            while (!hung_release->load()) {
+                usleep(1000);
+            }
+            // 此时本线程已被替换，提交的任务不能再放入新线程的本地队列
+            pool->addTask("cancel_hung_followup", [hung_followups]() {
+                hung_followups->fetch_add(1);
+            });
+        }, zTask::PRIORITY_NORMAL, 0, 50));
+    }
+    finished = zTaskFuture::whenAll(hung).waitFor(5000);
+    LOGI("cancel hung tasks: %zu futures failed after %.1f ms", hung.size(), (get_time_ns() - start) / 1e6);
+    recordTestResult(finished && zTaskFuture::whenAll(hung).isFailed() && hung_started->load() == worker_count);
+
+    zTaskFuture after_hung = pool->addTaskFuture("cancel_after_hung", []() {});
+    finished = after_hung.waitFor(10000);
+    LOGI("cancel hung tasks: new task ran after %.1f ms, %zu hung workers replaced",
+         (get_time_ns() - start) / 1e6, pool->getHungWorkerCount());
+    recordTestResult(finished && !after_hung.isFailed() && pool->getHungWorkerCount() > 0);
+
+    // 各任务开始执行的时间不同，等待全部被替换
+    wait_start = get_time_ns();
+    while (pool->getHungWorkerCount() < worker_count && get_time_ns() - wait_start < 5000000000ULL) {
+        usleep(1000);
+    }
+    recordTestResult(pool->getHungWorkerCount() == worker_count);
+
+    // 挂起的任务返回后，被替换的线程退出
+    hung_release->store(true);
+    wait_start = get_time_ns();
+    while (pool->getHungWorkerCount() > 0 && get_time_ns() - wait_start < 5000000000ULL) {
+        usleep(1000);
+    }
+    recordTestResult(pool->getHungWorkerCount() == 0);
+
+    // 被替换的线程在返回前提交的任务照常执行
+    wait_start = get_time_ns();
+    while (hung_followups->load() < worker_count && get_time_ns() - wait_start < 5000000000ULL) {
+        usleep(1000);
+    }
+    recordTestResult(hung_followups->load() == worker_count);
+
+    LOGI("=== zTask Cancel Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+#include "zTaskGraph.h"
+#include "zProcMaps.h"
+
+// 任务依赖图测试：执行顺序与并行、共享输入只计算一次、环与未知依赖、失败传播、取消，
+// 以及 5 个检测任务共享一个耗时输入时与各自重复计算的对比基准
+void test_task_graph() {
+    LOGI("=== zTaskGraph Tests START ===");
+
+    zThreadPool* pool = zThreadPool::getInstance();
+    recordTestResult(pool != nullptr);
+    if (pool == nullptr) {
+        return;
+    }
+    size_t worker_count = pool->getWorkerCount();
+
+    // 菱形依赖 a -> (b, c) -> d，外加独立节点 e；记录每个节点的完成序号与 b、c 的最大并发数
+    std::shared_ptr<std::atomic<int>> sequence = std::make_shared<std::atomic<int>>(0);
+    std::shared_ptr<vector<std::atomic<int>>> finish_order = std::make_shared<vector<std::atomic<int>>>(5);
+    std::shared_ptr<std::atomic<int>> running = std::make_shared<std::atomic<int>>(0);
+    std::shared_ptr<std::atomic<int>> max_running = std::make_shared<std::atomic<int>>(0);
+    std::function<std::function<void()>(int, int)> make_node = [sequence, finish_order, running, max_running](int id, int sleep_ms) {
+        return [sequence, finish_order, running, max_running, id, sleep_ms]() {
+            int now = running->fetch_add(1) + 1;
+            int seen = max_running->load();
+            while (now > seen && !max_running->compare_exchange_weak(seen, now)) {
+            }
+            usleep(sleep_ms * 1000);
+            running->fetch_sub(1);
+            (*finish_order)[id].store(sequence->fetch_add(1) + 1);
+        };
+    };
+    zTaskGraph diamond;
+    recordTestResult(diamond.addNode("graph_d", make_node(3, 0), {"graph_b", "graph_c"}));
+    recordTestResult(diamond.addNode("graph_a", make_node(0, 0)));
+    recordTestResult(diamond.addNode("graph_b", make_node(1, 50), {"graph_a"}));
+    recordTestResult(diamond.addNode("graph_c", make_node(2, 50), {"graph_a"}));
+    recordTestResult(diamond.addNode("graph_e", make_node(4, 0)));
+    recordTestResult(!diamond.addNode("graph_e", make_node(4, 0)));
+    recordTestResult(diamond.validate() && diamond.getNodeCount() == 5);
+    uint64_t start = get_time_ns();
+    zTaskFuture round = diamond.run(pool);
+    recordTestResult(round.waitFor(5000) && !round.isFailed());
+    LOGI("task graph diamond: %.1f ms, max parallel %d", (get_time_ns() - start) / 1e6, max_running->load());
+    int a = (*finish_order)[0].load();
+    int b = (*finish_order)[1].load();
+    int c = (*finish_order)[2].load();
+    int d = (*finish_order)[3].load();
+    recordTestResult(a > 0 && b > a && c > a && d > b && d > c && (*finish_order)[4].load() > 0);
+    if (worker_count >= 2) {
+        recordTestResult(max_running->load() >= 2);
+    }
+
+    // 同一个图可以再执行一轮
+    sequence->store(0);
+    round = diamond.run(pool);
+    recordTestResult(round.waitFor(5000) && !round.isFailed() && sequence->load() == 5);
+
+    // 环、未知依赖：validate 失败，run 返回失败的句柄
+    zTaskGraph cycle;
+    cycle.addNode("cycle_x", []() {}, {"cycle_y"});
+    cycle.addNode("cycle_y", []() {}, {"cycle_x"});
+    cycle.addNode("cycle_z", []() {});
+    recordTestResult(!cycle.validate() && cycle.run(pool).isFailed());
+    zTaskGraph unknown;
+    unknown.addNode("unknown_x", []() {}, {"missing"});
+    recordTestResult(!unknown.validate());
+    recordTestResult(zTaskGraph().run(pool).waitFor(0));
+
+    // 共享输入：只计算一次，依赖它的节点拿到同一份结果；不在任务图中执行时 getInput 返回空
+    std::shared_ptr<std::atomic<int>> input_calls = std::make_shared<std::atomic<int>>(0);
+    std::shared_ptr<std::atomic<int>> input_hits = std::make_shared<std::atomic<int>>(0);
+    zTaskGraph shared;
+    shared.addInput<int>("shared_input", [input_calls]() {
+        input_calls->fetch_add(1);
+        return std::make_shared<int>(42);
+    });
+    shared.addInput<zProcMaps>(zProcMaps::ROUND_INPUT_NAME, []() {
+        return std::make_shared<zProcMaps>();
+    });
+    for (int i = 0; i < 5; i++) {
+        shared.addNode(string_format("shared_consumer_%d", i), [input_hits]() {
+            std::shared_ptr<int> value = zTaskGraph::getInput<int>("shared_input");
+            std::shared_ptr<zProcMaps> first = zProcMaps::get_round_snapshot();
+            std::shared_ptr<zProcMaps> second = zProcMaps::get_round_snapshot();
+            if (value != nullptr && *value == 42 && first == second) {
+                input_hits->fetch_add(1);
+            }
+        }, {"shared_input", zProcMaps::ROUND_INPUT_NAME});
+    }
+    round = shared.run(pool);
+    recordTestResult(round.waitFor(5000) && !round.isFailed());
+    recordTestResult(input_calls->load() == 1 && input_hits->load() == 5);
+    recordTestResult(zTaskGraph::getInput<int>("shared_input") == nullptr);
+    recordTestResult(zProcMaps::get_round_snapshot() != zProcMaps::get_round_snapshot());
+
+    // 失败传播：输入节点返回空、任务抛出异常，依赖它们的节点（包括间接依赖）跳过，其它节点照常执行
+    std::shared_ptr<std::atomic<int>> executed = std::make_shared<std::atomic<int>>(0);
+    zTaskGraph failing;
+    failing.addInput<int>("null_input", []() {
+        return std::shared_ptr<int>();
+    });
+    failing.addNode("throw_node", []() {
+        throw std::runtime_error("test");
+    });
+    failing.addNode("after_null", [executed]() { executed->fetch_add(100); }, {"null_input"});
+    failing.addNode("after_throw", [executed]() { executed->fetch_add(100); }, {"throw_node"});
+    failing.addNode("after_after", [executed]() { executed->fetch_add(100); }, {"after_throw"});
+    failing.addNode("independent", [executed]() { executed->fetch_add(1); });
+    round = failing.run(pool);
+    recordTestResult(round.waitFor(5000) && round.isFailed() && executed->load() == 1);
+
+    // 取消一轮：还没有提交的节点不再执行
+    zTaskGraph cancelled;
+    cancelled.addNode("cancel_first", []() { usleep(50 * 1000); });
+    cancelled.addNode("cancel_second", [executed]() { executed->fetch_add(100); }, {"cancel_first"});
+    round = cancelled.run(pool);
+    round.cancel("test");
+    recordTestResult(round.waitFor(5000) && round.isFailed() && executed->load() == 1);
+
+    // 基准：5 个检测任务共享一个耗时输入（固定计算量），各自重复计算 vs 任务图中只计算一次
+    const int consumer_num = 5;
+    const int round_num = 10;
+    const uint32_t input_iterations = 4000000;
+    const uint32_t detector_iterations = 200000;
+    uint64_t repeated_ns = 0;
+    uint64_t graph_ns = 0;
+    for (int r = 0; r < round_num; r++) {
+        start = get_time_ns();
+        vector<zTaskFuture> detectors;
+        for (int i = 0; i < consumer_num; i++) {
+            detectors.push_back(pool->addTaskFuture(string_format("repeat_detector_%d", i), [input_iterations, detector_iterations]() {
+                simulate_detector_work(input_iterations);
+                simulate_detector_work(detector_iterations);
+            }));
+        }
+        zTaskFuture::whenAll(detectors).wait();
+        repeated_ns += get_time_ns() - start;
+
+        start = get_time_ns();
+        zTaskGraph bench;
+        bench.addInput<uint32_t>("bench_input", [input_iterations]() {
+            return std::make_shared<uint32_t>(simulate_detector_work(input_iterations));
+        });
+        for (int i = 0; i < consumer_num; i++) {
+            bench.addNode(string_format("graph_detector_%d", i), [detector_iterations]() {
+                zTaskGraph::getInput<uint32_t>("bench_input");
+                simulate_detector_work(detector_iterations);
+            }, {"bench_input"});
+        }
+        bench.run(pool).wait();
+        graph_ns += get_time_ns() - start;
+    }
+    LOGI("shared input round (%d detectors, %zu workers): recompute per detector %.2f ms/round, task graph %.2f ms/round",
+         consumer_num, worker_count, repeated_ns / 1e6 / round_num, graph_ns / 1e6 / round_num);
+
+    LOGI("=== zTaskGraph Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+#include <sched.h>
+#include <math.h>
+#include "zCpuTopology.h"
+
+// 在伪造的 sysfs 目录中写入文件，自动创建中间目录
+static bool write_cpu_fixture(const string& root, const string& relative_path, const string& text) {
+    string path = root;
+    vector<string> parts = split_str(relative_path, '/');
+    for (size_t i = 0; i + 1 < parts.size(); i++) {
+        path += "/" + parts[i];
+        mkdir(path.c_str(), 0700);
+    }
+    return write_test_file(root + "/" + relative_path, vector<uint8_t>(text.begin(), text.end()));
+}
+
+static void remove_cpu_fixture(const string& root) {
+    runShell("rm -rf '" + root + "'");
+}
+
+// 当前线程的绑定是否等于 cpus 与 allowed（进程所在 cpuset 允许的核）的交集，交集为空时无法绑定，不检查
+static bool affinity_matches(const vector<int>& cpus, const cpu_set_t& allowed) {
+    cpu_set_t expected;
+    CPU_ZERO(&expected);
+    for (size_t i = 0; i < cpus.size(); i++) {
+        if (CPU_ISSET(cpus[i], &allowed)) {
+            CPU_SET(cpus[i], &expected);
+        }
+    }
+    if (CPU_COUNT(&expected) == 0) {
+        return true;
+    }
+    cpu_set_t current;
+    CPU_ZERO(&current);
+    return sched_getaffinity(0, sizeof(current), &current) == 0 && CPU_EQUAL(&current, &expected);
+}
+
+// CPU 拓扑与绑核测试：伪造 sysfs 目录（三簇 capacity、只有频率、离线核、空目录）的拓扑解析，
+// 作用域绑核的恢复，线程池各绑核策略与任务核心类别，以及各策略下吞吐与计时抖动的对比基准
+void test_cpu_topology() {
+    LOGI("=== zCpuTopology Tests START ===");
+
+    // CPU 列表解析
+    vector<int> parsed = zCpuTopology::parseCpuList("0-3,6,8-9\n");
+    recordTestResult(parsed == vector<int>({0, 1, 2, 3, 6, 8, 9}));
+    recordTestResult(zCpuTopology::parseCpuList("4 5 6 7") == vector<int>({4, 5, 6, 7}));
+    recordTestResult(zCpuTopology::parseCpuList("").empty());
+
+    string tmp_dir = get_test_tmp_dir();
+    recordTestResult(!tmp_dir.empty());
+    if (tmp_dir.empty()) {
+        return;
+    }
+
+    // 三簇：4 个小核、3 个中核、1 个超大核，按 cpu_capacity 分簇
+    string tri_root = tmp_dir + "/cpu_fixture_tri";
+    remove_cpu_fixture(tri_root);
+    mkdir(tri_root.c_str(), 0700);
+    write_cpu_fixture(tri_root, "online", "0-7\n");
+    for (int cpu = 0; cpu < 8; cpu++) {
+        uint32_t capacity = cpu < 4 ? 400 : (cpu < 7 ? 850 : 1024);
+        uint32_t freq = cpu < 4 ? 1800000 : (cpu < 7 ? 2400000 : 3000000);
+        write_cpu_fixture(tri_root, string_format("cpu%d/cpu_capacity", cpu), string_format("%u\n", capacity));
+        write_cpu_fixture(tri_root, string_format("cpu%d/cpufreq/cpuinfo_max_freq", cpu), string_format("%u\n", freq));
+    }
+    zCpuTopology tri = zCpuTopology::load(tri_root);
+    recordTestResult(tri.getCpuCount() == 8 && tri.getClusters().size() == 3 && tri.isHeterogeneous());
+    recordTestResult(tri.getCpus(zCpuTopology::CORE_LITTLE) == vector<int>({0, 1, 2, 3}));
+    recordTestResult(tri.getCpus(zCpuTopology::CORE_MID) == vector<int>({4, 5, 6}));
+    recordTestResult(tri.getCpus(zCpuTopology::CORE_BIG) == vector<int>({7}));
+    recordTestResult(tri.getCpus(zCpuTopology::CORE_ANY).size() == 8);
+    recordTestResult(tri.getCoreClass(0) == zCpuTopology::CORE_LITTLE && tri.getCoreClass(5) == zCpuTopology::CORE_MID &&
+                     tri.getCoreClass(7) == zCpuTopology::CORE_BIG && tri.getCoreClass(9) == zCpuTopology::CORE_ANY);
+    recordTestResult(tri.getClusters()[2].maxFreqKHz == 3000000);
+    recordTestResult(tri.getSpreadOrder() == vector<int>({7, 4, 0, 5, 1, 6, 2, 3}));
+    remove_cpu_fixture(tri_root);
+
+    // 只有频率、没有 online 文件：逐个探测 cpuN 目录，跳过离线核，两簇时中核等同于大核
+    string freq_root = tmp_dir + "/cpu_fixture_freq";
+    remove_cpu_fixture(freq_root);
+    mkdir(freq_root.c_str(), 0700);
+    for (int cpu = 0; cpu < 8; cpu++) {
+        write_cpu_fixture(freq_root, string_format("cpu%d/cpufreq/cpuinfo_max_freq", cpu), cpu < 4 ? "1800000\n" : "2800000\n");
+    }
+    write_cpu_fixture(freq_root, "cpu3/online", "0\n");
+    write_cpu_fixture(freq_root, "cpu4/online", "1\n");
+    zCpuTopology freq = zCpuTopology::load(freq_root);
+    recordTestResult(freq.getCpuCount() == 7 && freq.getClusters().size() == 2);
+    recordTestResult(freq.getCpus(zCpuTopology::CORE_LITTLE) == vector<int>({0, 1, 2}));
+    recordTestResult(freq.getCpus(zCpuTopology::CORE_BIG) == vector<int>({4, 5, 6, 7}));
+    recordTestResult(freq.getCpus(zCpuTopology::CORE_MID) == freq.getCpus(zCpuTopology::CORE_BIG));
+    remove_cpu_fixture(freq_root);
+
+    // 部分核缺少 cpu_capacity：全部按频率分簇，同一簇不会因为有无 capacity 被拆开
+    string mixed_root = tmp_dir + "/cpu_fixture_mixed";
+    remove_cpu_fixture(mixed_root);
+    mkdir(mixed_root.c_str(), 0700);
+    write_cpu_fixture(mixed_root, "online", "0-7\n");
+    for (int cpu = 0; cpu < 8; cpu++) {
+        write_cpu_fixture(mixed_root, string_format("cpu%d/cpufreq/cpuinfo_max_freq", cpu), cpu < 4 ? "1800000\n" : "2800000\n");
+        if (cpu % 2 == 0) {
+            write_cpu_fixture(mixed_root, string_format("cpu%d/cpu_capacity", cpu), cpu < 4 ? "400\n" : "1024\n");
+        }
+    }
+    zCpuTopology mixed = zCpuTopology::load(mixed_root);
+    recordTestResult(mixed.getCpuCount() == 8 && mixed.getClusters().size() == 2);
+    recordTestResult(mixed.getCpus(zCpuTopology::CORE_LITTLE) == vector<int>({0, 1, 2, 3}));
+    recordTestResult(mixed.getCpus(zCpuTopology::CORE_BIG) == vector<int>({4, 5, 6, 7}));
+    remove_cpu_fixture(mixed_root);
+
+    // 读不到任何信息：没有 CPU，绑定不做任何修改
+    string empty_root = tmp_dir + "/cpu_fixture_empty";
+    remove_cpu_fixture(empty_root);
+    mkdir(empty_root.c_str(), 0700);
+    zCpuTopology empty = zCpuTopology::load(empty_root);
+    recordTestResult(empty.getCpuCount() == 0 && !empty.isHeterogeneous() && empty.getCpus(zCpuTopology::CORE_BIG).empty());
+    recordTestResult(empty.getSpreadOrder().empty() && !zCpuTopology::bindCurrentThread(vector<int>()));
+    remove_cpu_fixture(empty_root);
+
+    // 本机拓扑
+    const zCpuTopology* system = zCpuTopology::getInstance();
+    recordTestResult(system != nullptr && system->getCpuCount() > 0);
+    if (system == nullptr || system->getCpuCount() == 0) {
+        return;
+    }
+    vector<int> all_cpus = system->getCpus(zCpuTopology::CORE_ANY);
+    vector<int> big_cpus = system->getCpus(zCpuTopology::CORE_BIG);
+    vector<int> little_cpus = system->getCpus(zCpuTopology::CORE_LITTLE);
+    LOGI("system cpu topology: %zu cpus, %zu clusters, %zu big, %zu little",
+         system->getCpuCount(), system->getClusters().size(), big_cpus.size(), little_cpus.size());
+
+    // 作用域绑核：作用域内绑定到大核，结束后恢复
+    cpu_set_t before;
+    CPU_ZERO(&before);
+    sched_getaffinity(0, sizeof(before), &before);
+    {
+        zCpuAffinityScope scope(zCpuTopology::CORE_BIG);
+        recordTestResult(affinity_matches(big_cpus, before));
+    }
+    cpu_set_t after;
+    CPU_ZERO(&after);
+    sched_getaffinity(0, sizeof(after), &after);
+    recordTestResult(CPU_EQUAL(&before, &after));
+
+    zThreadPool* pool = zThreadPool::getInstance();
+    recordTestResult(pool != nullptr);
+    if (pool == nullptr) {
+        return;
+    }
+    size_t worker_count = pool->getWorkerCount();
+
+    // 各策略下工作线程的绑定：每个工作线程阻塞在一个任务上，保证每个线程都检查一次
+    struct PolicyCase {
+        zThreadPool::AffinityPolicy policy;
+        const char* name;
+    };
+    const PolicyCase policies[] = {
+        {zThreadPool::AFFINITY_NONE, "none"},
+        {zThreadPool::AFFINITY_BIG_ONLY, "big_only"},
+        {zThreadPool::AFFINITY_LITTLE_ONLY, "little_only"},
+        {zThreadPool::AFFINITY_SPREAD, "spread"},
+    };
+    vector<int> spread_order = system->getSpreadOrder();
+    for (const PolicyCase& policy_case : policies) {
+        pool->setAffinityPolicy(policy_case.policy);
+        recordTestResult(pool->getAffinityPolicy() == policy_case.policy);
+        std::shared_ptr<TestLatch> arrived = std::make_shared<TestLatch>();
+        arrived->target = worker_count;
+        std::shared_ptr<std::atomic<bool>> release = std::make_shared<std::atomic<bool>>(false);
+        std::shared_ptr<std::atomic<int>> mismatched = std::make_shared<std::atomic<int>>(0);
+        vector<zTaskFuture> blockers;
+        for (size_t i = 0; i < worker_count; i++) {
+            blockers.push_back(pool->addTaskFuture("affinity_check", [policy_case, all_cpus, big_cpus, little_cpus, spread_order,
+                                                                      before, arrived, release, mismatched]() {
+                bool matched = false;
+                if (policy_case.policy == zThreadPool::AFFINITY_NONE) {
+                    matched = affinity_matches(all_cpus, before);
+                } else if (policy_case.policy == zThreadPool::AFFINITY_BIG_ONLY) {
+                    matched = affinity_matches(big_cpus, before);
+                } else if (policy_case.policy == zThreadPool::AFFINITY_LITTLE_ONLY) {
+                    matched = affinity_matches(little_cpus, before);
+                } else {
+                    for (int cpu : spread_order) {
+                        vector<int> single_cpu;
+                        single_cpu.push_back(cpu);
+                        matched = matched || (CPU_ISSET(cpu, &before) && affinity_matches(single_cpu, before));
+                    }
+                }
+                if (!matched) {
+                    mismatched->fetch_add(1);
+                }
+                arrived->arrive();
+                while (!release->load()) {
+                    usleep(1000);
+                }
+            }));
+        }
+        bool all_arrived = arrived->wait(5000);
+        release->store(true);
+        zTaskFuture::whenAll(blockers).wait();
+        recordTestResult(all_arrived && mismatched->load() == 0);
+    }
+
+    // 任务核心类别：执行期间绑定到小核，执行完恢复工作线程的绑定
+    pool->setAffinityPolicy(zThreadPool::AFFINITY_NONE);
+    std::shared_ptr<std::atomic<bool>> class_bound = std::make_shared<std::atomic<bool>>(false);
+    std::shared_ptr<std::atomic<bool>> restored = std::make_shared<std::atomic<bool>>(false);
+    std::shared_ptr<TestLatch> class_latch = std::make_shared<TestLatch>();
+    class_latch->target = 1;
+    zTask* class_task = new zTask("core_class_task", [class_bound, little_cpus, pool, restored, all_cpus, before, class_latch]() {
+        class_bound->store(affinity_matches(little_cpus, before));
+        pool->addTask("core_class_after", [restored, all_cpus, before, class_latch]() {
+            restored->store(affinity_matches(all_cpus, before));
+            class_latch->arrive();
+        });
+    });
+    class_task->setCoreClass(zCpuTopology::CORE_LITTLE);
+    pool->addTask(class_task);
+    recordTestResult(class_latch->wait(5000) && class_bound->load() && restored->load());
+
+    // 基准：各策略下 2000 个固定计算量任务的吞吐，以及计时探针（固定计算量的耗时）的抖动
+    const int task_num = 2000;
+    const int probe_num = 200;
+    for (const PolicyCase& policy_case : policies) {
+        pool->setAffinityPolicy(policy_case.policy);
+        uint64_t start = get_time_ns();
+        vector<zTaskFuture> tasks;
+        for (int i = 0; i < task_num; i++) {
+            tasks.push_back(pool->addTaskFuture("affinity_bench", []() {
+                simulate_detector_work(20000);
+            }));
+        }
+        // 计时探针与批量任务同时运行，绑定到大核，模拟侧信道检测
+        std::shared_ptr<vector<uint64_t>> probes = std::make_shared<vector<uint64_t>>();
+        std::shared_ptr<TestLatch> probe_latch = std::make_shared<TestLatch>();
+        probe_latch->target = 1;
+        zTask* probe = new zTask("affinity_probe", [probes, probe_num, probe_latch]() {
+            for (int i = 0; i < probe_num; i++) {
+                uint64_t probe_start = get_time_ns();
+                simulate_detector_work(20000);
+                probes->push_back(get_time_ns() - probe_start);
+            }
+            probe_latch->arrive();
+        });
+        probe->setPriority(zTask::PRIORITY_HIGH)->setCoreClass(zCpuTopology::CORE_BIG);
+        pool->addTask(probe);
+        zTaskFuture::whenAll(tasks).wait();
+        probe_latch->wait(30000);
+        uint64_t elapsed_ns = get_time_ns() - start;
+
+        double mean = 0;
+        double variance = 0;
+        uint64_t p99 = 0;
+        if (!probes->empty()) {
+            for (uint64_t value : *probes) {
+                mean += value;
+            }
+            mean /= probes->size();
+            for (uint64_t value : *probes) {
+                variance += (value - mean) * (value - mean);
+            }
+            variance /= probes->size();
+            std::sort(probes->begin(), probes->end());
+            p99 = (*probes)[probes->size() * 99 / 100];
+        }
+        LOGI("affinity %s: %d tasks %.1f ms (%.0f tasks/s), probe mean %.1f us, stddev %.1f us, p99 %.1f us",
+             policy_case.name, task_num, elapsed_ns / 1e6, task_num * 1e9 / (elapsed_ns ? elapsed_ns : 1),
+             mean / 1e3, sqrt(variance) / 1e3, p99 / 1e3);
+        recordTestResult(probes->size() == (size_t) probe_num);
+    }
+    pool->setAffinityPolicy(zThreadPool::AFFINITY_NONE);
+
+    LOGI("=== zCpuTopology Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+#include "zTaskRegistry.h"
+
+// 旧的任务名称登记方式（一把锁 + 线性扫描），基准对比用
+struct LinearTaskNames {
+    vector<pair<string, size_t>> names;
+    std::mutex mutex;
+
+    void add(const string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (pair<string, size_t>& entry : names) {
+            if (entry.first == name) {
+                entry.second++;
+                return;
+            }
+        }
+        names.push_back(pair<string, size_t>(name, 1));
+    }
+
+    void remove(const string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < names.size(); i++) {
+            if (names[i].first == name) {
+                if (--names[i].second == 0) {
+                    names.erase(names.begin() + i);
+                }
+                return;
+            }
+        }
+    }
+
+    bool has(const string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const pair<string, size_t>& entry : names) {
+            if (entry.first == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// 任务 ID 与任务登记表测试：多线程并发创建任务的 ID 唯一性，登记表并发增删与唯一登记，
+// 线程池唯一任务的去重与任务状态查询，以及与旧的线性扫描方式的查询开销对比
+void test_task_registry() {
+    LOGI("=== zTaskRegistry Tests START ===");
+
+    // 8 个线程并发创建任务，ID 全部不同且连续递增
+    const int thread_num = 8;
+    const int task_per_thread = 20000;
+    vector<vector<uint64_t>> thread_ids(thread_num);
+    vector<std::thread> threads;
+    for (int t = 0; t < thread_num; t++) {
+        threads.push_back(std::thread([&thread_ids, t, task_per_thread]() {
+            for (int i = 0; i < task_per_thread; i++) {
+                zTask task("id_task");
+                thread_ids[t].push_back(task.getId());
+            }
+        }));
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+    vector<uint64_t> all_ids;
+    for (const vector<uint64_t>& ids : thread_ids) {
+        all_ids.insert(all_ids.end(), ids.begin(), ids.end());
+    }
+    std::sort(all_ids.begin(), all_ids.end());
+    bool ids_unique = std::adjacent_find(all_ids.begin(), all_ids.end()) == all_ids.end();
+    LOGI("task ids: %zu created by %d threads, unique %d", all_ids.size(), thread_num, ids_unique);
+    recordTestResult(all_ids.size() == (size_t) thread_num * task_per_thread && ids_unique);
+    recordTestResult(all_ids.back() - all_ids.front() + 1 == all_ids.size());
+
+    zTask id_task("id_format");
+    recordTestResult(id_task.getTaskId() == "task_" + to_string(id_task.getId()));
+
+    // 登记表基本语义
+    zTaskRegistry registry;
+    recordTestResult(registry.add("detector", 1) && registry.add("detector", 2));
+    recordTestResult(registry.getNameCount("detector") == 2 && registry.getState(1) == zTaskRegistry::STATE_PENDING);
+    recordTestResult(!registry.add("detector", 3, true));
+    registry.markRunning("detector", 1);
+    recordTestResult(registry.getState(1) == zTaskRegistry::STATE_RUNNING && registry.getState(3) == zTaskRegistry::STATE_NONE);
+    registry.remove("detector", 1, true);
+    registry.remove("detector", 2, false);
+    recordTestResult(!registry.hasName("detector") && registry.size() == 0);
+    recordTestResult(registry.add("detector", 4, true) && registry.hasName("detector"));
+    registry.remove("detector", 4, false);
+
+    // 并发增删：每个线程用自己的名称与 ID 反复登记、执行、移除，结束后登记表为空
+    std::atomic<int> state_errors(0);
+    for (int t = 0; t < thread_num; t++) {
+        threads.push_back(std::thread([&registry, &state_errors, t]() {
+            string name = "stress_" + to_string(t % 4);
+            for (uint64_t i = 0; i < 20000; i++) {
+                uint64_t id = (uint64_t) t * 1000000 + i + 1;
+                registry.add(name, id);
+                registry.markRunning(name, id);
+                if (registry.getState(id) != zTaskRegistry::STATE_RUNNING || !registry.hasName(name)) {
+                    state_errors.fetch_add(1);
+                }
+                registry.remove(name, id, true);
+            }
+        }));
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+    recordTestResult(state_errors.load() == 0 && registry.size() == 0 && !registry.hasName("stress_0"));
+
+    // 并发唯一登记同一个名称，每一轮只有一个线程成功
+    bool unique_ok = true;
+    for (int round = 0; round < 200; round++) {
+        std::atomic<int> accepted(0);
+        std::atomic<bool> go(false);
+        for (int t = 0; t < thread_num; t++) {
+            threads.push_back(std::thread([&registry, &accepted, &go, t, round]() {
+                while (!go.load()) {
+                    std::this_thread::yield();
+                }
+                if (registry.add("unique_detector", (uint64_t) round * 100 + t + 1, true)) {
+                    accepted.fetch_add(1);
+                }
+            }));
+        }
+        go.store(true);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+        if (accepted.load() != 1 || registry.getNameCount("unique_detector") != 1) {
+            unique_ok = false;
+        }
+        for (int t = 0; t < thread_num; t++) {
+            uint64_t id = (uint64_t) round * 100 + t + 1;
+            if (registry.getState(id) == zTaskRegistry::STATE_PENDING) {
+                registry.remove("unique_detector", id, false);
+            }
+        }
+    }
+    recordTestResult(unique_ok && registry.size() == 0);
+
+    // 线程池：唯一任务在同名任务执行期间被拒绝，结束后可以再次提交；任务状态 排队 -> 执行 -> 结束
+    zThreadPool* pool = zThreadPool::getInstance();
+    std::shared_ptr<std::atomic<bool>> release = std::make_shared<std::atomic<bool>>(false);
+    std::shared_ptr<std::atomic<int>> executed = std::make_shared<std::atomic<int>>(0);
+    std::shared_ptr<TestLatch> started = std::make_shared<TestLatch>();
+    started->target = 1;
+    zTask* running_task = new zTask("unique_running", [release, executed, started]() {
+        started->arrive();
+        while (!release->load()) {
+            usleep(1000);
+        }
+        executed->fetch_add(1);
+    });
+    running_task->setUnique(true);
+    uint64_t running_id = running_task->getId();
+    recordTestResult(pool->addTask(running_task));
+    recordTestResult(started->wait(5000) && pool->getTaskState(running_id) == zTaskRegistry::STATE_RUNNING);
+    recordTestResult(pool->hasTaskName("unique_running"));
+    bool duplicate_rejected = true;
+    for (int i = 0; i < 10; i++) {
+        if (pool->addUniqueTask("unique_running", [executed]() { executed->fetch_add(1); })) {
+            duplicate_rejected = false;
+        }
+    }
+    recordTestResult(duplicate_rejected);
+    release->store(true);
+    for (int i = 0; i < 5000 && pool->hasTaskName("unique_running"); i++) {
+        usleep(1000);
+    }
+    recordTestResult(!pool->hasTaskName("unique_running") && pool->getTaskState(running_id) == zTaskRegistry::STATE_NONE);
+    recordTestResult(executed->load() == 1);
+    recordTestResult(pool->addUniqueTask("unique_running", [executed]() { executed->fetch_add(1); }));
+    for (int i = 0; i < 5000 && executed->load() < 2; i++) {
+        usleep(1000);
+    }
+    recordTestResult(executed->load() == 2);
+
+    // 基准：多个线程同时 登记 -> 查询 -> 移除，名称数为 zManager 的检测数（19）与 1000 时
+    const int name_counts[] = {19, 1000};
+    const int op_per_thread = 50000;
+    for (int name_count : name_counts) {
+        vector<string> names;
+        for (int i = 0; i < name_count; i++) {
+            names.push_back("detector_" + to_string(i));
+        }
+
+        // 名称常驻登记，模拟线程池中排队的其它任务
+        LinearTaskNames linear;
+        zTaskRegistry sharded;
+        for (int i = 0; i < name_count; i++) {
+            linear.add(names[i]);
+            sharded.add(names[i], (uint64_t) i + 1);
+        }
+
+        uint64_t start = get_time_ns();
+        for (int t = 0; t < thread_num; t++) {
+            threads.push_back(std::thread([&linear, &names, t, op_per_thread]() {
+                for (int i = 0; i < op_per_thread; i++) {
+                    const string& name = names[(i * 7 + t) % names.size()];
+                    linear.add(name);
+                    linear.has(name);
+                    linear.remove(name);
+                }
+            }));
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+        uint64_t linear_ns = get_time_ns() - start;
+
+        start = get_time_ns();
+        for (int t = 0; t < thread_num; t++) {
+            threads.push_back(std::thread([&sharded, &names, t, op_per_thread]() {
+                for (int i = 0; i < op_per_thread; i++) {
+                    const string& name = names[(i * 7 + t) % names.size()];
+                    uint64_t id = (uint64_t) (t + 1) * 10000000 + i;
+                    sharded.add(name, id);
+                    sharded.hasName(name);
+                    sharded.remove(name, id, false);
+                }
+            }));
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+        uint64_t sharded_ns = get_time_ns() - start;
+
+        size_t total_ops = (size_t) thread_num * op_per_thread;
+        LOGI("task registry %d names, %d threads: linear %.1f ns/op, sharded %.1f ns/op",
+             name_count, thread_num, (double) linear_ns / total_ops, (double) sharded_ns / total_ops);
+        recordTestResult(sharded.size() == (size_t) name_count);
+    }
+
+    LOGI("=== zTaskRegistry Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+#include "zJson.h"
+#include "zTaskMetrics.h"
+
+// 等待线程池记录完 count 个名为 name 的任务（句柄完成时统计可能还没有记录）
+static bool wait_task_metrics(zThreadPool* pool, const string& name, uint64_t count) {
+    for (int i = 0; i < 5000; i++) {
+        zThreadPoolMetrics metrics = pool->getMetrics();
+        std::map<string, zTaskMetrics::TaskSummary>::const_iterator it = metrics.tasks.find(name);
+        if (it != metrics.tasks.end() && it->second.run.count >= count) {
+            return true;
+        }
+        usleep(1000);
+    }
+    return false;
+}
+
+// 线程池统计测试：直方图分桶与百分位数，开启统计后各任务名称的等待/执行时间、工作线程统计与 JSON 导出，
+// 关闭后不再记录，以及关闭/开启统计时的任务吞吐对比（统计的开销）
+void test_pool_metrics() {
+    LOGI("=== zThreadPool Metrics Tests START ===");
+
+    // 分桶：不足 1us 为桶 0，[1us, 2us) 为桶 1，[2us, 4us) 为桶 2
+    recordTestResult(zLatencyHistogram::getBucketIndex(0) == 0 && zLatencyHistogram::getBucketIndex(999) == 0);
+    recordTestResult(zLatencyHistogram::getBucketIndex(1000) == 1 && zLatencyHistogram::getBucketIndex(1999) == 1);
+    recordTestResult(zLatencyHistogram::getBucketIndex(2000) == 2 && zLatencyHistogram::getBucketIndex(3999) == 2);
+    recordTestResult(zLatencyHistogram::getBucketIndex(UINT64_MAX) == zLatencyHistogram::BUCKET_COUNT - 1);
+
+    zLatencyHistogram histogram;
+    for (int i = 0; i < 90; i++) {
+        histogram.record(1500);
+    }
+    for (int i = 0; i < 10; i++) {
+        histogram.record(3000000);
+    }
+    zLatencyHistogram::Snapshot snapshot = histogram.getSnapshot();
+    recordTestResult(snapshot.count == 100 && snapshot.maxNs == 3000000 && snapshot.getMeanNs() == 301350);
+    recordTestResult(snapshot.getPercentileNs(50) == 2000 && snapshot.getPercentileNs(90) == 2000);
+    recordTestResult(snapshot.getPercentileNs(99) == 3000000);
+    histogram.reset();
+    recordTestResult(histogram.getSnapshot().count == 0 && histogram.getSnapshot().getPercentileNs(50) == 0);
+
+    // 开启统计后执行两类任务
+    zThreadPool* pool = zThreadPool::getInstance();
+    pool->setMetricsEnabled(true);
+    recordTestResult(pool->isMetricsEnabled());
+    vector<zTaskFuture> tasks;
+    for (int i = 0; i < 200; i++) {
+        tasks.push_back(pool->addTaskFuture("metrics_short", []() {
+            simulate_detector_work(1000);
+        }));
+    }
+    for (int i = 0; i < 10; i++) {
+        tasks.push_back(pool->addTaskFuture("metrics_long", []() {
+            usleep(2000);
+        }));
+    }
+    zTaskFuture::whenAll(tasks).wait();
+    recordTestResult(wait_task_metrics(pool, "metrics_short", 200) && wait_task_metrics(pool, "metrics_long", 10));
+
+    zThreadPoolMetrics metrics = pool->getMetrics();
+    const zTaskMetrics::TaskSummary& long_summary = metrics.tasks["metrics_long"];
+    recordTestResult(metrics.enabled && metrics.workers.size() == pool->getWorkerCount());
+    recordTestResult(long_summary.run.count == 10 && long_summary.run.getPercentileNs(50) >= 1000000);
+    recordTestResult(metrics.tasks["metrics_short"].wait.count == 200);
+    recordTestResult(metrics.total.run.count >= 210 && metrics.peakQueueDepth > 0);
+
+    uint64_t executed = 0;
+    uint64_t busy_ns = 0;
+    for (const zWorkerMetrics& worker : metrics.workers) {
+        executed += worker.executed;
+        busy_ns += worker.busyNs;
+    }
+    recordTestResult(executed >= 210 && busy_ns >= 10 * 2000000ULL);
+
+    bool timestamps_ordered = !metrics.recent.empty() && metrics.recent.size() <= zTaskMetrics::RECENT_CAPACITY;
+    for (const zTaskMetrics::TaskRecord& record : metrics.recent) {
+        if (record.enqueueNs > record.startNs || record.startNs > record.finishNs) {
+            timestamps_ordered = false;
+        }
+    }
+    recordTestResult(timestamps_ordered);
+
+    string json_text = pool->dumpMetricsJson();
+    LOGI("metrics json: %zu bytes", json_text.size());
+    bool json_ok = false;
+    try {
+        zJson json = zJson::parse(json_text.c_str());
+        json_ok = json["enabled"] == true
+                  && json["tasks"].contains("metrics_long")
+                  && json["tasks"]["metrics_long"]["run"]["count"] == 10
+                  && json["workers"].size() == pool->getWorkerCount()
+                  && json["recent"].is_array();
+    } catch (zJson::exception& e) {
+        LOGE("metrics json: %s", e.what());
+    }
+    recordTestResult(json_ok);
+
+    // 关闭后不再记录
+    pool->setMetricsEnabled(false);
+    pool->addTaskFuture("metrics_disabled", []() {}).wait();
+    usleep(10000);
+    recordTestResult(pool->getMetrics().tasks.count("metrics_disabled") == 0);
+
+    // 基准：关闭与开启统计时 10 万个小任务的吞吐
+    const int task_num = 100000;
+    const int round_num = 3;
+    uint64_t best_ns[2] = {UINT64_MAX, UINT64_MAX};
+    for (int round = 0; round < round_num; round++) {
+        for (int enabled = 0; enabled < 2; enabled++) {
+            pool->setMetricsEnabled(enabled != 0);
+            std::shared_ptr<TestLatch> latch = std::make_shared<TestLatch>();
+            latch->target = task_num;
+            uint64_t start = get_time_ns();
+            for (int i = 0; i < task_num; i++) {
+                pool->addTask("metrics_bench", [latch]() {
+                    latch->arrive();
+                });
+            }
+            latch->wait(60000);
+            uint64_t elapsed_ns = get_time_ns() - start;
+            best_ns[enabled] = elapsed_ns < best_ns[enabled] ? elapsed_ns : best_ns[enabled];
+        }
+    }
+    pool->setMetricsEnabled(false);
+    LOGI("metrics overhead (%d tasks, best of %d): disabled %.1f ns/task, enabled %.1f ns/task (%+.1f%%)",
+         task_num, round_num, (double) best_ns[0] / task_num, (double) best_ns[1] / task_num,
+         (best_ns[1] - (double) best_ns[0]) * 100.0 / best_ns[0]);
+
+    // 单次直方图记录的开销
+    const int record_num = 1000000;
+    uint64_t start = get_time_ns();
+    for (int i = 0; i < record_num; i++) {
+        histogram.record((uint64_t) i * 37);
+    }
+    uint64_t record_ns = get_time_ns() - start;
+    LOGI("histogram record: %.1f ns/op", (double) record_ns / record_num);
+    recordTestResult(histogram.getSnapshot().count == (uint64_t) record_num);
+
+    LOGI("=== zThreadPool Metrics Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+#include "zTriggerScheduler.h"
+
+// 记录调度器派发的检测
+struct DispatchLog {
+    std::mutex mutex;
+    map<string, int> counts;
+
+    int get(const string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return counts[name];
+    }
+
+    // 等待 name 的派发次数达到 count
+    bool waitFor(const string& name, int count, int timeout_ms = 3000) {
+        for (int i = 0; i < timeout_ms; i++) {
+            if (get(name) >= count) {
+                return true;
+            }
+            usleep(1000);
+        }
+        return false;
+    }
+};
+
+static uint32_t get_last_reasons(zTriggerScheduler& scheduler, const string& name) {
+    zTriggerScheduler::DetectorStats stats;
+    return scheduler.getStats(name, stats) ? stats.lastReasons : 0;
+}
+
+static uint64_t get_process_cpu_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// 按变化触发的调度测试：模拟文件、网络、属性、maps 变化与最长间隔、最小间隔合并、忙碌推迟，
+// 以及空闲时与旧的固定间隔轮询（每 10 秒执行全部检测）的每小时 CPU 时间对比
+void test_trigger_scheduler() {
+    LOGI("=== zTriggerScheduler Tests START ===");
+
+    string dir = get_test_tmp_dir() + "/trigger_test";
+    runShell("rm -rf '" + dir + "'");
+    mkdir(dir.c_str(), 0700);
+    string watched_path = dir + "/watched.txt";
+
+    std::shared_ptr<std::atomic<uint32_t>> property_serial = std::make_shared<std::atomic<uint32_t>>(1);
+    std::shared_ptr<std::atomic<uint64_t>> maps_fingerprint = std::make_shared<std::atomic<uint64_t>>(1);
+    std::shared_ptr<std::atomic<bool>> busy = std::make_shared<std::atomic<bool>>(false);
+    DispatchLog log;
+
+    zTriggerScheduler scheduler;
+    zTriggerScheduler::Triggers file_triggers;
+    file_triggers.paths.push_back(watched_path);
+    zTriggerScheduler::Triggers network_triggers;
+    network_triggers.network = true;
+    zTriggerScheduler::Triggers property_triggers;
+    property_triggers.property = true;
+    zTriggerScheduler::Triggers maps_triggers;
+    maps_triggers.maps = true;
+    zTriggerScheduler::Triggers stale_triggers;
+    stale_triggers.maxStaleMs = 300;
+    zTriggerScheduler::Triggers coalesce_triggers;
+    coalesce_triggers.minIntervalMs = 300;
+    zTriggerScheduler::Triggers busy_triggers;
+    recordTestResult(scheduler.addDetector("file_detector", file_triggers));
+    recordTestResult(scheduler.addDetector("network_detector", network_triggers));
+    recordTestResult(scheduler.addDetector("property_detector", property_triggers));
+    recordTestResult(scheduler.addDetector("maps_detector", maps_triggers));
+    recordTestResult(scheduler.addDetector("stale_detector", stale_triggers));
+    recordTestResult(scheduler.addDetector("coalesce_detector", coalesce_triggers));
+    recordTestResult(scheduler.addDetector("busy_detector", busy_triggers));
+    recordTestResult(!scheduler.addDetector("busy_detector", busy_triggers));
+
+    scheduler.setPollIntervalMs(20);
+    scheduler.setMapsPollIntervalMs(20);
+    scheduler.setPropertyProbe([property_serial]() { return property_serial->load(); });
+    scheduler.setMapsProbe([maps_fingerprint]() { return maps_fingerprint->load(); });
+    scheduler.setBusyProbe([busy](const string& name) { return name == "busy_detector" && busy->load(); });
+    scheduler.setDispatcher([&log](const vector<string>& names) {
+        std::lock_guard<std::mutex> lock(log.mutex);
+        for (const string& name : names) {
+            log.counts[name]++;
+        }
+    });
+
+    std::thread loop([&scheduler]() { scheduler.run(); });
+
+    // 启动后每个检测执行一次
+    bool initial_ok = true;
+    const char* names[] = {"file_detector", "network_detector", "property_detector", "maps_detector",
+                           "stale_detector", "coalesce_detector", "busy_detector"};
+    for (const char* name : names) {
+        initial_ok = log.waitFor(name, 1) && initial_ok;
+    }
+    recordTestResult(initial_ok && get_last_reasons(scheduler, "file_detector") == zTriggerScheduler::TRIGGER_INITIAL);
+    recordTestResult(!scheduler.run());
+
+    // 文件：等待的文件被创建、修改时触发，同目录的其它文件不触发
+    usleep(50000);
+    write_test_file(dir + "/other.txt", vector<uint8_t>(4, 'x'));
+    usleep(100000);
+    recordTestResult(log.get("file_detector") == 1);
+    write_test_file(watched_path, vector<uint8_t>(4, 'a'));
+    recordTestResult(log.waitFor("file_detector", 2)
+                     && get_last_reasons(scheduler, "file_detector") == zTriggerScheduler::TRIGGER_FILE);
+    int file_runs = log.get("file_detector");
+    usleep(50000);
+    write_test_file(watched_path, vector<uint8_t>(8, 'b'));
+    recordTestResult(log.waitFor("file_detector", file_runs + 1));
+
+    // 网络、属性、maps：只触发关心该变化的检测
+    scheduler.notify(zTriggerScheduler::TRIGGER_NETWORK);
+    recordTestResult(log.waitFor("network_detector", 2)
+                     && get_last_reasons(scheduler, "network_detector") == zTriggerScheduler::TRIGGER_NETWORK);
+    property_serial->fetch_add(1);
+    recordTestResult(log.waitFor("property_detector", 2)
+                     && get_last_reasons(scheduler, "property_detector") == zTriggerScheduler::TRIGGER_PROPERTY);
+    maps_fingerprint->fetch_add(1);
+    recordTestResult(log.waitFor("maps_detector", 2)
+                     && get_last_reasons(scheduler, "maps_detector") == zTriggerScheduler::TRIGGER_MAPS);
+    recordTestResult(log.get("network_detector") == 2 && log.get("property_detector") == 2 && log.get("busy_detector") == 1);
+
+    // 最长间隔：没有变化也会定期执行；其它检测没有变化时不执行
+    int stale_runs = log.get("stale_detector");
+    int network_runs = log.get("network_detector");
+    recordTestResult(log.waitFor("stale_detector", stale_runs + 1, 1000)
+                     && get_last_reasons(scheduler, "stale_detector") == zTriggerScheduler::TRIGGER_STALE);
+    recordTestResult(log.get("network_detector") == network_runs);
+
+    // 最小间隔：连续触发合并为一次
+    usleep(350000);
+    int coalesce_runs = log.get("coalesce_detector");
+    scheduler.trigger("coalesce_detector");
+    recordTestResult(log.waitFor("coalesce_detector", coalesce_runs + 1));
+    for (int i = 0; i < 5; i++) {
+        scheduler.trigger("coalesce_detector");
+        usleep(10000);
+    }
+    recordTestResult(log.get("coalesce_detector") == coalesce_runs + 1);
+    recordTestResult(log.waitFor("coalesce_detector", coalesce_runs + 2, 1000));
+    usleep(400000);
+    recordTestResult(log.get("coalesce_detector") == coalesce_runs + 2);
+
+    // 忙碌推迟：仍在执行时不派发，结束后补上
+    busy->store(true);
+    scheduler.trigger("busy_detector");
+    usleep(100000);
+    recordTestResult(log.get("busy_detector") == 1);
+    busy->store(false);
+    recordTestResult(log.waitFor("busy_detector", 2));
+
+    scheduler.stop();
+    loop.join();
+    recordTestResult(!scheduler.isRunning());
+    runShell("rm -rf '" + dir + "'");
+
+    // 基准：19 个检测，时间按 1/200 缩放（10 秒的轮询间隔为 50ms），统计空闲时（没有变化）每小时的 CPU 时间
+    // 旧的方式每个间隔执行全部检测；新的方式只在最长间隔到期时执行，属性与 maps 的检查也按同样比例缩放
+    const int detector_num = 19;
+    const uint32_t detector_work = 200000;
+    const uint64_t scale = 200;
+    const uint64_t window_ms = 2000;
+    double simulated_hours = window_ms * scale / 1000.0 / 3600.0;
+
+    uint64_t cpu_start = get_process_cpu_ns();
+    uint64_t start = get_time_ns();
+    while (get_time_ns() - start < window_ms * 1000000ULL) {
+        for (int i = 0; i < detector_num; i++) {
+            simulate_detector_work(detector_work);
+        }
+        usleep(10 * 1000000 / scale);
+    }
+    uint64_t polling_cpu_ns = get_process_cpu_ns() - cpu_start;
+
+    zTriggerScheduler idle_scheduler;
+    // 与 zManager 中的最长间隔分布相同：1 分钟 4 个、2 分钟 2 个、5 分钟 5 个、10 分钟 3 个、30 分钟 4 个、60 分钟 1 个
+    const uint64_t stale_minutes[detector_num] = {1, 1, 1, 1, 2, 2, 5, 5, 5, 5, 5, 10, 10, 10, 30, 30, 30, 30, 60};
+    for (int i = 0; i < detector_num; i++) {
+        zTriggerScheduler::Triggers triggers;
+        triggers.maxStaleMs = stale_minutes[i] * 60 * 1000 / scale;
+        triggers.property = i % 3 == 0;
+        triggers.maps = i % 4 == 0;
+        idle_scheduler.addDetector("idle_" + to_string(i), triggers);
+    }
+    idle_scheduler.setPollIntervalMs(1000 / scale);
+    idle_scheduler.setMapsPollIntervalMs(5000 / scale);
+    std::atomic<int> idle_runs(0);
+    idle_scheduler.setDispatcher([&idle_runs, detector_work](const vector<string>& names) {
+        for (size_t i = 0; i < names.size(); i++) {
+            simulate_detector_work(detector_work);
+        }
+        idle_runs += names.size();
+    });
+    cpu_start = get_process_cpu_ns();
+    std::thread idle_loop([&idle_scheduler]() { idle_scheduler.run(); });
+    usleep(window_ms * 1000);
+    idle_scheduler.stop();
+    idle_loop.join();
+    uint64_t trigger_cpu_ns = get_process_cpu_ns() - cpu_start;
+
+    LOGI("idle cpu per hour (%d detectors, %.2f simulated hours): fixed interval %.1f s, change-driven %.1f s (%d runs)",
+         detector_num, simulated_hours, polling_cpu_ns / 1e9 / simulated_hours, trigger_cpu_ns / 1e9 / simulated_hours,
+         idle_runs.load());
+
+    LOGI("=== zTriggerScheduler Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+
+// 自适应间隔与 CPU 预算的模拟测试：检测不实际消耗 CPU，由 dispatcher 按设定的消耗调用 reportResult
+void test_detector_budget() {
+    LOGI("=== zTriggerScheduler Budget Tests START ===");
+
+    // 自适应间隔：结果不变时最长间隔 50 -> 100 -> 200 -> 400（上限），结果变化后恢复为 50
+    zTriggerScheduler backoff_scheduler;
+    zTriggerScheduler::Triggers backoff_triggers;
+    backoff_triggers.maxStaleMs = 50;
+    backoff_triggers.maxBackoffMs = 400;
+    zTriggerScheduler::Triggers fixed_triggers;
+    fixed_triggers.maxStaleMs = 50;
+    recordTestResult(backoff_scheduler.addDetector("stable_detector", backoff_triggers));
+    recordTestResult(backoff_scheduler.addDetector("fixed_detector", fixed_triggers));
+    backoff_scheduler.setPollIntervalMs(10);
+
+    std::atomic<bool> result_changed(false);
+    std::atomic<int> stable_reports(0);
+    DispatchLog log;
+    backoff_scheduler.setDispatcher([&](const vector<string>& names) {
+        for (const string& name : names) {
+            // 第一次执行总是变化（之前没有结果）
+            bool changed = stable_reports == 0 || result_changed.load();
+            if (name == "stable_detector") {
+                stable_reports++;
+            }
+            backoff_scheduler.reportResult(name, changed, 1000000);
+        }
+        std::lock_guard<std::mutex> lock(log.mutex);
+        for (const string& name : names) {
+            log.counts[name]++;
+        }
+    });
+
+    std::thread backoff_loop([&backoff_scheduler]() { backoff_scheduler.run(); });
+    const uint64_t expected_intervals[] = {50, 100, 200, 400, 400};
+    bool backoff_ok = true;
+    uint64_t last_run_ns = 0;
+    uint64_t last_gap_ns = 0;
+    for (int i = 0; i < 5; i++) {
+        backoff_ok = log.waitFor("stable_detector", i + 1) && backoff_ok;
+        zTriggerScheduler::DetectorStats stats;
+        backoff_scheduler.getStats("stable_detector", stats);
+        if (stats.effectiveStaleMs != expected_intervals[i]) {
+            LOGE("backoff run %d: interval %llu, expected %llu", i + 1,
+                 (unsigned long long) stats.effectiveStaleMs, (unsigned long long) expected_intervals[i]);
+            backoff_ok = false;
+        }
+        if (stats.nextDueNs != stats.lastRunNs + stats.effectiveStaleMs * 1000000ULL) {
+            backoff_ok = false;
+        }
+        last_gap_ns = last_run_ns ? stats.lastRunNs - last_run_ns : 0;
+        last_run_ns = stats.lastRunNs;
+    }
+    recordTestResult(backoff_ok);
+    // 第 4、5 次之间按 400ms 间隔
+    recordTestResult(last_gap_ns >= 380 * 1000000ULL);
+
+    // 没有设置上限的检测保持固定间隔，执行次数明显更多
+    zTriggerScheduler::DetectorStats fixed_stats;
+    backoff_scheduler.getStats("fixed_detector", fixed_stats);
+    recordTestResult(fixed_stats.effectiveStaleMs == 50 && fixed_stats.runs > 10 && fixed_stats.stableRuns > 10);
+
+    // 结果变化后恢复
+    result_changed.store(true);
+    backoff_scheduler.trigger("stable_detector");
+    recordTestResult(log.waitFor("stable_detector", 6));
+    zTriggerScheduler::DetectorStats changed_stats;
+    backoff_scheduler.getStats("stable_detector", changed_stats);
+    recordTestResult(changed_stats.effectiveStaleMs == 50 && changed_stats.stableRuns == 0 && changed_stats.changes >= 2);
+    backoff_scheduler.stop();
+    backoff_loop.join();
+
+    // 执行失败不算作结果不变：拉长的间隔恢复，不计入变化次数，失败前的消耗计入预算
+    zTriggerScheduler failure_scheduler;
+    failure_scheduler.setCpuBudget(100 * 1000000ULL, 1000);
+    recordTestResult(failure_scheduler.addDetector("failing_detector", backoff_triggers));
+    failure_scheduler.reportResult("failing_detector", true, 1000000);
+    failure_scheduler.reportResult("failing_detector", false, 1000000);
+    failure_scheduler.reportResult("failing_detector", false, 1000000);
+    zTriggerScheduler::DetectorStats before_failure;
+    failure_scheduler.getStats("failing_detector", before_failure);
+    failure_scheduler.reportFailure("failing_detector", 2000000);
+    zTriggerScheduler::DetectorStats after_failure;
+    failure_scheduler.getStats("failing_detector", after_failure);
+    recordTestResult(before_failure.effectiveStaleMs == 200 && before_failure.stableRuns == 2);
+    recordTestResult(after_failure.effectiveStaleMs == 50 && after_failure.stableRuns == 0 &&
+                     after_failure.failures == 1 && after_failure.changes == before_failure.changes &&
+                     after_failure.costNs == before_failure.costNs);
+    recordTestResult(failure_scheduler.getBudgetUsage().usedNs == 5000000);
+
+    // CPU 预算：三个检测都希望每 50ms 执行一次，消耗分别为 5、10、80ms，预算为每 1000ms 100ms
+    const uint64_t ms = 1000000ULL;
+    const uint64_t budget_ns = 100 * ms;
+    const uint64_t budget_window_ms = 1000;
+    map<string, uint64_t> costs = {{"cheap_a", 5 * ms}, {"cheap_b", 10 * ms}, {"expensive", 80 * ms}};
+
+    zTriggerScheduler budget_scheduler;
+    for (const auto& item : costs) {
+        zTriggerScheduler::Triggers triggers;
+        triggers.maxStaleMs = 50;
+        budget_scheduler.addDetector(item.first, triggers);
+    }
+    budget_scheduler.setPollIntervalMs(10);
+    budget_scheduler.setCpuBudget(budget_ns, budget_window_ms);
+
+    std::mutex spent_mutex;
+    vector<pair<uint64_t, uint64_t>> spent;     // 派发时间，消耗
+    map<string, int> budget_runs;
+    budget_scheduler.setDispatcher([&](const vector<string>& names) {
+        uint64_t now = zTask::getMonotonicNs();
+        for (const string& name : names) {
+            {
+                std::lock_guard<std::mutex> lock(spent_mutex);
+                spent.push_back(pair<uint64_t, uint64_t>(now, costs[name]));
+                budget_runs[name]++;
+            }
+            budget_scheduler.reportResult(name, false, costs[name]);
+        }
+    });
+
+    const uint64_t simulate_ms = 3000;
+    std::thread budget_loop([&budget_scheduler]() { budget_scheduler.run(); });
+    bool usage_ok = true;
+    for (uint64_t elapsed = 0; elapsed < simulate_ms; elapsed += 20) {
+        zTriggerScheduler::BudgetUsage usage = budget_scheduler.getBudgetUsage();
+        if (usage.usedNs + usage.inFlightNs > usage.budgetNs) {
+            usage_ok = false;
+        }
+        usleep(20000);
+    }
+    budget_scheduler.stop();
+    budget_loop.join();
+    recordTestResult(usage_ok);
+
+    // 任意一个窗口内的消耗不超过预算
+    uint64_t max_window_ns = 0;
+    for (size_t i = 0; i < spent.size(); i++) {
+        uint64_t window_ns = 0;
+        for (size_t j = i; j < spent.size() && spent[j].first - spent[i].first < budget_window_ms * ms; j++) {
+            window_ns += spent[j].second;
+        }
+        max_window_ns = window_ns > max_window_ns ? window_ns : max_window_ns;
+    }
+    recordTestResult(max_window_ns <= budget_ns);
+
+    // 推迟的是最贵的检测，但它不会一直等下去
+    zTriggerScheduler::DetectorStats expensive_stats;
+    zTriggerScheduler::DetectorStats cheap_stats;
+    budget_scheduler.getStats("expensive", expensive_stats);
+    budget_scheduler.getStats("cheap_a", cheap_stats);
+    zTriggerScheduler::BudgetUsage usage = budget_scheduler.getBudgetUsage();
+    recordTestResult(expensive_stats.deferrals > 0 && usage.deferrals >= expensive_stats.deferrals);
+    recordTestResult(expensive_stats.costNs == 80 * ms && cheap_stats.costNs == 5 * ms);
+    recordTestResult(budget_runs["cheap_a"] > budget_runs["expensive"] && budget_runs["expensive"] >= 2);
+
+    std::map<string, zTriggerScheduler::DetectorStats> schedule = budget_scheduler.getSchedule();
+    recordTestResult(schedule.size() == 3 && schedule["cheap_b"].runs == (uint64_t) budget_runs["cheap_b"]);
+
+    uint64_t total_ns = 0;
+    for (const auto& item : spent) {
+        total_ns += item.second;
+    }
+    // 没有预算时每个检测每 50ms 执行一次
+    uint64_t unlimited_ns = (5 + 10 + 80) * ms * (simulate_ms / 50);
+    LOGI("budget simulation (%llu ms): runs cheap_a %d cheap_b %d expensive %d, spent %.1f ms (unlimited %.1f ms), "
+         "max per window %.1f ms, budget %.1f ms, deferrals %llu",
+         (unsigned long long) simulate_ms, budget_runs["cheap_a"], budget_runs["cheap_b"], budget_runs["expensive"],
+         total_ns / 1e6, unlimited_ns / 1e6, max_window_ns / 1e6, budget_ns / 1e6, (unsigned long long) usage.deferrals);
+
+    LOGI("=== zTriggerScheduler Budget Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+
+#include <shared_mutex>
+#include "zInfoDiff.h"
+
+// 生成 item_num 个检测项目，每个项目有 risk、explain 两个属性
+static zInfoDiff::Info make_test_info(int item_num, const string& prefix) {
+    zInfoDiff::Info info;
+    for (int i = 0; i < item_num; i++) {
+        map<string, string>& item = info[prefix + to_string(i)];
+        item["risk"] = i % 7 == 0 ? "error" : "safe";
+        item["explain"] = "detail of " + prefix + to_string(i) + " /data/app/com.example.overt/base.apk";
+    }
+    return info;
+}
+
+// 检测结果增量差异测试：新增、删除、修改项目的识别，apply 还原，JSON 格式，
+// 以及 19 个检测 × 200 个项目时整体替换并发送完整 JSON 与增量更新的开销对比
+void test_info_diff() {
+    LOGI("=== zInfoDiff Tests START ===");
+
+    zInfoDiff::Info before;
+    before["a"]["risk"] = "error";
+    before["b"]["risk"] = "safe";
+    before["b"]["explain"] = "old";
+    before["c"]["risk"] = "safe";
+    zInfoDiff::Info after = before;
+    recordTestResult(zInfoDiff::compute(before, after).empty());
+
+    after.erase("a");
+    after["b"]["explain"] = "new";
+    after["d"]["risk"] = "warn";
+    zInfoDiff diff = zInfoDiff::compute(before, after);
+    recordTestResult(diff.size() == 3);
+    recordTestResult(diff.removed.size() == 1 && diff.removed[0] == "a");
+    recordTestResult(diff.added.size() == 1 && diff.added["d"]["risk"] == "warn");
+    recordTestResult(diff.changed.size() == 1 && diff.changed["b"]["explain"] == "new" && diff.changed["b"]["risk"] == "safe");
+    zInfoDiff::Info applied = before;
+    diff.apply(applied);
+    recordTestResult(applied == after);
+
+    // 项目内删除属性也算修改
+    zInfoDiff::Info fewer_attrs = before;
+    fewer_attrs["b"].erase("explain");
+    zInfoDiff attr_diff = zInfoDiff::compute(before, fewer_attrs);
+    recordTestResult(attr_diff.size() == 1 && attr_diff.changed.size() == 1 && attr_diff.changed["b"].size() == 1);
+
+    // 从空到有、从有到空
+    zInfoDiff::Info empty_info;
+    zInfoDiff from_empty = zInfoDiff::compute(empty_info, before);
+    zInfoDiff to_empty = zInfoDiff::compute(before, empty_info);
+    recordTestResult(from_empty.added.size() == 3 && from_empty.changed.empty() && from_empty.removed.empty());
+    recordTestResult(to_empty.removed.size() == 3 && to_empty.added.empty() && to_empty.changed.empty());
+
+    // JSON 格式
+    zJson diff_json = zJson::parse(diff.toJson().c_str());
+    recordTestResult(diff_json["removed"].size() == 1 && diff_json["removed"][0] == "a");
+    recordTestResult(diff_json["added"]["d"]["risk"] == "warn" && diff_json["changed"]["b"]["explain"] == "new");
+    zJson empty_json = zJson::parse(zInfoDiff().toJson().c_str());
+    recordTestResult(empty_json["added"].empty() && empty_json["changed"].empty() && empty_json["removed"].empty());
+    // 直接写出的 JSON 与原来经过 zJson DOM 的结果逐字节相同
+    auto dom_diff_json = [](const zInfoDiff& value) {
+        zJson json;
+        json["added"] = zJson::object();
+        json["changed"] = zJson::object();
+        json["removed"] = zJson::array();
+        for (auto it = value.added.begin(); it != value.added.end(); ++it) {
+            json["added"][it->first] = it->second;
+        }
+        for (auto it = value.changed.begin(); it != value.changed.end(); ++it) {
+            json["changed"][it->first] = it->second;
+        }
+        for (const string& name : value.removed) {
+            json["removed"].push_back(name);
+        }
+        return json.dump();
+    };
+    recordTestResult(diff.toJson() == dom_diff_json(diff) && zInfoDiff().toJson() == dom_diff_json(zInfoDiff()));
+    recordTestResult(to_empty.toJson() == dom_diff_json(to_empty) && from_empty.toJson() == dom_diff_json(from_empty));
+
+    // 随机修改：apply 之后与修改后的结果相同
+    bool random_ok = true;
+    unsigned int seed = 12345;
+    zInfoDiff::Info current = make_test_info(200, "item_");
+    for (int round = 0; round < 50; round++) {
+        zInfoDiff::Info next = current;
+        for (int i = 0; i < 10; i++) {
+            string name = "item_" + to_string(rand_r(&seed) % 260);
+            switch (rand_r(&seed) % 3) {
+                case 0:
+                    next.erase(name);
+                    break;
+                case 1:
+                    next[name]["risk"] = rand_r(&seed) % 2 ? "error" : "warn";
+                    break;
+                default:
+                    next[name]["explain"] = "round " + to_string(round);
+                    break;
+            }
+        }
+        zInfoDiff round_diff = zInfoDiff::compute(current, next);
+        zInfoDiff::Info patched = current;
+        round_diff.apply(patched);
+        random_ok = random_ok && patched == next && round_diff.empty() == (current == next);
+        current = next;
+    }
+    recordTestResult(random_ok);
+
+    // 基准：19 个检测，每个 200 个项目，每轮每个检测更新一次
+    // 整体替换：写锁内替换，再在读锁内复制一份完整结果序列化为 JSON（原来的 update_device_info + notice_java）
+    // 增量更新：写锁内计算差异，有变化时才替换并只序列化差异
+    const int detector_num = 19;
+    const int item_num = 200;
+    const int rounds = 20;
+    vector<zInfoDiff::Info> results;
+    for (int i = 0; i < detector_num; i++) {
+        results.push_back(make_test_info(item_num, "detector_" + to_string(i) + "_item_"));
+    }
+    std::shared_mutex store_mutex;
+
+    // changed_items 为每轮每个检测变化的项目数
+    auto run_full = [&](int changed_items, size_t& bytes) {
+        map<string, zInfoDiff::Info> store;
+        vector<zInfoDiff::Info> inputs = results;
+        bytes = 0;
+        uint64_t start = get_time_ns();
+        for (int round = 0; round < rounds; round++) {
+            for (int i = 0; i < detector_num; i++) {
+                string key = "detector_" + to_string(i);
+                for (int c = 0; c < changed_items; c++) {
+                    inputs[i][key + "_item_" + to_string(c)]["explain"] = "round " + to_string(round);
+                }
+                {
+                    std::unique_lock<std::shared_mutex> lock(store_mutex);
+                    store[key] = inputs[i];
+                }
+                zInfoDiff::Info card;
+                {
+                    std::shared_lock<std::shared_mutex> lock(store_mutex);
+                    card = store[key];
+                }
+                zJson card_json = card;
+                bytes += card_json.dump().size();
+            }
+        }
+        return get_time_ns() - start;
+    };
+    auto run_delta = [&](int changed_items, size_t& bytes, int& notices) {
+        map<string, zInfoDiff::Info> store;
+        vector<zInfoDiff::Info> inputs = results;
+        bytes = 0;
+        notices = 0;
+        uint64_t start = get_time_ns();
+        for (int round = 0; round < rounds; round++) {
+            for (int i = 0; i < detector_num; i++) {
+                string key = "detector_" + to_string(i);
+                for (int c = 0; c < changed_items; c++) {
+                    inputs[i][key + "_item_" + to_string(c)]["explain"] = "round " + to_string(round);
+                }
+                zInfoDiff round_diff;
+                {
+                    std::unique_lock<std::shared_mutex> lock(store_mutex);
+                    zInfoDiff::Info& current_info = store[key];
+                    round_diff = zInfoDiff::compute(current_info, inputs[i]);
+                    if (!round_diff.empty()) {
+                        current_info = inputs[i];
+                    }
+                }
+                // 第一轮的差异是完整结果，之后没有变化的检测不发送
+                if (!round_diff.empty()) {
+                    bytes += round_diff.toJson().size();
+                    notices++;
+                }
+            }
+        }
+        return get_time_ns() - start;
+    };
+
+    const int changed_cases[] = {0, 1, 20};
+    bool delta_faster = true;
+    for (int changed_items : changed_cases) {
+        size_t full_bytes = 0;
+        size_t delta_bytes = 0;
+        int notices = 0;
+        uint64_t full_ns = run_full(changed_items, full_bytes);
+        uint64_t delta_ns = run_delta(changed_items, delta_bytes, notices);
+        LOGI("info update %d detectors x %d items, %d changed per round: full %.2f ms/round (%zu bytes), "
+             "delta %.2f ms/round (%zu bytes, %d notices)", detector_num, item_num, changed_items,
+             full_ns / 1e6 / rounds, full_bytes / rounds, delta_ns / 1e6 / rounds, delta_bytes / rounds, notices);
+        delta_faster = delta_faster && delta_ns < full_ns && delta_bytes < full_bytes;
+        if (changed_items == 0) {
+            // 只有第一轮发送
+            recordTestResult(notices == detector_num);
+        }
+    }
+    recordTestResult(delta_faster);
+
+    LOGI("=== zInfoDiff Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+
+#include "zInfoStore.h"
+
+// 设备信息写时复制快照测试：版本号、未变化类别的共享、旧快照不受更新影响，
+// 读写并发时读到的每个类别结果完整一致，以及与读写锁 + 复制的读取吞吐量对比
+void test_info_store() {
+    LOGI("=== zInfoStore Tests START ===");
+
+    zInfoStore store;
+    zInfoStore::SnapshotPtr empty_snapshot = store.getSnapshot();
+    recordTestResult(empty_snapshot != nullptr && empty_snapshot->empty());
+
+    zInfoDiff::Info info_a = make_test_info(3, "a_");
+    zInfoDiff::Info info_b = make_test_info(3, "b_");
+    zInfoDiff diff;
+    uint64_t version = 0;
+    recordTestResult(store.update("a", info_a, &diff, &version) && version == 1 && diff.added.size() == 3);
+    recordTestResult(store.update("b", info_b, nullptr, &version) && version == 1);
+    recordTestResult(!store.update("a", info_a, &diff, &version) && version == 1 && diff.empty());
+
+    // 更新 b 之后 a 的结果与上一个快照共享，上一个快照中的 b 不变
+    zInfoStore::SnapshotPtr before = store.getSnapshot();
+    info_b["b_1"]["risk"] = "error";
+    recordTestResult(store.update("b", info_b, &diff, &version) && version == 2 && diff.changed.size() == 1);
+    zInfoStore::SnapshotPtr after = store.getSnapshot();
+    recordTestResult(before->find("a")->second.info == after->find("a")->second.info);
+    recordTestResult(before->find("b")->second.info->find("b_1")->second.find("risk")->second == "safe");
+    recordTestResult(after->find("b")->second.version == 2 && *after->find("b")->second.info == info_b);
+    recordTestResult(empty_snapshot->empty());
+
+    // clear 之后版本号继续递增
+    store.clear();
+    recordTestResult(store.size() == 0 && store.get("a") == nullptr && before->size() == 2);
+    store.set("a", info_a);
+    store.get("a", &version);
+    recordTestResult(version == 2);
+
+    // 空结果第一次写入也算变化：类别出现在快照中并有版本号，再次写入空结果才没有变化
+    recordTestResult(store.update("empty", zInfoDiff::Info(), &diff, &version) && version == 1 && diff.empty());
+    recordTestResult(store.get("empty") != nullptr && store.get("empty")->empty());
+    recordTestResult(!store.update("empty", zInfoDiff::Info(), &diff, &version) && version == 1);
+
+    // 并发：每个类别的所有项目在同一轮写入相同的 explain，版本号 v 对应第 v 轮，
+    // 读到的结果必须全部是同一轮，且同一类别的版本号不回退
+    const int detector_num = 19;
+    const int item_num = 50;
+    const int reader_num = 4;
+    zInfoStore concurrent_store;
+    std::atomic<bool> stop(false);
+    std::atomic<bool> consistent(true);
+    std::atomic<uint64_t> snapshot_reads(0);
+    vector<std::thread> readers;
+    for (int r = 0; r < reader_num; r++) {
+        readers.push_back(std::thread([&, r]() {
+            vector<uint64_t> last_versions((size_t) detector_num, (uint64_t) 0);
+            uint64_t reads = 0;
+            while (!stop.load()) {
+                zInfoStore::SnapshotPtr snapshot = concurrent_store.getSnapshot();
+                for (int i = 0; i < detector_num; i++) {
+                    zInfoStore::Snapshot::const_iterator it = snapshot->find("detector_" + to_string(i));
+                    if (it == snapshot->end()) {
+                        continue;
+                    }
+                    uint64_t entry_version = it->second.version;
+                    string expected = "round " + to_string(entry_version);
+                    bool ok = entry_version >= last_versions[i] && it->second.info->size() == (size_t) item_num;
+                    for (auto item = it->second.info->begin(); ok && item != it->second.info->end(); ++item) {
+                        ok = item->second.find("explain")->second == expected;
+                    }
+                    if (!ok) {
+                        consistent.store(false);
+                    }
+                    last_versions[i] = entry_version;
+                }
+                reads++;
+            }
+            snapshot_reads.fetch_add(reads);
+        }));
+    }
+    const int write_rounds = 200;
+    for (int round = 1; round <= write_rounds; round++) {
+        for (int i = 0; i < detector_num; i++) {
+            zInfoDiff::Info info = make_test_info(item_num, "item_");
+            for (auto item = info.begin(); item != info.end(); ++item) {
+                item->second["explain"] = "round " + to_string(round);
+            }
+            concurrent_store.update("detector_" + to_string(i), info);
+        }
+    }
+    stop.store(true);
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    recordTestResult(consistent.load());
+    recordTestResult(concurrent_store.getGeneration() == (uint64_t) write_rounds * detector_num);
+    LOGI("info store concurrency: %d writes, %llu snapshot reads", write_rounds * detector_num,
+         (unsigned long long) snapshot_reads.load());
+
+    // 基准：4 个读线程各读取 read_num 次（原来的 get_info：读锁内复制；快照：取得引用），
+    // 同时 1 个写线程每 1ms 更新一个类别，比较读取吞吐量
+    const int item_per_detector = 200;
+    const int read_num = 5000;
+    vector<zInfoDiff::Info> results;
+    for (int i = 0; i < detector_num; i++) {
+        results.push_back(make_test_info(item_per_detector, "detector_" + to_string(i) + "_item_"));
+    }
+
+    auto run_bench = [&](bool use_snapshot, uint64_t& writes) {
+        map<string, zInfoDiff::Info> locked_store;
+        std::shared_mutex locked_mutex;
+        zInfoStore snapshot_store;
+        for (int i = 0; i < detector_num; i++) {
+            locked_store["detector_" + to_string(i)] = results[i];
+            snapshot_store.set("detector_" + to_string(i), results[i]);
+        }
+        std::atomic<bool> readers_done(false);
+        std::atomic<uint64_t> total_items(0);
+        writes = 0;
+        std::thread writer([&]() {
+            while (!readers_done.load()) {
+                int i = (int) (writes % detector_num);
+                string key = "detector_" + to_string(i);
+                zInfoDiff::Info info = results[i];
+                info[key + "_item_0"]["explain"] = "write " + to_string(writes);
+                if (use_snapshot) {
+                    snapshot_store.set(key, info);
+                } else {
+                    std::unique_lock<std::shared_mutex> lock(locked_mutex);
+                    locked_store[key] = info;
+                }
+                writes++;
+                usleep(1000);
+            }
+        });
+        uint64_t start = get_time_ns();
+        vector<std::thread> bench_readers;
+        for (int r = 0; r < reader_num; r++) {
+            bench_readers.push_back(std::thread([&, r]() {
+                size_t items = 0;
+                for (int n = 0; n < read_num; n++) {
+                    string key = "detector_" + to_string((n + r) % detector_num);
+                    if (use_snapshot) {
+                        zInfoStore::InfoPtr info = snapshot_store.get(key);
+                        items += info->size();
+                    } else {
+                        std::shared_lock<std::shared_mutex> lock(locked_mutex);
+                        zInfoDiff::Info info = locked_store.find(key)->second;
+                        items += info.size();
+                    }
+                }
+                total_items.fetch_add(items);
+            }));
+        }
+        for (std::thread& reader : bench_readers) {
+            reader.join();
+        }
+        uint64_t elapsed = get_time_ns() - start;
+        readers_done.store(true);
+        writer.join();
+        recordTestResult(total_items.load() == (uint64_t) reader_num * read_num * item_per_detector);
+        return elapsed;
+    };
+
+    uint64_t locked_writes = 0;
+    uint64_t snapshot_writes = 0;
+    uint64_t locked_ns = run_bench(false, locked_writes);
+    uint64_t snapshot_ns = run_bench(true, snapshot_writes);
+    double total_reads = (double) reader_num * read_num;
+    LOGI("info store read throughput (%d readers, %d items): shared_mutex + copy %.0f reads/s (%llu writes), "
+         "snapshot %.0f reads/s (%llu writes)", reader_num, item_per_detector,
+         total_reads * 1e9 / locked_ns, (unsigned long long) locked_writes,
+         total_reads * 1e9 / snapshot_ns, (unsigned long long) snapshot_writes);
+
+    LOGI("=== zInfoStore Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+
+#include "zDetectorPerf.h"
+
+// 检测开销统计测试：内存分配与系统调用计数、滑动窗口百分位数、卡片与 JSON 输出，
+// 以及统计本身的开销：每次 Scope 的耗时与内存分配计数对一次 200 项目检测的影响
+void test_detector_perf() {
+    LOGI("=== zDetectorPerf Tests START ===");
+
+    zDetectorPerf perf;
+    zPerfCounters::Sample cost;
+    {
+        zDetectorPerf::Scope scope(perf, "alloc");
+        vector<int*> ptrs;
+        for (int i = 0; i < 100; i++) {
+            ptrs.push_back(new int(i));
+        }
+        for (int* ptr : ptrs) {
+            delete ptr;
+        }
+        for (int i = 0; i < 10; i++) {
+            getpid();
+        }
+        cost = scope.finish();
+    }
+    LOGI("perf scope: wall %llu ns, cpu %llu ns, allocs %llu, syscalls %llu", (unsigned long long) cost.wallNs,
+         (unsigned long long) cost.cpuNs, (unsigned long long) cost.allocs, (unsigned long long) cost.syscalls);
+    recordTestResult(cost.allocs >= 100 && cost.syscalls >= 10 && cost.wallNs > 0);
+
+    // 关闭计数后不再统计内存分配
+    zPerfCounters::setAllocCountEnabled(false);
+    uint64_t allocs_before = zPerfCounters::getThreadAllocCount();
+    delete new int(1);
+    recordTestResult(zPerfCounters::getThreadAllocCount() == allocs_before);
+    zPerfCounters::setAllocCountEnabled(true);
+
+    // 窗口只保留最近 WINDOW_SIZE 次：1..100 中的 37..100
+    for (uint64_t i = 1; i <= 100; i++) {
+        zPerfCounters::Sample sample;
+        sample.wallNs = i * 1000;
+        sample.cpuNs = i * 500;
+        sample.allocs = i;
+        perf.record("window", sample);
+    }
+    zDetectorPerf::Summary summary;
+    recordTestResult(perf.getSummary("window", summary));
+    recordTestResult(summary.runs == 100 && summary.samples == zDetectorPerf::WINDOW_SIZE);
+    recordTestResult(summary.wallNs.p50 == 68000 && summary.wallNs.max == 100000 && summary.allocs.p90 == 94);
+    recordTestResult(summary.totalCpuNs == 5050 * 500);
+
+    map<string, map<string, string>> info = perf.toInfo();
+    recordTestResult(info.size() == 2 && info["window"]["risk"] == "safe" && info["window"]["runs"] == "100");
+    zJson json = zJson::parse(perf.toJson().c_str());
+    recordTestResult(json["window"]["runs"] == 100 && json["window"]["wall"]["max_us"] == 100.0);
+
+    // 开销：一次 200 个项目的检测，与 Scope 本身的耗时对比；
+    // 内存分配计数开启、关闭交替测量几次取最小值，减少预热与调度的影响
+    const int runs = 200;
+    size_t items = 0;
+    auto run_workload = [&](bool count_allocs) {
+        zPerfCounters::setAllocCountEnabled(count_allocs);
+        uint64_t begin = get_time_ns();
+        for (int i = 0; i < runs; i++) {
+            items += make_test_info(200, "item_").size();
+        }
+        zPerfCounters::setAllocCountEnabled(true);
+        return (get_time_ns() - begin) / runs;
+    };
+    uint64_t workload_ns = UINT64_MAX;
+    uint64_t uncounted_ns = UINT64_MAX;
+    for (int trial = 0; trial < 3; trial++) {
+        workload_ns = std::min(workload_ns, run_workload(true));
+        uncounted_ns = std::min(uncounted_ns, run_workload(false));
+    }
+
+    const int scope_num = 10000;
+    zDetectorPerf scope_perf;
+    uint64_t start = get_time_ns();
+    for (int i = 0; i < scope_num; i++) {
+        zDetectorPerf::Scope scope(scope_perf, "empty");
+    }
+    uint64_t scope_ns = (get_time_ns() - start) / scope_num;
+
+    {
+        zDetectorPerf::Scope scope(scope_perf, "workload");
+        items += make_test_info(200, "item_").size();
+        cost = scope.finish();
+    }
+    LOGI("perf overhead: detector %.1f us/run (%llu allocs), scope %llu ns (%.3f%%), "
+         "alloc counting %.1f us/run vs %.1f us/run uncounted", workload_ns / 1e3,
+         (unsigned long long) cost.allocs, (unsigned long long) scope_ns, scope_ns * 100.0 / workload_ns,
+         workload_ns / 1e3, uncounted_ns / 1e3);
+    recordTestResult(items == (size_t) runs * 6 * 200 + 200);
+
+    LOGI("=== zDetectorPerf Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+
+#include "zResultRecord.h"
+
+// 200 个项目的检测结果，每个项目有风险等级、说明、路径与两个数字字段
+static zInfoDiff::Info make_result_info(int item_num) {
+    zInfoDiff::Info info;
+    for (int i = 0; i < item_num; i++) {
+        map<string, string>& item = info["item_" + to_string(i)];
+        item["risk"] = i % 7 == 0 ? "error" : "safe";
+        item["explain"] = "detail of item_" + to_string(i) + " /data/app/com.example.overt/base.apk";
+        item["path"] = "/proc/self/task/" + to_string(1000 + i) + "/status";
+        item["pid"] = to_string(1000 + i);
+        item["inode"] = to_string((uint64_t) i * 7919);
+    }
+    return info;
+}
+
+static void make_result_record(int item_num, zResultRecord& record) {
+    static const zResultRecord::KeyId KEY_PATH = zResultRecord::internKey("path");
+    static const zResultRecord::KeyId KEY_PID = zResultRecord::internKey("pid");
+    static const zResultRecord::KeyId KEY_INODE = zResultRecord::internKey("inode");
+    char name[32];
+    record.clear();
+    for (int i = 0; i < item_num; i++) {
+        snprintf(name, sizeof(name), "item_%d", i);
+        record.addItem(name, i % 7 == 0 ? zResultRecord::RISK_ERROR : zResultRecord::RISK_SAFE)
+              .addFormat(zResultRecord::KEY_EXPLAIN, "detail of item_%d /data/app/com.example.overt/base.apk", i)
+              .addFormat(KEY_PATH, "/proc/self/task/%d/status", 1000 + i)
+              .addNumber(KEY_PID, (uint64_t) (1000 + i))
+              .addNumber(KEY_INODE, (uint64_t) i * 7919);
+    }
+}
+
+// 紧凑检测结果记录测试：键驻留、转换为 map 与 JSON 与原有方式一致（合并、覆盖、转义、非标准风险等级），
+// 重复填充不再分配内存，以及 200 个项目的检测结果按 map + zJson 与按记录构造并序列化的开销对比
+void test_result_record() {
+    LOGI("=== zResultRecord Tests START ===");
+
+    // 键驻留
+    zResultRecord::KeyId key_path = zResultRecord::internKey("path");
+    recordTestResult(key_path == zResultRecord::internKey(string("path")) && key_path != zResultRecord::KEY_EXTERNAL);
+    recordTestResult(zResultRecord::internKey("risk") == zResultRecord::KEY_RISK &&
+                     zResultRecord::internKey("explain") == zResultRecord::KEY_EXPLAIN);
+    const char* key_name = nullptr;
+    size_t key_length = 0;
+    recordTestResult(zResultRecord::getKeyName(key_path, key_name, key_length) &&
+                     string(key_name, key_length) == "path");
+
+    // 基本转换
+    zResultRecord record;
+    record.addItem("frida", zResultRecord::RISK_ERROR, "发现 frida-agent")
+          .addField(key_path, "/data/local/tmp/re.frida.server")
+          .addNumber(zResultRecord::internKey("port"), (uint64_t) 27042);
+    record.addItem("root", zResultRecord::RISK_SAFE);
+    record.addItem("empty");
+    zInfoDiff::Info expected;
+    expected["frida"]["risk"] = "error";
+    expected["frida"]["explain"] = "发现 frida-agent";
+    expected["frida"]["path"] = "/data/local/tmp/re.frida.server";
+    expected["frida"]["port"] = "27042";
+    expected["root"]["risk"] = "safe";
+    expected["empty"];
+    recordTestResult(record.toInfo() == expected);
+    recordTestResult(record.toJson() == zJson(expected).dump());
+
+    // 同名条目合并，同名键后写覆盖，显式的 risk 字段覆盖风险等级
+    record.addItem("frida", zResultRecord::RISK_WARN).addField(key_path, "/system/bin/frida");
+    record.addItem("root").addField("risk", "unknown").addField("a", "1").addField("a", "2");
+    expected["frida"]["risk"] = "warn";
+    expected["frida"]["path"] = "/system/bin/frida";
+    expected["root"]["risk"] = "unknown";
+    expected["root"]["a"] = "2";
+    recordTestResult(record.toInfo() == expected);
+    recordTestResult(record.toJson() == zJson(expected).dump());
+
+    // 从 map 构造再转换回来不变，非标准的风险等级作为普通字段保留
+    zResultRecord assigned;
+    assigned.assign(expected);
+    recordTestResult(assigned.toInfo() == expected && assigned.toJson() == zJson(expected).dump());
+
+    // 转义：引号、反斜杠、控制字符、DEL、中文与四字节字符，键与条目名称同样转义
+    zInfoDiff::Info escaped;
+    string special = "q\"b\\s/n\nr\rt\tb\bf\fc\x01\x1f" "d\x7f 中文 \xF0\x9F\x98\x80";
+    escaped[special]["risk"] = "warn";
+    escaped[special][special] = special;
+    escaped[""][""] = "";
+    zResultRecord escaped_record;
+    escaped_record.assign(escaped);
+    recordTestResult(escaped_record.toJson() == zJson(escaped).dump());
+
+    // 空记录
+    zResultRecord empty_record;
+    recordTestResult(empty_record.toJson() == zJson(zInfoDiff::Info()).dump() && empty_record.toInfo().empty());
+
+    // 超过栈上缓冲区的格式化
+    zResultRecord long_record;
+    long_record.addItem("long").addFormat(zResultRecord::KEY_EXPLAIN, "%0600d", 7);
+    string long_explain = long_record.toInfo()["long"]["explain"];
+    recordTestResult(long_explain.size() == 600 && long_explain[599] == '7' && long_explain[0] == '0');
+
+    // 不合法的 UTF-8 与 zJson 一样抛出异常
+    zInfoDiff::Info invalid;
+    invalid["bad"]["explain"] = "\xC3\x28";
+    zResultRecord invalid_record;
+    invalid_record.assign(invalid);
+    bool dom_threw = false;
+    bool record_threw = false;
+    try { zJson(invalid).dump(); } catch (...) { dom_threw = true; }
+    try { invalid_record.toJson(); } catch (...) { record_threw = true; }
+    recordTestResult(dom_threw && record_threw);
+
+    // 随机内容：与 zJson 输出逐字节一致
+    bool random_ok = true;
+    unsigned int seed = 4321;
+    for (int round = 0; round < 50 && random_ok; round++) {
+        zInfoDiff::Info info;
+        int item_num = rand_r(&seed) % 8;
+        for (int i = 0; i < item_num; i++) {
+            string name(1 + rand_r(&seed) % 4, 'a');
+            for (char& c : name) c = (char) (' ' + rand_r(&seed) % 95);
+            map<string, string>& item = info[name];
+            int field_num = rand_r(&seed) % 5;
+            for (int j = 0; j < field_num; j++) {
+                string value(rand_r(&seed) % 20, 'a');
+                for (char& c : value) c = (char) (1 + rand_r(&seed) % 127);
+                item[j % 2 ? "risk" : "k" + to_string(rand_r(&seed) % 4)] = value;
+            }
+        }
+        zResultRecord random_record;
+        random_record.assign(info);
+        random_ok = random_record.toInfo() == info && random_record.toJson() == zJson(info).dump();
+    }
+    recordTestResult(random_ok);
+
+    // 重复填充不再分配内存
+    zResultRecord reused;
+    make_result_record(200, reused);
+    uint64_t allocs_before = zPerfCounters::getThreadAllocCount();
+    make_result_record(200, reused);
+    uint64_t refill_allocs = zPerfCounters::getThreadAllocCount() - allocs_before;
+    recordTestResult(refill_allocs == 0);
+    recordTestResult(reused.toJson() == zJson(make_result_info(200)).dump());
+
+    // 开销：200 个项目，构造 map 并经过 zJson DOM 序列化，与复用记录构造并直接序列化对比
+    const int runs = 200;
+    size_t bytes_map = 0;
+    size_t bytes_record = 0;
+    uint64_t allocs_map = 0;
+    uint64_t allocs_record = 0;
+    uint64_t map_build_ns = UINT64_MAX;
+    uint64_t map_dump_ns = UINT64_MAX;
+    uint64_t record_build_ns = UINT64_MAX;
+    uint64_t record_dump_ns = UINT64_MAX;
+    string out;
+    for (int trial = 0; trial < 3; trial++) {
+        uint64_t build_ns = 0;
+        uint64_t dump_ns = 0;
+        uint64_t allocs = zPerfCounters::getThreadAllocCount();
+        for (int i = 0; i < runs; i++) {
+            uint64_t begin = get_time_ns();
+            zInfoDiff::Info info = make_result_info(200);
+            uint64_t built = get_time_ns();
+            bytes_map += zJson(info).dump().size();
+            dump_ns += get_time_ns() - built;
+            build_ns += built - begin;
+        }
+        allocs_map = (zPerfCounters::getThreadAllocCount() - allocs) / runs;
+        map_build_ns = std::min(map_build_ns, build_ns / runs);
+        map_dump_ns = std::min(map_dump_ns, dump_ns / runs);
+
+        build_ns = 0;
+        dump_ns = 0;
+        allocs = zPerfCounters::getThreadAllocCount();
+        for (int i = 0; i < runs; i++) {
+            uint64_t begin = get_time_ns();
+            make_result_record(200, reused);
+            uint64_t built = get_time_ns();
+            reused.toJson(out);
+            bytes_record += out.size();
+            dump_ns += get_time_ns() - built;
+            build_ns += built - begin;
+        }
+        allocs_record = (zPerfCounters::getThreadAllocCount() - allocs) / runs;
+        record_build_ns = std::min(record_build_ns, build_ns / runs);
+        record_dump_ns = std::min(record_dump_ns, dump_ns / runs);
+    }
+    LOGI("result record: 200 items, map build %.1f us + zJson dump %.1f us (%llu allocs), "
+         "record build %.1f us + toJson %.1f us (%llu allocs), json %zu bytes, arena %zu bytes, %zu fields",
+         map_build_ns / 1e3, map_dump_ns / 1e3, (unsigned long long) allocs_map,
+         record_build_ns / 1e3, record_dump_ns / 1e3, (unsigned long long) allocs_record,
+         out.size(), reused.getArenaSize(), reused.getFieldCount());
+    recordTestResult(bytes_map == bytes_record);
+    recordTestResult(allocs_record < 10 && allocs_record * 100 < allocs_map);
+
+    LOGI("=== zResultRecord Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+
+#include "zJsonWriter.h"
+
+// 分别用 zJson 与 zJsonWriter 序列化，都抛出异常时比较异常信息
+template <typename T>
+static bool json_writer_matches(const T& value, const std::function<const string&(zJsonWriter&)>& write) {
+    string dom;
+    string dom_error;
+    try { dom = zJson(value).dump(); } catch (const std::exception& e) { dom_error = e.what(); }
+    string direct;
+    string direct_error;
+    zJsonWriter writer;
+    try { direct = write(writer); } catch (const std::exception& e) { direct_error = e.what(); }
+    return dom == direct && dom_error == direct_error;
+}
+
+// 直接 JSON 序列化测试：与 zJson dump 逐字节比较（转义、UTF-8、不合法 UTF-8 的异常、空对象、随机内容），
+// 缓冲区复用不再分配内存，以及 19 个类别 × 200 个项目的 device_info 经过 DOM 与直接序列化的开销对比
+void test_json_writer() {
+    LOGI("=== zJsonWriter Tests START ===");
+
+    // 字符串与数字
+    zJsonWriter writer;
+    string special = "q\"b\\s/n\nr\rt\tb\bf\fc\x01\x1f" "d\x7f 中文 \xF0\x9F\x98\x80 \xEF\xBF\xBF";
+    recordTestResult(writer.writeString(special).getBuffer() == zJson(special).dump());
+    writer.clear();
+    recordTestResult(writer.writeUint(UINT64_MAX).getBuffer() == zJson((uint64_t) UINT64_MAX).dump());
+    writer.clear();
+    recordTestResult(writer.writeUint(0).getBuffer() == "0" && writer.size() == 1);
+
+    // 检测结果与 device_info
+    zInfoDiff::Info info = make_result_info(20);
+    info[special][special] = special;
+    info["empty"];
+    recordTestResult(json_writer_matches(info, [&](zJsonWriter& w) -> const string& { return w.dumpInfo(info); }));
+    recordTestResult(json_writer_matches(zInfoDiff::Info(),
+                                         [](zJsonWriter& w) -> const string& { return w.dumpInfo(zInfoDiff::Info()); }));
+    map<string, zInfoDiff::Info> device_map;
+    device_map["proc_info"] = info;
+    device_map["root_state_info"] = make_test_info(5, "su_");
+    device_map["empty_info"];
+    recordTestResult(json_writer_matches(device_map, [&](zJsonWriter& w) -> const string& {
+        return w.writeDeviceInfo(device_map).getBuffer();
+    }));
+    zInfoStore store;
+    for (const auto& item : device_map) {
+        store.set(item.first, item.second);
+    }
+    zInfoStore::SnapshotPtr snapshot = store.getSnapshot();
+    recordTestResult(json_writer_matches(zInfoStore::toMap(*snapshot), [&](zJsonWriter& w) -> const string& {
+        return w.dumpDeviceInfo(*snapshot);
+    }));
+
+    // 不合法的 UTF-8：截断、过长编码、代理区、超出范围、孤立的后续字节，与 zJson 抛出相同的异常
+    const char* invalid_values[] = {"\xC3", "\xC3\x28", "\xC0\xAF", "\xE0\x80\xAF", "\xED\xA0\x80",
+                                    "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "ok\x80", "\xE2\x82"};
+    bool invalid_ok = true;
+    for (const char* value : invalid_values) {
+        zInfoDiff::Info invalid;
+        invalid["item"]["explain"] = value;
+        invalid_ok = invalid_ok && json_writer_matches(invalid, [&](zJsonWriter& w) -> const string& {
+            return w.dumpInfo(invalid);
+        });
+    }
+    recordTestResult(invalid_ok);
+
+    // 随机字节：任意内容与 zJson 输出或异常一致
+    bool random_ok = true;
+    unsigned int seed = 9876;
+    for (int round = 0; round < 500 && random_ok; round++) {
+        zInfoDiff::Info random_info;
+        int item_num = rand_r(&seed) % 4;
+        for (int i = 0; i < item_num; i++) {
+            string name(rand_r(&seed) % 4, 'a');
+            for (char& c : name) c = (char) (1 + rand_r(&seed) % 255);
+            map<string, string>& item = random_info[name];
+            int field_num = rand_r(&seed) % 3;
+            for (int j = 0; j < field_num; j++) {
+                string value(rand_r(&seed) % 12, 'a');
+                // 大部分是 ASCII，少量高位字节组成合法或不合法的 UTF-8
+                for (char& c : value) c = (char) (rand_r(&seed) % 4 ? rand_r(&seed) % 128 : 128 + rand_r(&seed) % 128);
+                item["k" + to_string(j)] = value;
+            }
+        }
+        random_ok = json_writer_matches(random_info, [&](zJsonWriter& w) -> const string& {
+            return w.dumpInfo(random_info);
+        });
+    }
+    recordTestResult(random_ok);
+
+    // 缓冲区复用不再分配内存
+    zInfoDiff::Info card = make_result_info(200);
+    writer.dumpInfo(card);
+    uint64_t allocs_before = zPerfCounters::getThreadAllocCount();
+    size_t card_bytes = writer.dumpInfo(card).size();
+    recordTestResult(zPerfCounters::getThreadAllocCount() == allocs_before && card_bytes == zJson(card).dump().size());
+
+    // 开销：19 个类别 × 200 个项目，DOM 与直接序列化对比，单个类别（notice_java）与整个 device_info
+    zInfoStore device_store;
+    for (int i = 0; i < 19; i++) {
+        device_store.set("detector_" + to_string(i), make_result_info(200));
+    }
+    zInfoStore::SnapshotPtr device_snapshot = device_store.getSnapshot();
+    const int runs = 20;
+    size_t bytes_dom = 0;
+    size_t bytes_direct = 0;
+    uint64_t card_dom_ns = UINT64_MAX;
+    uint64_t card_direct_ns = UINT64_MAX;
+    uint64_t device_dom_ns = UINT64_MAX;
+    uint64_t device_direct_ns = UINT64_MAX;
+    uint64_t card_dom_allocs = 0;
+    uint64_t card_direct_allocs = 0;
+    for (int trial = 0; trial < 3; trial++) {
+        uint64_t allocs = zPerfCounters::getThreadAllocCount();
+        uint64_t start = get_time_ns();
+        for (int i = 0; i < runs; i++) {
+            bytes_dom += zJson(card).dump().size();
+        }
+        card_dom_ns = std::min(card_dom_ns, (get_time_ns() - start) / runs);
+        card_dom_allocs = (zPerfCounters::getThreadAllocCount() - allocs) / runs;
+
+        allocs = zPerfCounters::getThreadAllocCount();
+        start = get_time_ns();
+        for (int i = 0; i < runs; i++) {
+            bytes_direct += writer.dumpInfo(card).size();
+        }
+        card_direct_ns = std::min(card_direct_ns, (get_time_ns() - start) / runs);
+        card_direct_allocs = (zPerfCounters::getThreadAllocCount() - allocs) / runs;
+
+        start = get_time_ns();
+        for (int i = 0; i < runs; i++) {
+            bytes_dom += zJson(zInfoStore::toMap(*device_snapshot)).dump().size();
+        }
+        device_dom_ns = std::min(device_dom_ns, (get_time_ns() - start) / runs);
+
+        start = get_time_ns();
+        for (int i = 0; i < runs; i++) {
+            bytes_direct += writer.dumpDeviceInfo(*device_snapshot).size();
+        }
+        device_direct_ns = std::min(device_direct_ns, (get_time_ns() - start) / runs);
+    }
+    recordTestResult(writer.getBuffer() == zJson(zInfoStore::toMap(*device_snapshot)).dump());
+    LOGI("json writer: card of 200 items %zu bytes, zJson %.1f us (%llu allocs) vs writer %.1f us (%llu allocs); "
+         "device_info of 19 x 200 items %zu bytes, zJson %.1f us vs writer %.1f us",
+         card_bytes, card_dom_ns / 1e3, (unsigned long long) card_dom_allocs,
+         card_direct_ns / 1e3, (unsigned long long) card_direct_allocs,
+         writer.size(), device_dom_ns / 1e3, device_direct_ns / 1e3);
+    recordTestResult(bytes_dom == bytes_direct);
+    recordTestResult(card_direct_allocs == 0);
+
+    LOGI("=== zJsonWriter Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+
+#include "zJavaVm.h"
+#include "zJniCache.h"
+
+// JNI 句柄缓存测试：类只解析一次、返回同一个全局引用，找不到的类不留下异常，
+// 以及 19 个检测每轮通知的开销：每次 FindClass + GetStaticMethodID 并逐个调用，与缓存句柄并合并为一次调用对比
+// 需要 JavaVM，在没有 JNIEnv 的进程中跳过
+void test_jni_cache() {
+    LOGI("=== zJniCache Tests START ===");
+
+    JNIEnv* env = zJavaVm::getInstance()->getEnv();
+    if (env == nullptr) {
+        LOGW("test_jni_cache: env is null, skip");
+        return;
+    }
+    zJniCache* cache = zJniCache::getInstance();
+
+    jclass first = cache->getClass(env, "java/lang/String");
+    uint64_t hits_before = cache->getHitCount();
+    jclass second = cache->getClass(env, "java/lang/String");
+    recordTestResult(first != nullptr && first == second);
+    recordTestResult(cache->getHitCount() == hits_before + 1);
+
+    jmethodID value_of = cache->getStaticMethodId(env, "java/lang/String", "valueOf", "(Ljava/lang/Object;)Ljava/lang/String;");
+    recordTestResult(value_of != nullptr);
+    recordTestResult(value_of == cache->getStaticMethodId(env, "java/lang/String", "valueOf", "(Ljava/lang/Object;)Ljava/lang/String;"));
+
+    // 找不到的类、方法返回nullptr，异常已清除
+    recordTestResult(cache->getClass(env, "com/example/overt/NotExist") == nullptr);
+    recordTestResult(!env->ExceptionCheck());
+    recordTestResult(cache->getStaticMethodId(env, "java/lang/String", "notExist", "()V") == nullptr);
+    recordTestResult(!env->ExceptionCheck());
+
+    // 模拟一轮通知：每个检测一段 JSON，用 String.valueOf 代替 NativeUpdateBus 的回调
+    const int detector_num = 19;
+    const int rounds = 200;
+    vector<string> cards;
+    for (int i = 0; i < detector_num; i++) {
+        cards.push_back("{\"item_" + to_string(i) + "\":{\"risk\":\"safe\",\"explain\":\"detail\"}}");
+    }
+
+    uint64_t start = get_time_ns();
+    for (int round = 0; round < rounds; round++) {
+        for (const string& card : cards) {
+            jclass clazz = env->FindClass("java/lang/String");
+            jmethodID method = env->GetStaticMethodID(clazz, "valueOf", "(Ljava/lang/Object;)Ljava/lang/String;");
+            jstring data = env->NewStringUTF(card.c_str());
+            jobject result = env->CallStaticObjectMethod(clazz, method, data);
+            env->DeleteLocalRef(result);
+            env->DeleteLocalRef(data);
+            env->DeleteLocalRef(clazz);
+        }
+    }
+    uint64_t uncached_ns = get_time_ns() - start;
+
+    start = get_time_ns();
+    for (int round = 0; round < rounds; round++) {
+        jclass clazz = cache->getClass(env, "java/lang/String");
+        jmethodID method = cache->getStaticMethodId(env, "java/lang/String", "valueOf", "(Ljava/lang/Object;)Ljava/lang/String;");
+        string batch = "[";
+        for (size_t i = 0; i < cards.size(); i++) {
+            if (i > 0) {
+                batch += ",";
+            }
+            batch += cards[i];
+        }
+        batch += "]";
+        jstring data = env->NewStringUTF(batch.c_str());
+        jobject result = env->CallStaticObjectMethod(clazz, method, data);
+        env->DeleteLocalRef(result);
+        env->DeleteLocalRef(data);
+    }
+    uint64_t batched_ns = get_time_ns() - start;
+
+    LOGI("notice %d detectors per round: uncached per-card %.1f us/round, cached batched %.1f us/round",
+         detector_num, uncached_ns / 1e3 / rounds, batched_ns / 1e3 / rounds);
+
+    LOGI("=== zJniCache Tests END (passed %d failed %d) ===", g_testsPassed, g_testsFailed);
+}
+
+
 // ==================== 主测试函数 ====================
 void __attribute__((constructor)) init_(void) {
     LOGI("🚀 zCore 初始化 - 启动全面测试");
@@ -316,5 +3856,31 @@ void __attribute__((constructor)) init_(void) {
     zFile file2 = zFile("/data");
     LOGE("file blocks %lu", file2.getBlocks());
 
+//    test_elf_symbol_index();
+//    test_elf_cache();
+//    test_elf_file_view();
+//    test_lib_crc_scan();
+//    test_soinfo_snapshot();
+//    test_crc32c();
+//    test_crc32c_parallel();
+//    test_sha256();
+//    test_sha256_cache();
+//    test_thread_pool();
+//    test_task_future();
+//    test_task_priority();
+//    test_task_cancel();
+//    test_task_graph();
+//    test_cpu_topology();
+//    test_task_registry();
+//    test_pool_metrics();
+//    test_trigger_scheduler();
+//    test_detector_budget();
+//    test_info_diff();
+//    test_info_store();
+//    test_detector_perf();
+//    test_result_record();
+//    test_json_writer();
+//    test_jni_cache();
+
     return;
 }
\ No newline at end of file
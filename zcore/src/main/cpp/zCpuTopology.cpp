@@ -0,0 +1,211 @@
+//
+// Created by lxz on 2025/12/01.
+// zCpuTopology 实现 - CPU 拓扑（大小核簇）与线程绑核
+//
+
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <mutex>
+#include <algorithm>
+
+#include "zFile.h"
+#include "zStdUtil.h"
+#include "zCpuTopology.h"
+
+zCpuTopology* zCpuTopology::instance = nullptr;
+
+// 读取 sysfs 中的整数，文件不存在或内容不是数字时返回 0
+static uint32_t read_sysfs_uint(const string& path) {
+    zFile file(path);
+    if (!file.exists()) {
+        return 0;
+    }
+    string text = file.readAllText();
+    return (uint32_t) strtoul(text.c_str(), nullptr, 10);
+}
+
+vector<int> zCpuTopology::parseCpuList(const string& text) {
+    vector<int> cpus;
+    const char* p = text.c_str();
+    while (*p != '\0') {
+        if (*p < '0' || *p > '9') {
+            p++;
+            continue;
+        }
+        char* end = nullptr;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        if (*end == '-') {
+            last = strtol(end + 1, &end, 10);
+        }
+        for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+            cpus.push_back((int) cpu);
+        }
+        p = end;
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+zCpuTopology zCpuTopology::load(const string& sysfsRoot) {
+    zCpuTopology topology;
+
+    // 优先使用 online，其次 present；都没有时逐个探测 cpuN 目录
+    vector<int> cpus = parseCpuList(zFile(sysfsRoot + "/online").readAllText());
+    if (cpus.empty()) {
+        cpus = parseCpuList(zFile(sysfsRoot + "/present").readAllText());
+    }
+    if (cpus.empty()) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (access(string_format("%s/cpu%d", sysfsRoot.c_str(), cpu).c_str(), F_OK) != 0) {
+                break;
+            }
+            string online = zFile(string_format("%s/cpu%d/online", sysfsRoot.c_str(), cpu)).readAllText();
+            if (!online.empty() && online[0] == '0') {
+                continue;
+            }
+            cpus.push_back(cpu);
+        }
+    }
+
+    vector<uint32_t> capacities;
+    vector<uint32_t> maxFreqs;
+    bool byCapacity = !cpus.empty();
+    for (size_t i = 0; i < cpus.size(); i++) {
+        int cpu = cpus[i];
+        capacities.push_back(read_sysfs_uint(string_format("%s/cpu%d/cpu_capacity", sysfsRoot.c_str(), cpu)));
+        maxFreqs.push_back(read_sysfs_uint(string_format("%s/cpu%d/cpufreq/cpuinfo_max_freq", sysfsRoot.c_str(), cpu)));
+        byCapacity = byCapacity && capacities.back() != 0;
+    }
+
+    // 所有核都有 cpu_capacity 时按 capacity 分簇，否则全部按最大频率；两种指标混用会把同一簇拆开
+    for (size_t i = 0; i < cpus.size(); i++) {
+        int cpu = cpus[i];
+        uint32_t capacity = capacities[i];
+        uint32_t maxFreq = maxFreqs[i];
+
+        Cluster* cluster = nullptr;
+        for (size_t c = 0; c < topology.m_clusters.size(); c++) {
+            Cluster& candidate = topology.m_clusters[c];
+            if (byCapacity ? candidate.capacity == capacity : candidate.maxFreqKHz == maxFreq) {
+                cluster = &candidate;
+                break;
+            }
+        }
+        if (cluster == nullptr) {
+            topology.m_clusters.push_back(Cluster());
+            cluster = &topology.m_clusters.back();
+            cluster->capacity = capacity;
+            cluster->maxFreqKHz = maxFreq;
+        }
+        cluster->capacity = std::max(cluster->capacity, capacity);
+        cluster->maxFreqKHz = std::max(cluster->maxFreqKHz, maxFreq);
+        cluster->cpus.push_back(cpu);
+        topology.m_cpus.push_back(cpu);
+    }
+
+    std::sort(topology.m_clusters.begin(), topology.m_clusters.end(), [byCapacity](const Cluster& a, const Cluster& b) {
+        if (byCapacity && a.capacity != b.capacity) {
+            return a.capacity < b.capacity;
+        }
+        return a.maxFreqKHz < b.maxFreqKHz;
+    });
+
+    LOGI("zCpuTopology: %zu cpus, %zu clusters from %s", topology.m_cpus.size(), topology.m_clusters.size(), sysfsRoot.c_str());
+    for (size_t c = 0; c < topology.m_clusters.size(); c++) {
+        const Cluster& cluster = topology.m_clusters[c];
+        LOGI("zCpuTopology: cluster %zu capacity %u max_freq %u kHz, %zu cpus starting at cpu%d",
+             c, cluster.capacity, cluster.maxFreqKHz, cluster.cpus.size(), cluster.cpus[0]);
+    }
+    return topology;
+}
+
+const zCpuTopology* zCpuTopology::getInstance() {
+    static std::once_flag init_flag;
+    std::call_once(init_flag, []() {
+        instance = new zCpuTopology(load());
+    });
+    return instance;
+}
+
+vector<int> zCpuTopology::getCpus(CoreClass coreClass) const {
+    if (m_clusters.empty() || coreClass == CORE_ANY) {
+        return m_cpus;
+    }
+    if (coreClass == CORE_LITTLE) {
+        return m_clusters.front().cpus;
+    }
+    if (coreClass == CORE_MID && m_clusters.size() > 2) {
+        vector<int> cpus;
+        for (size_t c = 1; c + 1 < m_clusters.size(); c++) {
+            cpus.insert(cpus.end(), m_clusters[c].cpus.begin(), m_clusters[c].cpus.end());
+        }
+        return cpus;
+    }
+    return m_clusters.back().cpus;
+}
+
+zCpuTopology::CoreClass zCpuTopology::getCoreClass(int cpu) const {
+    for (size_t c = 0; c < m_clusters.size(); c++) {
+        const vector<int>& cpus = m_clusters[c].cpus;
+        if (std::find(cpus.begin(), cpus.end(), cpu) == cpus.end()) {
+            continue;
+        }
+        if (c + 1 == m_clusters.size()) {
+            return CORE_BIG;
+        }
+        return c == 0 ? CORE_LITTLE : CORE_MID;
+    }
+    return CORE_ANY;
+}
+
+vector<int> zCpuTopology::getSpreadOrder() const {
+    vector<int> order;
+    for (size_t round = 0; order.size() < m_cpus.size(); round++) {
+        for (size_t c = m_clusters.size(); c > 0; c--) {
+            const vector<int>& cpus = m_clusters[c - 1].cpus;
+            if (round < cpus.size()) {
+                order.push_back(cpus[round]);
+            }
+        }
+    }
+    return order;
+}
+
+bool zCpuTopology::bindCurrentThread(const vector<int>& cpus) {
+    if (cpus.empty()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i = 0; i < cpus.size(); i++) {
+        CPU_SET(cpus[i], &set);
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        LOGW("zCpuTopology: bind to %zu cpus starting at cpu%d failed (errno: %d: %s)",
+             cpus.size(), cpus[0], errno, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+zCpuAffinityScope::zCpuAffinityScope(zCpuTopology::CoreClass coreClass)
+    : zCpuAffinityScope(zCpuTopology::getInstance()->getCpus(coreClass)) {
+}
+
+zCpuAffinityScope::zCpuAffinityScope(const vector<int>& cpus) : m_bound(false) {
+    CPU_ZERO(&m_previous);
+    if (cpus.empty() || sched_getaffinity(0, sizeof(m_previous), &m_previous) != 0) {
+        return;
+    }
+    m_bound = zCpuTopology::bindCurrentThread(cpus);
+}
+
+zCpuAffinityScope::~zCpuAffinityScope() {
+    if (m_bound) {
+        sched_setaffinity(0, sizeof(m_previous), &m_previous);
+    }
+}
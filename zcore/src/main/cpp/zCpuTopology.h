@@ -0,0 +1,115 @@
+//
+// Created by lxz on 2025/12/01.
+// zCpuTopology - CPU 拓扑（大小核簇）与线程绑核
+//
+
+#ifndef OVERT_ZCPUTOPOLOGY_H
+#define OVERT_ZCPUTOPOLOGY_H
+
+#include <sched.h>
+#include <stdint.h>
+
+#include "zLog.h"
+#include "zStd.h"
+
+/**
+ * CPU 拓扑
+ * 从 sysfs（/sys/devices/system/cpu）读取每个在线 CPU 的 cpu_capacity 与 cpufreq/cpuinfo_max_freq，
+ * 性能相同的 CPU 归为一个簇，簇按性能从低到高排列：最低的是小核，最高的是大核，中间的是中核
+ * 没有 cpu_capacity 时按最大频率分簇；都读不到时所有 CPU 为一个簇（同构，既是大核也是小核）
+ *
+ * load 可以指定 sysfs 根目录，测试时用伪造的目录结构模拟各种设备
+ */
+class zCpuTopology {
+public:
+    /**
+     * 核心类别
+     */
+    enum CoreClass {
+        CORE_ANY = 0,       // 不限制
+        CORE_LITTLE = 1,    // 性能最低的簇
+        CORE_MID = 2,       // 大小核之间的簇，没有时等同于大核
+        CORE_BIG = 3,       // 性能最高的簇
+    };
+
+    struct Cluster {
+        vector<int> cpus;
+        uint32_t capacity = 0;      // cpu_capacity，读不到为 0
+        uint32_t maxFreqKHz = 0;    // cpuinfo_max_freq，读不到为 0
+    };
+
+private:
+    vector<Cluster> m_clusters;     // 按性能从低到高
+    vector<int> m_cpus;             // 所有在线 CPU
+
+    static zCpuTopology* instance;
+
+public:
+    zCpuTopology() {}
+
+    /**
+     * 读取 sysfsRoot 下的拓扑
+     * @param sysfsRoot 对应 /sys/devices/system/cpu 的目录
+     */
+    static zCpuTopology load(const string& sysfsRoot = "/sys/devices/system/cpu");
+
+    /**
+     * 本机拓扑，第一次调用时读取，之后不再变化
+     */
+    static const zCpuTopology* getInstance();
+
+    /**
+     * 解析 CPU 列表，支持 "0-3,6" 与 "0 1 2 3" 两种格式
+     */
+    static vector<int> parseCpuList(const string& text);
+
+    const vector<Cluster>& getClusters() const { return m_clusters; }
+
+    size_t getCpuCount() const { return m_cpus.size(); }
+
+    bool isHeterogeneous() const { return m_clusters.size() > 1; }
+
+    /**
+     * 指定类别的 CPU，CORE_ANY 返回所有在线 CPU
+     */
+    vector<int> getCpus(CoreClass coreClass) const;
+
+    /**
+     * CPU 所属的类别，不在拓扑中返回 CORE_ANY
+     */
+    CoreClass getCoreClass(int cpu) const;
+
+    /**
+     * 工作线程分散绑核的顺序：从大核簇开始，在各簇之间轮流取一个 CPU
+     */
+    vector<int> getSpreadOrder() const;
+
+    /**
+     * 把当前线程绑定到 cpus，cpus 为空时不修改
+     */
+    static bool bindCurrentThread(const vector<int>& cpus);
+};
+
+/**
+ * 作用域内把当前线程绑定到指定的核心，析构时恢复之前的绑定
+ * 用于单个任务临时绑核（侧信道计时需要在大核上稳定测量），不影响执行它的工作线程之后的任务
+ */
+class zCpuAffinityScope {
+private:
+    cpu_set_t m_previous;
+    bool m_bound;
+
+public:
+    explicit zCpuAffinityScope(zCpuTopology::CoreClass coreClass);
+
+    explicit zCpuAffinityScope(const vector<int>& cpus);
+
+    ~zCpuAffinityScope();
+
+    bool isBound() const { return m_bound; }
+
+    zCpuAffinityScope(const zCpuAffinityScope&) = delete;
+    zCpuAffinityScope& operator=(const zCpuAffinityScope&) = delete;
+};
+
+#endif //OVERT_ZCPUTOPOLOGY_H
@@ -1,56 +1,506 @@
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+
+#if defined(__aarch64__)
+#include <arm_acle.h>
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define CRC32C_HAS_HW 1
+#elif defined(__x86_64__)
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#define CRC32C_HAS_HW 1
+#else
+#define CRC32C_HAS_HW 0
+#endif
+
 #include "zCrc32.h"
 #include "zLog.h"
+#include "zThreadPool.h"
 
-/* 1. 8→4 折叠表 */
-static const uint32_t fold8[256] = {0x00000000, 0x0a5f4d75, 0x14be9aea, 0x1ee1d79f, 0x14c5eb57, 0x1e9aa622, 0x007b71bd, 0x0a243cc8, 0x1433082d, 0x1e6c4558, 0x008d92c7, 0x0ad2dfb2, 0x00f6e37a, 0x0aa9ae0f, 0x14487990, 0x1e1734e5, 0x15deced9, 0x1f8183ac, 0x01605433, 0x0b3f1946, 0x011b258e, 0x0b4468fb, 0x15a5bf64, 0x1ffaf211, 0x01edc6f4, 0x0bb28b81, 0x15535c1e, 0x1f0c116b, 0x15282da3, 0x1f7760d6, 0x0196b749, 0x0bc9fa3c, 0x16054331, 0x1c5a0e44, 0x02bbd9db, 0x08e494ae, 0x02c0a866, 0x089fe513, 0x167e328c, 0x1c217ff9, 0x02364b1c, 0x08690669, 0x1688d1f6, 0x1cd79c83, 0x16f3a04b, 0x1caced3e, 0x024d3aa1, 0x081277d4, 0x03db8de8, 0x0984c09d, 0x17651702, 0x1d3a5a77, 0x171e66bf, 0x1d412bca, 0x03a0fc55, 0x09ffb120, 0x17e885c5, 0x1db7c8b0, 0x03561f2f, 0x0909525a, 0x032d6e92, 0x097223e7, 0x1793f478, 0x1dccb90d, 0x11b258e1, 0x1bed1594, 0x050cc20b, 0x0f538f7e, 0x0577b3b6, 0x0f28fec3, 0x11c9295c, 0x1b966429, 0x058150cc, 0x0fde1db9, 0x113fca26, 0x1b608753, 0x1144bb9b, 0x1b1bf6ee, 0x05fa2171, 0x0fa56c04, 0x046c9638, 0x0e33db4d, 0x10d20cd2, 0x1a8d41a7, 0x10a97d6f, 0x1af6301a, 0x0417e785, 0x0e48aaf0, 0x105f9e15, 0x1a00d360, 0x04e104ff, 0x0ebe498a, 0x049a7542, 0x0ec53837, 0x1024efa8, 0x1a7ba2dd, 0x07b71bd0, 0x0de856a5, 0x1309813a, 0x1956cc4f, 0x1372f087, 0x192dbdf2, 0x07cc6a6d, 0x0d932718, 0x138413fd, 0x19db5e88, 0x073a8917, 0x0d65c462, 0x0741f8aa, 0x0d1eb5df, 0x13ff6240, 0x19a02f35, 0x1269d509, 0x1836987c, 0x06d74fe3, 0x0c880296, 0x06ac3e5e, 0x0cf3732b, 0x1212a4b4, 0x184de9c1, 0x065add24, 0x0c059051, 0x12e447ce, 0x18bb0abb, 0x129f3673, 0x18c07b06, 0x0621ac99, 0x0c7ee1ec, 0x1edc6f41, 0x14832234, 0x0a62f5ab, 0x003db8de, 0x0a198416,0x0046c963, 0x1ea71efc, 0x14f85389, 0x0aef676c, 0x00b02a19, 0x1e51fd86, 0x140eb0f3, 0x1e2a8c3b, 0x1475c14e, 0x0a9416d1, 0x00cb5ba4, 0x0b02a198, 0x015deced, 0x1fbc3b72, 0x15e37607, 0x1fc74acf, 0x159807ba, 0x0b79d025, 0x01269d50, 0x1f31a9b5, 0x156ee4c0, 0x0b8f335f, 0x01d07e2a, 0x0bf442e2, 0x01ab0f97, 0x1f4ad808, 0x1515957d, 0x08d92c70, 0x02866105, 0x1c67b69a, 0x1638fbef, 0x1c1cc727, 0x16438a52, 0x08a25dcd, 0x02fd10b8, 0x1cea245d, 0x16b56928, 0x0854beb7, 0x020bf3c2, 0x082fcf0a, 0x0270827f, 0x1c9155e0, 0x16ce1895, 0x1d07e2a9, 0x1758afdc, 0x09b97843, 0x03e63536, 0x09c209fe, 0x039d448b, 0x1d7c9314, 0x1723de61, 0x0934ea84, 0x036ba7f1, 0x1d8a706e, 0x17d53d1b, 0x1df101d3, 0x17ae4ca6, 0x094f9b39, 0x0310d64c, 0x0f6e37a0, 0x05317ad5, 0x1bd0ad4a, 0x118fe03f, 0x1babdcf7, 0x11f49182, 0x0f15461d, 0x054a0b68, 0x1b5d3f8d, 0x110272f8, 0x0fe3a567, 0x05bce812, 0x0f98d4da, 0x05c799af, 0x1b264e30, 0x11790345, 0x1ab0f979, 0x10efb40c, 0x0e0e6393, 0x04512ee6, 0x0e75122e, 0x042a5f5b, 0x1acb88c4, 0x1094c5b1, 0x0e83f154, 0x04dcbc21, 0x1a3d6bbe, 0x106226cb, 0x1a461a03, 0x10195776, 0x0ef880e9, 0x04a7cd9c, 0x196b7491, 0x133439e4, 0x0dd5ee7b, 0x078aa30e, 0x0dae9fc6, 0x07f1d2b3, 0x1910052c, 0x134f4859, 0x0d587cbc, 0x070731c9, 0x19e6e656, 0x13b9ab23, 0x199d97eb, 0x13c2da9e, 0x0d230d01, 0x077c4074, 0x0cb5ba48, 0x06eaf73d, 0x180b20a2, 0x12546dd7, 0x1870511f, 0x122f1c6a, 0x0ccecbf5, 0x06918680, 0x1886b265, 0x12d9ff10, 0x0c38288f, 0x066765fa, 0x0c435932, 0x061c1447, 0x18fdc3d8, 0x12a28ead};
+/*
+ * CRC-32C（Castagnoli，反射多项式 0x82F63B78，初值与结果均取反）
+ * - 查表实现：slicing-by-8，每次处理 8 字节
+ * - 硬件实现：CRC32C 指令，三路数据流交错隐藏指令延迟，再用 GF(2) 乘法合并
+ * - 折叠实现：PMULL / PCLMUL 以 64 字节为单位并行折叠大块数据，最后用 CRC32C 指令归约
+ * 所有实现的结果完全一致，运行时根据 CPU 特性选择最快的实现
+ */
 
-/* 2. 4 字节 CRC-32C 查表（256×4） */
-static const uint32_t crc32c_tab[256] = {0x00000000, 0x0a5f4d75, 0x14be9aea, 0x1ee1d79f, 0x14c5eb57, 0x1e9aa622, 0x007b71bd, 0x0a243cc8, 0x1433082d, 0x1e6c4558, 0x008d92c7, 0x0ad2dfb2, 0x00f6e37a, 0x0aa9ae0f, 0x14487990, 0x1e1734e5, 0x15deced9, 0x1f8183ac, 0x01605433, 0x0b3f1946, 0x011b258e, 0x0b4468fb, 0x15a5bf64, 0x1ffaf211, 0x01edc6f4, 0x0bb28b81, 0x15535c1e, 0x1f0c116b, 0x15282da3, 0x1f7760d6, 0x0196b749, 0x0bc9fa3c, 0x16054331, 0x1c5a0e44, 0x02bbd9db, 0x08e494ae, 0x02c0a866, 0x089fe513, 0x167e328c, 0x1c217ff9, 0x02364b1c, 0x08690669, 0x1688d1f6, 0x1cd79c83, 0x16f3a04b, 0x1caced3e, 0x024d3aa1, 0x081277d4, 0x03db8de8, 0x0984c09d, 0x17651702, 0x1d3a5a77, 0x171e66bf, 0x1d412bca, 0x03a0fc55, 0x09ffb120, 0x17e885c5, 0x1db7c8b0, 0x03561f2f, 0x0909525a, 0x032d6e92, 0x097223e7, 0x1793f478, 0x1dccb90d, 0x11b258e1, 0x1bed1594, 0x050cc20b, 0x0f538f7e, 0x0577b3b6, 0x0f28fec3, 0x11c9295c, 0x1b966429, 0x058150cc, 0x0fde1db9, 0x113fca26, 0x1b608753, 0x1144bb9b, 0x1b1bf6ee, 0x05fa2171, 0x0fa56c04, 0x046c9638, 0x0e33db4d, 0x10d20cd2, 0x1a8d41a7, 0x10a97d6f, 0x1af6301a, 0x0417e785, 0x0e48aaf0, 0x105f9e15, 0x1a00d360, 0x04e104ff, 0x0ebe498a, 0x049a7542, 0x0ec53837, 0x1024efa8, 0x1a7ba2dd, 0x07b71bd0, 0x0de856a5, 0x1309813a, 0x1956cc4f, 0x1372f087, 0x192dbdf2, 0x07cc6a6d, 0x0d932718, 0x138413fd, 0x19db5e88, 0x073a8917, 0x0d65c462, 0x0741f8aa, 0x0d1eb5df, 0x13ff6240, 0x19a02f35, 0x1269d509, 0x1836987c, 0x06d74fe3, 0x0c880296, 0x06ac3e5e, 0x0cf3732b, 0x1212a4b4, 0x184de9c1, 0x065add24, 0x0c059051, 0x12e447ce, 0x18bb0abb, 0x129f3673, 0x18c07b06, 0x0621ac99, 0x0c7ee1ec, 0x1edc6f41, 0x14832234, 0x0a62f5ab, 0x003db8de, 0x0a198416,0x0046c963, 0x1ea71efc, 0x14f85389, 0x0aef676c, 0x00b02a19, 0x1e51fd86, 0x140eb0f3, 0x1e2a8c3b, 0x1475c14e, 0x0a9416d1, 0x00cb5ba4, 0x0b02a198, 0x015deced, 0x1fbc3b72, 0x15e37607, 0x1fc74acf, 0x159807ba, 0x0b79d025, 0x01269d50, 0x1f31a9b5, 0x156ee4c0, 0x0b8f335f, 0x01d07e2a, 0x0bf442e2, 0x01ab0f97, 0x1f4ad808, 0x1515957d, 0x08d92c70, 0x02866105, 0x1c67b69a, 0x1638fbef, 0x1c1cc727, 0x16438a52, 0x08a25dcd, 0x02fd10b8, 0x1cea245d, 0x16b56928, 0x0854beb7, 0x020bf3c2, 0x082fcf0a, 0x0270827f, 0x1c9155e0, 0x16ce1895, 0x1d07e2a9, 0x1758afdc, 0x09b97843, 0x03e63536, 0x09c209fe, 0x039d448b, 0x1d7c9314, 0x1723de61, 0x0934ea84, 0x036ba7f1, 0x1d8a706e, 0x17d53d1b, 0x1df101d3, 0x17ae4ca6, 0x094f9b39, 0x0310d64c, 0x0f6e37a0, 0x05317ad5, 0x1bd0ad4a, 0x118fe03f, 0x1babdcf7, 0x11f49182, 0x0f15461d, 0x054a0b68, 0x1b5d3f8d, 0x110272f8, 0x0fe3a567, 0x05bce812, 0x0f98d4da, 0x05c799af, 0x1b264e30, 0x11790345, 0x1ab0f979, 0x10efb40c, 0x0e0e6393, 0x04512ee6, 0x0e75122e, 0x042a5f5b, 0x1acb88c4, 0x1094c5b1, 0x0e83f154, 0x04dcbc21, 0x1a3d6bbe, 0x106226cb, 0x1a461a03, 0x10195776, 0x0ef880e9, 0x04a7cd9c, 0x196b7491, 0x133439e4, 0x0dd5ee7b, 0x078aa30e, 0x0dae9fc6, 0x07f1d2b3, 0x1910052c, 0x134f4859, 0x0d587cbc, 0x070731c9, 0x19e6e656, 0x13b9ab23, 0x199d97eb, 0x13c2da9e, 0x0d230d01, 0x077c4074, 0x0cb5ba48, 0x06eaf73d, 0x180b20a2, 0x12546dd7, 0x1870511f, 0x122f1c6a, 0x0ccecbf5, 0x06918680, 0x1886b265, 0x12d9ff10, 0x0c38288f, 0x066765fa, 0x0c435932, 0x061c1447, 0x18fdc3d8, 0x12a28ead};
+#define CRC32C_POLY 0x82F63B78u
 
-/* 3. 折叠 8→4 字节函数 */
-static inline uint32_t fold64(uint64_t v, uint32_t crc)
-{
-    uint8_t *p = (uint8_t *)&v;
-    crc ^= fold8[p[0]];
-    crc ^= fold8[p[1]];
-    crc ^= fold8[p[2]];
-    crc ^= fold8[p[3]];
-    crc ^= fold8[p[4]];
-    crc ^= fold8[p[5]];
-    crc ^= fold8[p[6]];
-    crc ^= fold8[p[7]];
+/* 三路交错的块长度（每一路），大块用 LONG，剩余部分用 SHORT */
+#define CRC32C_LONG 8192
+#define CRC32C_SHORT 256
+
+/* 小于该长度时折叠实现直接使用三路交错实现 */
+#define CRC32C_FOLD_MIN 1024
+
+/* 1. slicing-by-8 查表 */
+static uint32_t crc32c_table[8][256];
+
+/* 2. x^(2^n) mod P，用于计算 x^k mod P */
+static uint32_t crc32c_x2n_table[32];
+
+/* 3. 三路交错合并用的移位常量 x^(8*LONG) mod P、x^(8*SHORT) mod P */
+static uint32_t crc32c_long_shift;
+static uint32_t crc32c_short_shift;
+
+/* 4. 折叠常量：x^(n) mod P 的反射形式左移一位 */
+static uint64_t crc32c_fold_k512[2];
+static uint64_t crc32c_fold_k128[2];
+
+static crc32c_impl crc32c_selected_impl = CRC32C_IMPL_TABLE;
+static bool crc32c_hw_supported = false;
+static bool crc32c_fold_supported = false;
+
+/* 5. GF(2) 多项式乘法 a * b mod P（反射表示，最高位为 x^0） */
+static uint32_t crc32c_multmodp(uint32_t a, uint32_t b) {
+    uint32_t m = 1u << 31;
+    uint32_t p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+    return p;
+}
+
+/* 6. x^n mod P */
+static uint32_t crc32c_xnmodp(uint64_t n) {
+    uint32_t p = 1u << 31;  // x^0
+    int k = 0;
+    while (n) {
+        if (n & 1) {
+            p = crc32c_multmodp(crc32c_x2n_table[k & 31], p);
+        }
+        n >>= 1;
+        k++;
+    }
+    return p;
+}
+
+/* 7. 将未取反的 crc 后移 len 字节（相当于在其后追加 len 个 0 字节） */
+static inline uint32_t crc32c_shift(uint32_t crc, uint32_t shift) {
+    return crc32c_multmodp(shift, crc);
+}
+
+static void crc32c_init_tables() {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = n;
+        for (int k = 0; k < 8; k++) {
+            crc = crc & 1 ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        }
+        crc32c_table[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        for (int k = 1; k < 8; k++) {
+            uint32_t crc = crc32c_table[k - 1][n];
+            crc32c_table[k][n] = (crc >> 8) ^ crc32c_table[0][crc & 0xff];
+        }
+    }
+
+    uint32_t p = 1u << 30;  // x^1
+    for (int n = 0; n < 32; n++) {
+        crc32c_x2n_table[n] = p;
+        p = crc32c_multmodp(p, p);
+    }
+
+    crc32c_long_shift = crc32c_xnmodp((uint64_t) CRC32C_LONG * 8);
+    crc32c_short_shift = crc32c_xnmodp((uint64_t) CRC32C_SHORT * 8);
+
+    // 低 64 位乘 x^(n+32)，高 64 位乘 x^(n-32)，n 为折叠跨度（位）
+    crc32c_fold_k512[0] = (uint64_t) crc32c_xnmodp(512 + 32) << 1;
+    crc32c_fold_k512[1] = (uint64_t) crc32c_xnmodp(512 - 32) << 1;
+    crc32c_fold_k128[0] = (uint64_t) crc32c_xnmodp(128 + 32) << 1;
+    crc32c_fold_k128[1] = (uint64_t) crc32c_xnmodp(128 - 32) << 1;
+}
+
+/* 8. 查表实现，crc 为未取反的中间值（小端） */
+static uint32_t crc32c_sw(uint32_t crc, const uint8_t *p, size_t len) {
+    while (len && ((uintptr_t) p & 7)) {
+        crc = crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+        len--;
+    }
+    while (len >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        v ^= crc;
+        crc = crc32c_table[7][v & 0xff] ^
+              crc32c_table[6][(v >> 8) & 0xff] ^
+              crc32c_table[5][(v >> 16) & 0xff] ^
+              crc32c_table[4][(v >> 24) & 0xff] ^
+              crc32c_table[3][(v >> 32) & 0xff] ^
+              crc32c_table[2][(v >> 40) & 0xff] ^
+              crc32c_table[1][(v >> 48) & 0xff] ^
+              crc32c_table[0][v >> 56];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
     return crc;
 }
 
-/* 4. 尾部 0–7 字节，逐字节查表 */
-static inline uint32_t crc32c_tail(const uint8_t *p, size_t len, uint32_t crc)
-{
+#if CRC32C_HAS_HW
+
+#if defined(__aarch64__)
+
+#define CRC32C_HW_TARGET __attribute__((target("crc")))
+#define CRC32C_FOLD_TARGET __attribute__((target("crc,aes")))
+
+typedef uint64x2_t crc32c_v128;
+
+static inline CRC32C_HW_TARGET uint32_t crc32c_hw_u64(uint32_t crc, uint64_t v) {
+    return __crc32cd(crc, v);
+}
+
+static inline CRC32C_HW_TARGET uint32_t crc32c_hw_u8(uint32_t crc, uint8_t v) {
+    return __crc32cb(crc, v);
+}
+
+static inline CRC32C_FOLD_TARGET crc32c_v128 crc32c_v_load(const uint8_t *p) {
+    return vreinterpretq_u64_u8(vld1q_u8(p));
+}
+
+static inline CRC32C_FOLD_TARGET crc32c_v128 crc32c_v_make(uint64_t lo, uint64_t hi) {
+    return vcombine_u64(vcreate_u64(lo), vcreate_u64(hi));
+}
+
+static inline CRC32C_FOLD_TARGET uint64_t crc32c_v_lane(crc32c_v128 v, int hi) {
+    return hi ? vgetq_lane_u64(v, 1) : vgetq_lane_u64(v, 0);
+}
+
+/* x 的低 64 位乘 k 的低 64 位，异或上 x 的高 64 位乘 k 的高 64 位 */
+static inline CRC32C_FOLD_TARGET crc32c_v128 crc32c_v_fold(crc32c_v128 x, crc32c_v128 k) {
+    poly128_t lo = vmull_p64((poly64_t) vgetq_lane_u64(x, 0), (poly64_t) vgetq_lane_u64(k, 0));
+    poly128_t hi = vmull_p64((poly64_t) vgetq_lane_u64(x, 1), (poly64_t) vgetq_lane_u64(k, 1));
+    return veorq_u64(vreinterpretq_u64_p128(lo), vreinterpretq_u64_p128(hi));
+}
+
+static inline CRC32C_FOLD_TARGET crc32c_v128 crc32c_v_xor(crc32c_v128 a, crc32c_v128 b) {
+    return veorq_u64(a, b);
+}
+
+static void crc32c_detect_cpu() {
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    crc32c_hw_supported = (hwcap & HWCAP_CRC32) != 0;
+    crc32c_fold_supported = crc32c_hw_supported && (hwcap & HWCAP_PMULL) != 0;
+}
+
+#else
+
+#define CRC32C_HW_TARGET __attribute__((target("sse4.2")))
+#define CRC32C_FOLD_TARGET __attribute__((target("sse4.2,pclmul")))
+
+typedef __m128i crc32c_v128;
+
+static inline CRC32C_HW_TARGET uint32_t crc32c_hw_u64(uint32_t crc, uint64_t v) {
+    return (uint32_t) _mm_crc32_u64(crc, v);
+}
+
+static inline CRC32C_HW_TARGET uint32_t crc32c_hw_u8(uint32_t crc, uint8_t v) {
+    return _mm_crc32_u8(crc, v);
+}
+
+static inline CRC32C_FOLD_TARGET crc32c_v128 crc32c_v_load(const uint8_t *p) {
+    return _mm_loadu_si128((const __m128i *) p);
+}
+
+static inline CRC32C_FOLD_TARGET crc32c_v128 crc32c_v_make(uint64_t lo, uint64_t hi) {
+    return _mm_set_epi64x((long long) hi, (long long) lo);
+}
+
+static inline CRC32C_FOLD_TARGET uint64_t crc32c_v_lane(crc32c_v128 v, int hi) {
+    return hi ? (uint64_t) _mm_extract_epi64(v, 1) : (uint64_t) _mm_cvtsi128_si64(v);
+}
+
+/* x 的低 64 位乘 k 的低 64 位，异或上 x 的高 64 位乘 k 的高 64 位 */
+static inline CRC32C_FOLD_TARGET crc32c_v128 crc32c_v_fold(crc32c_v128 x, crc32c_v128 k) {
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+static inline CRC32C_FOLD_TARGET crc32c_v128 crc32c_v_xor(crc32c_v128 a, crc32c_v128 b) {
+    return _mm_xor_si128(a, b);
+}
+
+static void crc32c_detect_cpu() {
+    __builtin_cpu_init();
+    crc32c_hw_supported = __builtin_cpu_supports("sse4.2");
+    crc32c_fold_supported = crc32c_hw_supported && __builtin_cpu_supports("pclmul");
+}
+
+#endif
+
+static inline uint64_t crc32c_load64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+/* 9. 硬件实现：三路交错，每路处理 block 字节后用 shift 合并 */
+static inline CRC32C_HW_TARGET uint32_t crc32c_hw_3way(uint32_t crc, const uint8_t **pp, size_t *plen,
+                                                      size_t block, uint32_t shift) {
+    const uint8_t *p = *pp;
+    size_t len = *plen;
+    while (len >= 3 * block) {
+        uint32_t crc0 = crc;
+        uint32_t crc1 = 0;
+        uint32_t crc2 = 0;
+        const uint8_t *end = p + block;
+        do {
+            crc0 = crc32c_hw_u64(crc0, crc32c_load64(p));
+            crc1 = crc32c_hw_u64(crc1, crc32c_load64(p + block));
+            crc2 = crc32c_hw_u64(crc2, crc32c_load64(p + 2 * block));
+            p += 8;
+        } while (p < end);
+        crc = crc32c_shift(crc0, shift) ^ crc1;
+        crc = crc32c_shift(crc, shift) ^ crc2;
+        p += 2 * block;
+        len -= 3 * block;
+    }
+    *pp = p;
+    *plen = len;
+    return crc;
+}
+
+static CRC32C_HW_TARGET uint32_t crc32c_hw(uint32_t crc, const uint8_t *p, size_t len) {
+    while (len && ((uintptr_t) p & 7)) {
+        crc = crc32c_hw_u8(crc, *p++);
+        len--;
+    }
+    crc = crc32c_hw_3way(crc, &p, &len, CRC32C_LONG, crc32c_long_shift);
+    crc = crc32c_hw_3way(crc, &p, &len, CRC32C_SHORT, crc32c_short_shift);
+    while (len >= 8) {
+        crc = crc32c_hw_u64(crc, crc32c_load64(p));
+        p += 8;
+        len -= 8;
+    }
     while (len--) {
-        crc = crc32c_tab[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+        crc = crc32c_hw_u8(crc, *p++);
     }
     return crc;
 }
 
-/* 5. 入口函数 */
+/* 10. 折叠实现：4 个 128 位累加器每次折叠 64 字节，最后归约为 16 字节交给 CRC32C 指令 */
+static CRC32C_FOLD_TARGET uint32_t crc32c_hw_fold(uint32_t crc, const uint8_t *p, size_t len) {
+    if (len < CRC32C_FOLD_MIN) {
+        return crc32c_hw(crc, p, len);
+    }
+
+    crc32c_v128 x0 = crc32c_v_xor(crc32c_v_load(p), crc32c_v_make(crc, 0));
+    crc32c_v128 x1 = crc32c_v_load(p + 16);
+    crc32c_v128 x2 = crc32c_v_load(p + 32);
+    crc32c_v128 x3 = crc32c_v_load(p + 48);
+    p += 64;
+    len -= 64;
+
+    crc32c_v128 k512 = crc32c_v_make(crc32c_fold_k512[0], crc32c_fold_k512[1]);
+    while (len >= 64) {
+        x0 = crc32c_v_xor(crc32c_v_fold(x0, k512), crc32c_v_load(p));
+        x1 = crc32c_v_xor(crc32c_v_fold(x1, k512), crc32c_v_load(p + 16));
+        x2 = crc32c_v_xor(crc32c_v_fold(x2, k512), crc32c_v_load(p + 32));
+        x3 = crc32c_v_xor(crc32c_v_fold(x3, k512), crc32c_v_load(p + 48));
+        p += 64;
+        len -= 64;
+    }
+
+    crc32c_v128 k128 = crc32c_v_make(crc32c_fold_k128[0], crc32c_fold_k128[1]);
+    x0 = crc32c_v_xor(crc32c_v_fold(x0, k128), x1);
+    x0 = crc32c_v_xor(crc32c_v_fold(x0, k128), x2);
+    x0 = crc32c_v_xor(crc32c_v_fold(x0, k128), x3);
+    while (len >= 16) {
+        x0 = crc32c_v_xor(crc32c_v_fold(x0, k128), crc32c_v_load(p));
+        p += 16;
+        len -= 16;
+    }
+
+    // 剩余的 16 字节与原始数据的 CRC 等价，从 0 开始计算即可
+    crc = crc32c_hw_u64(0, crc32c_v_lane(x0, 0));
+    crc = crc32c_hw_u64(crc, crc32c_v_lane(x0, 1));
+    return crc32c_hw(crc, p, len);
+}
+
+#else
+
+static void crc32c_detect_cpu() {
+    crc32c_hw_supported = false;
+    crc32c_fold_supported = false;
+}
+
+#endif
+
+/* 11. 初始化：生成查表、计算常量、检测 CPU 特性并选择实现 */
+static void crc32c_init() {
+    static std::once_flag init_flag;
+    std::call_once(init_flag, []() {
+        crc32c_init_tables();
+        crc32c_detect_cpu();
+        if (crc32c_fold_supported) {
+            crc32c_selected_impl = CRC32C_IMPL_HW_FOLD;
+        } else if (crc32c_hw_supported) {
+            crc32c_selected_impl = CRC32C_IMPL_HW;
+        } else {
+            crc32c_selected_impl = CRC32C_IMPL_TABLE;
+        }
+        LOGI("crc32c_init: hw %d fold %d impl %d", crc32c_hw_supported, crc32c_fold_supported, crc32c_selected_impl);
+    });
+}
+
+crc32c_impl crc32c_get_impl(void) {
+    crc32c_init();
+    return crc32c_selected_impl;
+}
+
+int crc32c_impl_supported(crc32c_impl impl) {
+    crc32c_init();
+    switch (impl) {
+        case CRC32C_IMPL_TABLE:
+            return 1;
+        case CRC32C_IMPL_HW:
+            return crc32c_hw_supported;
+        case CRC32C_IMPL_HW_FOLD:
+            return crc32c_fold_supported;
+    }
+    return 0;
+}
+
+uint32_t crc32c_update_impl(crc32c_impl impl, uint32_t crc, const void *data, size_t len) {
+    crc32c_init();
+    const uint8_t *p = (const uint8_t *) data;
+    crc = ~crc;
+#if CRC32C_HAS_HW
+    if (impl == CRC32C_IMPL_HW_FOLD && crc32c_fold_supported) {
+        return ~crc32c_hw_fold(crc, p, len);
+    }
+    if (impl == CRC32C_IMPL_HW && crc32c_hw_supported) {
+        return ~crc32c_hw(crc, p, len);
+    }
+#endif
+    return ~crc32c_sw(crc, p, len);
+}
+
+/* 12. 入口函数 */
 uint32_t crc32c_fold(const void *data, size_t len)
 {
     LOGD("crc32c_fold called, len: %zu", len);
-    uint32_t crc = 0xFFFFFFFF;      /* 初始值 CRC-32C */
+    return crc32c_fold_update(0, data, len);
+}
 
-    /* 5-1. 8 字节主循环 */
-    const uint64_t *p64 = (const uint64_t *)data;
-    while (len >= 8) {
-        uint64_t v = *p64++;
-        crc = fold64(v, crc);
-        len -= 8;
+/* 13. 分块入口，crc 为上一块的结果 */
+uint32_t crc32c_fold_update(uint32_t crc, const void *data, size_t len)
+{
+    if (data == nullptr || len == 0) {
+        return crc;
     }
+    return crc32c_update_impl(crc32c_get_impl(), crc, data, len);
+}
+
+/* 14. 合并：A+B 的 CRC 等于 A 的 CRC 后移 len_b 字节再异或 B 的 CRC，初值与结果取反在两边相互抵消 */
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, size_t len_b)
+{
+    crc32c_init();
+    return crc32c_multmodp(crc32c_xnmodp((uint64_t) len_b * 8), crc_a) ^ crc_b;
+}
+
+/* 并行计算时每块的最小长度，太小的块线程调度开销大于计算本身 */
+#define CRC32C_PARALLEL_MIN_CHUNK (256 * 1024)
 
-    /* 5-2. 剩余 0–7 字节 */
-    data = (const uint8_t *)p64;
-    crc  = crc32c_tail((const uint8_t *)data, len, crc);
-    LOGD("crc32c_fold, after crc32c_tail: %u, len: %zu", crc, len);
+/* 每个线程平均分到的块数，块多一些可以平衡各线程的进度差异 */
+#define CRC32C_PARALLEL_CHUNKS_PER_THREAD 4
 
-    return crc ^ 0xFFFFFFFF;        /* 最终异或 */
-}
\ No newline at end of file
+/**
+ * 并行计算的共享状态
+ * 调用线程与线程池中的辅助任务按顺序领取数据块，只有调用线程等待全部块完成，
+ * 因此即使线程池繁忙也能完成；辅助任务晚于调用线程启动时领取不到块，不会访问数据
+ */
+struct Crc32cParallelState {
+    const uint8_t *data = nullptr;
+    size_t len = 0;
+    size_t chunk_size = 0;
+    size_t chunk_count = 0;
+    vector<uint32_t> chunk_crcs;
+    std::atomic<size_t> next_index{0};
+    std::atomic<size_t> done_count{0};
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+
+    // 循环领取数据块直到全部领取完
+    void run() {
+        while (true) {
+            size_t index = next_index.fetch_add(1);
+            if (index >= chunk_count) {
+                return;
+            }
+            size_t offset = index * chunk_size;
+            size_t size = index + 1 == chunk_count ? len - offset : chunk_size;
+            chunk_crcs[index] = crc32c_fold_update(0, data + offset, size);
+            if (done_count.fetch_add(1) + 1 == chunk_count) {
+                std::lock_guard<std::mutex> lock(done_mutex);
+                done_cv.notify_all();
+            }
+        }
+    }
+};
+
+/* 15. 并行入口 */
+uint32_t crc32c_fold_parallel(uint32_t crc, const void *data, size_t len, size_t thread_count)
+{
+    LOGD("crc32c_fold_parallel called, len: %zu, thread_count: %zu", len, thread_count);
+    if (thread_count <= 1 || len < 2 * CRC32C_PARALLEL_MIN_CHUNK) {
+        return crc32c_fold_update(crc, data, len);
+    }
+
+    std::shared_ptr<Crc32cParallelState> state = std::make_shared<Crc32cParallelState>();
+    state->data = (const uint8_t *) data;
+    state->len = len;
+    state->chunk_count = thread_count * CRC32C_PARALLEL_CHUNKS_PER_THREAD;
+    if (state->chunk_count > len / CRC32C_PARALLEL_MIN_CHUNK) {
+        state->chunk_count = len / CRC32C_PARALLEL_MIN_CHUNK;
+    }
+    // 块长度按 64 字节对齐，让每块的起始地址对齐方式一致
+    state->chunk_size = (len / state->chunk_count + 63) & ~(size_t) 63;
+    state->chunk_count = (len + state->chunk_size - 1) / state->chunk_size;
+    state->chunk_crcs.resize(state->chunk_count);
+
+    // 向线程池提交辅助任务，数量不超过块数
+    size_t helper_count = thread_count - 1;
+    if (helper_count > state->chunk_count - 1) {
+        helper_count = state->chunk_count - 1;
+    }
+    zThreadPool *pool = zThreadPool::getInstance();
+    for (size_t i = 0; pool != nullptr && i < helper_count; i++) {
+        pool->addTask(string_format("crc32c_fold_parallel_%zu", i), [state]() {
+            state->run();
+        });
+    }
+
+    // 调用线程参与计算，然后等待辅助任务完成已领取的块
+    state->run();
+    {
+        std::unique_lock<std::mutex> lock(state->done_mutex);
+        state->done_cv.wait(lock, [&state]() {
+            return state->done_count.load() == state->chunk_count;
+        });
+    }
+
+    // 按顺序合并各块的结果
+    size_t offset = 0;
+    for (size_t i = 0; i < state->chunk_count; i++) {
+        size_t size = i + 1 == state->chunk_count ? len - offset : state->chunk_size;
+        crc = crc32c_combine(crc, state->chunk_crcs[i], size);
+        offset += size;
+    }
+    return crc;
+}
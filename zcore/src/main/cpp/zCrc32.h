@@ -9,6 +9,35 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/* CRC-32C 实现，运行时根据 CPU 特性（HWCAP / cpuid）自动选择 */
+typedef enum {
+    CRC32C_IMPL_TABLE = 0,      /* slicing-by-8 查表，所有平台可用 */
+    CRC32C_IMPL_HW = 1,         /* CRC32C 指令（ARMv8 CRC32 / x86 SSE4.2），三路交错 */
+    CRC32C_IMPL_HW_FOLD = 2,    /* CRC32C 指令 + PMULL / PCLMUL 折叠大块数据 */
+} crc32c_impl;
+
+/* 标准 CRC-32C（Castagnoli），所有实现结果一致 */
 uint32_t crc32c_fold(const void *data, size_t len);
 
+/* 分块计算：crc 传入上一块的结果（首块传 0），结果与一次性计算相同 */
+uint32_t crc32c_fold_update(uint32_t crc, const void *data, size_t len);
+
+/* 合并：crc_a 为数据 A 的结果，crc_b 为紧随其后、长度为 len_b 的数据 B 的结果，返回 A+B 的结果 */
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, size_t len_b);
+
+/*
+ * 并行计算：数据切分为若干块，由调用线程与线程池共同计算后按顺序合并，结果与 crc32c_fold_update 完全相同
+ * thread_count 为并行度（包括调用线程），数据较小或 thread_count 为 1 时在调用线程上串行计算
+ */
+uint32_t crc32c_fold_parallel(uint32_t crc, const void *data, size_t len, size_t thread_count);
+
+/* 当前选择的实现 */
+crc32c_impl crc32c_get_impl(void);
+
+/* 当前 CPU 是否支持指定实现 */
+int crc32c_impl_supported(crc32c_impl impl);
+
+/* 使用指定实现计算（用于测试和性能对比），不支持时回退到查表实现 */
+uint32_t crc32c_update_impl(crc32c_impl impl, uint32_t crc, const void *data, size_t len);
+
 #endif //OVERT_ZCRC32_H
@@ -0,0 +1,296 @@
+//
+// Created by lxz on 2025/12/08.
+// zDetectorPerf 实现 - 检测的耗时、CPU 时间、内存分配与系统调用统计
+//
+
+#include <time.h>
+#include <new>
+#include <atomic>
+#include <algorithm>
+
+#include "zLibc.h"
+#include "zStdUtil.h"
+#include "zJson.h"
+#include "zDetectorPerf.h"
+#include "zResultRecord.h"
+
+static thread_local uint64_t tls_alloc_count = 0;
+static std::atomic<bool> g_alloc_count_enabled(true);
+
+#if ZPERF_ENABLE_ALLOC_COUNT
+
+// 替换本 so 内的全局 operator new，只多一次线程局部变量加一；释放不计数
+static inline void* counted_alloc(size_t size) {
+    if (g_alloc_count_enabled.load(std::memory_order_relaxed)) {
+        tls_alloc_count++;
+    }
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size) {
+    void* ptr = counted_alloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    void* ptr = counted_alloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    free(ptr);
+}
+
+#endif
+
+static uint64_t read_clock_ns(clockid_t clock_id) {
+    struct timespec ts;
+    clock_gettime(clock_id, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+zPerfCounters::Sample zPerfCounters::Sample::operator-(const Sample& other) const {
+    Sample diff;
+    diff.wallNs = wallNs > other.wallNs ? wallNs - other.wallNs : 0;
+    diff.cpuNs = cpuNs > other.cpuNs ? cpuNs - other.cpuNs : 0;
+    diff.allocs = allocs > other.allocs ? allocs - other.allocs : 0;
+    diff.syscalls = syscalls > other.syscalls ? syscalls - other.syscalls : 0;
+    return diff;
+}
+
+zPerfCounters::Sample zPerfCounters::read() {
+    Sample sample;
+    sample.wallNs = read_clock_ns(CLOCK_MONOTONIC);
+    sample.cpuNs = read_clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    sample.allocs = tls_alloc_count;
+    sample.syscalls = get_thread_syscall_count();
+    return sample;
+}
+
+uint64_t zPerfCounters::getThreadAllocCount() {
+    return tls_alloc_count;
+}
+
+void zPerfCounters::setAllocCountEnabled(bool enabled) {
+    g_alloc_count_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool zPerfCounters::isAllocCountEnabled() {
+    return ZPERF_ENABLE_ALLOC_COUNT && g_alloc_count_enabled.load(std::memory_order_relaxed);
+}
+
+zDetectorPerf::Scope::Scope(zDetectorPerf& perf, const string& name)
+        : m_perf(&perf), m_name(name), m_finished(false) {
+    m_start = zPerfCounters::read();
+}
+
+zDetectorPerf::Scope::~Scope() {
+    finish();
+}
+
+const zPerfCounters::Sample& zDetectorPerf::Scope::finish() {
+    if (!m_finished) {
+        m_finished = true;
+        m_cost = zPerfCounters::read() - m_start;
+        m_perf->record(m_name, m_cost);
+    }
+    return m_cost;
+}
+
+zDetectorPerf::zDetectorPerf() {
+}
+
+void zDetectorPerf::record(const string& name, const zPerfCounters::Sample& cost) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry& entry = m_entries[name];
+    entry.window[entry.next] = cost;
+    entry.next = (entry.next + 1) % WINDOW_SIZE;
+    if (entry.count < WINDOW_SIZE) {
+        entry.count++;
+    }
+    entry.runs++;
+    entry.totalCpuNs += cost.cpuNs;
+}
+
+// 窗口只有 WINDOW_SIZE 个值，直接排序
+static zDetectorPerf::Percentiles get_percentiles(vector<uint64_t>& values) {
+    zDetectorPerf::Percentiles percentiles;
+    if (values.empty()) {
+        return percentiles;
+    }
+    std::sort(values.begin(), values.end());
+    size_t count = values.size();
+    percentiles.p50 = values[(count * 50 + 99) / 100 - 1];
+    percentiles.p90 = values[(count * 90 + 99) / 100 - 1];
+    percentiles.p99 = values[(count * 99 + 99) / 100 - 1];
+    percentiles.max = values[count - 1];
+    return percentiles;
+}
+
+zDetectorPerf::Summary zDetectorPerf::summarize(const Entry& entry) {
+    Summary summary;
+    summary.runs = entry.runs;
+    summary.totalCpuNs = entry.totalCpuNs;
+    summary.samples = entry.count;
+
+    vector<uint64_t> wall;
+    vector<uint64_t> cpu;
+    vector<uint64_t> allocs;
+    vector<uint64_t> syscalls;
+    for (size_t i = 0; i < entry.count; i++) {
+        wall.push_back(entry.window[i].wallNs);
+        cpu.push_back(entry.window[i].cpuNs);
+        allocs.push_back(entry.window[i].allocs);
+        syscalls.push_back(entry.window[i].syscalls);
+    }
+    summary.wallNs = get_percentiles(wall);
+    summary.cpuNs = get_percentiles(cpu);
+    summary.allocs = get_percentiles(allocs);
+    summary.syscalls = get_percentiles(syscalls);
+    return summary;
+}
+
+bool zDetectorPerf::getSummary(const string& name, Summary& summary) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    map<string, Entry>::const_iterator it = m_entries.find(name);
+    if (it == m_entries.end()) {
+        return false;
+    }
+    summary = summarize(it->second);
+    return true;
+}
+
+std::map<string, zDetectorPerf::Summary> zDetectorPerf::getSummaries() const {
+    // 复制窗口后在锁外排序，record 只等待复制
+    std::map<string, Entry> entries;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& item : m_entries) {
+            entries[item.first] = item.second;
+        }
+    }
+    std::map<string, Summary> summaries;
+    for (const auto& item : entries) {
+        summaries[item.first] = summarize(item.second);
+    }
+    return summaries;
+}
+
+static double ns_to_us(uint64_t ns) {
+    return ns / 1000.0;
+}
+
+map<string, map<string, string>> zDetectorPerf::toInfo() const {
+    static const zResultRecord::KeyId KEY_RUNS = zResultRecord::internKey("runs");
+    static const zResultRecord::KeyId KEY_TOTAL_CPU_US = zResultRecord::internKey("total_cpu_us");
+    static const zResultRecord::KeyId KEY_WALL_P50_US = zResultRecord::internKey("wall_p50_us");
+    static const zResultRecord::KeyId KEY_WALL_P90_US = zResultRecord::internKey("wall_p90_us");
+    static const zResultRecord::KeyId KEY_WALL_P99_US = zResultRecord::internKey("wall_p99_us");
+    static const zResultRecord::KeyId KEY_CPU_P50_US = zResultRecord::internKey("cpu_p50_us");
+    static const zResultRecord::KeyId KEY_CPU_P90_US = zResultRecord::internKey("cpu_p90_us");
+    static const zResultRecord::KeyId KEY_CPU_P99_US = zResultRecord::internKey("cpu_p99_us");
+    static const zResultRecord::KeyId KEY_ALLOC_P50 = zResultRecord::internKey("alloc_p50");
+    static const zResultRecord::KeyId KEY_ALLOC_P90 = zResultRecord::internKey("alloc_p90");
+    static const zResultRecord::KeyId KEY_SYSCALL_P50 = zResultRecord::internKey("syscall_p50");
+    static const zResultRecord::KeyId KEY_SYSCALL_P90 = zResultRecord::internKey("syscall_p90");
+
+    zResultRecord record;
+    std::map<string, Summary> summaries = getSummaries();
+    record.reserve(summaries.size(), summaries.size() * 13, summaries.size() * 160);
+    for (const auto& item : summaries) {
+        const Summary& summary = item.second;
+        record.addItem(item.first, zResultRecord::RISK_SAFE)
+              .addFormat(zResultRecord::KEY_EXPLAIN,
+                         "耗时 p50 %.2fms p90 %.2fms，CPU p50 %.2fms p90 %.2fms，内存分配 p50 %llu，系统调用 p50 %llu，执行 %llu 次",
+                         summary.wallNs.p50 / 1e6, summary.wallNs.p90 / 1e6,
+                         summary.cpuNs.p50 / 1e6, summary.cpuNs.p90 / 1e6,
+                         (unsigned long long) summary.allocs.p50, (unsigned long long) summary.syscalls.p50,
+                         (unsigned long long) summary.runs)
+              .addNumber(KEY_RUNS, summary.runs)
+              .addNumber(KEY_TOTAL_CPU_US, summary.totalCpuNs / 1000)
+              .addNumber(KEY_WALL_P50_US, summary.wallNs.p50 / 1000)
+              .addNumber(KEY_WALL_P90_US, summary.wallNs.p90 / 1000)
+              .addNumber(KEY_WALL_P99_US, summary.wallNs.p99 / 1000)
+              .addNumber(KEY_CPU_P50_US, summary.cpuNs.p50 / 1000)
+              .addNumber(KEY_CPU_P90_US, summary.cpuNs.p90 / 1000)
+              .addNumber(KEY_CPU_P99_US, summary.cpuNs.p99 / 1000)
+              .addNumber(KEY_ALLOC_P50, summary.allocs.p50)
+              .addNumber(KEY_ALLOC_P90, summary.allocs.p90)
+              .addNumber(KEY_SYSCALL_P50, summary.syscalls.p50)
+              .addNumber(KEY_SYSCALL_P90, summary.syscalls.p90);
+    }
+    return record.toInfo();
+}
+
+static zJson percentiles_to_json(const zDetectorPerf::Percentiles& percentiles, bool is_time) {
+    zJson json;
+    if (is_time) {
+        json["p50_us"] = ns_to_us(percentiles.p50);
+        json["p90_us"] = ns_to_us(percentiles.p90);
+        json["p99_us"] = ns_to_us(percentiles.p99);
+        json["max_us"] = ns_to_us(percentiles.max);
+    } else {
+        json["p50"] = percentiles.p50;
+        json["p90"] = percentiles.p90;
+        json["p99"] = percentiles.p99;
+        json["max"] = percentiles.max;
+    }
+    return json;
+}
+
+string zDetectorPerf::toJson(int indent) const {
+    zJson json = zJson::object();
+    std::map<string, Summary> summaries = getSummaries();
+    for (const auto& item : summaries) {
+        const Summary& summary = item.second;
+        zJson detector_json;
+        detector_json["runs"] = summary.runs;
+        detector_json["samples"] = summary.samples;
+        detector_json["total_cpu_us"] = ns_to_us(summary.totalCpuNs);
+        detector_json["wall"] = percentiles_to_json(summary.wallNs, true);
+        detector_json["cpu"] = percentiles_to_json(summary.cpuNs, true);
+        detector_json["allocs"] = percentiles_to_json(summary.allocs, false);
+        detector_json["syscalls"] = percentiles_to_json(summary.syscalls, false);
+        json[item.first] = detector_json;
+    }
+    return json.dump(indent);
+}
+
+void zDetectorPerf::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
@@ -0,0 +1,146 @@
+//
+// Created by lxz on 2025/12/08.
+// zDetectorPerf - 检测的耗时、CPU 时间、内存分配与系统调用统计
+//
+
+#ifndef OVERT_ZDETECTORPERF_H
+#define OVERT_ZDETECTORPERF_H
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+
+#include "zLog.h"
+#include "zStd.h"
+
+// 模块配置开关 - 是否替换全局 operator new 统计每个线程的内存分配次数
+#define ZPERF_ENABLE_ALLOC_COUNT 1
+
+/**
+ * 当前线程的累计计数器
+ * - 墙上时间：CLOCK_MONOTONIC
+ * - CPU 时间：CLOCK_THREAD_CPUTIME_ID，只包括本线程
+ * - 内存分配：本 so 内 operator new 的调用次数（ZPERF_ENABLE_ALLOC_COUNT）
+ * - 系统调用：经过 zLibc syscall 的次数，系统 libc 内部的调用不计入，是近似值
+ * 两次读取的差就是之间这段代码的开销
+ */
+class zPerfCounters {
+public:
+    struct Sample {
+        uint64_t wallNs = 0;
+        uint64_t cpuNs = 0;
+        uint64_t allocs = 0;
+        uint64_t syscalls = 0;
+
+        Sample operator-(const Sample& other) const;
+    };
+
+    static Sample read();
+
+    static uint64_t getThreadAllocCount();
+
+    /**
+     * 关闭后 operator new 不再计数，用于测量计数本身的开销
+     */
+    static void setAllocCountEnabled(bool enabled);
+
+    static bool isAllocCountEnabled();
+};
+
+/**
+ * 按检测名称统计每次执行的开销
+ * 每个检测保留最近 WINDOW_SIZE 次的样本，百分位数按这个滑动窗口计算，反映检测当前的开销；
+ * 执行次数与总 CPU 时间从开始统计起累计
+ *
+ * zManager 在 update_info 中用 Scope 包住一次检测，结果作为 "perf_info" 卡片放入 device_info
+ */
+class zDetectorPerf {
+public:
+    static const size_t WINDOW_SIZE = 64;
+
+    struct Percentiles {
+        uint64_t p50 = 0;
+        uint64_t p90 = 0;
+        uint64_t p99 = 0;
+        uint64_t max = 0;
+    };
+
+    struct Summary {
+        uint64_t runs = 0;          // 累计执行次数
+        uint64_t totalCpuNs = 0;    // 累计 CPU 时间
+        size_t samples = 0;         // 窗口内的样本数
+        Percentiles wallNs;
+        Percentiles cpuNs;
+        Percentiles allocs;
+        Percentiles syscalls;
+    };
+
+    /**
+     * 统计一段代码的开销，析构或 finish 时记录
+     */
+    class Scope {
+    private:
+        zDetectorPerf* m_perf;
+        string m_name;
+        zPerfCounters::Sample m_start;
+        zPerfCounters::Sample m_cost;
+        bool m_finished;
+
+    public:
+        Scope(zDetectorPerf& perf, const string& name);
+
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /**
+         * 结束统计并记录，多次调用只记录一次
+         * @return 本次的开销
+         */
+        const zPerfCounters::Sample& finish();
+    };
+
+private:
+    struct Entry {
+        zPerfCounters::Sample window[WINDOW_SIZE];
+        size_t next = 0;
+        size_t count = 0;
+        uint64_t runs = 0;
+        uint64_t totalCpuNs = 0;
+    };
+
+    mutable std::mutex m_mutex;
+    map<string, Entry> m_entries;
+
+    static Summary summarize(const Entry& entry);
+
+public:
+    zDetectorPerf();
+
+    zDetectorPerf(const zDetectorPerf&) = delete;
+    zDetectorPerf& operator=(const zDetectorPerf&) = delete;
+
+    void record(const string& name, const zPerfCounters::Sample& cost);
+
+    bool getSummary(const string& name, Summary& summary) const;
+
+    // 按名称排序的所有检测统计
+    std::map<string, Summary> getSummaries() const;
+
+    /**
+     * 转换为 device_info 的卡片格式：检测名称 -> 属性 -> 值
+     * 每项的 risk 为 safe，explain 为可读的摘要，其余属性为各项数值（时间单位 us）
+     */
+    map<string, map<string, string>> toInfo() const;
+
+    /**
+     * 序列化为 JSON，时间单位为 us
+     * @param indent 缩进，-1 为紧凑格式
+     */
+    string toJson(int indent = -1) const;
+
+    void reset();
+};
+
+#endif //OVERT_ZDETECTORPERF_H
@@ -9,6 +9,10 @@
 #include <elf.h>
 #include <link.h>
 #include <errno.h>
+#include <cxxabi.h>
+#include <algorithm>
+#include <new>
+#include <mutex>
 
 
 #include "zLog.h"
@@ -18,6 +22,7 @@
 #include "zCrc32.h"
 #include "zElf.h"
 #include "zProcMaps.h"
+#include "zThreadPool.h"
 
 /**
  * 默认构造函数
@@ -97,13 +102,50 @@ zElf::zElf(char *elf_file_name) : zFile(elf_file_name) {
             LOGW("Failed to parse elf file: %s", elf_file_name);
             return;
         }
+        // 文件内容不可信（可能是链接脚本、32 位库或被截断），先校验头部再解析
+        if (!check_elf_file_header()) {
+            LOGW("Invalid elf file: %s", elf_file_name);
+            if (elf_file_mapped) {
+                munmap(elf_file_ptr, elf_file_size);
+            } else {
+                delete[] elf_file_ptr;
+            }
+            elf_file_ptr = nullptr;
+            return;
+        }
         parse_elf_head();
         parse_program_header_table();
         parse_dynamic_table();
-        parse_section_table();
+        if (elf_header->e_shnum > 0) {
+            parse_section_table();
+        }
     }
 }
 
+/**
+ * 校验文件视图的ELF头部
+ * 检查魔数、位数以及程序头表、节头表是否完整落在文件内
+ * @return 校验通过返回true
+ */
+bool zElf::check_elf_file_header() {
+    if (elf_file_ptr == nullptr || elf_file_size < sizeof(Elf64_Ehdr)) {
+        return false;
+    }
+    Elf64_Ehdr* header = (Elf64_Ehdr*) elf_file_ptr;
+    if (memcmp(header->e_ident, ELFMAG, SELFMAG) != 0 || header->e_ident[EI_CLASS] != ELFCLASS64) {
+        return false;
+    }
+    if (header->e_phnum > 0 && (header->e_phentsize != sizeof(Elf64_Phdr)
+            || get_file_span(header->e_phoff, (uint64_t)header->e_phnum * sizeof(Elf64_Phdr)).empty())) {
+        return false;
+    }
+    if (header->e_shnum > 0 && (header->e_shentsize != sizeof(Elf64_Shdr) || header->e_shstrndx >= header->e_shnum
+            || get_file_span(header->e_shoff, (uint64_t)header->e_shnum * sizeof(Elf64_Shdr)).empty())) {
+        return false;
+    }
+    return true;
+}
+
 /**
  * 解析ELF头部
  * 解析ELF文件的头部信息，包括节头表偏移、程序头表等
@@ -178,6 +220,11 @@ void zElf::parse_dynamic_table() {
         LOGW("dynamic table is empty, skip parse_dynamic_table");
         return;
     }
+    if (link_view == LINK_VIEW::FILE_VIEW
+            && get_file_span((char*)dynamic_table - elf_file_ptr, dynamic_element_num * sizeof(Elf64_Dyn)).empty()) {
+        LOGW("dynamic table out of file, skip parse_dynamic_table");
+        return;
+    }
 
     Elf64_Dyn *dynamic_element = dynamic_table;
 
@@ -346,6 +393,11 @@ Elf64_Addr zElf::find_symbol_offset_by_dynamic(const char *symbol_name) {
  * @return 符号的偏移地址，未找到返回0
  */
 Elf64_Addr zElf::find_symbol_offset_by_section(const char *symbol_name) {
+    // 启用索引时走哈希查找，避免对 .symtab 的重复线性扫描
+    if (symbol_index_enabled) {
+        return find_symbol_offset_by_index(symbol_name);
+    }
+
     Elf64_Sym *symbol = symbol_table;
     for (int j = 0; j < section_symbol_num; j++) {
         const char *name = string_table + symbol->st_name;
@@ -360,6 +412,256 @@ Elf64_Addr zElf::find_symbol_offset_by_section(const char *symbol_name) {
     return 0;
 }
 
+/**
+ * GNU 风格的字符串哈希（与 DT_GNU_HASH 一致）
+ * @param name 符号名称
+ * @return 32 位哈希值
+ */
+static uint32_t elf_gnu_hash(const char *name) {
+    uint32_t h = 5381;
+    for (const uint8_t *p = (const uint8_t *) name; *p != '\0'; p++) {
+        h = (h << 5) + h + *p;
+    }
+    return h;
+}
+
+/**
+ * demangle 符号名称
+ * linker64 中的符号带有 "__dl_" 前缀，需要先去掉再 demangle
+ * @param name 原始符号名称
+ * @return demangle 后的名称，不是 C++ 符号或失败时返回空字符串
+ */
+static string demangle_symbol_name(const char *name) {
+    if (strncmp(name, "__dl_", 5) == 0) {
+        name += 5;
+    }
+    if (strncmp(name, "_Z", 2) != 0) {
+        return "";
+    }
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status != 0 || demangled == nullptr) {
+        return "";
+    }
+    string result = demangled;
+    free(demangled);
+    return result;
+}
+
+/**
+ * 获取 .symtab 符号索引
+ * 首次调用时构建：按 GNU hash 排序的下标表 + 按名称排序的下标表
+ * 构建一次后在同一个 zElf 的多次查找间复用
+ * @return 符号索引，.symtab 不可用时返回nullptr
+ */
+ElfSymbolIndex* zElf::get_symbol_index() {
+    std::lock_guard<std::mutex> lock(*symbol_index_mutex);
+    if (symbol_index != nullptr) {
+        return symbol_index.get();
+    }
+    if (symbol_table == nullptr || string_table == nullptr || section_symbol_num == 0) {
+        LOGD("get_symbol_index: symtab is empty");
+        return nullptr;
+    }
+
+    std::shared_ptr<ElfSymbolIndex> index = std::make_shared<ElfSymbolIndex>();
+    index->hash_entries.reserve(section_symbol_num);
+    index->name_entries.reserve(section_symbol_num);
+
+    for (uint32_t i = 0; i < section_symbol_num; i++) {
+        const char *name = string_table + symbol_table[i].st_name;
+        if (name[0] == '\0') {
+            continue;
+        }
+        index->hash_entries.push_back(((uint64_t) elf_gnu_hash(name) << 32) | i);
+        index->name_entries.push_back(i);
+    }
+
+    // 哈希相同时按符号下标升序，保证与线性扫描返回同一个（第一个）符号
+    std::sort(index->hash_entries.data(), index->hash_entries.data() + index->hash_entries.size());
+
+    const Elf64_Sym *symbols = symbol_table;
+    const char *strings = string_table;
+    std::sort(index->name_entries.data(), index->name_entries.data() + index->name_entries.size(),
+              [symbols, strings](uint32_t a, uint32_t b) {
+                  int ret = strcmp(strings + symbols[a].st_name, strings + symbols[b].st_name);
+                  return ret < 0 || (ret == 0 && a < b);
+              });
+
+    symbol_index = index;
+    LOGI("get_symbol_index: indexed %zu symbols", index->hash_entries.size());
+    return symbol_index.get();
+}
+
+/**
+ * 通过符号索引查找符号偏移
+ * @param symbol_name 符号名称
+ * @return 符号的偏移地址，未找到返回0
+ */
+unsigned long long zElf::find_symbol_offset_by_index(const char *symbol_name) {
+    if (symbol_name == nullptr) {
+        return 0;
+    }
+    ElfSymbolIndex* index = get_symbol_index();
+    if (index == nullptr) {
+        return 0;
+    }
+
+    uint32_t hash = elf_gnu_hash(symbol_name);
+    const uint64_t *begin = index->hash_entries.data();
+    const uint64_t *end = begin + index->hash_entries.size();
+    for (const uint64_t *it = std::lower_bound(begin, end, (uint64_t) hash << 32); it != end && (uint32_t) (*it >> 32) == hash; it++) {
+        Elf64_Sym *symbol = symbol_table + (uint32_t) *it;
+        if (strcmp(string_table + symbol->st_name, symbol_name) == 0) {
+            LOGD("find_symbol_offset_by_index [%u] %s 0x%llx", (uint32_t) *it, symbol_name, symbol->st_value);
+            return symbol->st_value - physical_address;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 通过 demangle 后的名称查找符号偏移
+ * 支持完整签名（"art::JNIEnvExt::NewLocalRef(art::mirror::Object*)"）
+ * 以及不带参数列表的名称（"art::JNIEnvExt::NewLocalRef"，返回第一个重载）
+ * demangle 表在首次调用时构建
+ * @param demangled_name demangle 后的名称
+ * @return 符号的偏移地址，未找到返回0
+ */
+unsigned long long zElf::find_symbol_offset_by_demangled(const char *demangled_name) {
+    if (demangled_name == nullptr || demangled_name[0] == '\0') {
+        return 0;
+    }
+    ElfSymbolIndex* index = get_symbol_index();
+    if (index == nullptr) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(*symbol_index_mutex);
+    if (!index->demangled_built) {
+        for (size_t i = 0; i < index->name_entries.size(); i++) {
+            uint32_t symbol_id = index->name_entries[i];
+            string demangled = demangle_symbol_name(string_table + symbol_table[symbol_id].st_name);
+            if (!demangled.empty()) {
+                index->demangled_entries.push_back(pair<string, uint32_t>(demangled, symbol_id));
+            }
+        }
+        pair<string, uint32_t> *entries = index->demangled_entries.data();
+        std::sort(entries, entries + index->demangled_entries.size(),
+                  [](const pair<string, uint32_t> &a, const pair<string, uint32_t> &b) {
+                      int ret = strcmp(a.first.c_str(), b.first.c_str());
+                      return ret < 0 || (ret == 0 && a.second < b.second);
+                  });
+        index->demangled_built = true;
+        LOGI("find_symbol_offset_by_demangled: demangled %zu symbols", index->demangled_entries.size());
+    }
+
+    size_t name_len = strlen(demangled_name);
+    const pair<string, uint32_t> *begin = index->demangled_entries.data();
+    const pair<string, uint32_t> *end = begin + index->demangled_entries.size();
+    const pair<string, uint32_t> *it = std::lower_bound(begin, end, demangled_name,
+            [](const pair<string, uint32_t> &entry, const char *name) {
+                return strcmp(entry.first.c_str(), name) < 0;
+            });
+    for (; it != end && strncmp(it->first.c_str(), demangled_name, name_len) == 0; it++) {
+        char next = it->first.c_str()[name_len];
+        if (next == '\0' || next == '(') {
+            Elf64_Sym *symbol = symbol_table + it->second;
+            LOGD("find_symbol_offset_by_demangled %s -> %s", demangled_name, string_table + symbol->st_name);
+            return symbol->st_value - physical_address;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 按前缀查找符号
+ * @param prefix 符号名称前缀
+ * @return 名称以 prefix 开头的符号列表，按名称排序
+ */
+vector<ElfSymbol> zElf::find_symbols_by_prefix(const char *prefix) {
+    vector<ElfSymbol> symbols;
+    if (prefix == nullptr) {
+        return symbols;
+    }
+    ElfSymbolIndex* index = get_symbol_index();
+    if (index == nullptr) {
+        return symbols;
+    }
+
+    size_t prefix_len = strlen(prefix);
+    const Elf64_Sym *symbol_base = symbol_table;
+    const char *strings = string_table;
+    const uint32_t *begin = index->name_entries.data();
+    const uint32_t *end = begin + index->name_entries.size();
+    const uint32_t *it = std::lower_bound(begin, end, prefix, [symbol_base, strings](uint32_t symbol_id, const char *name) {
+        return strcmp(strings + symbol_base[symbol_id].st_name, name) < 0;
+    });
+    for (; it != end; it++) {
+        const Elf64_Sym *symbol = symbol_table + *it;
+        const char *name = string_table + symbol->st_name;
+        if (strncmp(name, prefix, prefix_len) != 0) {
+            break;
+        }
+        symbols.push_back(ElfSymbol{name, symbol->st_value - physical_address});
+    }
+    LOGD("find_symbols_by_prefix %s found %zu", prefix, symbols.size());
+    return symbols;
+}
+
+/**
+ * 批量查找符号偏移
+ * 先对动态符号表做一次遍历同时匹配所有名称，剩余未命中的名称再走 .symtab 索引
+ * 查找顺序与 find_symbol_offset 一致（动态表优先）
+ * @param symbol_names 符号名称列表
+ * @return 与 symbol_names 一一对应的偏移列表，未找到的位置为0
+ */
+vector<unsigned long long> zElf::find_symbol_offsets(const vector<string>& symbol_names) {
+    vector<unsigned long long> offsets(symbol_names.size(), 0);
+    if (symbol_names.empty()) {
+        return offsets;
+    }
+
+    // 待查找名称按哈希排序：(hash << 32) | 名称下标
+    vector<uint64_t> pending;
+    pending.reserve(symbol_names.size());
+    for (uint32_t i = 0; i < symbol_names.size(); i++) {
+        pending.push_back(((uint64_t) elf_gnu_hash(symbol_names[i].c_str()) << 32) | i);
+    }
+    std::sort(pending.data(), pending.data() + pending.size());
+    vector<uint8_t> matched(symbol_names.size(), 0);
+    size_t resolved = 0;
+
+    // 一次遍历动态符号表，遍历条件与 find_symbol_offset_by_dynamic 保持一致
+    if (dynamic_symbol_table != nullptr && dynamic_string_table != nullptr) {
+        const uint64_t *begin = pending.data();
+        const uint64_t *end = begin + pending.size();
+        Elf64_Sym *dynamic_symbol = dynamic_symbol_table;
+        for (; resolved < pending.size() && dynamic_symbol->st_name <= dynamic_string_table_offset + dynamic_string_table_size; dynamic_symbol++) {
+            const char *name = dynamic_string_table + dynamic_symbol->st_name;
+            uint32_t hash = elf_gnu_hash(name);
+            for (const uint64_t *it = std::lower_bound(begin, end, (uint64_t) hash << 32); it != end && (uint32_t) (*it >> 32) == hash; it++) {
+                uint32_t name_id = (uint32_t) *it;
+                if (!matched[name_id] && strcmp(name, symbol_names[name_id].c_str()) == 0) {
+                    // 与线性查找一致：只取第一个同名符号
+                    matched[name_id] = 1;
+                    offsets[name_id] = dynamic_symbol->st_value - load_segment_virtual_offset;
+                    resolved++;
+                }
+            }
+        }
+    }
+
+    // 动态表中未找到的再查 .symtab
+    for (size_t i = 0; i < offsets.size(); i++) {
+        if (!matched[i]) {
+            offsets[i] = find_symbol_offset_by_section(symbol_names[i].c_str());
+        }
+    }
+    LOGI("find_symbol_offsets: resolved %zu/%zu symbols from dynsym", resolved, symbol_names.size());
+    return offsets;
+}
+
 /**
  * 查找符号偏移
  * 先在动态表中查找，如果未找到则在节头表中查找
@@ -421,14 +723,40 @@ char *zElf::parse_elf_file(char *elf_path) {
     }
     LOGD("parse_elf_file: file size obtained: %ld", file_size);
     
-    // 将文件映射到内存中
-    elf_file_ptr = (char *) mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, getFd(), 0);
-    if (elf_file_ptr == MAP_FAILED) {
-        // 处理映射失败的情况
-        LOGE("parse_elf_file: failed to mmap file");
+    // 将文件只读映射到内存中，各个段和节直接指向映射，不再拷贝
+    void* mapped = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, getFd(), 0);
+    if (mapped != MAP_FAILED) {
+        elf_file_ptr = (char *) mapped;
+        elf_file_mapped = true;
+        elf_file_size = file_size;
+        LOGI("parse_elf_file: file mapped successfully");
+        return elf_file_ptr;
+    }
+    LOGW("parse_elf_file: failed to mmap file: %s, fallback to read", strerror(errno));
+
+    // 无法映射的文件（部分虚拟文件系统不支持 mmap）回退为读取到堆缓冲区
+    char* buffer = new (std::nothrow) char[file_size];
+    if (buffer == nullptr) {
+        LOGE("parse_elf_file: failed to allocate %ld bytes", file_size);
         return nullptr;
     }
-    LOGI("parse_elf_file: file mapped successfully");
+    long read_size = 0;
+    while (read_size < file_size) {
+        ssize_t ret = pread(getFd(), buffer + read_size, file_size - read_size, read_size);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            LOGE("parse_elf_file: failed to read file at %ld", read_size);
+            delete[] buffer;
+            return nullptr;
+        }
+        read_size += ret;
+    }
+    elf_file_ptr = buffer;
+    elf_file_mapped = false;
+    elf_file_size = file_size;
+    LOGI("parse_elf_file: file read successfully");
     return elf_file_ptr;
 }
 
@@ -486,22 +814,54 @@ char *zElf::parse_elf_file_(char *elf_path) {
  */
 uint64_t zElf::get_text_segment_crc(){
     LOGI("loadable_rx_segment is called");
-    char* base_addr = link_view == LINK_VIEW::MEMORY_VIEW ? elf_mem_ptr : elf_file_ptr;
 
     if(loadable_rx_segment == nullptr){
         LOGE("loadable_rx_segment == nullptr");
         return 0;
     }
 
-    void* code_mem_ptr = (void*)(base_addr + loadable_rx_segment->p_vaddr);
-    Elf64_Xword code_mem_size = loadable_rx_segment->p_memsz;
-    LOGD("check_text_segment offset:%llx code_mem_ptr: %p, code_mem_size: %llx", loadable_rx_segment->p_vaddr, code_mem_ptr, code_mem_size);
+    ElfSpan text = get_segment_span(loadable_rx_segment);
+    if (text.empty()) {
+        LOGE("get_text_segment_crc: text segment out of range");
+        return 0;
+    }
+    LOGD("check_text_segment offset:%llx code_mem_ptr: %p, code_mem_size: %zx", loadable_rx_segment->p_vaddr, text.data, text.size);
 
-    mprotect(code_mem_ptr, code_mem_size, PROT_READ | PROT_EXEC);
+    if (link_view == LINK_VIEW::MEMORY_VIEW) {
+        mprotect((void*)text.data, text.size, PROT_READ | PROT_EXEC);
+    }
+    if (link_view != LINK_VIEW::FILE_VIEW || !elf_file_mapped) {
+        // 计算代码段的CRC32校验和，大的代码段分块并行计算，并行度为线程池的工作线程数
+        // 已经在工作线程上（如检测任务中）时串行计算，不在线程池内再扇出辅助任务
+        size_t thread_count = 1;
+        zThreadPool* pool = zThreadPool::getInstance();
+        if (pool != nullptr && zThreadPool::getCurrentPool() == nullptr) {
+            thread_count = pool->getWorkerCount();
+        }
+        uint64_t crc = crc32c_fold_parallel(0, text.data, text.size, thread_count);
+        LOGD("check_text_segment crc: %lu", crc);
+        return crc;
+    }
 
-    // 计算代码段的CRC32校验和
-    uint64_t crc = crc32c_fold(code_mem_ptr, code_mem_size);
-    LOGD("check_text_segment code_mem_ptr: %p, code_mem_size: %llx", code_mem_ptr, code_mem_size);
+    // 文件映射：按窗口顺序校验，校验完的页立即释放，峰值常驻内存只有一个窗口大小
+    // 释放的是未修改的私有只读映射页，再次访问时会从页缓存重新读入
+    const size_t window_size = 1024 * 1024;
+    uintptr_t page_mask = (uintptr_t)getpagesize() - 1;
+    uint32_t crc = 0;
+    size_t offset = 0;
+    while (offset < text.size) {
+        size_t size = text.size - offset < window_size ? text.size - offset : window_size;
+        const char* window = text.data + offset;
+        crc = crc32c_fold_update(crc, window, size);
+
+        // 只释放完全落在代码段内的页，避免影响前后的其它数据
+        uintptr_t page_start = ((uintptr_t)window + page_mask) & ~page_mask;
+        uintptr_t page_end = ((uintptr_t)window + size) & ~page_mask;
+        if (page_end > page_start) {
+            madvise((void*)page_start, page_end - page_start, MADV_DONTNEED);
+        }
+        offset += size;
+    }
     LOGD("check_text_segment crc: %lu", crc);
     return crc;
 }
@@ -545,6 +905,81 @@ uint64_t zElf::get_program_header_crc(){
     return crc;
 }
 
+/**
+ * 获取文件中的一段数据
+ * 只在 FILE_VIEW 下有效，指向文件映射（或回退读取的缓冲区），不拷贝数据
+ * @param offset 文件偏移
+ * @param size 数据大小
+ * @return 数据片段，越界时返回空片段
+ */
+ElfSpan zElf::get_file_span(uint64_t offset, uint64_t size) {
+    ElfSpan span;
+    if (link_view != LINK_VIEW::FILE_VIEW || elf_file_ptr == nullptr) {
+        return span;
+    }
+    if (offset > elf_file_size || size > elf_file_size - offset) {
+        LOGW("get_file_span: [0x%llx, +0x%llx) out of file size 0x%zx", offset, size, elf_file_size);
+        return span;
+    }
+    span.data = elf_file_ptr + offset;
+    span.size = size;
+    return span;
+}
+
+/**
+ * 获取段数据
+ * FILE_VIEW 按 p_offset 指向文件映射，MEMORY_VIEW 按 p_vaddr 指向加载后的内存
+ * 两种视图的长度都是 p_filesz：超出 p_filesz 到 p_memsz 的部分是加载时零填充的，文件中没有，
+ * 只有覆盖相同的字节，文件与内存的 CRC 才能直接比较
+ * @param segment 程序头表项
+ * @return 段数据片段
+ */
+ElfSpan zElf::get_segment_span(const Elf64_Phdr* segment) {
+    ElfSpan span;
+    if (segment == nullptr) {
+        return span;
+    }
+    if (link_view == LINK_VIEW::FILE_VIEW) {
+        return get_file_span(segment->p_offset, segment->p_filesz);
+    }
+    if (link_view == LINK_VIEW::MEMORY_VIEW && elf_mem_ptr != nullptr) {
+        span.data = elf_mem_ptr + segment->p_vaddr;
+        span.size = segment->p_filesz;
+    }
+    return span;
+}
+
+/**
+ * 获取节数据
+ * 节头表只存在于文件中，仅 FILE_VIEW 有效
+ * @param section_name 节名称（如".text"）
+ * @return 节数据片段，未找到或 SHT_NOBITS 时返回空片段
+ */
+ElfSpan zElf::get_section_span(const char* section_name) {
+    ElfSpan span;
+    if (section_name == nullptr || link_view != LINK_VIEW::FILE_VIEW || elf_header == nullptr) {
+        return span;
+    }
+    ElfSpan section_table = get_file_span(elf_header->e_shoff, (uint64_t)elf_header->e_shnum * sizeof(Elf64_Shdr));
+    if (section_table.empty() || elf_header->e_shstrndx >= elf_header->e_shnum) {
+        return span;
+    }
+    const Elf64_Shdr* sections = (const Elf64_Shdr*)section_table.data;
+    ElfSpan names = get_file_span(sections[elf_header->e_shstrndx].sh_offset, sections[elf_header->e_shstrndx].sh_size);
+    if (names.empty()) {
+        return span;
+    }
+    for (int i = 0; i < elf_header->e_shnum; i++) {
+        if (sections[i].sh_name >= names.size || sections[i].sh_type == SHT_NOBITS) {
+            continue;
+        }
+        if (strncmp(names.data + sections[i].sh_name, section_name, names.size - sections[i].sh_name) == 0) {
+            return get_file_span(sections[i].sh_offset, sections[i].sh_size);
+        }
+    }
+    return span;
+}
+
 /**
  * 析构函数
  * 清理资源，取消内存映射
@@ -552,7 +987,9 @@ uint64_t zElf::get_program_header_crc(){
 zElf::~zElf() {
     // 清理文件视图资源
     if (link_view == LINK_VIEW::FILE_VIEW && elf_file_ptr != nullptr) {
-        if (munmap(elf_file_ptr, getFileSize()) != 0) {
+        if (!elf_file_mapped) {
+            delete[] elf_file_ptr;
+        } else if (munmap(elf_file_ptr, elf_file_size) != 0) {
             LOGW("Failed to munmap: %s", strerror(errno));
         }
         elf_file_ptr = nullptr;
@@ -7,9 +7,43 @@
 
 #include <linux/elf.h>
 #include <stddef.h>
+#include <memory>
+#include <mutex>
 #include "zStd.h"
 #include "zFile.h"
 
+/**
+ * 符号查找结果
+ * name 指向 ELF 字符串表内部，生命周期与所属 zElf 相同
+ */
+struct ElfSymbol {
+    const char* name;                       // 符号名称
+    unsigned long long offset;              // 符号偏移
+};
+
+/**
+ * .symtab 符号索引
+ * .symtab 没有哈希表，线性扫描为 O(n)，这里惰性构建一次后在多次查找间复用
+ * 只保存符号下标，不拷贝符号名称
+ */
+struct ElfSymbolIndex {
+    vector<uint64_t> hash_entries;          // (GNU hash << 32) | 符号下标，升序排列
+    vector<uint32_t> name_entries;          // 按符号名称字典序排列的符号下标，用于前缀查找
+    vector<pair<string, uint32_t>> demangled_entries;  // 按 demangle 名称排序，首次按 demangle 名称查找时构建
+    bool demangled_built = false;
+};
+
+/**
+ * ELF 数据片段
+ * 指向文件映射或内存中的一段连续数据，不持有所有权，生命周期跟随所属的 zElf
+ */
+struct ElfSpan {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    bool empty() const { return data == nullptr || size == 0; }
+};
+
 class zElf : public zFile {
 public:
     enum LINK_VIEW {
@@ -24,6 +58,10 @@ public:
     char* elf_mem_ptr = nullptr;
     char* elf_file_ptr = nullptr;
 
+    // 文件视图的数据来源：默认只读 mmap 整个文件，文件无法映射时回退为读取到堆缓冲区
+    bool elf_file_mapped = false;
+    size_t elf_file_size = 0;
+
     // 构造函数
     zElf();
     zElf(char* elf_file_name);
@@ -73,6 +111,7 @@ public:
 
     // ELF 特有方法
     char* parse_elf_file(char* elf_path);
+    bool check_elf_file_header();
     static char* parse_elf_file_(char* elf_path);
 
     char* find_symbol(const char *symbol_name);
@@ -80,8 +119,24 @@ public:
     unsigned long long find_symbol_offset_by_dynamic(const char *symbol_name);
     unsigned long long find_symbol_offset_by_section(const char *symbol_name);
 
+    // .symtab 符号索引，默认启用，首次查找时构建
+    bool symbol_index_enabled = true;
+    std::shared_ptr<ElfSymbolIndex> symbol_index;
+    // 只保护本实例的索引与 demangle 表构建，不同 zElf 互不阻塞；zElf 按值返回，拷贝之间共用同一把锁
+    std::shared_ptr<std::mutex> symbol_index_mutex = std::make_shared<std::mutex>();
+    ElfSymbolIndex* get_symbol_index();
+    unsigned long long find_symbol_offset_by_index(const char *symbol_name);
+    unsigned long long find_symbol_offset_by_demangled(const char *demangled_name);
+    vector<ElfSymbol> find_symbols_by_prefix(const char *prefix);
+    vector<unsigned long long> find_symbol_offsets(const vector<string>& symbol_names);
+
     static int is_link_view(uintptr_t base_addr);
 
+    // 数据片段访问，FILE_VIEW 下直接指向文件映射，越界时返回空片段
+    ElfSpan get_file_span(uint64_t offset, uint64_t size);
+    ElfSpan get_segment_span(const Elf64_Phdr* segment);
+    ElfSpan get_section_span(const char* section_name);
+
     uint64_t get_elf_header_crc();
     uint64_t get_program_header_crc();
     uint64_t get_text_segment_crc();
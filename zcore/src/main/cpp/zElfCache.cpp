@@ -0,0 +1,276 @@
+//
+// Created by lxz on 2025/11/24.
+//
+
+#include <sys/stat.h>
+
+#include "zLog.h"
+#include "zProcMaps.h"
+#include "zElfCache.h"
+
+// 静态单例实例指针
+zElfCache* zElfCache::instance = nullptr;
+
+/**
+ * 获取单例实例
+ * 采用线程安全的懒加载模式，首次调用时创建实例
+ * @return zElfCache单例指针
+ */
+zElfCache* zElfCache::getInstance() {
+    // 使用 std::call_once 确保线程安全的单例初始化
+    static std::once_flag init_flag;
+    std::call_once(init_flag, []() {
+        try {
+            instance = new zElfCache();
+            LOGI("zElfCache: Created singleton instance");
+        } catch (const std::exception& e) {
+            LOGE("zElfCache: Failed to create singleton instance: %s", e.what());
+            instance = nullptr;
+        } catch (...) {
+            LOGE("zElfCache: Failed to create singleton instance with unknown error");
+            instance = nullptr;
+        }
+    });
+
+    if (instance == nullptr) {
+        LOGE("zElfCache: Singleton instance is null");
+    }
+    return instance;
+}
+
+zElfCache::zElfCache() {
+    LOGD("Constructor called");
+}
+
+zElfCache::~zElfCache() {
+    LOGD("Destructor called");
+    clear();
+}
+
+/**
+ * 获取文件的 (dev, inode, mtime)
+ * @return stat 成功返回true
+ */
+static bool stat_file_identity(const string& path, uint64_t& dev, uint64_t& ino, int64_t& mtime_ns) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    dev = st.st_dev;
+    ino = st.st_ino;
+    mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+/**
+ * 查找条目下标
+ * FILE_VIEW 按路径与映射基址匹配，MEMORY_VIEW 按内存基址匹配
+ */
+int zElfCache::find_entry_locked(zElf::LINK_VIEW link_view, const string& path, void* mem_base) const {
+    for (size_t i = 0; i < entries.size(); i++) {
+        const CacheEntry& entry = entries[i];
+        if (entry.link_view != link_view || entry.mem_base != mem_base) {
+            continue;
+        }
+        if (link_view == zElf::LINK_VIEW::FILE_VIEW && entry.path != path) {
+            continue;
+        }
+        return (int)i;
+    }
+    return -1;
+}
+
+/**
+ * 获取文件视图的 zElf
+ * 命中时校验 (dev, inode, mtime)，任何一项不一致都视为文件已被替换，重新解析
+ */
+std::shared_ptr<zElf> zElfCache::get_file_elf(const string& path, void* mem_base) {
+    if (path.empty()) {
+        LOGE("get_file_elf: invalid path");
+        return nullptr;
+    }
+
+    uint64_t dev = 0;
+    uint64_t ino = 0;
+    int64_t mtime_ns = 0;
+    if (!stat_file_identity(path, dev, ino, mtime_ns)) {
+        LOGW("get_file_elf: stat failed for %s", path.c_str());
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        int index = find_entry_locked(zElf::LINK_VIEW::FILE_VIEW, path, mem_base);
+        if (index >= 0) {
+            CacheEntry& entry = entries[index];
+            if (entry.dev == dev && entry.ino == ino && entry.mtime_ns == mtime_ns) {
+                entry.last_used = ++use_counter;
+                hit_count++;
+                return entry.elf;
+            }
+            LOGI("get_file_elf: stale entry for %s, reparse", path.c_str());
+            entries.erase(entries.begin() + index);
+        }
+        miss_count++;
+    }
+
+    // 解析放在锁外，避免阻塞其它 so 的查询
+    std::shared_ptr<zElf> elf = std::make_shared<zElf>((char*)path.c_str());
+    if (elf->elf_file_ptr == nullptr) {
+        LOGW("get_file_elf: failed to parse %s", path.c_str());
+        return nullptr;
+    }
+    elf->elf_mem_ptr = (char*)mem_base;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    int index = find_entry_locked(zElf::LINK_VIEW::FILE_VIEW, path, mem_base);
+    if (index >= 0) {
+        CacheEntry& entry = entries[index];
+        if (entry.dev == dev && entry.ino == ino && entry.mtime_ns == mtime_ns) {
+            // 其它线程已经先一步完成解析，使用已缓存的对象
+            entry.last_used = ++use_counter;
+            return entry.elf;
+        }
+        entries.erase(entries.begin() + index);
+    }
+
+    CacheEntry entry;
+    entry.link_view = zElf::LINK_VIEW::FILE_VIEW;
+    entry.path = path;
+    entry.dev = dev;
+    entry.ino = ino;
+    entry.mtime_ns = mtime_ns;
+    entry.mem_base = mem_base;
+    entry.last_used = ++use_counter;
+    entry.elf = elf;
+    entries.push_back(entry);
+    evict_lru_locked();
+    return elf;
+}
+
+/**
+ * 获取内存视图的 zElf
+ */
+std::shared_ptr<zElf> zElfCache::get_memory_elf(void* mem_base) {
+    if (mem_base == nullptr) {
+        LOGE("get_memory_elf: invalid mem_base");
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        int index = find_entry_locked(zElf::LINK_VIEW::MEMORY_VIEW, "", mem_base);
+        if (index >= 0) {
+            entries[index].last_used = ++use_counter;
+            hit_count++;
+            return entries[index].elf;
+        }
+        miss_count++;
+    }
+
+    std::shared_ptr<zElf> elf = std::make_shared<zElf>(mem_base);
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    int index = find_entry_locked(zElf::LINK_VIEW::MEMORY_VIEW, "", mem_base);
+    if (index >= 0) {
+        entries[index].last_used = ++use_counter;
+        return entries[index].elf;
+    }
+
+    CacheEntry entry;
+    entry.link_view = zElf::LINK_VIEW::MEMORY_VIEW;
+    entry.mem_base = mem_base;
+    entry.last_used = ++use_counter;
+    entry.elf = elf;
+    entries.push_back(entry);
+    evict_lru_locked();
+    return elf;
+}
+
+/**
+ * 淘汰最久未使用的条目，直到不超过 max_entries
+ */
+void zElfCache::evict_lru_locked() {
+    while (entries.size() > max_entries) {
+        size_t oldest = 0;
+        for (size_t i = 1; i < entries.size(); i++) {
+            if (entries[i].last_used < entries[oldest].last_used) {
+                oldest = i;
+            }
+        }
+        LOGD("evict_lru: %s %p", entries[oldest].path.c_str(), entries[oldest].mem_base);
+        entries.erase(entries.begin() + oldest);
+    }
+}
+
+void zElfCache::evict(const string& path) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    for (size_t i = 0; i < entries.size();) {
+        if (entries[i].link_view == zElf::LINK_VIEW::FILE_VIEW && entries[i].path == path) {
+            entries.erase(entries.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void zElfCache::evict(void* mem_base) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    for (size_t i = 0; i < entries.size();) {
+        if (entries[i].mem_base == mem_base) {
+            entries.erase(entries.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+/**
+ * 淘汰所有已经不在 /proc/self/maps 中的 so
+ * 只读取一次 maps，收集当前所有 so 的基址后再比对缓存
+ * 没有映射基址的纯文件视图不受 maps 影响，由 stat 校验负责失效
+ */
+size_t zElfCache::evict_unmapped() {
+    vector<void*> mapped_bases;
+    zProcMaps proc_maps;
+    for (auto& library : proc_maps.loaded_libraries) {
+        mapped_bases.push_back(library.second.address_range_start);
+    }
+
+    size_t evicted = 0;
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    for (size_t i = 0; i < entries.size();) {
+        bool mapped = entries[i].mem_base == nullptr;
+        for (size_t j = 0; !mapped && j < mapped_bases.size(); j++) {
+            mapped = mapped_bases[j] == entries[i].mem_base;
+        }
+        if (!mapped) {
+            LOGI("evict_unmapped: %s %p", entries[i].path.c_str(), entries[i].mem_base);
+            entries.erase(entries.begin() + i);
+            evicted++;
+        } else {
+            i++;
+        }
+    }
+    return evicted;
+}
+
+void zElfCache::clear() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    entries.clear();
+}
+
+size_t zElfCache::size() const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return entries.size();
+}
+
+uint64_t zElfCache::get_hit_count() const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return hit_count;
+}
+
+uint64_t zElfCache::get_miss_count() const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return miss_count;
+}
@@ -0,0 +1,127 @@
+//
+// Created by lxz on 2025/11/24.
+//
+
+#ifndef OVERT_ZELFCACHE_H
+#define OVERT_ZELFCACHE_H
+
+#include <mutex>
+#include <memory>
+
+#include "zStd.h"
+#include "zElf.h"
+
+/**
+ * 进程级 ELF 解析缓存
+ * 同一个 so 的 zElf 只解析一次，以引用计数的方式（std::shared_ptr）共享给调用方
+ * 缓存的 zElf 同时保留了惰性构建的符号索引，后续查找不再重新解析
+ *
+ * 缓存键：
+ * - FILE_VIEW：文件路径，命中时再校验 (dev, inode, mtime) 与映射基址，文件被替换时重新解析
+ * - MEMORY_VIEW：内存基址
+ *
+ * 淘汰：
+ * - evict_unmapped() 根据 /proc/self/maps 淘汰已经被卸载的 so，get_linker_info 在 soinfo 差异中出现卸载时调用
+ * - 超过 max_entries 时淘汰最久未使用的条目
+ * - 被淘汰的 zElf 在调用方释放最后一个引用后才析构，不会影响正在使用的调用方
+ */
+class zElfCache {
+private:
+    // 私有构造函数，防止外部实例化
+    zElfCache();
+
+    // 禁用拷贝构造函数
+    zElfCache(const zElfCache&) = delete;
+
+    // 禁用赋值操作符
+    zElfCache& operator=(const zElfCache&) = delete;
+
+    // 静态单例实例指针
+    static zElfCache* instance;
+
+    /**
+     * 缓存条目
+     */
+    struct CacheEntry {
+        zElf::LINK_VIEW link_view = zElf::LINK_VIEW::UNKNOWN_VIEW;  // 视图类型
+        string path;                        // 文件路径（FILE_VIEW）
+        uint64_t dev = 0;                   // 文件设备号
+        uint64_t ino = 0;                   // 文件 inode
+        int64_t mtime_ns = 0;               // 文件修改时间（纳秒）
+        void* mem_base = nullptr;           // 内存基址
+        uint64_t last_used = 0;             // 最近使用序号，用于 LRU 淘汰
+        std::shared_ptr<zElf> elf;          // 解析后的 ELF
+    };
+
+    // 缓存条目，数量很少（受 max_entries 限制），线性查找即可
+    vector<CacheEntry> entries;
+
+    // 查找条目下标，调用方需持有 cache_mutex，未找到返回-1
+    int find_entry_locked(zElf::LINK_VIEW link_view, const string& path, void* mem_base) const;
+
+    // 缓存互斥锁
+    mutable std::mutex cache_mutex;
+
+    // 使用序号、命中与未命中计数
+    uint64_t use_counter = 0;
+    uint64_t hit_count = 0;
+    uint64_t miss_count = 0;
+
+    // 淘汰最久未使用的条目，调用方需持有 cache_mutex
+    void evict_lru_locked();
+
+public:
+    // 缓存条目上限，FILE_VIEW 条目会占用文件描述符和文件映射
+    size_t max_entries = 32;
+
+    /**
+     * 获取单例实例
+     * @return zElfCache单例指针
+     */
+    static zElfCache* getInstance();
+
+    // 析构函数
+    ~zElfCache();
+
+    /**
+     * 获取文件视图的 zElf
+     * @param path 文件路径（绝对路径）
+     * @param mem_base so 在内存中的基址，用于 find_symbol，可为nullptr
+     * @return 共享的 zElf，文件不存在或解析失败时返回nullptr
+     */
+    std::shared_ptr<zElf> get_file_elf(const string& path, void* mem_base = nullptr);
+
+    /**
+     * 获取内存视图的 zElf
+     * @param mem_base so 在内存中的基址
+     * @return 共享的 zElf，失败时返回nullptr
+     */
+    std::shared_ptr<zElf> get_memory_elf(void* mem_base);
+
+    /**
+     * 淘汰指定文件路径的缓存
+     */
+    void evict(const string& path);
+
+    /**
+     * 淘汰指定内存基址的缓存（包括以该基址映射的文件视图）
+     */
+    void evict(void* mem_base);
+
+    /**
+     * 淘汰所有已经不在 /proc/self/maps 中的 so
+     * @return 淘汰的条目数
+     */
+    size_t evict_unmapped();
+
+    /**
+     * 清空缓存
+     */
+    void clear();
+
+    size_t size() const;
+    uint64_t get_hit_count() const;
+    uint64_t get_miss_count() const;
+};
+
+#endif //OVERT_ZELFCACHE_H
@@ -6,6 +6,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <sys/select.h>
+#include <poll.h>
 #include "zLog.h"
 #include "zLibc.h"
 #include "zLibcUtil.h"
@@ -549,6 +550,13 @@ HttpsResponse zHttps::performRequest(const HttpsRequest& request) {
     // 将socket文件描述符设置到mbedtls网络上下文
     resources.server_fd.fd = resources.sockfd;
 
+    // 所在的线程池任务被取消时关闭连接，阻塞中的握手与读写立即返回
+    // 在 resources 之后构造、之前析构，注销回调时 socket 还没有关闭
+    int cancel_fd = resources.sockfd;
+    zCancelCallback shutdown_on_cancel(zCancelToken::current(), [cancel_fd]() {
+        shutdown(cancel_fd, SHUT_RDWR);
+    });
+
     // 标记连接建立完成
     timer.markConnection();
     LOGI("Connection established successfully in %d seconds", timer.getConnectionDuration());
@@ -1301,27 +1309,21 @@ int zHttps::connectWithTimeout(const string& host, int port, int timeout_seconds
     // 尝试连接
     int ret = connect(sockfd, (struct sockaddr*)&serv_addr, sizeof(serv_addr));
     if (ret < 0 && errno == EINPROGRESS) {
-        // 连接正在进行中，等待完成或超时
-        fd_set writefds, exceptfds;
-        FD_ZERO(&writefds);
-        FD_ZERO(&exceptfds);
-        FD_SET(sockfd, &writefds);
-        FD_SET(sockfd, &exceptfds);
-
-        struct timeval timeout;
-        timeout.tv_sec = timeout_seconds;
-        timeout.tv_usec = 0;
-
-        ret = select(sockfd + 1, nullptr, &writefds, &exceptfds, &timeout);
+        // 连接正在进行中，等待完成、超时或所在的线程池任务被取消
+        ret = zCancelToken::current().waitFd(sockfd, POLLOUT, timeout_seconds * 1000);
         if (ret == 0) {
             LOGE("Connection timeout after %d seconds", timeout_seconds);
             close(sockfd);
             return -1;
+        } else if (ret < 0 && errno == ECANCELED) {
+            LOGE("Connection cancelled");
+            close(sockfd);
+            return -1;
         } else if (ret < 0) {
-            LOGE("Select failed");
+            LOGE("Poll failed");
             close(sockfd);
             return -1;
-        } else if (FD_ISSET(sockfd, &exceptfds)) {
+        } else if (ret & POLLNVAL) {
             LOGE("Connection failed with exception");
             close(sockfd);
             return -1;
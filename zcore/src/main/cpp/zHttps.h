@@ -26,6 +26,7 @@
 #include "zLibc.h"
 #include "zStd.h"
 #include "zStdUtil.h"
+#include "zCancelToken.h"
 
 /**
  * 证书信息结构体
@@ -199,10 +200,13 @@ private:
         int getTotalDuration() const { return total_time - start_time; }
 
         /**
-         * 检查是否超时
+         * 检查是否超时，所在的线程池任务被取消时也视为超时
          * @return true表示已超时
          */
         bool isTimeout() const {
+            if (zCancelToken::isCurrentCancelled()) {
+                return true;
+            }
             time_t current_time = time(nullptr);
             return (current_time - start_time) >= timeout_seconds;
         }
@@ -0,0 +1,57 @@
+//
+// Created by lxz on 2025/12/05.
+// zInfoDiff 实现 - 检测结果（项目 -> 属性 -> 值）的增量差异
+//
+
+#include "zInfoDiff.h"
+#include "zJsonWriter.h"
+
+zInfoDiff zInfoDiff::compute(const Info& before, const Info& after) {
+    zInfoDiff diff;
+    Info::const_iterator old_it = before.begin();
+    Info::const_iterator new_it = after.begin();
+    while (old_it != before.end() || new_it != after.end()) {
+        if (new_it == after.end() || (old_it != before.end() && old_it->first < new_it->first)) {
+            diff.removed.push_back(old_it->first);
+            ++old_it;
+        } else if (old_it == before.end() || new_it->first < old_it->first) {
+            diff.added[new_it->first] = new_it->second;
+            ++new_it;
+        } else {
+            if (old_it->second != new_it->second) {
+                diff.changed[new_it->first] = new_it->second;
+            }
+            ++old_it;
+            ++new_it;
+        }
+    }
+    return diff;
+}
+
+void zInfoDiff::apply(Info& info) const {
+    for (const string& name : removed) {
+        info.erase(name);
+    }
+    for (Info::const_iterator it = added.begin(); it != added.end(); ++it) {
+        info[it->first] = it->second;
+    }
+    for (Info::const_iterator it = changed.begin(); it != changed.end(); ++it) {
+        info[it->first] = it->second;
+    }
+}
+
+string zInfoDiff::toJson() const {
+    // 直接写出，与 zJson DOM 的 dump 相同：{"added":{...},"changed":{...},"removed":[...]}
+    zJsonWriter writer;
+    writer.writeRaw("{\"added\":").writeInfo(added);
+    writer.writeRaw(",\"changed\":").writeInfo(changed);
+    writer.writeRaw(",\"removed\":[");
+    for (size_t i = 0; i < removed.size(); i++) {
+        if (i != 0) {
+            writer.writeRaw(",");
+        }
+        writer.writeString(removed[i]);
+    }
+    writer.writeRaw("]}");
+    return writer.getBuffer();
+}
@@ -0,0 +1,48 @@
+//
+// Created by lxz on 2025/12/05.
+// zInfoDiff - 检测结果（项目 -> 属性 -> 值）的增量差异
+//
+
+#ifndef OVERT_ZINFODIFF_H
+#define OVERT_ZINFODIFF_H
+
+#include "zLog.h"
+#include "zStd.h"
+
+/**
+ * 两次检测结果之间的差异
+ * 以项目为单位比较：新增的项目、删除的项目、属性有变化的项目；
+ * 变化的项目携带完整的新属性（每个项目只有 risk、explain 等少量属性，逐个属性比较的收益不大）
+ *
+ * zManager 用它判断检测结果是否变化，并只把变化的部分发送给 Java 层
+ */
+class zInfoDiff {
+public:
+    typedef map<string, map<string, string>> Info;
+
+    Info added;
+    Info changed;
+    vector<string> removed;
+
+    bool empty() const { return added.empty() && changed.empty() && removed.empty(); }
+
+    // 变化的项目数
+    size_t size() const { return added.size() + changed.size() + removed.size(); }
+
+    /**
+     * 计算差异，两个 map 按键有序，同时遍历一次即可，O(n + m)
+     */
+    static zInfoDiff compute(const Info& before, const Info& after);
+
+    /**
+     * 把差异应用到 info 上，apply(before) 之后与 after 相同
+     */
+    void apply(Info& info) const;
+
+    /**
+     * 序列化为 JSON：{"added":{项目:{属性:值}},"changed":{项目:{属性:值}},"removed":[项目]}，由 zJsonWriter 直接写出
+     */
+    string toJson() const;
+};
+
+#endif //OVERT_ZINFODIFF_H
@@ -0,0 +1,85 @@
+//
+// Created by lxz on 2025/12/07.
+// zInfoStore 实现 - 设备信息的写时复制快照
+//
+
+#include "zInfoStore.h"
+
+zInfoStore::zInfoStore() : m_snapshot(std::make_shared<const Snapshot>()), m_generation(0) {
+}
+
+zInfoStore::SnapshotPtr zInfoStore::getSnapshot() const {
+    return std::atomic_load(&m_snapshot);
+}
+
+zInfoStore::InfoPtr zInfoStore::get(const string& key, uint64_t* version) const {
+    SnapshotPtr snapshot = getSnapshot();
+    Snapshot::const_iterator it = snapshot->find(key);
+    if (it == snapshot->end()) {
+        if (version != nullptr) {
+            *version = 0;
+        }
+        return nullptr;
+    }
+    if (version != nullptr) {
+        *version = it->second.version;
+    }
+    return it->second.info;
+}
+
+void zInfoStore::replaceLocked(const SnapshotPtr& current, const string& key, const InfoPtr& info, uint64_t version) {
+    // 只复制类别索引，其它类别的结果与旧快照共享
+    std::shared_ptr<Snapshot> next = std::make_shared<Snapshot>(*current);
+    Entry& entry = (*next)[key];
+    entry.info = info;
+    entry.version = version;
+    std::atomic_store(&m_snapshot, SnapshotPtr(next));
+    m_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+void zInfoStore::set(const string& key, const Info& value) {
+    InfoPtr info = std::make_shared<const Info>(value);
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    uint64_t version = ++m_versions[key];
+    replaceLocked(getSnapshot(), key, info, version);
+}
+
+bool zInfoStore::update(const string& key, const Info& value, zInfoDiff* diff, uint64_t* version) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    SnapshotPtr current = getSnapshot();
+    Snapshot::const_iterator it = current->find(key);
+    static const Info empty_info;
+    const Info& current_info = it == current->end() || !it->second.info ? empty_info : *it->second.info;
+
+    zInfoDiff result = zInfoDiff::compute(current_info, value);
+    uint64_t& current_version = m_versions[key];
+    // 第一次写入（或 clear 之后）即使结果为空也算变化，保证类别出现在快照中并有版本号
+    bool changed = !result.empty() || it == current->end() || !it->second.info;
+    if (changed) {
+        current_version++;
+        replaceLocked(current, key, std::make_shared<const Info>(value), current_version);
+    }
+    if (version != nullptr) {
+        *version = current_version;
+    }
+    if (diff != nullptr) {
+        *diff = result;
+    }
+    return changed;
+}
+
+void zInfoStore::clear() {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    std::atomic_store(&m_snapshot, SnapshotPtr(std::make_shared<const Snapshot>()));
+    m_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+map<string, zInfoStore::Info> zInfoStore::toMap(const Snapshot& snapshot) {
+    map<string, Info> result;
+    for (Snapshot::const_iterator it = snapshot.begin(); it != snapshot.end(); ++it) {
+        if (it->second.info) {
+            result[it->first] = *it->second.info;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,101 @@
+//
+// Created by lxz on 2025/12/07.
+// zInfoStore - 设备信息的写时复制快照
+//
+
+#ifndef OVERT_ZINFOSTORE_H
+#define OVERT_ZINFOSTORE_H
+
+#include <stdint.h>
+#include <mutex>
+#include <memory>
+#include <atomic>
+
+#include "zLog.h"
+#include "zStd.h"
+#include "zInfoDiff.h"
+
+/**
+ * 设备信息（类别 -> 项目 -> 属性 -> 值）的写时复制存储
+ *
+ * 每次更新生成一个新的不可变快照，通过原子操作替换当前快照：
+ * - 读取只需要原子地取得当前快照的引用计数指针，O(1)，不复制数据，也不需要读写锁，
+ *   拿到的快照在持有期间不会被修改，可以放心在锁外遍历、序列化
+ * - 写入串行执行，新快照只复制顶层的类别索引，没有变化的类别结果与旧快照共享
+ *
+ * 版本号按类别记录，结果变化一次加一；clear 只清空结果，版本号保留，
+ * 保证 Java 层看到的版本号一直递增
+ */
+class zInfoStore {
+public:
+    typedef zInfoDiff::Info Info;
+    typedef std::shared_ptr<const Info> InfoPtr;
+
+    struct Entry {
+        InfoPtr info;
+        uint64_t version = 0;
+    };
+
+    // 一个版本的所有设备信息：类别 -> 结果与版本号
+    typedef map<string, Entry> Snapshot;
+    typedef std::shared_ptr<const Snapshot> SnapshotPtr;
+
+private:
+    // 只通过 std::atomic_load / std::atomic_store 访问
+    SnapshotPtr m_snapshot;
+
+    std::mutex m_writeMutex;
+    map<string, uint64_t> m_versions;       // 由 m_writeMutex 保护，clear 之后仍保留
+    std::atomic<uint64_t> m_generation;     // 快照替换次数
+
+    // 基于当前快照替换一个类别，调用时持有 m_writeMutex
+    void replaceLocked(const SnapshotPtr& current, const string& key, const InfoPtr& info, uint64_t version);
+
+public:
+    zInfoStore();
+
+    zInfoStore(const zInfoStore&) = delete;
+    zInfoStore& operator=(const zInfoStore&) = delete;
+
+    /**
+     * 当前快照，永远不为nullptr
+     */
+    SnapshotPtr getSnapshot() const;
+
+    /**
+     * 指定类别的结果
+     * @param version 不为nullptr时返回结果对应的版本号，与结果来自同一个快照
+     * @return 类别不存在时返回nullptr
+     */
+    InfoPtr get(const string& key, uint64_t* version = nullptr) const;
+
+    /**
+     * 替换指定类别的结果，版本号加一
+     */
+    void set(const string& key, const Info& value);
+
+    /**
+     * 与当前结果比较，有变化时才替换并把版本号加一；类别不在当前快照中时（包括空结果）总是算作变化
+     * 差异在写入互斥内计算，两次更新交错时不会基于过期的结果计算差异
+     * @param diff 不为nullptr时返回与上次结果的差异
+     * @param version 不为nullptr时返回更新后的版本号（没有变化时为当前版本号）
+     * @return 结果是否变化
+     */
+    bool update(const string& key, const Info& value, zInfoDiff* diff = nullptr, uint64_t* version = nullptr);
+
+    /**
+     * 清空所有结果，版本号保留
+     */
+    void clear();
+
+    size_t size() const { return getSnapshot()->size(); }
+
+    uint64_t getGeneration() const { return m_generation.load(std::memory_order_relaxed); }
+
+    /**
+     * 复制出完整的三层 map，用于需要可修改副本的调用者
+     */
+    static map<string, Info> toMap(const Snapshot& snapshot);
+};
+
+#endif //OVERT_ZINFOSTORE_H
@@ -0,0 +1,161 @@
+//
+// Created by lxz on 2025/12/06.
+// zJniCache 实现 - JNI 类、方法、字段句柄缓存
+//
+
+#include <mutex>
+
+#include "zJavaVm.h"
+#include "zJniCache.h"
+
+zJniCache* zJniCache::instance = nullptr;
+
+zJniCache* zJniCache::getInstance() {
+    static std::once_flag init_flag;
+    std::call_once(init_flag, []() {
+        try {
+            instance = new zJniCache();
+            LOGI("zJniCache: Created singleton instance");
+        } catch (const std::exception& e) {
+            LOGE("zJniCache: Failed to create singleton instance: %s", e.what());
+        } catch (...) {
+            LOGE("zJniCache: Failed to create singleton instance with unknown error");
+        }
+    });
+    return instance;
+}
+
+zJniCache::zJniCache() : m_hits(0), m_misses(0) {
+}
+
+size_t zJniCache::init(JNIEnv* env, const vector<const char*>& classNames) {
+    size_t count = 0;
+    for (const char* className : classNames) {
+        if (getClass(env, className) != nullptr) {
+            count++;
+        } else {
+            LOGW("zJniCache: init - class %s not found", className);
+        }
+    }
+    LOGI("zJniCache: init - %zu/%zu classes cached", count, classNames.size());
+    return count;
+}
+
+jclass zJniCache::getClass(JNIEnv* env, const char* className) {
+    if (env == nullptr || className == nullptr) {
+        return nullptr;
+    }
+    string key(className);
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        std::map<string, jclass>::const_iterator it = m_classes.find(key);
+        if (it != m_classes.end()) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+
+    jclass local = env->FindClass(className);
+    if (local == nullptr) {
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+        }
+        // 子线程的 FindClass 找不到应用自己的类，改用应用的 ClassLoader
+        local = zJavaVm::getInstance()->findClass(className);
+        if (local == nullptr) {
+            return nullptr;
+        }
+    }
+    jclass global = (jclass) env->NewGlobalRef(local);
+    env->DeleteLocalRef(local);
+    if (global == nullptr) {
+        return nullptr;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    std::pair<std::map<string, jclass>::iterator, bool> result = m_classes.insert(std::make_pair(key, global));
+    if (!result.second) {
+        // 其它线程已经缓存
+        env->DeleteGlobalRef(global);
+    }
+    return result.first->second;
+}
+
+jmethodID zJniCache::getMethodId(JNIEnv* env, const char* className, const char* name, const char* signature, bool isStatic) {
+    if (env == nullptr || name == nullptr || signature == nullptr) {
+        return nullptr;
+    }
+    string key = string(isStatic ? "static " : "") + className + "." + name + signature;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        std::map<string, jmethodID>::const_iterator it = m_methods.find(key);
+        if (it != m_methods.end()) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    jclass clazz = getClass(env, className);
+    if (clazz == nullptr) {
+        return nullptr;
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    jmethodID method = isStatic ? env->GetStaticMethodID(clazz, name, signature) : env->GetMethodID(clazz, name, signature);
+    if (method == nullptr) {
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+        }
+        LOGW("zJniCache: method %s not found", key.c_str());
+        return nullptr;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_methods[key] = method;
+    return method;
+}
+
+jfieldID zJniCache::getFieldId(JNIEnv* env, const char* className, const char* name, const char* signature, bool isStatic) {
+    if (env == nullptr || name == nullptr || signature == nullptr) {
+        return nullptr;
+    }
+    string key = string(isStatic ? "static " : "") + className + "." + name + ":" + signature;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        std::map<string, jfieldID>::const_iterator it = m_fields.find(key);
+        if (it != m_fields.end()) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    jclass clazz = getClass(env, className);
+    if (clazz == nullptr) {
+        return nullptr;
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    jfieldID field = isStatic ? env->GetStaticFieldID(clazz, name, signature) : env->GetFieldID(clazz, name, signature);
+    if (field == nullptr) {
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+        }
+        LOGW("zJniCache: field %s not found", key.c_str());
+        return nullptr;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_fields[key] = field;
+    return field;
+}
+
+void zJniCache::clear(JNIEnv* env) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (env != nullptr) {
+        for (std::map<string, jclass>::iterator it = m_classes.begin(); it != m_classes.end(); ++it) {
+            env->DeleteGlobalRef(it->second);
+        }
+    }
+    m_classes.clear();
+    m_methods.clear();
+    m_fields.clear();
+}
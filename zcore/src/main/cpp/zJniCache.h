@@ -0,0 +1,88 @@
+//
+// Created by lxz on 2025/12/06.
+// zJniCache - JNI 类、方法、字段句柄缓存
+//
+
+#ifndef OVERT_ZJNICACHE_H
+#define OVERT_ZJNICACHE_H
+
+#include <jni.h>
+#include <map>
+#include <atomic>
+#include <shared_mutex>
+
+#include "zLog.h"
+#include "zStd.h"
+
+/**
+ * JNI 句柄缓存
+ * 类解析一次后提升为全局引用，jmethodID / jfieldID 在类不被卸载时一直有效，也只解析一次，
+ * 避免每次调用都 FindClass、GetMethodID（FindClass 需要按类名查找类加载器，是 JNI 中较贵的调用）
+ *
+ * 返回的 jclass 是全局引用，由缓存持有，调用者不能 DeleteLocalRef
+ *
+ * 类的解析：先用 env->FindClass，找不到时通过 zJavaVm::findClass 使用应用的 ClassLoader，
+ * 子线程中 FindClass 只能找到系统类，应用自己的类最好在 JNI_OnLoad 中通过 init 预先解析
+ */
+class zJniCache {
+private:
+    zJniCache();
+
+    zJniCache(const zJniCache&) = delete;
+    zJniCache& operator=(const zJniCache&) = delete;
+
+    static zJniCache* instance;
+
+    mutable std::shared_mutex m_mutex;
+    std::map<string, jclass> m_classes;
+    std::map<string, jmethodID> m_methods;    // 类名 + 方法名 + 签名
+    std::map<string, jfieldID> m_fields;      // 类名 + 字段名 + 签名
+
+    std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_misses;
+
+    jmethodID getMethodId(JNIEnv* env, const char* className, const char* name, const char* signature, bool isStatic);
+
+    jfieldID getFieldId(JNIEnv* env, const char* className, const char* name, const char* signature, bool isStatic);
+
+public:
+    static zJniCache* getInstance();
+
+    /**
+     * 预先解析类，在 JNI_OnLoad 中调用
+     * JNI_OnLoad 所在线程的 FindClass 使用加载本 so 的 ClassLoader，可以找到应用自己的类
+     * @return 成功解析的类数量
+     */
+    size_t init(JNIEnv* env, const vector<const char*>& classNames);
+
+    /**
+     * 获取类的全局引用，找不到时返回nullptr（不留下未处理的异常）
+     */
+    jclass getClass(JNIEnv* env, const char* className);
+
+    jmethodID getMethodId(JNIEnv* env, const char* className, const char* name, const char* signature) {
+        return getMethodId(env, className, name, signature, false);
+    }
+
+    jmethodID getStaticMethodId(JNIEnv* env, const char* className, const char* name, const char* signature) {
+        return getMethodId(env, className, name, signature, true);
+    }
+
+    jfieldID getFieldId(JNIEnv* env, const char* className, const char* name, const char* signature) {
+        return getFieldId(env, className, name, signature, false);
+    }
+
+    jfieldID getStaticFieldId(JNIEnv* env, const char* className, const char* name, const char* signature) {
+        return getFieldId(env, className, name, signature, true);
+    }
+
+    /**
+     * 释放所有全局引用并清空缓存
+     */
+    void clear(JNIEnv* env);
+
+    uint64_t getHitCount() const { return m_hits.load(std::memory_order_relaxed); }
+    uint64_t getMissCount() const { return m_misses.load(std::memory_order_relaxed); }
+};
+
+#endif //OVERT_ZJNICACHE_H
@@ -0,0 +1,207 @@
+//
+// Created by lxz on 2025/12/10.
+// zJsonWriter 实现 - 设备信息的直接 JSON 序列化
+//
+
+#include "zJson.h"
+#include "zJsonWriter.h"
+
+/**
+ * 从 data[i] 开始的 UTF-8 序列的长度，不合法时返回 0
+ * 与 zJson 的校验一致：拒绝过长编码、代理区与超过 U+10FFFF 的码点
+ */
+static size_t utf8_sequence_length(const unsigned char* data, size_t i, size_t length) {
+    unsigned char c = data[i];
+    size_t count;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (c >= 0xC2 && c <= 0xDF) {
+        count = 2;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        count = 3;
+        if (c == 0xE0) low = 0xA0;
+        if (c == 0xED) high = 0x9F;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        count = 4;
+        if (c == 0xF0) low = 0x90;
+        if (c == 0xF4) high = 0x8F;
+    } else {
+        return 0;
+    }
+    if (i + count > length) {
+        return 0;
+    }
+    if (data[i + 1] < low || data[i + 1] > high) {
+        return 0;
+    }
+    for (size_t j = 2; j < count; j++) {
+        if ((data[i + j] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return count;
+}
+
+void zJsonWriter::appendString(string& out, const char* data, size_t length) {
+    static const char HEX[] = "0123456789abcdef";
+    const unsigned char* bytes = (const unsigned char*) data;
+    size_t start = out.size();
+    out.push_back('"');
+    // 不需要转义的连续字节一次追加
+    size_t runStart = 0;
+    size_t i = 0;
+    while (i < length) {
+        unsigned char c = bytes[i];
+        if (c >= 0x80) {
+            size_t sequence = utf8_sequence_length(bytes, i, length);
+            if (sequence == 0) {
+                // 不合法的 UTF-8 交给 zJson，抛出与 dump 相同的异常
+                out.resize(start);
+                out += zJson(string(data, length)).dump();
+                return;
+            }
+            i += sequence;
+            continue;
+        }
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            i++;
+            continue;
+        }
+        out.append(data + runStart, i - runStart);
+        switch (c) {
+            case '"': out.append("\\\"", 2); break;
+            case '\\': out.append("\\\\", 2); break;
+            case '\b': out.append("\\b", 2); break;
+            case '\f': out.append("\\f", 2); break;
+            case '\n': out.append("\\n", 2); break;
+            case '\r': out.append("\\r", 2); break;
+            case '\t': out.append("\\t", 2); break;
+            default: {
+                char escape[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF]};
+                out.append(escape, 6);
+                break;
+            }
+        }
+        i++;
+        runStart = i;
+    }
+    out.append(data + runStart, length - runStart);
+    out.push_back('"');
+}
+
+void zJsonWriter::clear() {
+    // string::clear 会释放内存，缩小到 0 保留容量
+    m_buffer.resize(0);
+}
+
+void zJsonWriter::reserve(size_t size) {
+    m_buffer.reserve(size);
+}
+
+zJsonWriter& zJsonWriter::writeRaw(const char* data, size_t length) {
+    m_buffer.append(data, length);
+    return *this;
+}
+
+zJsonWriter& zJsonWriter::writeRaw(const char* data) {
+    return writeRaw(data, strlen(data));
+}
+
+zJsonWriter& zJsonWriter::writeRaw(const string& data) {
+    return writeRaw(data.data(), data.size());
+}
+
+zJsonWriter& zJsonWriter::writeString(const char* data, size_t length) {
+    appendString(m_buffer, data, length);
+    return *this;
+}
+
+zJsonWriter& zJsonWriter::writeString(const string& value) {
+    return writeString(value.data(), value.size());
+}
+
+zJsonWriter& zJsonWriter::writeUint(uint64_t value) {
+    char buffer[24];
+    int length = snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long) value);
+    return writeRaw(buffer, (size_t) length);
+}
+
+zJsonWriter& zJsonWriter::writeStringMap(const map<string, string>& value) {
+    m_buffer.push_back('{');
+    bool first = true;
+    for (const auto& item : value) {
+        if (!first) {
+            m_buffer.push_back(',');
+        }
+        first = false;
+        writeString(item.first);
+        m_buffer.push_back(':');
+        writeString(item.second);
+    }
+    m_buffer.push_back('}');
+    return *this;
+}
+
+zJsonWriter& zJsonWriter::writeInfo(const Info& info) {
+    m_buffer.push_back('{');
+    bool first = true;
+    for (const auto& item : info) {
+        if (!first) {
+            m_buffer.push_back(',');
+        }
+        first = false;
+        writeString(item.first);
+        m_buffer.push_back(':');
+        writeStringMap(item.second);
+    }
+    m_buffer.push_back('}');
+    return *this;
+}
+
+zJsonWriter& zJsonWriter::writeDeviceInfo(const zInfoStore::Snapshot& snapshot) {
+    m_buffer.push_back('{');
+    bool first = true;
+    for (const auto& item : snapshot) {
+        // 与 zInfoStore::toMap 一致，跳过没有结果的类别
+        if (!item.second.info) {
+            continue;
+        }
+        if (!first) {
+            m_buffer.push_back(',');
+        }
+        first = false;
+        writeString(item.first);
+        m_buffer.push_back(':');
+        writeInfo(*item.second.info);
+    }
+    m_buffer.push_back('}');
+    return *this;
+}
+
+zJsonWriter& zJsonWriter::writeDeviceInfo(const map<string, Info>& deviceInfo) {
+    m_buffer.push_back('{');
+    bool first = true;
+    for (const auto& item : deviceInfo) {
+        if (!first) {
+            m_buffer.push_back(',');
+        }
+        first = false;
+        writeString(item.first);
+        m_buffer.push_back(':');
+        writeInfo(item.second);
+    }
+    m_buffer.push_back('}');
+    return *this;
+}
+
+const string& zJsonWriter::dumpInfo(const Info& info) {
+    clear();
+    writeInfo(info);
+    return m_buffer;
+}
+
+const string& zJsonWriter::dumpDeviceInfo(const zInfoStore::Snapshot& snapshot) {
+    clear();
+    writeDeviceInfo(snapshot);
+    return m_buffer;
+}
@@ -0,0 +1,83 @@
+//
+// Created by lxz on 2025/12/10.
+// zJsonWriter - 设备信息的直接 JSON 序列化
+//
+
+#ifndef OVERT_ZJSONWRITER_H
+#define OVERT_ZJSONWRITER_H
+
+#include <stdint.h>
+
+#include "zLog.h"
+#include "zStd.h"
+#include "zInfoStore.h"
+
+/**
+ * 把检测结果与 device_info 直接写成 JSON，不经过 zJson 的 DOM
+ *
+ * 输出与 zJson(value).dump() 逐字节相同：紧凑格式，对象按 map 的顺序输出，
+ * 字符串只转义 " \ 与控制字符（\b \f \n \r \t 用简写，其它为小写的 \u00xx），UTF-8 原样输出；
+ * 遇到不是合法 UTF-8 的字符串时交给 zJson 处理该字符串，与 dump 一样抛出 zJson::type_error
+ *
+ * 输出写入内部缓冲区，clear 保留容量，同一个 writer 反复使用时不再分配内存；
+ * writer 本身不加锁，同一个 writer 只在一个线程上使用
+ */
+class zJsonWriter {
+public:
+    typedef zInfoDiff::Info Info;
+
+private:
+    string m_buffer;
+
+public:
+    zJsonWriter() = default;
+
+    zJsonWriter(const zJsonWriter&) = delete;
+    zJsonWriter& operator=(const zJsonWriter&) = delete;
+
+    // 清空输出，保留容量
+    void clear();
+
+    void reserve(size_t size);
+
+    const string& getBuffer() const { return m_buffer; }
+
+    size_t size() const { return m_buffer.size(); }
+
+    /**
+     * 原样追加，用于拼接已经是 JSON 的内容和标点
+     */
+    zJsonWriter& writeRaw(const char* data, size_t length);
+    zJsonWriter& writeRaw(const char* data);
+    zJsonWriter& writeRaw(const string& data);
+
+    // 带引号并转义的字符串
+    zJsonWriter& writeString(const char* data, size_t length);
+    zJsonWriter& writeString(const string& value);
+
+    zJsonWriter& writeUint(uint64_t value);
+
+    // {"键":"值",...}
+    zJsonWriter& writeStringMap(const map<string, string>& value);
+
+    // 一个类别的结果：{"项目":{"属性":"值"}}
+    zJsonWriter& writeInfo(const Info& info);
+
+    // 所有类别：{"类别":{"项目":{"属性":"值"}}}，与 zJson(zInfoStore::toMap(snapshot)).dump() 相同
+    zJsonWriter& writeDeviceInfo(const zInfoStore::Snapshot& snapshot);
+    zJsonWriter& writeDeviceInfo(const map<string, Info>& deviceInfo);
+
+    /**
+     * 清空后写入一个类别的结果，返回内部缓冲区，下一次写入前有效
+     */
+    const string& dumpInfo(const Info& info);
+
+    const string& dumpDeviceInfo(const zInfoStore::Snapshot& snapshot);
+
+    /**
+     * 转义后追加带引号的字符串，供其它直接序列化的地方使用
+     */
+    static void appendString(string& out, const char* data, size_t length);
+};
+
+#endif //OVERT_ZJSONWRITER_H
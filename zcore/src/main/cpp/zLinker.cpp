@@ -10,7 +10,12 @@
 #include "zFile.h"
 #include "zLinker.h"
 #include "zProcMaps.h"
+#include "zThreadPool.h"
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <time.h>
+#include <algorithm>
 
 // 静态单例实例指针
 zLinker* zLinker::instance = nullptr;
@@ -207,35 +212,207 @@ zElf zLinker::find_lib(const char* so_name){
 }
 
 /**
- * 获取所有已加载共享库的路径列表
- * 遍历soinfo链表，收集所有共享库的真实路径
- * @return 共享库路径列表
+ * 查找共享库并返回缓存的zElf对象
+ * 遍历soinfo链表找到共享库路径和基址后，从zElfCache获取解析结果
+ * 文件被替换（inode/mtime变化）或库被重新加载（基址变化）时缓存会自动失效
+ * @param so_name 共享库名称（如"libart.so"）
+ * @return 共享的zElf对象，未找到或解析失败时返回nullptr
  */
-vector<string> zLinker::get_libpath_list(){
-    LOGD("get_libpath_list called");
-    vector<string> libpath_list = vector<string>();
+std::shared_ptr<zElf> zLinker::get_lib(const char* so_name){
+    if (so_name == nullptr || so_name[0] == '\0') {
+        LOGE("get_lib: invalid so_name");
+        return nullptr;
+    }
     if (soinfo_head == nullptr || soinfo_get_realpath == nullptr) {
-        LOGE("get_libpath_list: linker state not ready");
-        return libpath_list;
+        LOGE("get_lib: linker state not ready");
+        return nullptr;
     }
-    
-    // 从soinfo链表头开始遍历
+
     soinfo* soinfo = soinfo_head;
     while(soinfo != nullptr){
-        // 获取共享库的真实路径
         char* real_path = soinfo_get_realpath(soinfo);
-        if (real_path == nullptr) {
-            soinfo = soinfo->next;
-            continue;
+        if (real_path != nullptr && string_end_with(real_path, so_name)) {
+            zElfCache* cache = zElfCache::getInstance();
+            if (cache == nullptr) {
+                return nullptr;
+            }
+            return cache->get_file_elf(real_path, (void*)soinfo->base);
         }
-        // 添加到路径列表
-        libpath_list.push_back(real_path);
         soinfo = soinfo->next;
     }
+    LOGD("get_lib: %s not found", so_name);
+    return nullptr;
+}
+
+/**
+ * 获取所有已加载共享库的路径列表
+ * 遍历soinfo链表，收集所有共享库的真实路径
+ * @return 共享库路径列表
+ */
+vector<string> zLinker::get_libpath_list(){
+    LOGD("get_libpath_list called");
+    vector<string> libpath_list = vector<string>();
+
+    // 从soinfo快照中获取路径，未变化的库不再重复调用get_realpath
+    vector<SoinfoEntry> snapshot = get_soinfo_snapshot();
+    libpath_list.reserve(snapshot.size());
+    for (size_t i = 0; i < snapshot.size(); i++) {
+        libpath_list.push_back(snapshot[i].realpath);
+    }
     LOGI("get_libpath_list: found %zu libraries", libpath_list.size());
     return libpath_list;
 }
 
+/**
+ * 遍历soinfo链表生成快照
+ * 与previous中节点地址、基址、大小、路径都相同的条目视为未变化，直接移动previous中的路径
+ * @param head 链表头
+ * @param get_realpath 获取路径的函数
+ * @param previous 上一次的快照，调用后失效
+ * @param diff 不为nullptr时追加新加载和已卸载的条目
+ * @return 按链表顺序排列的新快照
+ */
+vector<SoinfoEntry> zLinker::walk_soinfo_list(soinfo* head, char*(*get_realpath)(void*),
+                                              vector<SoinfoEntry>& previous, SoinfoDiff* diff){
+    // previous按节点地址排序的下标，用于二分查找
+    vector<size_t> order;
+    order.resize(previous.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.data(), order.data() + order.size(), [&previous](size_t a, size_t b) {
+        return (uintptr_t)previous[a].soinfo_ptr < (uintptr_t)previous[b].soinfo_ptr;
+    });
+    vector<uint8_t> matched;
+    matched.resize(previous.size());
+
+    vector<SoinfoEntry> snapshot;
+    snapshot.reserve(previous.size() + 8);
+    for (soinfo* node = head; node != nullptr; node = node->next) {
+        SoinfoEntry entry;
+        entry.soinfo_ptr = node;
+        entry.base = (void*)node->base;
+        entry.size = node->size;
+
+        size_t* found = std::lower_bound(order.data(), order.data() + order.size(), (uintptr_t)node,
+                                         [&previous](size_t index, uintptr_t ptr) {
+            return (uintptr_t)previous[index].soinfo_ptr < ptr;
+        });
+        size_t index = found != order.data() + order.size() ? *found : previous.size();
+        char* real_path = nullptr;
+        bool reused = false;
+        if (index < previous.size() && previous[index].soinfo_ptr == node && !matched[index]
+                && previous[index].base == entry.base && previous[index].size == entry.size) {
+            // 卸载后节点地址可能分配给另一个库，路径也相同才视为未变化；这里只比较，不拷贝路径
+            real_path = get_realpath(node);
+            if (real_path != nullptr && previous[index].realpath == real_path) {
+                matched[index] = 1;
+                entry.realpath = std::move(previous[index].realpath);
+                reused = true;
+            }
+        }
+        if (!reused) {
+            if (real_path == nullptr) {
+                real_path = get_realpath(node);
+            }
+            if (real_path == nullptr) {
+                continue;
+            }
+            entry.realpath = real_path;
+            if (diff != nullptr) {
+                diff->loaded.push_back(entry);
+            }
+        }
+        snapshot.push_back(std::move(entry));
+    }
+
+    // 未匹配的旧条目即已卸载的库
+    if (diff != nullptr) {
+        for (size_t i = 0; i < previous.size(); i++) {
+            if (!matched[i]) {
+                diff->unloaded.push_back(std::move(previous[i]));
+            }
+        }
+    }
+    previous.clear();
+    return snapshot;
+}
+
+/**
+ * 从条目列表中移除节点地址、路径、基址、大小都相同的条目
+ * @return 是否找到并移除
+ */
+static bool remove_soinfo_entry(vector<SoinfoEntry>& entries, const SoinfoEntry& entry){
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].soinfo_ptr == entry.soinfo_ptr && entries[i].base == entry.base
+                && entries[i].size == entry.size && entries[i].realpath == entry.realpath) {
+            if (i + 1 != entries.size()) {
+                entries[i] = std::move(entries.back());
+            }
+            entries.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 重新遍历soinfo链表并更新快照，调用方需持有soinfo_snapshot_mutex
+ * 本次遍历的差异并入累计差异：累计期间先加载后卸载（或卸载后原样重新加载）的库互相抵消，
+ * 因此两次update_soinfo_snapshot之间累计的条目数不会超过前后两次快照的大小
+ */
+void zLinker::refresh_soinfo_snapshot_locked(){
+    if (soinfo_head == nullptr || soinfo_get_realpath == nullptr) {
+        LOGE("refresh_soinfo_snapshot: linker state not ready");
+        return;
+    }
+    SoinfoDiff diff;
+    soinfo_snapshot = walk_soinfo_list(soinfo_head, soinfo_get_realpath, soinfo_snapshot, &diff);
+    for (size_t i = 0; i < diff.unloaded.size(); i++) {
+        if (!remove_soinfo_entry(soinfo_pending_diff.loaded, diff.unloaded[i])) {
+            soinfo_pending_diff.unloaded.push_back(std::move(diff.unloaded[i]));
+        }
+    }
+    for (size_t i = 0; i < diff.loaded.size(); i++) {
+        if (!remove_soinfo_entry(soinfo_pending_diff.unloaded, diff.loaded[i])) {
+            soinfo_pending_diff.loaded.push_back(std::move(diff.loaded[i]));
+        }
+    }
+}
+
+/**
+ * 获取soinfo快照
+ * @return 按链表顺序排列的快照
+ */
+vector<SoinfoEntry> zLinker::get_soinfo_snapshot(){
+    std::lock_guard<std::mutex> lock(soinfo_snapshot_mutex);
+    refresh_soinfo_snapshot_locked();
+    return soinfo_snapshot;
+}
+
+/**
+ * 更新soinfo快照并返回自上一次调用以来的差异
+ * @return 新加载和已卸载的库
+ */
+SoinfoDiff zLinker::update_soinfo_snapshot(){
+    std::lock_guard<std::mutex> lock(soinfo_snapshot_mutex);
+    refresh_soinfo_snapshot_locked();
+    SoinfoDiff diff = std::move(soinfo_pending_diff);
+    soinfo_pending_diff = SoinfoDiff();
+    diff.initial = !soinfo_diff_reported;
+    soinfo_diff_reported = true;
+    LOGI("update_soinfo_snapshot: loaded %zu unloaded %zu", diff.loaded.size(), diff.unloaded.size());
+    return diff;
+}
+
+/**
+ * 计算ELF的CRC校验和（ELF头 + 程序头 + 代码段）
+ * 文件视图与内存视图使用相同的计算方式，结果可直接比较
+ */
+static uint64_t get_elf_crc(zElf& elf) {
+    return elf.get_elf_header_crc() + elf.get_program_header_crc() + elf.get_text_segment_crc();
+}
+
 /**
  * 检查共享库的CRC校验和
  * 比较共享库文件版本和内存版本的CRC校验和，检测是否被篡改
@@ -265,13 +442,12 @@ bool zLinker::check_lib_crc(const char* so_name){
     }
 
     // 计算文件版本的CRC校验和（ELF头 + 程序头 + 代码段）
-    uint64_t elf_lib_file_crc = elf_lib_file.get_elf_header_crc() + 
-                                elf_lib_file.get_program_header_crc() + 
-                                elf_lib_file.get_text_segment_crc();
+    uint64_t elf_lib_file_crc = get_elf_crc(elf_lib_file);
     LOGI("check_lib_hash elf_lib_file: %p crc: %lu", elf_lib_file.elf_file_ptr, elf_lib_file_crc);
 
-    // 获取共享库的内存版本zElf对象
-    LibraryMapping* so_mapping = zProcMaps().find_so_by_name(so_name);
+    // 获取共享库的内存版本zElf对象（检测轮次中复用同一份 maps 快照）
+    std::shared_ptr<zProcMaps> proc_maps = zProcMaps::get_round_snapshot();
+    LibraryMapping* so_mapping = proc_maps->find_so_by_name(so_name);
     if (so_mapping == nullptr || so_mapping->address_range_start == nullptr) {
         LOGW("check_lib_crc: failed to resolve memory mapping for %s", so_name);
         return false;
@@ -282,9 +458,7 @@ bool zLinker::check_lib_crc(const char* so_name){
         return false;
     }
     // 计算内存版本的CRC校验和
-    uint64_t elf_lib_mem_crc = elf_lib_mem.get_elf_header_crc() + 
-                               elf_lib_mem.get_program_header_crc() + 
-                               elf_lib_mem.get_text_segment_crc();
+    uint64_t elf_lib_mem_crc = get_elf_crc(elf_lib_mem);
 
 
     LOGI("check_lib_hash elf_lib_mem: %p crc: %lu", elf_lib_mem.elf_mem_ptr, elf_lib_mem_crc);
@@ -299,17 +473,168 @@ bool zLinker::check_lib_crc(const char* so_name){
     return crc_mismatch;
 }
 
+/**
+ * 获取所有已加载共享库的完整性扫描目标
+ * 遍历一次soinfo链表，名称匹配priority_names的库排在最前面
+ * @param priority_names 优先扫描的库名称（如"libart.so"）
+ * @param priority_only 为true时只返回优先扫描的库
+ * @return 扫描目标列表
+ */
+vector<LibCrcTarget> zLinker::get_lib_crc_targets(const vector<string>& priority_names, bool priority_only){
+    vector<LibCrcTarget> priority_targets;
+    vector<LibCrcTarget> other_targets;
+
+    vector<SoinfoEntry> snapshot = get_soinfo_snapshot();
+    for (size_t index = 0; index < snapshot.size(); index++) {
+        const SoinfoEntry& entry = snapshot[index];
+        // 只扫描有真实文件路径的库（跳过 vdso 等没有文件的条目）
+        if (entry.realpath.empty() || entry.realpath[0] != '/' || entry.base == nullptr) {
+            continue;
+        }
+        LibCrcTarget target;
+        target.path = entry.realpath;
+        target.mem_base = entry.base;
+        for (size_t i = 0; i < priority_names.size(); i++) {
+            if (string_end_with(entry.realpath.c_str(), priority_names[i].c_str())) {
+                target.priority = true;
+                break;
+            }
+        }
+        if (target.priority) {
+            priority_targets.push_back(target);
+        } else if (!priority_only) {
+            other_targets.push_back(target);
+        }
+    }
+
+    for (size_t i = 0; i < other_targets.size(); i++) {
+        priority_targets.push_back(other_targets[i]);
+    }
+    LOGI("get_lib_crc_targets: %zu targets", priority_targets.size());
+    return priority_targets;
+}
+
+/**
+ * 扫描单个共享库
+ * 优先目标的文件视图通过zElfCache获取，每轮扫描都可以复用已解析的映射；
+ * 其余目标数量多、只扫描一次，直接解析，避免挤掉缓存中的常用库
+ */
+static void scan_lib_crc(const LibCrcTarget& target, LibCrcResult& result) {
+    struct timespec start_ts;
+    clock_gettime(CLOCK_MONOTONIC, &start_ts);
+
+    result.path = target.path;
+    result.mem_base = target.mem_base;
+
+    if (target.priority) {
+        zElfCache* cache = zElfCache::getInstance();
+        std::shared_ptr<zElf> elf_file = cache == nullptr ? nullptr : cache->get_file_elf(target.path, target.mem_base);
+        if (elf_file != nullptr && elf_file->elf_file_ptr != nullptr) {
+            result.file_ok = true;
+            result.file_crc = get_elf_crc(*elf_file);
+        }
+    } else {
+        zElf elf_file((char*)target.path.c_str());
+        if (elf_file.link_view == zElf::LINK_VIEW::FILE_VIEW && elf_file.elf_file_ptr != nullptr) {
+            result.file_ok = true;
+            result.file_crc = get_elf_crc(elf_file);
+        }
+    }
+
+    // 内存视图直接从加载基址解析，先确认基址处是ELF头
+    if (target.mem_base != nullptr && memcmp(target.mem_base, ELFMAG, SELFMAG) == 0) {
+        zElf elf_mem(target.mem_base);
+        if (elf_mem.elf_mem_ptr != nullptr) {
+            result.mem_ok = true;
+            result.mem_crc = get_elf_crc(elf_mem);
+        }
+    }
+
+    result.crc_mismatch = result.file_ok && result.mem_ok && result.file_crc != result.mem_crc;
+    if (result.crc_mismatch) {
+        LOGW("check_libs_crc: CRC mismatch detected for %s", target.path.c_str());
+    }
+
+    struct timespec end_ts;
+    clock_gettime(CLOCK_MONOTONIC, &end_ts);
+    result.elapsed_ns = (uint64_t)(end_ts.tv_sec - start_ts.tv_sec) * 1000000000ULL + end_ts.tv_nsec - start_ts.tv_nsec;
+}
+
+/**
+ * 批量扫描的共享状态
+ * 由调用线程与线程池辅助任务共同持有，辅助任务可能在扫描结束后才被调度，
+ * 此时只会发现没有剩余目标并直接退出
+ */
+struct LibCrcScanState {
+    vector<LibCrcTarget> targets;
+    vector<LibCrcResult> results;
+    std::atomic<size_t> next_index{0};
+    std::atomic<size_t> done_count{0};
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+
+    // 循环领取目标直到全部领取完
+    void run() {
+        size_t total = targets.size();
+        while (true) {
+            size_t index = next_index.fetch_add(1);
+            if (index >= total) {
+                return;
+            }
+            scan_lib_crc(targets[index], results[index]);
+            if (done_count.fetch_add(1) + 1 == total) {
+                std::lock_guard<std::mutex> lock(done_mutex);
+                done_cv.notify_all();
+            }
+        }
+    }
+};
+
+/**
+ * 批量检查共享库的CRC校验和
+ * 调用线程与线程池中的辅助任务一起按顺序领取目标，调用线程本身也参与扫描，
+ * 即使线程池繁忙也能完成，不会因为等待线程池而阻塞
+ * @param targets 扫描目标，按顺序领取，优先目标应放在最前面
+ * @param shard_count 并行度（包括调用线程），为1时在调用线程上串行扫描
+ * @return 与targets一一对应的扫描结果
+ */
+vector<LibCrcResult> zLinker::check_libs_crc(const vector<LibCrcTarget>& targets, size_t shard_count){
+    LOGD("check_libs_crc called with %zu targets, shard_count %zu", targets.size(), shard_count);
+    std::shared_ptr<LibCrcScanState> state = std::make_shared<LibCrcScanState>();
+    state->targets = targets;
+    state->results.resize(targets.size());
+    if (targets.empty()) {
+        return state->results;
+    }
+
+    // 向线程池提交辅助任务，数量不超过目标数
+    size_t helper_count = shard_count > 1 ? shard_count - 1 : 0;
+    if (helper_count > targets.size() - 1) {
+        helper_count = targets.size() - 1;
+    }
+    zThreadPool* pool = helper_count > 0 ? zThreadPool::getInstance() : nullptr;
+    for (size_t i = 0; pool != nullptr && i < helper_count; i++) {
+        pool->addTask(string_format("check_libs_crc_%zu", i), [state]() {
+            state->run();
+        });
+    }
+
+    // 调用线程参与扫描，然后等待辅助任务完成已领取的目标
+    state->run();
+    {
+        std::unique_lock<std::mutex> lock(state->done_mutex);
+        state->done_cv.wait(lock, [&state]() {
+            return state->done_count.load() == state->targets.size();
+        });
+    }
+    return state->results;
+}
+
 /**
  * zLinker析构函数
  * 清理资源，取消内存映射
  */
 zLinker::~zLinker() {
-    // 清理资源
-    if (elf_file_ptr != nullptr) {
-        if (munmap(elf_file_ptr, getFileSize()) != 0) {
-            LOGW("Failed to munmap linker64: %s", strerror(errno));
-        }
-        elf_file_ptr = nullptr;
-    }
+    // linker64 以 FILE_VIEW 解析，映射（或回退读取的缓冲区）由父类析构函数释放
     // 父类析构函数会自动处理文件描述符
 }
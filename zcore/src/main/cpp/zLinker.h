@@ -10,8 +10,10 @@
 #include <unistd.h>
 #include <sys/mman.h>
 #include <link.h>
+#include <mutex>
 
 #include "zElf.h"
+#include "zElfCache.h"
 
 
 /**
@@ -31,6 +33,49 @@ struct soinfo{
     soinfo *next;               // 链表下一个节点指针
 };
 
+/**
+ * soinfo快照条目
+ * 记录一次遍历时每个soinfo节点的关键信息，下一次遍历时节点未变化则直接复用路径
+ */
+struct SoinfoEntry {
+    void* soinfo_ptr = nullptr;         // soinfo节点地址
+    string realpath;                    // 共享库真实路径
+    void* base = nullptr;               // 加载基址
+    size_t size = 0;                    // 加载大小
+};
+
+/**
+ * soinfo快照差异
+ */
+struct SoinfoDiff {
+    vector<SoinfoEntry> loaded;         // 新加载的库
+    vector<SoinfoEntry> unloaded;       // 已卸载的库
+    bool initial = false;               // 首次update_soinfo_snapshot，loaded为当时已加载的全部库
+};
+
+/**
+ * 共享库完整性扫描目标
+ */
+struct LibCrcTarget {
+    string path;                        // 共享库文件路径
+    void* mem_base = nullptr;           // 内存基址，为nullptr时只计算文件CRC
+    bool priority = false;              // 优先扫描，文件视图通过zElfCache复用
+};
+
+/**
+ * 共享库完整性扫描结果
+ */
+struct LibCrcResult {
+    string path;                        // 共享库文件路径
+    void* mem_base = nullptr;           // 内存基址
+    bool file_ok = false;               // 文件视图解析成功
+    bool mem_ok = false;                // 内存视图解析成功
+    bool crc_mismatch = false;          // 文件与内存CRC不一致
+    uint64_t file_crc = 0;              // 文件CRC（ELF头 + 程序头 + 代码段）
+    uint64_t mem_crc = 0;               // 内存CRC（ELF头 + 程序头 + 代码段）
+    uint64_t elapsed_ns = 0;            // 该库的扫描耗时
+};
+
 /**
  * 动态链接器检测类
  * 继承自zElf类，负责检测和分析Android动态链接器
@@ -50,6 +95,21 @@ private:
     // 静态单例实例指针
     static zLinker* instance;
 
+    // 最近一次遍历soinfo链表的快照（链表顺序）
+    vector<SoinfoEntry> soinfo_snapshot;
+
+    // 自上次update_soinfo_snapshot以来累计的差异
+    SoinfoDiff soinfo_pending_diff;
+
+    // 是否已经调用过update_soinfo_snapshot
+    bool soinfo_diff_reported = false;
+
+    // 保护快照与差异
+    std::mutex soinfo_snapshot_mutex;
+
+    // 重新遍历soinfo链表并更新快照，调用方需持有soinfo_snapshot_mutex
+    void refresh_soinfo_snapshot_locked();
+
 public:
     /**
      * 获取单例实例
@@ -82,6 +142,14 @@ public:
      */
     zElf find_lib(const char* so_name);
 
+    /**
+     * 查找共享库并返回缓存的zElf对象
+     * 与find_lib相同的查找方式，但通过zElfCache共享解析结果，重复调用不会重新解析文件
+     * @param so_name 共享库名称（如"libart.so"）
+     * @return 共享的zElf对象，未找到或解析失败时返回nullptr
+     */
+    std::shared_ptr<zElf> get_lib(const char* so_name);
+
     /**
      * 获取所有已加载共享库的路径列表
      * 遍历soinfo链表，收集所有共享库的真实路径
@@ -89,6 +157,34 @@ public:
      */
     vector<string> get_libpath_list();
 
+    /**
+     * 获取soinfo快照
+     * 重新遍历soinfo链表，节点地址、基址、大小和路径都未变化的条目直接复用上一次的路径，不再拷贝
+     * @return 按链表顺序排列的快照
+     */
+    vector<SoinfoEntry> get_soinfo_snapshot();
+
+    /**
+     * 更新soinfo快照并返回差异
+     * 差异为自上一次调用以来新加载和已卸载的库（期间其它接口触发的遍历也会累计进来）
+     * 首次调用时所有库都视为新加载，并设置initial
+     * 由检测轮次（get_linker_info）每轮调用一次取走累计的差异
+     * @return 新加载和已卸载的库
+     */
+    SoinfoDiff update_soinfo_snapshot();
+
+    /**
+     * 遍历soinfo链表生成快照
+     * 与previous中节点地址、基址、大小、路径都相同的条目视为未变化，直接移动previous中的路径
+     * @param head 链表头
+     * @param get_realpath 获取路径的函数
+     * @param previous 上一次的快照，调用后失效
+     * @param diff 不为nullptr时追加新加载和已卸载的条目
+     * @return 按链表顺序排列的新快照
+     */
+    static vector<SoinfoEntry> walk_soinfo_list(soinfo* head, char*(*get_realpath)(void*),
+                                                vector<SoinfoEntry>& previous, SoinfoDiff* diff);
+
     /**
      * 检查共享库的CRC校验和
      * 比较共享库文件版本和内存版本的CRC校验和，检测是否被篡改
@@ -96,6 +192,25 @@ public:
      * @return 如果CRC不匹配返回true，表示库被篡改
      */
     static bool check_lib_crc(const char* so_name);
+
+    /**
+     * 获取所有已加载共享库的完整性扫描目标
+     * 遍历一次soinfo链表，名称匹配priority_names的库排在最前面
+     * @param priority_names 优先扫描的库名称（如"libart.so"）
+     * @param priority_only 为true时只返回优先扫描的库
+     * @return 扫描目标列表
+     */
+    vector<LibCrcTarget> get_lib_crc_targets(const vector<string>& priority_names = {}, bool priority_only = false);
+
+    /**
+     * 批量检查共享库的CRC校验和
+     * 调用线程与线程池中的辅助任务一起按顺序领取目标，调用线程本身也参与扫描，
+     * 即使线程池繁忙也能完成，不会因为等待线程池而阻塞
+     * @param targets 扫描目标，按顺序领取，优先目标应放在最前面
+     * @param shard_count 并行度（包括调用线程），为1时在调用线程上串行扫描
+     * @return 与targets一一对应的扫描结果
+     */
+    static vector<LibCrcResult> check_libs_crc(const vector<LibCrcTarget>& targets, size_t shard_count = 4);
 };
 
 #endif //OVERT_ZLINKER_H
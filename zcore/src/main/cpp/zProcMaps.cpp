@@ -3,6 +3,7 @@
 //
 
 #include "zProcMaps.h"
+#include "zTaskGraph.h"
 #include "zStdUtil.h"
 
 zProcMaps::zProcMaps() {
@@ -113,6 +114,10 @@ LibraryMapping* zProcMaps::find_so_by_name(string so_name) {
     return nullptr;
 }
 
-
-
-
+std::shared_ptr<zProcMaps> zProcMaps::get_round_snapshot() {
+    std::shared_ptr<zProcMaps> snapshot = zTaskGraph::getInput<zProcMaps>(ROUND_INPUT_NAME);
+    if (snapshot != nullptr) {
+        return snapshot;
+    }
+    return std::make_shared<zProcMaps>();
+}
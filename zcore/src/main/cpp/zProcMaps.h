@@ -5,6 +5,8 @@
 #ifndef OVERT_ZPROCMAPS_H
 #define OVERT_ZPROCMAPS_H
 
+#include <memory>
+
 #include "zLog.h"
 #include "zStd.h"
 #include "zFile.h"
@@ -41,6 +43,14 @@ public :
 
     LibraryMapping* find_so_by_name(string so_name);
 
+    // 检测轮次中共享的 maps 快照对应的 zTaskGraph 输入节点名
+    static constexpr const char* ROUND_INPUT_NAME = "proc_maps";
+
+    /**
+     * 获取本轮检测共享的 maps 快照，不在检测轮次中（或本轮没有该输入）时重新读取 /proc/self/maps
+     */
+    static std::shared_ptr<zProcMaps> get_round_snapshot();
+
 };
 
 
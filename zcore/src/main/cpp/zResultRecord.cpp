@@ -0,0 +1,516 @@
+//
+// Created by lxz on 2025/12/09.
+// zResultRecord 实现 - 紧凑的检测结果记录
+//
+
+#include <stdarg.h>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <algorithm>
+
+#include "zJsonWriter.h"
+#include "zResultRecord.h"
+
+namespace {
+
+/**
+ * 全局键表：开放寻址的哈希表，槽位保存 KeyId + 1，0 表示空槽
+ * 键只增加不删除，名称发布后不再修改，查找只需要 acquire 读，插入在互斥锁内进行
+ */
+struct KeyTable {
+    static const size_t SLOT_COUNT = zResultRecord::MAX_KEYS * 2;
+
+    std::mutex mutex;
+    std::atomic<uint32_t> slots[SLOT_COUNT];
+    std::atomic<const string*> names[zResultRecord::MAX_KEYS];
+    std::atomic<uint32_t> count;
+
+    KeyTable() : count(0) {
+        for (size_t i = 0; i < SLOT_COUNT; i++) {
+            slots[i].store(0, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < zResultRecord::MAX_KEYS; i++) {
+            names[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+};
+
+uint32_t hash_key(const char* key, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t) key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool key_equals(const string* name, const char* key, size_t length) {
+    return name->size() == length && (length == 0 || memcmp(name->data(), key, length) == 0);
+}
+
+/**
+ * 在键表中查找，found 返回是否找到，没找到时 slot 为应插入的空槽（表满时为 SLOT_COUNT）
+ */
+uint32_t find_key(KeyTable& table, const char* key, size_t length, size_t& slot, bool& found) {
+    size_t index = hash_key(key, length) & (KeyTable::SLOT_COUNT - 1);
+    for (size_t probe = 0; probe < KeyTable::SLOT_COUNT; probe++) {
+        uint32_t value = table.slots[index].load(std::memory_order_acquire);
+        if (value == 0) {
+            slot = index;
+            found = false;
+            return 0;
+        }
+        const string* name = table.names[value - 1].load(std::memory_order_acquire);
+        if (key_equals(name, key, length)) {
+            slot = index;
+            found = true;
+            return value - 1;
+        }
+        index = (index + 1) & (KeyTable::SLOT_COUNT - 1);
+    }
+    slot = KeyTable::SLOT_COUNT;
+    found = false;
+    return 0;
+}
+
+uint32_t insert_key_locked(KeyTable& table, const char* key, size_t length) {
+    size_t slot = 0;
+    bool found = false;
+    uint32_t id = find_key(table, key, length, slot, found);
+    if (found) {
+        return id;
+    }
+    uint32_t count = table.count.load(std::memory_order_relaxed);
+    if (count >= zResultRecord::MAX_KEYS || slot == KeyTable::SLOT_COUNT) {
+        return zResultRecord::KEY_EXTERNAL;
+    }
+    // 先发布名称再发布槽位，读到槽位的线程一定能读到名称
+    table.names[count].store(new string(key, length), std::memory_order_release);
+    table.count.store(count + 1, std::memory_order_release);
+    table.slots[slot].store(count + 1, std::memory_order_release);
+    return count;
+}
+
+KeyTable& get_key_table() {
+    // 不析构，进程退出时其它线程可能仍在使用
+    static KeyTable* table = [] {
+        KeyTable* t = new KeyTable();
+        insert_key_locked(*t, "risk", 4);
+        insert_key_locked(*t, "explain", 7);
+        return t;
+    }();
+    return *table;
+}
+
+// 与 string::compare 相同，按 char 逐个比较，保证排序与 map 一致
+int compare_bytes(const char* a, size_t aLength, const char* b, size_t bLength) {
+    size_t length = aLength < bLength ? aLength : bLength;
+    for (size_t i = 0; i < length; i++) {
+        if (a[i] < b[i]) return -1;
+        if (a[i] > b[i]) return 1;
+    }
+    if (aLength < bLength) return -1;
+    if (aLength > bLength) return 1;
+    return 0;
+}
+
+// 一个条目内按键排序的字段，index 为字段下标，最高位表示条目的风险等级
+struct JsonEntry {
+    const char* key;
+    size_t keyLength;
+    uint32_t index;
+};
+
+const uint32_t ENTRY_RISK = 0x80000000u;
+
+} // namespace
+
+zResultRecord::KeyId zResultRecord::internKey(const char* key, size_t length) {
+    KeyTable& table = get_key_table();
+    size_t slot = 0;
+    bool found = false;
+    uint32_t id = find_key(table, key, length, slot, found);
+    if (found) {
+        return (KeyId) id;
+    }
+    std::lock_guard<std::mutex> lock(table.mutex);
+    id = insert_key_locked(table, key, length);
+    if (id == KEY_EXTERNAL) {
+        LOGW("zResultRecord::internKey: key table full, key stored inline");
+    }
+    return (KeyId) id;
+}
+
+zResultRecord::KeyId zResultRecord::internKey(const char* key) {
+    return internKey(key, strlen(key));
+}
+
+zResultRecord::KeyId zResultRecord::internKey(const string& key) {
+    return internKey(key.data(), key.size());
+}
+
+bool zResultRecord::getKeyName(KeyId id, const char*& data, size_t& length) {
+    if (id >= MAX_KEYS) {
+        return false;
+    }
+    const string* name = get_key_table().names[id].load(std::memory_order_acquire);
+    if (name == nullptr) {
+        return false;
+    }
+    data = name->data();
+    length = name->size();
+    return true;
+}
+
+size_t zResultRecord::getKeyCount() {
+    return get_key_table().count.load(std::memory_order_acquire);
+}
+
+const char* zResultRecord::getRiskName(Risk risk) {
+    switch (risk) {
+        case RISK_SAFE: return "safe";
+        case RISK_WARN: return "warn";
+        case RISK_ERROR: return "error";
+        default: return "";
+    }
+}
+
+bool zResultRecord::parseRisk(const char* value, size_t length, Risk& risk) {
+    if (length == 4 && memcmp(value, "safe", 4) == 0) {
+        risk = RISK_SAFE;
+    } else if (length == 4 && memcmp(value, "warn", 4) == 0) {
+        risk = RISK_WARN;
+    } else if (length == 5 && memcmp(value, "error", 5) == 0) {
+        risk = RISK_ERROR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void zResultRecord::reserve(size_t items, size_t fields, size_t arenaBytes) {
+    m_items.reserve(items);
+    m_fields.reserve(fields);
+    m_arena.reserve(arenaBytes);
+}
+
+void zResultRecord::clear() {
+    m_items.clear();
+    m_fields.clear();
+    m_arena.clear();
+}
+
+uint32_t zResultRecord::appendArena(const char* data, size_t length) {
+    uint32_t offset = (uint32_t) m_arena.size();
+    m_arena.insert(m_arena.end(), data, data + length);
+    return offset;
+}
+
+zResultRecord& zResultRecord::addItem(const char* name, size_t length, Risk risk) {
+    Item item;
+    item.nameOffset = appendArena(name, length);
+    item.nameLength = (uint32_t) length;
+    item.firstField = (uint32_t) m_fields.size();
+    item.fieldCount = 0;
+    item.risk = risk;
+    m_items.push_back(item);
+    return *this;
+}
+
+zResultRecord& zResultRecord::addItem(const char* name, Risk risk) {
+    return addItem(name, strlen(name), risk);
+}
+
+zResultRecord& zResultRecord::addItem(const string& name, Risk risk) {
+    return addItem(name.data(), name.size(), risk);
+}
+
+zResultRecord& zResultRecord::addItem(const string& name, Risk risk, const char* explain) {
+    return addItem(name.data(), name.size(), risk).addField(KEY_EXPLAIN, explain);
+}
+
+zResultRecord& zResultRecord::addItem(const string& name, Risk risk, const string& explain) {
+    return addItem(name.data(), name.size(), risk).addField(KEY_EXPLAIN, explain);
+}
+
+zResultRecord& zResultRecord::addField(KeyId key, const char* value, size_t length) {
+    if (m_items.empty()) {
+        LOGW("zResultRecord::addField: no item");
+        return *this;
+    }
+    if (key == KEY_EXTERNAL || key >= getKeyCount()) {
+        LOGW("zResultRecord::addField: invalid key %u", key);
+        return *this;
+    }
+    Field field;
+    field.key = key;
+    if (length <= INLINE_VALUE_SIZE) {
+        field.inlineLength = (uint8_t) length;
+        memcpy(field.inlineValue, value, length);
+        field.offset = 0;
+    } else {
+        field.inlineLength = VALUE_IN_ARENA;
+        field.offset = appendArena(value, length);
+    }
+    field.length = (uint32_t) length;
+    m_fields.push_back(field);
+    m_items.back().fieldCount++;
+    return *this;
+}
+
+zResultRecord& zResultRecord::addField(KeyId key, const char* value) {
+    return addField(key, value, strlen(value));
+}
+
+zResultRecord& zResultRecord::addField(KeyId key, const string& value) {
+    return addField(key, value.data(), value.size());
+}
+
+void zResultRecord::addExternalField(const char* key, size_t keyLength, const char* value, size_t length) {
+    if (m_items.empty()) {
+        LOGW("zResultRecord::addField: no item");
+        return;
+    }
+    Field field;
+    field.key = KEY_EXTERNAL;
+    field.inlineLength = VALUE_IN_ARENA;
+    uint32_t storedKeyLength = (uint32_t) keyLength;
+    memcpy(field.inlineValue, &storedKeyLength, sizeof(storedKeyLength));
+    field.offset = appendArena(key, keyLength);
+    appendArena(value, length);
+    field.length = (uint32_t) length;
+    m_fields.push_back(field);
+    m_items.back().fieldCount++;
+}
+
+zResultRecord& zResultRecord::addField(const char* key, const char* value) {
+    size_t keyLength = strlen(key);
+    KeyId id = internKey(key, keyLength);
+    if (id == KEY_EXTERNAL) {
+        addExternalField(key, keyLength, value, strlen(value));
+        return *this;
+    }
+    return addField(id, value, strlen(value));
+}
+
+zResultRecord& zResultRecord::addField(const char* key, const string& value) {
+    size_t keyLength = strlen(key);
+    KeyId id = internKey(key, keyLength);
+    if (id == KEY_EXTERNAL) {
+        addExternalField(key, keyLength, value.data(), value.size());
+        return *this;
+    }
+    return addField(id, value.data(), value.size());
+}
+
+zResultRecord& zResultRecord::addNumber(KeyId key, uint64_t value) {
+    char buffer[24];
+    int length = snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long) value);
+    return addField(key, buffer, (size_t) length);
+}
+
+zResultRecord& zResultRecord::addNumber(KeyId key, int64_t value) {
+    char buffer[24];
+    int length = snprintf(buffer, sizeof(buffer), "%lld", (long long) value);
+    return addField(key, buffer, (size_t) length);
+}
+
+zResultRecord& zResultRecord::addFormat(KeyId key, const char* format, ...) {
+    if (m_items.empty() || key == KEY_EXTERNAL || key >= getKeyCount()) {
+        // 由 addField 输出警告
+        return addField(key, "", 0);
+    }
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0 || (size_t) length < sizeof(buffer)) {
+        va_end(copy);
+        return addField(key, buffer, length < 0 ? 0 : (size_t) length);
+    }
+    // 超过栈上缓冲区时直接格式化到 arena 末尾
+    size_t offset = m_arena.size();
+    m_arena.resize(offset + length + 1);
+    vsnprintf(m_arena.data() + offset, length + 1, format, copy);
+    va_end(copy);
+    m_arena.resize(offset + length);
+    Field field;
+    field.key = key;
+    field.inlineLength = VALUE_IN_ARENA;
+    field.offset = (uint32_t) offset;
+    field.length = (uint32_t) length;
+    m_fields.push_back(field);
+    m_items.back().fieldCount++;
+    return *this;
+}
+
+void zResultRecord::getFieldKey(const Field& field, const char*& data, size_t& length) const {
+    if (field.key == KEY_EXTERNAL) {
+        uint32_t keyLength = 0;
+        memcpy(&keyLength, field.inlineValue, sizeof(keyLength));
+        data = m_arena.data() + field.offset;
+        length = keyLength;
+        return;
+    }
+    if (!getKeyName(field.key, data, length)) {
+        data = "";
+        length = 0;
+    }
+}
+
+void zResultRecord::getFieldValue(const Field& field, const char*& data, size_t& length) const {
+    length = field.length;
+    if (field.inlineLength != VALUE_IN_ARENA) {
+        data = field.inlineValue;
+    } else if (field.key == KEY_EXTERNAL) {
+        uint32_t keyLength = 0;
+        memcpy(&keyLength, field.inlineValue, sizeof(keyLength));
+        data = m_arena.data() + field.offset + keyLength;
+    } else {
+        data = m_arena.data() + field.offset;
+    }
+}
+
+void zResultRecord::appendTo(Info& info) const {
+    for (const Item& item : m_items) {
+        map<string, string>& item_info = info[string(m_arena.data() + item.nameOffset, item.nameLength)];
+        if (item.risk != RISK_NONE) {
+            item_info["risk"] = getRiskName(item.risk);
+        }
+        for (uint32_t i = item.firstField; i < item.firstField + item.fieldCount; i++) {
+            const char* key;
+            size_t keyLength;
+            const char* value;
+            size_t valueLength;
+            getFieldKey(m_fields[i], key, keyLength);
+            getFieldValue(m_fields[i], value, valueLength);
+            item_info[string(key, keyLength)] = string(value, valueLength);
+        }
+    }
+}
+
+zResultRecord::Info zResultRecord::toInfo() const {
+    Info info;
+    appendTo(info);
+    return info;
+}
+
+void zResultRecord::assign(const Info& info) {
+    clear();
+    for (const auto& item : info) {
+        Risk risk = RISK_NONE;
+        auto risk_it = item.second.find("risk");
+        bool known_risk = risk_it != item.second.end() &&
+                          parseRisk(risk_it->second.data(), risk_it->second.size(), risk);
+        addItem(item.first, risk);
+        for (const auto& field : item.second) {
+            if (known_risk && field.first == "risk") {
+                continue;
+            }
+            KeyId key = internKey(field.first);
+            if (key == KEY_EXTERNAL) {
+                addExternalField(field.first.data(), field.first.size(), field.second.data(), field.second.size());
+            } else {
+                addField(key, field.second);
+            }
+        }
+    }
+}
+
+void zResultRecord::toJson(string& out) const {
+    out.resize(0);
+    std::vector<uint32_t> order(m_items.size());
+    std::iota(order.begin(), order.end(), 0);
+    // 同名条目按添加顺序排列，合并时后添加的覆盖先添加的（按下标区分，不用 stable_sort 的临时缓冲区）
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        const Item& left = m_items[a];
+        const Item& right = m_items[b];
+        int result = compare_bytes(m_arena.data() + left.nameOffset, left.nameLength,
+                                   m_arena.data() + right.nameOffset, right.nameLength);
+        return result < 0 || (result == 0 && a < b);
+    });
+
+    std::vector<JsonEntry> entries;
+    entries.reserve(m_fields.size() + m_items.size());
+    out.push_back('{');
+    size_t group = 0;
+    while (group < order.size()) {
+        const Item& first = m_items[order[group]];
+        const char* name = m_arena.data() + first.nameOffset;
+        size_t end = group + 1;
+        while (end < order.size()) {
+            const Item& next = m_items[order[end]];
+            if (compare_bytes(name, first.nameLength, m_arena.data() + next.nameOffset, next.nameLength) != 0) {
+                break;
+            }
+            end++;
+        }
+
+        // 按 appendTo 的赋值顺序收集字段：每个条目先是风险等级再是字段
+        entries.clear();
+        for (size_t i = group; i < end; i++) {
+            const Item& item = m_items[order[i]];
+            if (item.risk != RISK_NONE) {
+                entries.push_back({"risk", 4, ENTRY_RISK | order[i]});
+            }
+            for (uint32_t f = item.firstField; f < item.firstField + item.fieldCount; f++) {
+                JsonEntry entry;
+                getFieldKey(m_fields[f], entry.key, entry.keyLength);
+                entry.index = f;
+                entries.push_back(entry);
+            }
+        }
+        // 一个条目只有几个字段，插入排序，保持同名键的赋值顺序
+        for (size_t i = 1; i < entries.size(); i++) {
+            JsonEntry entry = entries[i];
+            size_t j = i;
+            while (j > 0 && compare_bytes(entry.key, entry.keyLength, entries[j - 1].key, entries[j - 1].keyLength) < 0) {
+                entries[j] = entries[j - 1];
+                j--;
+            }
+            entries[j] = entry;
+        }
+
+        if (group > 0) {
+            out.push_back(',');
+        }
+        zJsonWriter::appendString(out, name, first.nameLength);
+        out.append(":{", 2);
+        bool first_field = true;
+        for (size_t i = 0; i < entries.size(); i++) {
+            // 同名键只输出最后赋值的一个
+            if (i + 1 < entries.size() &&
+                compare_bytes(entries[i].key, entries[i].keyLength, entries[i + 1].key, entries[i + 1].keyLength) == 0) {
+                continue;
+            }
+            const char* value;
+            size_t valueLength;
+            if (entries[i].index & ENTRY_RISK) {
+                value = getRiskName(m_items[entries[i].index & ~ENTRY_RISK].risk);
+                valueLength = strlen(value);
+            } else {
+                getFieldValue(m_fields[entries[i].index], value, valueLength);
+            }
+            if (!first_field) {
+                out.push_back(',');
+            }
+            first_field = false;
+            zJsonWriter::appendString(out, entries[i].key, entries[i].keyLength);
+            out.push_back(':');
+            zJsonWriter::appendString(out, value, valueLength);
+        }
+        out.push_back('}');
+        group = end;
+    }
+    out.push_back('}');
+}
+
+string zResultRecord::toJson() const {
+    string out;
+    toJson(out);
+    return out;
+}
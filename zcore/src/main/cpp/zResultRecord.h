@@ -0,0 +1,187 @@
+//
+// Created by lxz on 2025/12/09.
+// zResultRecord - 紧凑的检测结果记录
+//
+
+#ifndef OVERT_ZRESULTRECORD_H
+#define OVERT_ZRESULTRECORD_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "zLog.h"
+#include "zStd.h"
+
+/**
+ * 紧凑的检测结果记录，代替检测直接构造 map<string, map<string, string>>
+ *
+ * 存储方式：
+ * - 条目名称与较长的值追加到同一块连续内存（arena）中，条目与字段只保存偏移和长度
+ * - 字段的键是全局驻留的 KeyId，所有检测共用一张键表，不为每个字段保存键字符串
+ * - 风险等级是枚举，不保存 "safe"/"warn"/"error" 字符串
+ * - 不超过 INLINE_VALUE_SIZE 字节的值（数字、true/false 等）直接放在字段内
+ * clear 保留已分配的容量，同一个记录反复填充时不再分配内存
+ *
+ * 边界上无损地转换为原有格式：toInfo 得到与逐个赋值相同的 map（同名条目合并、同名键后写覆盖），
+ * toJson 得到与 zJson(toInfo()).dump() 相同的字节，但不构造 map 与 DOM
+ *
+ * 用法：
+ *   static const zResultRecord::KeyId KEY_PATH = zResultRecord::internKey("path");
+ *   record.addItem("/proc/self/maps", zResultRecord::RISK_ERROR, "发现 frida-agent")
+ *         .addField(KEY_PATH, path);
+ *
+ * 记录本身不加锁，同一个记录只在一个线程上填充；键表可以在任意线程使用
+ */
+class zResultRecord {
+public:
+    typedef map<string, map<string, string>> Info;
+
+    enum Risk : uint8_t {
+        RISK_NONE = 0,      // 不输出 risk 键
+        RISK_SAFE,
+        RISK_WARN,
+        RISK_ERROR,
+    };
+
+    typedef uint16_t KeyId;
+
+    // 预先驻留的键
+    static const KeyId KEY_RISK = 0;
+    static const KeyId KEY_EXPLAIN = 1;
+
+    // 键表已满时使用，键与值一起存放在 arena 中
+    static const KeyId KEY_EXTERNAL = 0xFFFF;
+
+    static const size_t MAX_KEYS = 4096;
+    static const size_t INLINE_VALUE_SIZE = 13;
+
+private:
+    struct Item {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t firstField;
+        uint32_t fieldCount;
+        Risk risk;
+    };
+
+    // 24 字节；inlineLength 为 VALUE_IN_ARENA 时值在 arena 的 [offset, offset + length)
+    // key 为 KEY_EXTERNAL 时 arena 中先存键再存值，键的长度保存在 inlineValue 的前 4 字节
+    struct Field {
+        KeyId key;
+        uint8_t inlineLength;
+        char inlineValue[INLINE_VALUE_SIZE];
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    static const uint8_t VALUE_IN_ARENA = 0xFF;
+
+    std::vector<char> m_arena;
+    std::vector<Item> m_items;
+    std::vector<Field> m_fields;
+
+    uint32_t appendArena(const char* data, size_t length);
+
+    void getFieldKey(const Field& field, const char*& data, size_t& length) const;
+
+    void getFieldValue(const Field& field, const char*& data, size_t& length) const;
+
+    void addExternalField(const char* key, size_t keyLength, const char* value, size_t length);
+
+public:
+    zResultRecord() = default;
+
+    /**
+     * 预留容量，避免填充过程中扩容
+     */
+    void reserve(size_t items, size_t fields, size_t arenaBytes);
+
+    // 清空内容，保留容量
+    void clear();
+
+    bool empty() const { return m_items.empty(); }
+
+    size_t getItemCount() const { return m_items.size(); }
+
+    size_t getFieldCount() const { return m_fields.size(); }
+
+    size_t getArenaSize() const { return m_arena.size(); }
+
+    /**
+     * 添加条目，之后的 addField 都属于这个条目，直到下一次 addItem
+     * 同名条目可以添加多次，转换时合并
+     */
+    zResultRecord& addItem(const char* name, size_t length, Risk risk = RISK_NONE);
+    zResultRecord& addItem(const char* name, Risk risk = RISK_NONE);
+    zResultRecord& addItem(const string& name, Risk risk = RISK_NONE);
+
+    // 添加条目并设置 explain
+    zResultRecord& addItem(const string& name, Risk risk, const char* explain);
+    zResultRecord& addItem(const string& name, Risk risk, const string& explain);
+
+    /**
+     * 给最近添加的条目添加字段，还没有条目时忽略
+     */
+    zResultRecord& addField(KeyId key, const char* value, size_t length);
+    zResultRecord& addField(KeyId key, const char* value);
+    zResultRecord& addField(KeyId key, const string& value);
+
+    // 按字符串添加，每次都查一次键表，循环中应事先缓存 KeyId
+    zResultRecord& addField(const char* key, const char* value);
+    zResultRecord& addField(const char* key, const string& value);
+
+    // 整数按十进制保存，与 to_string 相同
+    zResultRecord& addNumber(KeyId key, uint64_t value);
+    zResultRecord& addNumber(KeyId key, int64_t value);
+
+    // 按 printf 格式直接写入 arena，不构造临时字符串
+    zResultRecord& addFormat(KeyId key, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+    zResultRecord& setExplain(const char* explain) { return addField(KEY_EXPLAIN, explain); }
+
+    /**
+     * 按添加顺序逐个赋值得到的 map
+     */
+    Info toInfo() const;
+
+    /**
+     * 追加到已有的 map 中，同名条目与键覆盖
+     */
+    void appendTo(Info& info) const;
+
+    /**
+     * 替换为 info 的内容；risk 不是 safe/warn/error 时作为普通字段保存，转换回来时不变
+     */
+    void assign(const Info& info);
+
+    /**
+     * 序列化为与 zJson(toInfo()).dump() 相同的 JSON，字符串由 zJsonWriter 转义，
+     * 不是合法 UTF-8 时与 dump 一样抛出异常
+     * @param out 清空后写入，保留其容量
+     */
+    void toJson(string& out) const;
+    string toJson() const;
+
+    /**
+     * 驻留键，相同的键总是得到相同的 KeyId
+     * 查找不加锁，只有第一次出现的键才加锁插入；键表已满时返回 KEY_EXTERNAL
+     */
+    static KeyId internKey(const char* key, size_t length);
+    static KeyId internKey(const char* key);
+    static KeyId internKey(const string& key);
+
+    /**
+     * KeyId 对应的键，没有这个 KeyId 时返回false
+     */
+    static bool getKeyName(KeyId id, const char*& data, size_t& length);
+
+    static size_t getKeyCount();
+
+    // RISK_NONE 返回空字符串
+    static const char* getRiskName(Risk risk);
+
+    // 只识别 safe、warn、error
+    static bool parseRisk(const char* value, size_t length, Risk& risk);
+};
+
+#endif //OVERT_ZRESULTRECORD_H
@@ -1,3 +1,19 @@
+#include <string.h>
+#include <mutex>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define SHA256_HAS_HW 1
+#elif defined(__x86_64__)
+#include <immintrin.h>
+#include <cpuid.h>
+#define SHA256_HAS_HW 1
+#else
+#define SHA256_HAS_HW 0
+#endif
+
 #include "zSha256.h"
 
 #ifndef _cbmc_
@@ -101,63 +117,353 @@ FN_ uint32_t _word(uint8_t *c)
 
 
 // -----------------------------------------------------------------------------
-static void _addbits(sha256_context *ctx, uint32_t n)
+static void _addbits(sha256_context *ctx, uint64_t n)
 {
     __CPROVER_assume(__CPROVER_DYNAMIC_OBJECT(ctx));
 
-    if (ctx->bits[0] > (0xffffffff - n)) {
-        ctx->bits[1] = (ctx->bits[1] + 1) & 0xFFFFFFFF;
-    }
-    ctx->bits[0] = (ctx->bits[0] + n) & 0xFFFFFFFF;
+    uint64_t bits = ((uint64_t)ctx->bits[1] << 32) | ctx->bits[0];
+    bits += n;
+    ctx->bits[0] = (uint32_t)bits;
+    ctx->bits[1] = (uint32_t)(bits >> 32);
 } // _addbits
 
 
 // -----------------------------------------------------------------------------
-static void _hash(sha256_context *ctx)
-{
-    __CPROVER_assume(__CPROVER_DYNAMIC_OBJECT(ctx));
+// 压缩函数：依次处理 blocks 个 64 字节分组，更新 state
+typedef void (*sha256_compress_fn)(uint32_t state[8], const uint8_t *data, size_t blocks);
+
 
+// -----------------------------------------------------------------------------
+static void _hash_scalar(uint32_t state[8], const uint8_t *data, size_t blocks)
+{
     uint32_t a, b, c, d, e, f, g, h;
     uint32_t t[2];
+    uint32_t W[64];
+
+    while (blocks--) {
+        a = state[0];
+        b = state[1];
+        c = state[2];
+        d = state[3];
+        e = state[4];
+        f = state[5];
+        g = state[6];
+        h = state[7];
+
+        for (uint32_t i = 0; i < 64; i++) {
+            if (i < 16) {
+                W[i] = _word((uint8_t *)&data[_shw(i, 2)]);
+            } else {
+                W[i] = _G1(W[i - 2])  + W[i - 7] +
+                       _G0(W[i - 15]) + W[i - 16];
+            }
 
-    a = ctx->hash[0];
-    b = ctx->hash[1];
-    c = ctx->hash[2];
-    d = ctx->hash[3];
-    e = ctx->hash[4];
-    f = ctx->hash[5];
-    g = ctx->hash[6];
-    h = ctx->hash[7];
-
-    for (uint32_t i = 0; i < 64; i++) {
-        if (i < 16) {
-            ctx->W[i] = _word(&ctx->buf[_shw(i, 2)]);
-        } else {
-            ctx->W[i] = _G1(ctx->W[i - 2])  + ctx->W[i - 7] +
-                        _G0(ctx->W[i - 15]) + ctx->W[i - 16];
+            t[0] = h + _S1(e) + _Ch(e, f, g) + K[i] + W[i];
+            t[1] = _S0(a) + _Ma(a, b, c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + t[0];
+            d = c;
+            c = b;
+            b = a;
+            a = t[0] + t[1];
         }
 
-        t[0] = h + _S1(e) + _Ch(e, f, g) + K[i] + ctx->W[i];
-        t[1] = _S0(a) + _Ma(a, b, c);
-        h = g;
-        g = f;
-        f = e;
-        e = d + t[0];
-        d = c;
-        c = b;
-        b = a;
-        a = t[0] + t[1];
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+        data += 64;
     }
+} // _hash_scalar
 
-    ctx->hash[0] += a;
-    ctx->hash[1] += b;
-    ctx->hash[2] += c;
-    ctx->hash[3] += d;
-    ctx->hash[4] += e;
-    ctx->hash[5] += f;
-    ctx->hash[6] += g;
-    ctx->hash[7] += h;
-} // _hash
+
+#if SHA256_HAS_HW
+#if defined(__aarch64__)
+
+// -----------------------------------------------------------------------------
+// ARMv8 SHA2 扩展：每组 4 轮
+#define SHA256_ARM_ROUNDS(i, m0, m1, m2, m3) \
+    do { \
+        uint32x4_t tmp0 = vaddq_u32(m0, vld1q_u32(&K[4 * (i)])); \
+        uint32x4_t tmp1 = state0; \
+        if ((i) < 12) { \
+            m0 = vsha256su1q_u32(vsha256su0q_u32(m0, m1), m2, m3); \
+        } \
+        state0 = vsha256hq_u32(state0, state1, tmp0); \
+        state1 = vsha256h2q_u32(state1, tmp1, tmp0); \
+    } while (0)
+
+__attribute__((target("sha2")))
+static void _hash_hw(uint32_t state[8], const uint8_t *data, size_t blocks)
+{
+    uint32x4_t state0 = vld1q_u32(&state[0]);
+    uint32x4_t state1 = vld1q_u32(&state[4]);
+
+    while (blocks--) {
+        uint32x4_t abcd_save = state0;
+        uint32x4_t efgh_save = state1;
+
+        uint32x4_t msg0 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 0)));
+        uint32x4_t msg1 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16)));
+        uint32x4_t msg2 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 32)));
+        uint32x4_t msg3 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 48)));
+
+        SHA256_ARM_ROUNDS(0, msg0, msg1, msg2, msg3);
+        SHA256_ARM_ROUNDS(1, msg1, msg2, msg3, msg0);
+        SHA256_ARM_ROUNDS(2, msg2, msg3, msg0, msg1);
+        SHA256_ARM_ROUNDS(3, msg3, msg0, msg1, msg2);
+        SHA256_ARM_ROUNDS(4, msg0, msg1, msg2, msg3);
+        SHA256_ARM_ROUNDS(5, msg1, msg2, msg3, msg0);
+        SHA256_ARM_ROUNDS(6, msg2, msg3, msg0, msg1);
+        SHA256_ARM_ROUNDS(7, msg3, msg0, msg1, msg2);
+        SHA256_ARM_ROUNDS(8, msg0, msg1, msg2, msg3);
+        SHA256_ARM_ROUNDS(9, msg1, msg2, msg3, msg0);
+        SHA256_ARM_ROUNDS(10, msg2, msg3, msg0, msg1);
+        SHA256_ARM_ROUNDS(11, msg3, msg0, msg1, msg2);
+        SHA256_ARM_ROUNDS(12, msg0, msg1, msg2, msg3);
+        SHA256_ARM_ROUNDS(13, msg1, msg2, msg3, msg0);
+        SHA256_ARM_ROUNDS(14, msg2, msg3, msg0, msg1);
+        SHA256_ARM_ROUNDS(15, msg3, msg0, msg1, msg2);
+
+        state0 = vaddq_u32(state0, abcd_save);
+        state1 = vaddq_u32(state1, efgh_save);
+        data += 64;
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+} // _hash_hw
+
+
+// -----------------------------------------------------------------------------
+static int _hw_supported(void)
+{
+    return (getauxval(AT_HWCAP) & HWCAP_SHA2) != 0;
+} // _hw_supported
+
+#else
+
+// -----------------------------------------------------------------------------
+// x86 SHA-NI：state 以 ABEF / CDGH 的形式保存，每组 4 轮
+#define SHA256_NI_ROUNDS(i, m0, m1, m2, m3) \
+    do { \
+        msg = _mm_add_epi32(m0, _mm_loadu_si128((const __m128i *)&K[4 * (i)])); \
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg); \
+        if ((i) < 12) { \
+            m0 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(m0, m1), \
+                                                    _mm_alignr_epi8(m3, m2, 4)), m3); \
+        } \
+        msg = _mm_shuffle_epi32(msg, 0x0E); \
+        state0 = _mm_sha256rnds2_epu32(state0, state1, msg); \
+    } while (0)
+
+__attribute__((target("sha,sse4.1")))
+static void _hash_hw(uint32_t state[8], const uint8_t *data, size_t blocks)
+{
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i msg;
+
+    __m128i tmp = _mm_loadu_si128((const __m128i *)&state[0]);
+    __m128i state1 = _mm_loadu_si128((const __m128i *)&state[4]);
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);             // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);       // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);   // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);    // CDGH
+
+    while (blocks--) {
+        __m128i abef_save = state0;
+        __m128i cdgh_save = state1;
+
+        __m128i msg0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 0)), mask);
+        __m128i msg1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16)), mask);
+        __m128i msg2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 32)), mask);
+        __m128i msg3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 48)), mask);
+
+        SHA256_NI_ROUNDS(0, msg0, msg1, msg2, msg3);
+        SHA256_NI_ROUNDS(1, msg1, msg2, msg3, msg0);
+        SHA256_NI_ROUNDS(2, msg2, msg3, msg0, msg1);
+        SHA256_NI_ROUNDS(3, msg3, msg0, msg1, msg2);
+        SHA256_NI_ROUNDS(4, msg0, msg1, msg2, msg3);
+        SHA256_NI_ROUNDS(5, msg1, msg2, msg3, msg0);
+        SHA256_NI_ROUNDS(6, msg2, msg3, msg0, msg1);
+        SHA256_NI_ROUNDS(7, msg3, msg0, msg1, msg2);
+        SHA256_NI_ROUNDS(8, msg0, msg1, msg2, msg3);
+        SHA256_NI_ROUNDS(9, msg1, msg2, msg3, msg0);
+        SHA256_NI_ROUNDS(10, msg2, msg3, msg0, msg1);
+        SHA256_NI_ROUNDS(11, msg3, msg0, msg1, msg2);
+        SHA256_NI_ROUNDS(12, msg0, msg1, msg2, msg3);
+        SHA256_NI_ROUNDS(13, msg1, msg2, msg3, msg0);
+        SHA256_NI_ROUNDS(14, msg2, msg3, msg0, msg1);
+        SHA256_NI_ROUNDS(15, msg3, msg0, msg1, msg2);
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+        data += 64;
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);          // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);       // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);    // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);       // HGFE
+    _mm_storeu_si128((__m128i *)&state[0], state0);
+    _mm_storeu_si128((__m128i *)&state[4], state1);
+} // _hash_hw
+
+
+// -----------------------------------------------------------------------------
+static int _hw_supported(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSE4_1) || !(ecx & bit_SSSE3)) {
+        return 0;
+    }
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    return (ebx & bit_SHA) != 0;
+} // _hw_supported
+
+#endif
+#else
+
+// -----------------------------------------------------------------------------
+static void _hash_hw(uint32_t state[8], const uint8_t *data, size_t blocks)
+{
+    _hash_scalar(state, data, blocks);
+} // _hash_hw
+
+
+// -----------------------------------------------------------------------------
+static int _hw_supported(void)
+{
+    return 0;
+} // _hw_supported
+
+#endif
+
+
+static sha256_impl _selected_impl = SHA256_IMPL_SCALAR;
+static int _hw_available = 0;
+
+
+// -----------------------------------------------------------------------------
+// 首次使用时检测 CPU 特性（HWCAP / cpuid），选择压缩函数
+static void _select_impl(void)
+{
+    static std::once_flag init_flag;
+    std::call_once(init_flag, []() {
+        _hw_available = _hw_supported();
+        _selected_impl = _hw_available ? SHA256_IMPL_HW : SHA256_IMPL_SCALAR;
+    });
+} // _select_impl
+
+
+// -----------------------------------------------------------------------------
+static sha256_compress_fn _compress_fn(sha256_impl impl)
+{
+    _select_impl();
+    return impl == SHA256_IMPL_HW && _hw_available ? _hash_hw : _hash_scalar;
+} // _compress_fn
+
+
+// -----------------------------------------------------------------------------
+sha256_impl sha256_get_impl(void)
+{
+    _select_impl();
+    return _selected_impl;
+} // sha256_get_impl
+
+
+// -----------------------------------------------------------------------------
+int sha256_impl_supported(sha256_impl impl)
+{
+    _select_impl();
+    return impl == SHA256_IMPL_SCALAR || (impl == SHA256_IMPL_HW && _hw_available);
+} // sha256_impl_supported
+
+
+// -----------------------------------------------------------------------------
+static void _update(sha256_context *ctx, const uint8_t *bytes, size_t len, sha256_compress_fn compress)
+{
+    if (ctx->len > 0) {
+        size_t n = sizeof(ctx->buf) - ctx->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(ctx->buf + ctx->len, bytes, n);
+        ctx->len += n;
+        bytes += n;
+        len -= n;
+        if (ctx->len < sizeof(ctx->buf)) {
+            return;
+        }
+        compress(ctx->hash, ctx->buf, 1);
+        _addbits(ctx, sizeof(ctx->buf) * 8);
+        ctx->len = 0;
+    }
+
+    // 完整的分组直接从输入数据压缩，不再逐字节拷贝到 buf
+    size_t blocks = len / sizeof(ctx->buf);
+    if (blocks > 0) {
+        compress(ctx->hash, bytes, blocks);
+        _addbits(ctx, (uint64_t)blocks * sizeof(ctx->buf) * 8);
+        bytes += blocks * sizeof(ctx->buf);
+        len -= blocks * sizeof(ctx->buf);
+    }
+
+    memcpy(ctx->buf, bytes, len);
+    ctx->len = len;
+} // _update
+
+
+// -----------------------------------------------------------------------------
+static void _done(sha256_context *ctx, uint8_t *hash, sha256_compress_fn compress)
+{
+    uint32_t i, j;
+
+    j = ctx->len % sizeof(ctx->buf);
+    ctx->buf[j] = 0x80;
+    for (i = j + 1; i < sizeof(ctx->buf); i++) {
+        ctx->buf[i] = 0x00;
+    }
+
+    if (ctx->len > 55) {
+        compress(ctx->hash, ctx->buf, 1);
+        for (j = 0; j < sizeof(ctx->buf); j++) {
+            ctx->buf[j] = 0x00;
+        }
+    }
+
+    _addbits(ctx, ctx->len * 8);
+    ctx->buf[63] = _shb(ctx->bits[0],  0);
+    ctx->buf[62] = _shb(ctx->bits[0],  8);
+    ctx->buf[61] = _shb(ctx->bits[0], 16);
+    ctx->buf[60] = _shb(ctx->bits[0], 24);
+    ctx->buf[59] = _shb(ctx->bits[1],  0);
+    ctx->buf[58] = _shb(ctx->bits[1],  8);
+    ctx->buf[57] = _shb(ctx->bits[1], 16);
+    ctx->buf[56] = _shb(ctx->bits[1], 24);
+    compress(ctx->hash, ctx->buf, 1);
+
+    if (hash != NULL) {
+        for (i = 0, j = 24; i < 4; i++, j -= 8) {
+            hash[i +  0] = _shb(ctx->hash[0], j);
+            hash[i +  4] = _shb(ctx->hash[1], j);
+            hash[i +  8] = _shb(ctx->hash[2], j);
+            hash[i + 12] = _shb(ctx->hash[3], j);
+            hash[i + 16] = _shb(ctx->hash[4], j);
+            hash[i + 20] = _shb(ctx->hash[5], j);
+            hash[i + 24] = _shb(ctx->hash[6], j);
+            hash[i + 28] = _shb(ctx->hash[7], j);
+        }
+    }
+} // _done
 
 
 // -----------------------------------------------------------------------------
@@ -185,14 +491,7 @@ void sha256_hash(sha256_context *ctx, const void *data, size_t len)
     if ((ctx != NULL) && (bytes != NULL) && (ctx->len < sizeof(ctx->buf))) {
         __CPROVER_assume(__CPROVER_DYNAMIC_OBJECT(bytes));
         __CPROVER_assume(__CPROVER_DYNAMIC_OBJECT(ctx));
-        for (size_t i = 0; i < len; i++) {
-            ctx->buf[ctx->len++] = bytes[i];
-            if (ctx->len == sizeof(ctx->buf)) {
-                _hash(ctx);
-                _addbits(ctx, sizeof(ctx->buf) * 8);
-                ctx->len = 0;
-            }
-        }
+        _update(ctx, bytes, len, _compress_fn(sha256_get_impl()));
     }
 } // sha256_hash
 
@@ -200,45 +499,8 @@ void sha256_hash(sha256_context *ctx, const void *data, size_t len)
 // -----------------------------------------------------------------------------
 void sha256_done(sha256_context *ctx, uint8_t *hash)
 {
-    uint32_t i, j;
-
     if (ctx != NULL) {
-        j = ctx->len % sizeof(ctx->buf);
-        ctx->buf[j] = 0x80;
-        for (i = j + 1; i < sizeof(ctx->buf); i++) {
-            ctx->buf[i] = 0x00;
-        }
-
-        if (ctx->len > 55) {
-            _hash(ctx);
-            for (j = 0; j < sizeof(ctx->buf); j++) {
-                ctx->buf[j] = 0x00;
-            }
-        }
-
-        _addbits(ctx, ctx->len * 8);
-        ctx->buf[63] = _shb(ctx->bits[0],  0);
-        ctx->buf[62] = _shb(ctx->bits[0],  8);
-        ctx->buf[61] = _shb(ctx->bits[0], 16);
-        ctx->buf[60] = _shb(ctx->bits[0], 24);
-        ctx->buf[59] = _shb(ctx->bits[1],  0);
-        ctx->buf[58] = _shb(ctx->bits[1],  8);
-        ctx->buf[57] = _shb(ctx->bits[1], 16);
-        ctx->buf[56] = _shb(ctx->bits[1], 24);
-        _hash(ctx);
-
-        if (hash != NULL) {
-            for (i = 0, j = 24; i < 4; i++, j -= 8) {
-                hash[i +  0] = _shb(ctx->hash[0], j);
-                hash[i +  4] = _shb(ctx->hash[1], j);
-                hash[i +  8] = _shb(ctx->hash[2], j);
-                hash[i + 12] = _shb(ctx->hash[3], j);
-                hash[i + 16] = _shb(ctx->hash[4], j);
-                hash[i + 20] = _shb(ctx->hash[5], j);
-                hash[i + 24] = _shb(ctx->hash[6], j);
-                hash[i + 28] = _shb(ctx->hash[7], j);
-            }
-        }
+        _done(ctx, hash, _compress_fn(sha256_get_impl()));
     }
 } // sha256_done
 
@@ -254,6 +516,214 @@ void sha256(const void *data, size_t len, uint8_t *hash)
 } // sha256
 
 
+// -----------------------------------------------------------------------------
+void sha256_impl_hash(sha256_impl impl, const void *data, size_t len, uint8_t *hash)
+{
+    sha256_context ctx;
+    sha256_compress_fn compress = _compress_fn(impl);
+
+    sha256_init(&ctx);
+    if (data != NULL) {
+        _update(&ctx, (const uint8_t *)data, len, compress);
+    }
+    _done(&ctx, hash, compress);
+} // sha256_impl_hash
+
+
+// -----------------------------------------------------------------------------
+void sha256_clone(sha256_context *dst, const sha256_context *src)
+{
+    if (dst != NULL && src != NULL) {
+        memcpy(dst, src, sizeof(sha256_context));
+    }
+} // sha256_clone
+
+
+#if 0
+#pragma mark - Multi-buffer
+#endif
+
+// 4 路并行：每一路对应一个输入，一次压缩 4 个输入各自的一个分组
+// 使用编译器向量扩展，在 arm64 上生成 NEON 指令，在 x86 上生成 SSE2 指令
+#define SHA256_LANES 4
+
+typedef uint32_t sha256_vec __attribute__((vector_size(16)));
+
+typedef struct {
+    const uint8_t *data;
+    size_t full_blocks;         // 输入中完整的分组数
+    size_t block_count;         // 包括填充在内的总分组数
+    size_t block_index;         // 下一个要压缩的分组
+    uint8_t *out;
+    uint8_t tail[128];          // 剩余数据与填充
+} sha256_lane;
+
+
+// -----------------------------------------------------------------------------
+static void _lane_start(sha256_lane *lane, const uint8_t *data, size_t len, uint8_t *out)
+{
+    size_t rest = len % 64;
+    size_t tail_blocks = rest + 9 <= 64 ? 1 : 2;
+    uint64_t bits = (uint64_t)len * 8;
+
+    lane->data = data;
+    lane->full_blocks = len / 64;
+    lane->block_count = lane->full_blocks + tail_blocks;
+    lane->block_index = 0;
+    lane->out = out;
+    memset(lane->tail, 0, sizeof(lane->tail));
+    if (rest > 0) {
+        memcpy(lane->tail, data + lane->full_blocks * 64, rest);
+    }
+    lane->tail[rest] = 0x80;
+    for (int i = 0; i < 8; i++) {
+        lane->tail[tail_blocks * 64 - 1 - i] = (uint8_t)(bits >> (8 * i));
+    }
+} // _lane_start
+
+
+// -----------------------------------------------------------------------------
+static const uint8_t *_lane_block(const sha256_lane *lane)
+{
+    if (lane->block_index < lane->full_blocks) {
+        return lane->data + lane->block_index * 64;
+    }
+    return lane->tail + (lane->block_index - lane->full_blocks) * 64;
+} // _lane_block
+
+
+// -----------------------------------------------------------------------------
+static inline sha256_vec _vr(sha256_vec x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+} // _vr
+
+
+// -----------------------------------------------------------------------------
+static void _hash_lanes(sha256_vec state[8], const uint8_t *blocks[SHA256_LANES])
+{
+    sha256_vec W[16];
+    sha256_vec a = state[0], b = state[1], c = state[2], d = state[3];
+    sha256_vec e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 16; i++) {
+        for (int l = 0; l < SHA256_LANES; l++) {
+            W[i][l] = _word((uint8_t *)&blocks[l][i * 4]);
+        }
+    }
+
+    for (int i = 0; i < 64; i++) {
+        if (i >= 16) {
+            sha256_vec w2 = W[(i - 2) & 15];
+            sha256_vec w15 = W[(i - 15) & 15];
+            W[i & 15] += (_vr(w2, 17) ^ _vr(w2, 19) ^ (w2 >> 10)) + W[(i - 7) & 15] +
+                         (_vr(w15, 7) ^ _vr(w15, 18) ^ (w15 >> 3));
+        }
+        sha256_vec t0 = h + (_vr(e, 6) ^ _vr(e, 11) ^ _vr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + W[i & 15];
+        sha256_vec t1 = (_vr(a, 2) ^ _vr(a, 13) ^ _vr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t0;
+        d = c;
+        c = b;
+        b = a;
+        a = t0 + t1;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+} // _hash_lanes
+
+
+// -----------------------------------------------------------------------------
+static void _multi_lanes(const void *const *data, const size_t *len, size_t count, uint8_t *hashes)
+{
+    static const uint32_t iv[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    static const uint8_t idle_block[64] = {0};
+    sha256_lane lanes[SHA256_LANES];
+    int active[SHA256_LANES];
+    sha256_vec state[8];
+    size_t next = 0;
+    int active_count = 0;
+
+    // 某一路的输入处理完后立即换上下一个输入，长短不一的输入也能保持各路都在工作
+    for (int l = 0; l < SHA256_LANES; l++) {
+        active[l] = next < count;
+        if (active[l]) {
+            _lane_start(&lanes[l], (const uint8_t *)data[next], len[next], hashes + next * SHA256_SIZE_BYTES);
+            next++;
+            active_count++;
+        }
+        for (int k = 0; k < 8; k++) {
+            state[k][l] = iv[k];
+        }
+    }
+
+    while (active_count > 0) {
+        const uint8_t *blocks[SHA256_LANES];
+        for (int l = 0; l < SHA256_LANES; l++) {
+            blocks[l] = active[l] ? _lane_block(&lanes[l]) : idle_block;
+        }
+        _hash_lanes(state, blocks);
+
+        for (int l = 0; l < SHA256_LANES; l++) {
+            if (!active[l] || ++lanes[l].block_index < lanes[l].block_count) {
+                continue;
+            }
+            for (int k = 0; k < 8; k++) {
+                uint32_t v = state[k][l];
+                lanes[l].out[k * 4 + 0] = _shb(v, 24);
+                lanes[l].out[k * 4 + 1] = _shb(v, 16);
+                lanes[l].out[k * 4 + 2] = _shb(v, 8);
+                lanes[l].out[k * 4 + 3] = _shb(v, 0);
+                state[k][l] = iv[k];
+            }
+            if (next < count) {
+                _lane_start(&lanes[l], (const uint8_t *)data[next], len[next], hashes + next * SHA256_SIZE_BYTES);
+                next++;
+            } else {
+                active[l] = 0;
+                active_count--;
+            }
+        }
+    }
+} // _multi_lanes
+
+
+// -----------------------------------------------------------------------------
+void sha256_multi_impl(sha256_impl impl, const void *const *data, const size_t *len, size_t count, uint8_t *hashes)
+{
+    if (data == NULL || len == NULL || hashes == NULL) {
+        return;
+    }
+    // 硬件指令单路的吞吐已经高于 4 路软件并行，逐个计算即可
+    if (impl == SHA256_IMPL_HW && sha256_impl_supported(SHA256_IMPL_HW)) {
+        for (size_t i = 0; i < count; i++) {
+            sha256_impl_hash(SHA256_IMPL_HW, data[i], len[i], hashes + i * SHA256_SIZE_BYTES);
+        }
+        return;
+    }
+    _multi_lanes(data, len, count, hashes);
+} // sha256_multi_impl
+
+
+// -----------------------------------------------------------------------------
+void sha256_multi(const void *const *data, const size_t *len, size_t count, uint8_t *hashes)
+{
+    sha256_multi_impl(sha256_get_impl(), data, len, count, hashes);
+} // sha256_multi
+
+
 #if 0
 #pragma mark - Self Test
 #endif
@@ -306,3 +776,57 @@ int main(void)
 #ifdef __cplusplus
 }
 #endif
+
+
+// -----------------------------------------------------------------------------
+zSha256::zSha256()
+{
+    sha256_init(&ctx);
+} // zSha256
+
+
+// -----------------------------------------------------------------------------
+void zSha256::reset()
+{
+    sha256_init(&ctx);
+} // reset
+
+
+// -----------------------------------------------------------------------------
+void zSha256::update(const void *data, size_t len)
+{
+    sha256_hash(&ctx, data, len);
+} // update
+
+
+// -----------------------------------------------------------------------------
+void zSha256::final(uint8_t digest[SHA256_SIZE_BYTES])
+{
+    sha256_done(&ctx, digest);
+    sha256_init(&ctx);
+} // final
+
+
+// -----------------------------------------------------------------------------
+string zSha256::final_hex()
+{
+    static const char hex_chars[] = "0123456789abcdef";
+    uint8_t digest[SHA256_SIZE_BYTES];
+    final(digest);
+
+    string hex;
+    for (size_t i = 0; i < SHA256_SIZE_BYTES; i++) {
+        hex += hex_chars[digest[i] >> 4];
+        hex += hex_chars[digest[i] & 0x0f];
+    }
+    return hex;
+} // final_hex
+
+
+// -----------------------------------------------------------------------------
+zSha256 zSha256::clone() const
+{
+    zSha256 copy;
+    sha256_clone(&copy.ctx, &ctx);
+    return copy;
+} // clone
@@ -5,11 +5,6 @@
 #ifndef FAKECLICKEX_SHA256_H
 #define FAKECLICKEX_SHA256_H
 
-
-class zSha256 {
-
-};
-
 //
 //  SHA-256 implementation, Mark 2
 //
@@ -48,19 +43,68 @@ typedef struct {
     uint32_t bits[2];
     uint32_t len;
     uint32_t rfu__;
-    uint32_t W[64];
 } sha256_context;
 
 void sha256_init(sha256_context *ctx);
 void sha256_hash(sha256_context *ctx, const void *data, size_t len);
 void sha256_done(sha256_context *ctx, uint8_t *hash);
 
+// 复制上下文，用于保存中间状态后分别继续计算
+void sha256_clone(sha256_context *dst, const sha256_context *src);
+
 void sha256(const void *data, size_t len, uint8_t *hash);
 
+// 压缩函数实现，运行时根据 CPU 特性（HWCAP / cpuid）自动选择
+typedef enum {
+    SHA256_IMPL_SCALAR = 0,     // 纯软件实现
+    SHA256_IMPL_HW = 1,         // ARMv8 SHA2 扩展 / x86 SHA-NI
+} sha256_impl;
+
+sha256_impl sha256_get_impl(void);
+int sha256_impl_supported(sha256_impl impl);
+
+// 使用指定实现计算（用于测试和性能对比），不支持时回退到软件实现
+void sha256_impl_hash(sha256_impl impl, const void *data, size_t len, uint8_t *hash);
+
+// 多缓冲：一次计算 count 个输入的摘要，hashes 依次存放 count 个 32 字节摘要
+// 没有硬件指令时 4 个输入为一组并行压缩，适合大量小输入（zip 条目、证书等）
+void sha256_multi(const void *const *data, const size_t *len, size_t count, uint8_t *hashes);
+void sha256_multi_impl(sha256_impl impl, const void *const *data, const size_t *len, size_t count, uint8_t *hashes);
+
 #ifdef __cplusplus
 }
 #endif
 
 #endif
 
+#ifdef __cplusplus
+
+#include "zStd.h"
+
+/**
+ * 流式 SHA-256
+ * 边读取边计算，update 可以调用任意次，final 输出摘要后上下文重置，可以继续计算下一段数据
+ * clone 复制当前的中间状态，用于对公共前缀只计算一次
+ */
+class zSha256 {
+private:
+    sha256_context ctx;
+
+public:
+    zSha256();
+
+    void reset();
+
+    void update(const void* data, size_t len);
+
+    void final(uint8_t digest[SHA256_SIZE_BYTES]);
+
+    // 输出小写十六进制摘要
+    string final_hex();
+
+    zSha256 clone() const;
+};
+
+#endif
+
 #endif //FAKECLICKEX_SHA256_H
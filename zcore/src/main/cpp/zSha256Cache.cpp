@@ -0,0 +1,238 @@
+//
+// Created by lxz on 2025/11/26.
+//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "zLog.h"
+#include "zSha256Cache.h"
+
+// 静态单例实例指针
+zSha256Cache* zSha256Cache::instance = nullptr;
+
+/**
+ * 获取单例实例
+ * 采用线程安全的懒加载模式，首次调用时创建实例
+ * @return zSha256Cache单例指针
+ */
+zSha256Cache* zSha256Cache::getInstance() {
+    // 使用 std::call_once 确保线程安全的单例初始化
+    static std::once_flag init_flag;
+    std::call_once(init_flag, []() {
+        try {
+            instance = new zSha256Cache();
+            LOGI("zSha256Cache: Created singleton instance");
+        } catch (const std::exception& e) {
+            LOGE("zSha256Cache: Failed to create singleton instance: %s", e.what());
+            instance = nullptr;
+        } catch (...) {
+            LOGE("zSha256Cache: Failed to create singleton instance with unknown error");
+            instance = nullptr;
+        }
+    });
+
+    if (instance == nullptr) {
+        LOGE("zSha256Cache: Singleton instance is null");
+    }
+    return instance;
+}
+
+zSha256Cache::zSha256Cache() {
+    LOGD("Constructor called");
+}
+
+zSha256Cache::~zSha256Cache() {
+    LOGD("Destructor called");
+    clear();
+}
+
+/**
+ * 获取文件的 (dev, inode, size, mtime, ctime)
+ * @return stat 成功返回true
+ */
+bool zSha256Cache::stat_identity(const string& path, FileIdentity& identity) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    identity.dev = st.st_dev;
+    identity.ino = st.st_ino;
+    identity.size = st.st_size;
+    identity.mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    identity.ctime_ns = (int64_t)st.st_ctim.tv_sec * 1000000000LL + st.st_ctim.tv_nsec;
+    return true;
+}
+
+static int64_t get_realtime_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * 流式读取整个文件计算 SHA-256，内存占用只有一个读缓冲区
+ */
+static bool hash_file(const string& path, uint8_t* digest) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGW("hash_file: open %s failed: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    vector<uint8_t> buffer;
+    buffer.resize(1024 * 1024);
+    zSha256 sha256;
+    while (true) {
+        ssize_t n = read(fd, buffer.data(), buffer.size());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOGW("hash_file: read %s failed: %s", path.c_str(), strerror(errno));
+            close(fd);
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        sha256.update(buffer.data(), n);
+    }
+    close(fd);
+    sha256.final(digest);
+    return true;
+}
+
+int zSha256Cache::find_entry_locked(const string& path, const string& tag) const {
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].path == path && entries[i].tag == tag) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * 淘汰最久未使用的条目，直到不超过 max_entries
+ */
+void zSha256Cache::evict_lru_locked() {
+    while (entries.size() > max_entries) {
+        size_t oldest = 0;
+        for (size_t i = 1; i < entries.size(); i++) {
+            if (entries[i].last_used < entries[oldest].last_used) {
+                oldest = i;
+            }
+        }
+        LOGD("evict_lru: %s [%s]", entries[oldest].path.c_str(), entries[oldest].tag.c_str());
+        entries.erase(entries.begin() + oldest);
+    }
+}
+
+/**
+ * 计算期间文件被修改（标识变化）的结果不能缓存
+ * ctime 在计算开始前 racy_window_ms 以内的结果也不缓存：之后的修改可能落在同一个时间戳精度内
+ */
+bool zSha256Cache::is_cacheable(const FileIdentity& before, const FileIdentity& after, int64_t start_ns) const {
+    if (!(before == after)) {
+        return false;
+    }
+    int64_t last_change_ns = before.ctime_ns > before.mtime_ns ? before.ctime_ns : before.mtime_ns;
+    return last_change_ns + racy_window_ms * 1000000LL < start_ns;
+}
+
+void zSha256Cache::store(const string& path, const string& tag, const FileIdentity& identity, const uint8_t* digest) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    int index = find_entry_locked(path, tag);
+    if (index < 0) {
+        entries.push_back(CacheEntry());
+        index = (int)entries.size() - 1;
+        entries[index].path = path;
+        entries[index].tag = tag;
+    }
+    CacheEntry& entry = entries[index];
+    entry.identity = identity;
+    memcpy(entry.digest, digest, SHA256_SIZE_BYTES);
+    entry.last_used = ++use_counter;
+    evict_lru_locked();
+}
+
+bool zSha256Cache::get_derived_digest(const string& path, const string& tag,
+                                      const std::function<bool(uint8_t*)>& compute, uint8_t digest[SHA256_SIZE_BYTES]) {
+    FileIdentity before;
+    if (path.empty() || !stat_identity(path, before)) {
+        LOGW("get_derived_digest: stat failed for %s", path.c_str());
+        invalidate(path);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        int index = find_entry_locked(path, tag);
+        if (index >= 0) {
+            CacheEntry& entry = entries[index];
+            if (entry.identity == before) {
+                memcpy(digest, entry.digest, SHA256_SIZE_BYTES);
+                entry.last_used = ++use_counter;
+                hit_count++;
+                return true;
+            }
+            LOGI("get_derived_digest: %s [%s] changed, recompute", path.c_str(), tag.c_str());
+            entries.erase(entries.begin() + index);
+        }
+        miss_count++;
+    }
+
+    // 计算放在锁外，避免阻塞其它文件的查询
+    int64_t start_ns = get_realtime_ns();
+    if (!compute(digest)) {
+        return false;
+    }
+
+    FileIdentity after;
+    if (stat_identity(path, after) && is_cacheable(before, after, start_ns)) {
+        store(path, tag, before, digest);
+    } else {
+        LOGD("get_derived_digest: %s [%s] changed recently, not cached", path.c_str(), tag.c_str());
+    }
+    return true;
+}
+
+bool zSha256Cache::get_file_digest(const string& path, uint8_t digest[SHA256_SIZE_BYTES]) {
+    return get_derived_digest(path, "", [&path](uint8_t* out) {
+        return hash_file(path, out);
+    }, digest);
+}
+
+void zSha256Cache::invalidate(const string& path) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    for (size_t i = 0; i < entries.size();) {
+        if (entries[i].path == path) {
+            entries.erase(entries.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void zSha256Cache::clear() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    entries.clear();
+}
+
+size_t zSha256Cache::size() const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return entries.size();
+}
+
+uint64_t zSha256Cache::get_hit_count() const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return hit_count;
+}
+
+uint64_t zSha256Cache::get_miss_count() const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return miss_count;
+}
@@ -0,0 +1,142 @@
+//
+// Created by lxz on 2025/11/26.
+//
+
+#ifndef OVERT_ZSHA256CACHE_H
+#define OVERT_ZSHA256CACHE_H
+
+#include <mutex>
+#include <functional>
+
+#include "zStd.h"
+#include "zSha256.h"
+
+/**
+ * 文件摘要缓存
+ * 检测任务每一轮都会重新计算同一个 APK / so 的摘要，文件没有变化时直接返回上一次的结果
+ *
+ * 缓存键：文件路径 + 标签（整个文件的摘要使用空标签，其它标签表示从文件中派生出的摘要，例如签名块）
+ * 有效性：命中时重新 stat，(dev, inode, size, mtime, ctime) 任何一项变化都视为文件已被修改
+ *
+ * 时间戳竞争：
+ * 文件在计算期间或者计算前极短时间内被修改时，之后的修改可能得到相同的 mtime / ctime，无法通过 stat 发现，
+ * 因此 ctime 距离计算开始不足 racy_window_ms 的结果不放入缓存，下一次重新计算
+ *
+ * 只保存在内存中：磁盘上的缓存文件可以被篡改，而进程重启后也需要重新校验
+ */
+class zSha256Cache {
+private:
+    // 私有构造函数，防止外部实例化
+    zSha256Cache();
+
+    // 禁用拷贝构造函数
+    zSha256Cache(const zSha256Cache&) = delete;
+
+    // 禁用赋值操作符
+    zSha256Cache& operator=(const zSha256Cache&) = delete;
+
+    // 静态单例实例指针
+    static zSha256Cache* instance;
+
+    /**
+     * 文件标识，stat 得到
+     */
+    struct FileIdentity {
+        uint64_t dev = 0;
+        uint64_t ino = 0;
+        uint64_t size = 0;
+        int64_t mtime_ns = 0;
+        int64_t ctime_ns = 0;
+
+        bool operator==(const FileIdentity& other) const {
+            return dev == other.dev && ino == other.ino && size == other.size
+                   && mtime_ns == other.mtime_ns && ctime_ns == other.ctime_ns;
+        }
+    };
+
+    /**
+     * 缓存条目
+     */
+    struct CacheEntry {
+        string path;                            // 文件路径
+        string tag;                             // 摘要标签，空表示整个文件
+        FileIdentity identity;                  // 计算时的文件标识
+        uint8_t digest[SHA256_SIZE_BYTES];      // 摘要
+        uint64_t last_used = 0;                 // 最近使用序号，用于 LRU 淘汰
+    };
+
+    // 缓存条目，数量很少（受 max_entries 限制），线性查找即可
+    vector<CacheEntry> entries;
+
+    // 缓存互斥锁
+    mutable std::mutex cache_mutex;
+
+    // 使用序号、命中与未命中计数
+    uint64_t use_counter = 0;
+    uint64_t hit_count = 0;
+    uint64_t miss_count = 0;
+
+    static bool stat_identity(const string& path, FileIdentity& identity);
+
+    // 查找条目下标，调用方需持有 cache_mutex，未找到返回-1
+    int find_entry_locked(const string& path, const string& tag) const;
+
+    // 淘汰最久未使用的条目，调用方需持有 cache_mutex
+    void evict_lru_locked();
+
+    // 计算结果是否可以放入缓存：计算前后文件标识一致，且不在时间戳竞争窗口内
+    bool is_cacheable(const FileIdentity& before, const FileIdentity& after, int64_t start_ns) const;
+
+    void store(const string& path, const string& tag, const FileIdentity& identity, const uint8_t* digest);
+
+public:
+    // 缓存条目上限
+    size_t max_entries = 64;
+
+    // 时间戳竞争窗口（毫秒），默认值覆盖 2 秒精度的文件系统
+    int64_t racy_window_ms = 2000;
+
+    /**
+     * 获取单例实例
+     * @return zSha256Cache单例指针
+     */
+    static zSha256Cache* getInstance();
+
+    // 析构函数
+    ~zSha256Cache();
+
+    /**
+     * 获取整个文件的 SHA-256
+     * @param path 文件路径
+     * @param digest 输出摘要
+     * @return 文件不存在或读取失败时返回false
+     */
+    bool get_file_digest(const string& path, uint8_t digest[SHA256_SIZE_BYTES]);
+
+    /**
+     * 获取从文件派生出的摘要，未命中时调用 compute 计算
+     * @param path 文件路径，用于校验有效性
+     * @param tag 摘要标签，同一文件的不同派生摘要使用不同标签
+     * @param compute 计算函数，成功时写入摘要并返回true
+     * @param digest 输出摘要
+     * @return 文件不存在或计算失败时返回false
+     */
+    bool get_derived_digest(const string& path, const string& tag,
+                            const std::function<bool(uint8_t*)>& compute, uint8_t digest[SHA256_SIZE_BYTES]);
+
+    /**
+     * 使指定文件的所有摘要失效
+     */
+    void invalidate(const string& path);
+
+    /**
+     * 清空缓存
+     */
+    void clear();
+
+    size_t size() const;
+    uint64_t get_hit_count() const;
+    uint64_t get_miss_count() const;
+};
+
+#endif //OVERT_ZSHA256CACHE_H
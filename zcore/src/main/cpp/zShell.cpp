@@ -2,21 +2,33 @@
 // Created by lxz on 2025/8/11.
 //
 
+#include <errno.h>
+#include <signal.h>
+#include <sys/wait.h>
+
 #include "zLibc.h"
 #include "zStd.h"
 #include "zLog.h"
+#include "zCancelToken.h"
 
 /**
  * 执行Shell命令
  * 在Android系统中执行指定的Shell命令并返回输出结果
  * 使用fork和execve系统调用实现安全的命令执行
  * 主要用于检测系统中安装的应用程序和系统状态
+ * 在线程池任务中执行时响应任务的取消令牌：取消或超时时杀掉命令的整个进程组，返回已读到的输出
  * @param cmd 要执行的Shell命令
  * @return 命令执行的输出结果字符串
  */
 string runShell(string cmd){
     string ret = "";
 
+    zCancelToken token = zCancelToken::current();
+    if (token.isCancelled()) {
+        LOGW("runShell: cancelled before start: %s", cmd.c_str());
+        return ret;
+    }
+
     // 创建管道用于进程间通信
     int pipefd[2];
     pid_t pid;
@@ -32,10 +44,14 @@ string runShell(string cmd){
     pid = fork();
     if (pid == -1) {
         perror("fork");
+        close(pipefd[0]);
+        close(pipefd[1]);
         return ret;
     }
 
     if (pid == 0) {  // 子进程
+        // 独立的进程组，取消时连同命令派生的子进程一起杀掉
+        setpgid(0, 0);
         // 关闭管道的读取端，只保留写入端
         close(pipefd[0]);
         // 将标准输出重定向到管道的写入端，这样命令的输出会写入管道
@@ -44,18 +60,36 @@ string runShell(string cmd){
         execve("/system/bin/sh", (char* const[]){"sh", "-c", (char*)cmd.c_str(), nullptr}, nullptr);
         // 如果execve失败，输出错误信息并退出
         perror("execve");
-        exit(1);
+        _exit(1);
     } else {  // 父进程
+        // 父进程也设置一次，避免子进程还没执行 setpgid 时取消找不到进程组
+        setpgid(pid, pid);
+
+        // 任务被取消时杀掉进程组，管道写入端随之关闭，read 返回
+        uint64_t callbackId = token.registerCallback([pid]() {
+            kill(-pid, SIGKILL);
+        });
+
         // 关闭管道的写入端，只保留读取端
         close(pipefd[1]);
         ssize_t n;
         // 从管道读取子进程的输出，直到没有更多数据
-        while ((n = read(pipefd[0], buffer, sizeof(buffer) - 1)) > 0) {
+        while ((n = read(pipefd[0], buffer, sizeof(buffer) - 1)) > 0 || (n < 0 && errno == EINTR)) {
+            if (n < 0) {
+                continue;
+            }
             buffer[n] = '\0';  // 确保字符串以 null 结尾
             ret += buffer;     // 将读取的数据添加到结果字符串中
         }
         // 关闭管道的读取端
         close(pipefd[0]);
+
+        // 先注销回调再回收子进程，回收后 pid 可能被复用
+        token.unregisterCallback(callbackId);
+        waitpid(pid, nullptr, 0);
+        if (token.isCancelled()) {
+            LOGW("runShell: cancelled (%s): %s", token.getReason().c_str(), cmd.c_str());
+        }
     }
 
     return ret;
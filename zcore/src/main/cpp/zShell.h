@@ -11,6 +11,7 @@
  * 在Android系统中执行指定的Shell命令并返回输出结果
  * 使用fork和execve系统调用实现安全的命令执行
  * 主要用于检测系统中安装的应用程序和系统状态
+ * 在线程池任务中执行时响应任务的取消令牌：取消或超时时杀掉命令的整个进程组，返回已读到的输出
  * @param cmd 要执行的Shell命令
  * @return 命令执行的输出结果字符串
  */
@@ -10,9 +10,9 @@
 /**
  * 静态任务计数器初始化
  * 用于生成唯一的任务ID，从0开始递增
- * 线程安全：在单线程环境中使用，无需额外保护
+ * 线程安全：原子递增，多个线程同时创建任务也不会得到相同的ID
  */
-int zTask::s_taskCounter = 0;
+std::atomic<uint64_t> zTask::s_taskCounter(0);
 
 /**
  * 构造函数 - 使用自定义任务函数
@@ -33,9 +33,10 @@ int zTask::s_taskCounter = 0;
 zTask::zTask(const string& taskName, std::function<void()> taskFunction)
     : m_taskName(taskName)
     , m_taskFunction(taskFunction)
-    , m_taskId(generateTaskId())
+    , m_id(generateId())
+    , m_taskId("task_" + to_string(m_id))
 {
-    LOGI("zTask: Creating task '%s' with ID '%s'", m_taskName.c_str(), m_taskId.c_str());
+    LOGD("zTask: Creating task '%s' with ID '%s'", m_taskName.c_str(), m_taskId.c_str());
     
     // 验证任务函数的有效性
     if (!m_taskFunction) {
@@ -60,9 +61,10 @@ zTask::zTask(const string& taskName, std::function<void()> taskFunction)
  */
 zTask::zTask(const string& taskName)
     : m_taskName(taskName)
-    , m_taskId(generateTaskId())
+    , m_id(generateId())
+    , m_taskId("task_" + to_string(m_id))
 {
-    LOGI("zTask: Creating task '%s' with ID '%s' (using default task function)", m_taskName.c_str(), m_taskId.c_str());
+    LOGD("zTask: Creating task '%s' with ID '%s' (using default task function)", m_taskName.c_str(), m_taskId.c_str());
     
     // 设置默认任务函数
     // 使用lambda表达式包装defaultTaskFunction，保持this指针
@@ -77,7 +79,7 @@ zTask::zTask(const string& taskName)
  * 功能说明：
  * 1. 提供简单的任务执行示例
  * 2. 模拟任务执行过程，包含多个步骤
- * 3. 每个步骤之间有500ms的延迟
+ * 3. 每个步骤之间有500ms的延迟，任务被取消时提前结束
  * 4. 记录详细的执行日志
  * 
  * 执行流程：
@@ -97,7 +99,11 @@ void zTask::defaultTaskFunction() {
     // 执行5个步骤，模拟任务处理过程
     for(int i = 0; i < 5; i++) {
         LOGI("zTask: '%s' is executing step %d/5", m_taskName.c_str(), i + 1);
-        usleep(500000); // 500ms延迟，模拟实际工作
+        // 500ms延迟，模拟实际工作；任务被取消时提前结束
+        if (zCancelToken::current().waitCancelled(500)) {
+            LOGW("zTask: Default task '%s' cancelled at step %d/5", m_taskName.c_str(), i + 1);
+            return;
+        }
     }
     
     LOGI("zTask: Default task execution completed for '%s'", m_taskName.c_str());
@@ -116,7 +122,7 @@ void zTask::defaultTaskFunction() {
  * - 主要用于日志记录和调试
  */
 zTask::~zTask() {
-    LOGI("zTask: Destroying task '%s' (ID: %s)", m_taskName.c_str(), m_taskId.c_str());
+    LOGD("zTask: Destroying task '%s' (ID: %s)", m_taskName.c_str(), m_taskId.c_str());
 }
 
 /**
@@ -144,12 +150,12 @@ void zTask::execute() {
         return;
     }
     
-    LOGI("zTask: Executing task '%s' (ID: %s)", m_taskName.c_str(), m_taskId.c_str());
+    LOGD("zTask: Executing task '%s' (ID: %s)", m_taskName.c_str(), m_taskId.c_str());
     
     try {
         // 执行任务函数
         m_taskFunction();
-        LOGI("zTask: Task '%s' (ID: %s) execution completed successfully", m_taskName.c_str(), m_taskId.c_str());
+        LOGD("zTask: Task '%s' (ID: %s) execution completed successfully", m_taskName.c_str(), m_taskId.c_str());
     } catch (...) {
         // 捕获所有异常，防止程序崩溃
         LOGE("zTask: Task '%s' (ID: %s) execution failed with exception", m_taskName.c_str(), m_taskId.c_str());
@@ -161,17 +167,16 @@ void zTask::execute() {
  * 
  * 功能说明：
  * 1. 使用静态计数器生成唯一ID
- * 2. 格式为"task_" + 递增数字
+ * 2. 字符串形式为"task_" + 递增数字
  * 3. 确保每个任务都有唯一标识
  * 
  * 实现细节：
- * - 使用前置递增操作符，确保从1开始
- * - 使用to_string转换数字为字符串
- * - 线程安全：在单线程环境中使用
+ * - 原子递增，从1开始
+ * - 64位计数，不会回绕
+ * - 线程安全：可以在任意线程并发调用
  * 
- * @return 格式化的任务ID字符串
+ * @return 任务ID
  */
-string zTask::generateTaskId() {
-    string TaskId = "task_" + to_string(++s_taskCounter);
-    return TaskId;
+uint64_t zTask::generateId() {
+    return s_taskCounter.fetch_add(1, std::memory_order_relaxed) + 1;
 }
@@ -7,23 +7,53 @@
 #define TESTSLEEP_ZTASK_H
 
 #include "functional"
+#include <atomic>
+#include <time.h>
 
 #include "zLog.h"
 #include "zLibc.h"
 #include "zLibcUtil.h"
 #include "zStd.h"
 #include "zStdUtil.h"
+#include "zCancelToken.h"
+#include "zCpuTopology.h"
 
 
 /**
  * 任务类 - 封装任务信息和执行逻辑
  */
 class zTask {
+public:
+    /**
+     * 优先级类别，数值越小越优先
+     */
+    enum Priority {
+        PRIORITY_HIGH = 0,      // 延迟敏感的检测（linker、maps 完整性等）
+        PRIORITY_NORMAL = 1,    // 默认
+        PRIORITY_LOW = 2,       // 耗时的批量扫描（包列表、logcat 等）
+        PRIORITY_COUNT = 3,
+    };
+
 private:
     string m_taskName;                      // 任务名称
     std::function<void()> m_taskFunction;   // 任务执行函数
-    string m_taskId;                        // 任务唯一ID
-    static int s_taskCounter;               // 静态任务计数器
+    uint64_t m_id;                          // 任务唯一ID（数值）
+    string m_taskId;                        // 任务唯一ID（"task_" + 数值）
+    static std::atomic<uint64_t> s_taskCounter;  // 静态任务计数器，多线程并发创建任务时也不会重复
+
+    Priority m_priority = PRIORITY_NORMAL;  // 优先级类别
+    uint64_t m_deadlineNs = 0;              // 截止时间（CLOCK_MONOTONIC 绝对时间），0 表示没有截止时间
+    uint64_t m_enqueueNs = 0;               // 进入线程池队列的时间
+    uint64_t m_sequence = 0;                // 进入队列的序号，截止时间相同时先进先出
+    uint64_t m_startNs = 0;                 // 开始执行的时间
+    uint64_t m_finishNs = 0;                // 执行结束的时间，只在线程池开启统计时记录
+
+    zCancelToken m_cancelToken;             // 取消令牌，空令牌表示不可取消
+    uint64_t m_timeoutMs = 0;               // 执行超时，0 表示不限制
+
+    zCpuTopology::CoreClass m_coreClass = zCpuTopology::CORE_ANY;   // 执行时绑定的核心类别
+
+    bool m_unique = false;                  // 同名任务已在线程池中时不提交
 
 public:
     /**
@@ -49,9 +79,10 @@ public:
     template<typename Obj, typename RetType, typename... FuncArgs, typename... Args>
     zTask(const string& taskName, Obj* obj, RetType (Obj::*memberFunc)(FuncArgs...), Args&&... args)
         : m_taskName(taskName)
-        , m_taskId(generateTaskId())
+        , m_id(generateId())
+        , m_taskId("task_" + to_string(m_id))
     {
-        LOGI("zTask: Creating task '%s' with ID '%s'", m_taskName.c_str(), m_taskId.c_str());
+        LOGD("zTask: Creating task '%s' with ID '%s'", m_taskName.c_str(), m_taskId.c_str());
         
         // 检查对象和函数指针是否有效
         if (!obj || !memberFunc) {
@@ -62,9 +93,9 @@ public:
         
         // 创建包装 lambda 来调用成员函数
         m_taskFunction = [this, obj, memberFunc, args...]() {
-            LOGI("zTask: Executing task '%s' (ID: %s)", m_taskName.c_str(), m_taskId.c_str());
+            LOGD("zTask: Executing task '%s' (ID: %s)", m_taskName.c_str(), m_taskId.c_str());
             (obj->*memberFunc)(args...); // 调用成员函数
-            LOGI("zTask: Task '%s' (ID: %s) execution completed", m_taskName.c_str(), m_taskId.c_str());
+            LOGD("zTask: Task '%s' (ID: %s) execution completed", m_taskName.c_str(), m_taskId.c_str());
         };
     }
     
@@ -87,6 +118,11 @@ public:
      * 获取任务ID
      */
     const string& getTaskId() const { return m_taskId; }
+
+    /**
+     * 获取数值形式的任务ID，用于 zThreadPool::getTaskState 查询
+     */
+    uint64_t getId() const { return m_id; }
     
     /**
      * 获取任务函数
@@ -98,6 +134,77 @@ public:
      */
     bool isValid() const { return m_taskFunction != nullptr; }
 
+    Priority getPriority() const { return m_priority; }
+    zTask* setPriority(Priority priority) {
+        m_priority = (priority >= PRIORITY_HIGH && priority < PRIORITY_COUNT) ? priority : PRIORITY_NORMAL;
+        return this;
+    }
+
+    /**
+     * 设置截止时间，同一优先级类别内截止时间早的先执行（EDF）
+     * @param deadlineMs 距离现在的毫秒数，0 表示清除截止时间
+     */
+    zTask* setDeadlineMs(uint64_t deadlineMs) {
+        m_deadlineNs = deadlineMs ? getMonotonicNs() + deadlineMs * 1000000ULL : 0;
+        return this;
+    }
+    bool hasDeadline() const { return m_deadlineNs != 0; }
+    uint64_t getDeadlineNs() const { return m_deadlineNs; }
+
+    /**
+     * 设置取消令牌，开始执行前已取消的任务会被线程池跳过
+     */
+    zTask* setCancelToken(const zCancelToken& token) {
+        m_cancelToken = token;
+        return this;
+    }
+    const zCancelToken& getCancelToken() const { return m_cancelToken; }
+
+    /**
+     * 设置执行超时，超时后线程池取消任务的令牌；任务仍不返回时线程池用新线程替换被占住的工作线程
+     * @param timeoutMs 从开始执行算起的毫秒数，0 表示不限制
+     */
+    zTask* setTimeoutMs(uint64_t timeoutMs) {
+        m_timeoutMs = timeoutMs;
+        return this;
+    }
+    uint64_t getTimeoutMs() const { return m_timeoutMs; }
+
+    /**
+     * 设置执行时绑定的核心类别，执行期间工作线程临时绑定到该类别的核心，结束后恢复
+     * 用于计时敏感的检测（大核）或不急的批量计算（小核）
+     */
+    zTask* setCoreClass(zCpuTopology::CoreClass coreClass) {
+        m_coreClass = coreClass;
+        return this;
+    }
+    zCpuTopology::CoreClass getCoreClass() const { return m_coreClass; }
+
+    /**
+     * 设置为唯一任务：提交时同名任务已在排队或执行，线程池丢弃本任务，addTask 返回false
+     */
+    zTask* setUnique(bool unique) {
+        m_unique = unique;
+        return this;
+    }
+    bool isUnique() const { return m_unique; }
+
+    // 以下由线程池在入队、执行时设置
+    uint64_t getEnqueueNs() const { return m_enqueueNs; }
+    void setEnqueueNs(uint64_t enqueueNs) { m_enqueueNs = enqueueNs; }
+    uint64_t getSequence() const { return m_sequence; }
+    void setSequence(uint64_t sequence) { m_sequence = sequence; }
+    uint64_t getStartNs() const { return m_startNs; }
+    void setStartNs(uint64_t startNs) { m_startNs = startNs; }
+    uint64_t getFinishNs() const { return m_finishNs; }
+    void setFinishNs(uint64_t finishNs) { m_finishNs = finishNs; }
+
+    static uint64_t getMonotonicNs() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+
 private:
     /**
      * 默认任务函数
@@ -107,7 +214,7 @@ private:
     /**
      * 生成唯一任务ID
      */
-    string generateTaskId();
+    static uint64_t generateId();
 };
 
 #endif //TESTSLEEP_ZTASK_H
@@ -0,0 +1,163 @@
+//
+// Created by lxz on 2025/11/27.
+// zTaskDeque - Chase-Lev 工作窃取双端队列
+//
+
+#ifndef OVERT_ZTASKDEQUE_H
+#define OVERT_ZTASKDEQUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+#include "zStd.h"
+
+/**
+ * Chase-Lev 工作窃取双端队列（Lê 等人给出的 C11 内存模型版本）
+ *
+ * 所有者线程在底部 push / pop（后进先出，刚提交的任务数据还在缓存里），
+ * 其它线程从顶部 steal（先进先出），只有队列剩最后一个元素时才需要一次 CAS。
+ *
+ * T 必须是指针类型，队列为空或窃取失败时返回 nullptr。
+ * 扩容后旧数组可能仍在被窃取线程读取，因此不立即释放，保存到析构时统一释放。
+ */
+template<typename T>
+class zTaskDeque {
+private:
+    struct Array {
+        int64_t capacity;
+        int64_t mask;
+        std::atomic<T>* buffer;
+
+        explicit Array(int64_t cap) : capacity(cap), mask(cap - 1), buffer(new std::atomic<T>[cap]) {}
+
+        ~Array() {
+            delete[] buffer;
+        }
+
+        T get(int64_t index) const {
+            return buffer[index & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t index, T item) {
+            buffer[index & mask].store(item, std::memory_order_relaxed);
+        }
+
+        // 容量翻倍，拷贝 [top, bottom) 区间
+        Array* grow(int64_t bottom, int64_t top) const {
+            Array* array = new Array(capacity * 2);
+            for (int64_t i = top; i < bottom; i++) {
+                array->put(i, get(i));
+            }
+            return array;
+        }
+    };
+
+    // top 被窃取线程修改，bottom 只被所有者修改，分开放在不同缓存行避免伪共享
+    alignas(64) std::atomic<int64_t> m_top;
+    alignas(64) std::atomic<int64_t> m_bottom;
+    alignas(64) std::atomic<Array*> m_array;
+
+    // 扩容后被替换的旧数组，只有所有者线程访问
+    vector<Array*> m_retired;
+
+public:
+    explicit zTaskDeque(int64_t capacity = 256) : m_top(0), m_bottom(0) {
+        // 容量必须是 2 的幂
+        int64_t cap = 1;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        m_array.store(new Array(cap), std::memory_order_relaxed);
+    }
+
+    ~zTaskDeque() {
+        delete m_array.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < m_retired.size(); i++) {
+            delete m_retired[i];
+        }
+    }
+
+    zTaskDeque(const zTaskDeque&) = delete;
+    zTaskDeque& operator=(const zTaskDeque&) = delete;
+
+    /**
+     * 压入底部，只能由所有者线程调用
+     */
+    void push(T item) {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        int64_t top = m_top.load(std::memory_order_acquire);
+        Array* array = m_array.load(std::memory_order_relaxed);
+        if (bottom - top > array->capacity - 1) {
+            Array* bigger = array->grow(bottom, top);
+            m_retired.push_back(array);
+            m_array.store(bigger, std::memory_order_release);
+            array = bigger;
+        }
+        array->put(bottom, item);
+        // 用 release 写发布元素（等价于 release 栅栏 + relaxed 写，但 TSan 能识别）
+        m_bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    /**
+     * 从底部弹出，只能由所有者线程调用
+     * @return 队列为空时返回 nullptr
+     */
+    T pop() {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Array* array = m_array.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            // 队列为空，恢复 bottom
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T item = array->get(bottom);
+        if (top == bottom) {
+            // 最后一个元素，与窃取线程竞争
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    /**
+     * 从顶部窃取，任意线程都可以调用
+     * @return 队列为空或与其它线程竞争失败时返回 nullptr
+     */
+    T steal() {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        Array* array = m_array.load(std::memory_order_acquire);
+        T item = array->get(top);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    /**
+     * 近似元素数量，并发修改时只作为参考
+     */
+    size_t size() const {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+        return bottom > top ? (size_t) (bottom - top) : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+};
+
+#endif //OVERT_ZTASKDEQUE_H
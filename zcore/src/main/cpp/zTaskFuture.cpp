@@ -0,0 +1,191 @@
+//
+// Created by lxz on 2025/11/28.
+// zTaskFuture 实现 - 线程池任务的完成句柄
+//
+
+#include <chrono>
+
+#include "zTaskFuture.h"
+#include "zThreadPool.h"
+
+bool zTaskFuture::State::complete(bool succeeded) {
+    vector<std::function<void(bool)>> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (status.load(std::memory_order_relaxed) != PENDING) {
+            return false;
+        }
+        status.store(succeeded ? SUCCEEDED : FAILED, std::memory_order_release);
+        pending.swap(callbacks);
+        cv.notify_all();
+    }
+
+    // 回调在锁外调用，回调中可以再次访问句柄
+    for (size_t i = 0; i < pending.size(); i++) {
+        pending[i](succeeded);
+    }
+    return true;
+}
+
+zTaskFuture::Status zTaskFuture::getStatus() const {
+    if (!m_state) {
+        return FAILED;
+    }
+    return (Status) m_state->status.load(std::memory_order_acquire);
+}
+
+bool zTaskFuture::cancel(const string& reason) const {
+    if (!m_state) {
+        return false;
+    }
+    return m_state->cancelToken.cancel(reason);
+}
+
+void zTaskFuture::onComplete(std::function<void(bool)> callback) const {
+    if (!m_state) {
+        callback(false);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (m_state->status.load(std::memory_order_relaxed) == PENDING) {
+            m_state->callbacks.push_back(callback);
+            return;
+        }
+    }
+    callback(m_state->status.load(std::memory_order_acquire) == SUCCEEDED);
+}
+
+void zTaskFuture::wait() const {
+    if (!m_state || isReady()) {
+        return;
+    }
+
+    // 在工作线程中等待：执行其它待执行的任务，没有任务时短暂休眠再检查
+    zThreadPool* pool = zThreadPool::getCurrentPool();
+    if (pool != nullptr) {
+        while (!isReady()) {
+            if (pool->runPendingTask()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_state->mutex);
+            m_state->cv.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+                return isReady();
+            });
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->cv.wait(lock, [this]() {
+        return isReady();
+    });
+}
+
+bool zTaskFuture::waitFor(uint64_t timeoutMs) const {
+    if (!m_state || isReady()) {
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    zThreadPool* pool = zThreadPool::getCurrentPool();
+    if (pool != nullptr) {
+        while (!isReady() && std::chrono::steady_clock::now() < deadline) {
+            if (pool->runPendingTask()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_state->mutex);
+            m_state->cv.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+                return isReady();
+            });
+        }
+        return isReady();
+    }
+
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    return m_state->cv.wait_until(lock, deadline, [this]() {
+        return isReady();
+    });
+}
+
+zTaskFuture zTaskFuture::then(const string& taskName, std::function<void()> continuation) const {
+    if (!continuation) {
+        LOGE("zTaskFuture: then - Invalid continuation for task '%s'", taskName.c_str());
+        return makeReady(false);
+    }
+
+    std::shared_ptr<zTaskPromise> promise = std::make_shared<zTaskPromise>();
+    zTaskFuture next = promise->getFuture();
+    onComplete([taskName, continuation, promise](bool) {
+        zThreadPool* pool = zThreadPool::getInstance();
+        if (pool == nullptr) {
+            promise->setResult(false);
+            return;
+        }
+        // 任务被丢弃或抛出异常时 promise 随任务析构，后续句柄以失败完成
+        pool->addTask(taskName, [continuation, promise]() {
+            continuation();
+            promise->setResult(true);
+        });
+    });
+    return next;
+}
+
+zTaskFuture zTaskFuture::whenAll(const vector<zTaskFuture>& futures) {
+    if (futures.empty()) {
+        return makeReady(true);
+    }
+
+    std::shared_ptr<zTaskPromise> promise = std::make_shared<zTaskPromise>();
+    std::shared_ptr<std::atomic<size_t>> remaining = std::make_shared<std::atomic<size_t>>(futures.size());
+    std::shared_ptr<std::atomic<bool>> failed = std::make_shared<std::atomic<bool>>(false);
+    zTaskFuture result = promise->getFuture();
+
+    for (size_t i = 0; i < futures.size(); i++) {
+        futures[i].onComplete([promise, remaining, failed](bool succeeded) {
+            if (!succeeded) {
+                failed->store(true);
+            }
+            if (remaining->fetch_sub(1) == 1) {
+                promise->setResult(!failed->load());
+            }
+        });
+    }
+    return result;
+}
+
+zTaskFuture zTaskFuture::whenAny(const vector<zTaskFuture>& futures) {
+    if (futures.empty()) {
+        return makeReady(false);
+    }
+
+    std::shared_ptr<zTaskPromise> promise = std::make_shared<zTaskPromise>();
+    zTaskFuture result = promise->getFuture();
+
+    for (size_t i = 0; i < futures.size(); i++) {
+        futures[i].onComplete([promise](bool succeeded) {
+            promise->setResult(succeeded);
+        });
+    }
+    return result;
+}
+
+zTaskFuture zTaskFuture::makeReady(bool succeeded) {
+    zTaskPromise promise;
+    promise.setResult(succeeded);
+    return promise.getFuture();
+}
+
+zTaskPromise::zTaskPromise() : m_state(std::make_shared<zTaskFuture::State>()) {
+}
+
+zTaskPromise::~zTaskPromise() {
+    if (m_state->complete(false)) {
+        LOGW("zTaskPromise: destroyed without result, future completed as failed");
+    }
+}
+
+bool zTaskPromise::setResult(bool succeeded) {
+    return m_state->complete(succeeded);
+}
@@ -0,0 +1,153 @@
+//
+// Created by lxz on 2025/11/28.
+// zTaskFuture - 线程池任务的完成句柄
+//
+
+#ifndef OVERT_ZTASKFUTURE_H
+#define OVERT_ZTASKFUTURE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+
+#include "zLog.h"
+#include "zStd.h"
+#include "zCancelToken.h"
+
+class zTaskPromise;
+
+/**
+ * 任务完成句柄
+ * 由 zThreadPool::addTaskFuture 返回，可以等待任务结束、注册后续任务、组合多个句柄
+ *
+ * 句柄之间共享同一个状态，拷贝开销只是一个 shared_ptr
+ * 任务函数抛出异常、或者任务在执行前被丢弃（线程池停止），句柄以失败状态完成，等待方不会永远阻塞
+ * 任务被取消或执行超时时句柄立即以失败完成，不等待任务函数返回
+ *
+ * 在线程池工作线程中等待时，等待期间会执行线程池中其它待执行的任务，
+ * 因此任务内部等待自己提交的子任务不会因为工作线程全部阻塞而死锁
+ */
+class zTaskFuture {
+public:
+    enum Status {
+        PENDING = 0,        // 未完成
+        SUCCEEDED = 1,      // 正常结束
+        FAILED = 2,         // 抛出异常或被丢弃
+    };
+
+private:
+    struct State {
+        std::atomic<int> status{PENDING};
+        std::mutex mutex;
+        std::condition_variable cv;
+
+        // 完成时在完成线程上直接调用的回调，参数为是否成功
+        vector<std::function<void(bool)>> callbacks;
+
+        // 对应任务的取消令牌，组合句柄（whenAll 等）没有令牌
+        zCancelToken cancelToken;
+
+        // 设置完成状态，只有第一次调用生效
+        bool complete(bool succeeded);
+    };
+
+    std::shared_ptr<State> m_state;
+
+    explicit zTaskFuture(const std::shared_ptr<State>& state) : m_state(state) {}
+
+    // 完成时回调，已经完成时立即在当前线程调用
+    void onComplete(std::function<void(bool)> callback) const;
+
+    friend class zTaskPromise;
+    friend class zTaskGraph;
+
+public:
+    // 空句柄，isValid 返回false
+    zTaskFuture() {}
+
+    bool isValid() const { return m_state != nullptr; }
+
+    Status getStatus() const;
+
+    bool isReady() const { return getStatus() != PENDING; }
+
+    bool isFailed() const { return getStatus() == FAILED; }
+
+    /**
+     * 取消对应的任务：还没开始执行的任务不再执行，正在执行的任务的令牌被取消，句柄立即以失败完成
+     * @return 是否是第一次取消；组合句柄、空句柄返回false
+     */
+    bool cancel(const string& reason = "cancelled") const;
+
+    // 对应任务的令牌是否已被取消（包括执行超时）
+    bool isCancelled() const { return m_state && m_state->cancelToken.isCancelled(); }
+
+    /**
+     * 等待完成
+     */
+    void wait() const;
+
+    /**
+     * 等待完成，最多等待 timeoutMs 毫秒
+     * @return 是否已完成
+     */
+    bool waitFor(uint64_t timeoutMs) const;
+
+    /**
+     * 完成后（无论成功或失败）向线程池提交后续任务
+     * @return 后续任务的句柄
+     */
+    zTaskFuture then(const string& taskName, std::function<void()> continuation) const;
+
+    zTaskFuture then(std::function<void()> continuation) const {
+        return then("ContinuationTask", continuation);
+    }
+
+    /**
+     * 所有句柄都完成时完成，任意一个失败则结果为失败；列表为空时立即成功
+     */
+    static zTaskFuture whenAll(const vector<zTaskFuture>& futures);
+
+    /**
+     * 任意一个句柄完成时完成，结果与最先完成的句柄相同；列表为空时立即失败
+     */
+    static zTaskFuture whenAny(const vector<zTaskFuture>& futures);
+
+    /**
+     * 创建已完成的句柄
+     */
+    static zTaskFuture makeReady(bool succeeded = true);
+};
+
+/**
+ * 任务完成句柄的生产端
+ * 析构时如果还没有设置结果，以失败完成，保证句柄总会完成
+ */
+class zTaskPromise {
+private:
+    std::shared_ptr<zTaskFuture::State> m_state;
+
+public:
+    zTaskPromise();
+
+    ~zTaskPromise();
+
+    zTaskPromise(const zTaskPromise&) = delete;
+    zTaskPromise& operator=(const zTaskPromise&) = delete;
+
+    zTaskFuture getFuture() const { return zTaskFuture(m_state); }
+
+    // 关联任务的取消令牌，句柄的 cancel 会取消这个令牌
+    void setCancelToken(const zCancelToken& token) { m_state->cancelToken = token; }
+
+    /**
+     * 设置结果
+     * @return 是否是第一次设置
+     */
+    bool setResult(bool succeeded);
+};
+
+#endif //OVERT_ZTASKFUTURE_H
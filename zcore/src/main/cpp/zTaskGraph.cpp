@@ -0,0 +1,223 @@
+//
+// Created by lxz on 2025/11/30.
+// zTaskGraph 实现 - 基于线程池的任务依赖图执行器
+//
+
+#include <stdexcept>
+
+#include "zTaskGraph.h"
+#include "zThreadPool.h"
+
+// 当前线程正在执行的节点所属的轮次
+static thread_local const void* tls_current_round = nullptr;
+
+bool zTaskGraph::addNode(const string& name, std::function<void()> taskFunction,
+                         const vector<string>& dependencies, zTask::Priority priority) {
+    if (!taskFunction) {
+        LOGE("zTaskGraph: addNode - Invalid function for node '%s'", name.c_str());
+        return false;
+    }
+    Node node;
+    node.name = name;
+    node.taskFunction = taskFunction;
+    node.dependencies = dependencies;
+    node.priority = priority;
+    return addNodeInternal(node);
+}
+
+bool zTaskGraph::addNodeInternal(Node& node) {
+    if (node.name.empty()) {
+        LOGE("zTaskGraph: node name is empty");
+        return false;
+    }
+    if (hasNode(node.name)) {
+        LOGE("zTaskGraph: node '%s' already exists", node.name.c_str());
+        return false;
+    }
+    m_nodes.push_back(node);
+    m_compiled.reset();
+    return true;
+}
+
+bool zTaskGraph::hasNode(const string& name) const {
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        if (m_nodes[i].name == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<const zTaskGraph::Compiled> zTaskGraph::compile() const {
+    std::shared_ptr<Compiled> compiled = std::make_shared<Compiled>();
+    compiled->nodes = m_nodes;
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        compiled->indices[m_nodes[i].name] = i;
+    }
+
+    compiled->dependents.resize(m_nodes.size());
+    compiled->dependencyCounts.resize(m_nodes.size(), 0);
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        const vector<string>& dependencies = m_nodes[i].dependencies;
+        for (size_t d = 0; d < dependencies.size(); d++) {
+            map<string, size_t>::const_iterator it = compiled->indices.find(dependencies[d]);
+            if (it == compiled->indices.end()) {
+                LOGE("zTaskGraph: node '%s' depends on unknown node '%s'", m_nodes[i].name.c_str(), dependencies[d].c_str());
+                return nullptr;
+            }
+            compiled->dependents[it->second].push_back(i);
+            compiled->dependencyCounts[i]++;
+        }
+        if (compiled->dependencyCounts[i] == 0) {
+            compiled->roots.push_back(i);
+        }
+    }
+
+    // Kahn 拓扑排序，排不完说明有环
+    vector<size_t> counts = compiled->dependencyCounts;
+    vector<size_t> ready = compiled->roots;
+    size_t sorted = 0;
+    while (!ready.empty()) {
+        size_t index = ready.back();
+        ready.pop_back();
+        sorted++;
+        const vector<size_t>& dependents = compiled->dependents[index];
+        for (size_t d = 0; d < dependents.size(); d++) {
+            if (--counts[dependents[d]] == 0) {
+                ready.push_back(dependents[d]);
+            }
+        }
+    }
+    if (sorted != m_nodes.size()) {
+        for (size_t i = 0; i < counts.size(); i++) {
+            if (counts[i] != 0) {
+                LOGE("zTaskGraph: node '%s' is part of a dependency cycle", m_nodes[i].name.c_str());
+            }
+        }
+        return nullptr;
+    }
+    return compiled;
+}
+
+bool zTaskGraph::validate() {
+    if (!m_compiled) {
+        m_compiled = compile();
+    }
+    return m_compiled != nullptr;
+}
+
+zTaskFuture zTaskGraph::run(zThreadPool* pool) {
+    if (pool == nullptr) {
+        LOGE("zTaskGraph: run - thread pool is null");
+        return zTaskFuture::makeReady(false);
+    }
+    if (!validate()) {
+        return zTaskFuture::makeReady(false);
+    }
+    if (m_compiled->nodes.empty()) {
+        return zTaskFuture::makeReady(true);
+    }
+
+    size_t nodeCount = m_compiled->nodes.size();
+    std::shared_ptr<Round> round = std::make_shared<Round>();
+    round->graph = m_compiled;
+    round->pool = pool;
+    round->promise = std::make_shared<zTaskPromise>();
+    round->cancelToken = zCancelToken::create();
+    round->promise->setCancelToken(round->cancelToken);
+    round->remaining.reset(new std::atomic<size_t>[nodeCount]);
+    round->upstreamFailed.reset(new std::atomic<bool>[nodeCount]);
+    round->outputReady.reset(new std::atomic<bool>[nodeCount]);
+    round->outputs.resize(nodeCount);
+    for (size_t i = 0; i < nodeCount; i++) {
+        round->remaining[i].store(m_compiled->dependencyCounts[i], std::memory_order_relaxed);
+        round->upstreamFailed[i].store(false, std::memory_order_relaxed);
+        round->outputReady[i].store(false, std::memory_order_relaxed);
+    }
+    round->startNs = zTask::getMonotonicNs();
+    zTaskFuture future = round->promise->getFuture();
+
+    LOGD("zTaskGraph: run %zu nodes, %zu roots", nodeCount, m_compiled->roots.size());
+    for (size_t i = 0; i < m_compiled->roots.size(); i++) {
+        submitNode(round, m_compiled->roots[i]);
+    }
+    return future;
+}
+
+void zTaskGraph::submitNode(const std::shared_ptr<Round>& round, size_t index) {
+    const Node& node = round->graph->nodes[index];
+    if (round->cancelToken.isCancelled()) {
+        LOGD("zTaskGraph: round cancelled, skip node '%s'", node.name.c_str());
+        finishNode(round, index, false);
+        return;
+    }
+
+    zTaskFuture future = round->pool->addTaskFuture(node.name, [round, index]() {
+        const Node& node = round->graph->nodes[index];
+        const void* previous = tls_current_round;
+        tls_current_round = round.get();
+        try {
+            if (node.inputFunction) {
+                std::shared_ptr<void> output = node.inputFunction();
+                if (!output) {
+                    throw std::runtime_error("input node returned null");
+                }
+                round->outputs[index] = output;
+                round->outputReady[index].store(true, std::memory_order_release);
+            } else {
+                node.taskFunction();
+            }
+        } catch (...) {
+            tls_current_round = previous;
+            throw;
+        }
+        tls_current_round = previous;
+    }, node.priority);
+
+    future.onComplete([round, index](bool succeeded) {
+        finishNode(round, index, succeeded);
+    });
+}
+
+void zTaskGraph::finishNode(const std::shared_ptr<Round>& round, size_t index, bool succeeded) {
+    const Compiled& graph = *round->graph;
+    if (!succeeded) {
+        LOGW("zTaskGraph: node '%s' failed or skipped", graph.nodes[index].name.c_str());
+        round->failed.store(true);
+    }
+
+    // 依赖全部完成的后继节点：有依赖失败的直接跳过，否则提交
+    const vector<size_t>& dependents = graph.dependents[index];
+    for (size_t d = 0; d < dependents.size(); d++) {
+        size_t dependent = dependents[d];
+        if (!succeeded) {
+            round->upstreamFailed[dependent].store(true);
+        }
+        if (round->remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            if (round->upstreamFailed[dependent].load()) {
+                finishNode(round, dependent, false);
+            } else {
+                submitNode(round, dependent);
+            }
+        }
+    }
+
+    if (round->finished.fetch_add(1, std::memory_order_acq_rel) + 1 == graph.nodes.size()) {
+        bool failed = round->failed.load();
+        LOGD("zTaskGraph: round finished in %.3f ms, %s", (zTask::getMonotonicNs() - round->startNs) / 1e6,
+             failed ? "failed" : "succeeded");
+        round->promise->setResult(!failed);
+    }
+}
+
+std::shared_ptr<void> zTaskGraph::getCurrentInput(const string& name) {
+    const Round* round = (const Round*) tls_current_round;
+    if (round == nullptr) {
+        return nullptr;
+    }
+    map<string, size_t>::const_iterator it = round->graph->indices.find(name);
+    if (it == round->graph->indices.end() || !round->outputReady[it->second].load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return round->outputs[it->second];
+}
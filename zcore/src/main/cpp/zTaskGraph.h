@@ -0,0 +1,147 @@
+//
+// Created by lxz on 2025/11/30.
+// zTaskGraph - 基于线程池的任务依赖图执行器
+//
+
+#ifndef OVERT_ZTASKGRAPH_H
+#define OVERT_ZTASKGRAPH_H
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <functional>
+
+#include "zLog.h"
+#include "zStd.h"
+#include "zTask.h"
+#include "zTaskFuture.h"
+
+class zThreadPool;
+
+/**
+ * 任务依赖图（DAG）执行器
+ * 节点分两种：
+ * - 输入节点：计算一份共享数据（maps 快照、base.apk 路径等），每轮只计算一次，依赖它的节点都读取同一份结果
+ * - 任务节点：普通的任务函数，没有输出
+ *
+ * run 启动一轮执行：没有依赖的节点立即提交到线程池，节点完成时把后继节点的剩余依赖数减一，
+ * 减到 0 的节点立即提交，互不依赖的节点并行执行。节点失败（抛出异常、被取消、输入节点返回空）时，
+ * 所有直接或间接依赖它的节点跳过不执行，这一轮以失败完成
+ *
+ * 节点函数通过 getInput 读取本轮已经完成的输入节点的结果，深层调用（zLinker、zElf 等）不需要修改接口；
+ * 不在任务图中执行时 getInput 返回空，调用方自己计算
+ *
+ * 图本身不是线程安全的：先在一个线程中添加节点，再调用 run；run 会复制一份图结构，
+ * 之后修改或析构图不影响正在执行的轮次
+ */
+class zTaskGraph {
+private:
+    struct Node {
+        string name;
+        std::function<void()> taskFunction;                 // 任务节点
+        std::function<std::shared_ptr<void>()> inputFunction;  // 输入节点
+        vector<string> dependencies;
+        zTask::Priority priority = zTask::PRIORITY_NORMAL;
+    };
+
+    // run 使用的图结构：依赖已经解析为下标
+    struct Compiled {
+        vector<Node> nodes;
+        map<string, size_t> indices;
+        vector<vector<size_t>> dependents;      // 每个节点的后继
+        vector<size_t> dependencyCounts;        // 每个节点的依赖数
+        vector<size_t> roots;                   // 没有依赖的节点
+    };
+
+    // 一轮执行的状态
+    struct Round {
+        std::shared_ptr<const Compiled> graph;
+        zThreadPool* pool = nullptr;
+        std::shared_ptr<zTaskPromise> promise;
+        zCancelToken cancelToken;
+
+        std::unique_ptr<std::atomic<size_t>[]> remaining;      // 剩余依赖数
+        std::unique_ptr<std::atomic<bool>[]> upstreamFailed;   // 有依赖失败，跳过
+        std::unique_ptr<std::atomic<bool>[]> outputReady;      // 输入节点的结果已经写入
+        vector<std::shared_ptr<void>> outputs;
+
+        std::atomic<size_t> finished{0};
+        std::atomic<bool> failed{false};
+        uint64_t startNs = 0;
+    };
+
+    vector<Node> m_nodes;
+    std::shared_ptr<const Compiled> m_compiled;
+
+    bool addNodeInternal(Node& node);
+
+    // 解析依赖并检查环，失败返回空
+    std::shared_ptr<const Compiled> compile() const;
+
+    static void submitNode(const std::shared_ptr<Round>& round, size_t index);
+
+    static void finishNode(const std::shared_ptr<Round>& round, size_t index, bool succeeded);
+
+    static std::shared_ptr<void> getCurrentInput(const string& name);
+
+public:
+    zTaskGraph() {}
+
+    /**
+     * 添加任务节点
+     * @param dependencies 依赖的节点名称，可以引用之后才添加的节点
+     * @return 名称为空、重名或函数为空时返回false
+     */
+    bool addNode(const string& name, std::function<void()> taskFunction,
+                 const vector<string>& dependencies = vector<string>(),
+                 zTask::Priority priority = zTask::PRIORITY_NORMAL);
+
+    /**
+     * 添加输入节点，inputFunction 返回本轮共享的数据，返回空视为失败
+     */
+    template<typename T>
+    bool addInput(const string& name, std::function<std::shared_ptr<T>()> inputFunction,
+                  const vector<string>& dependencies = vector<string>(),
+                  zTask::Priority priority = zTask::PRIORITY_NORMAL) {
+        if (!inputFunction) {
+            LOGE("zTaskGraph: addInput - Invalid function for node '%s'", name.c_str());
+            return false;
+        }
+        Node node;
+        node.name = name;
+        node.inputFunction = [inputFunction]() -> std::shared_ptr<void> {
+            return inputFunction();
+        };
+        node.dependencies = dependencies;
+        node.priority = priority;
+        return addNodeInternal(node);
+    }
+
+    bool hasNode(const string& name) const;
+
+    size_t getNodeCount() const { return m_nodes.size(); }
+
+    /**
+     * 检查所有依赖都存在且没有环
+     */
+    bool validate();
+
+    /**
+     * 在线程池中执行一轮
+     * 返回的句柄在所有节点完成或跳过后完成，任意节点失败则结果为失败；
+     * 句柄的 cancel 使还没有提交的节点不再执行
+     * @return 图不合法或线程池为空时返回失败的句柄
+     */
+    zTaskFuture run(zThreadPool* pool);
+
+    /**
+     * 当前线程正在执行的节点所属轮次中，名为 name 的输入节点的结果
+     * 输入节点还没有完成（没有声明依赖）、类型对应不上由调用方保证；不在任务图中执行时返回空
+     */
+    template<typename T>
+    static std::shared_ptr<T> getInput(const string& name) {
+        return std::static_pointer_cast<T>(getCurrentInput(name));
+    }
+};
+
+#endif //OVERT_ZTASKGRAPH_H
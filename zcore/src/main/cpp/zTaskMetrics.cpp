@@ -0,0 +1,245 @@
+//
+// Created by lxz on 2025/12/03.
+// zTaskMetrics 实现 - 线程池任务的排队等待/执行时间直方图与最近任务记录
+//
+
+#include <math.h>
+
+#include "zJson.h"
+#include "zTaskMetrics.h"
+
+uint64_t zLatencyHistogram::Snapshot::getPercentileNs(double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t target = (uint64_t) ceil(count * percentile / 100.0);
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            uint64_t upper = getBucketUpperNs(i);
+            return upper < maxNs ? upper : maxNs;
+        }
+    }
+    return maxNs;
+}
+
+void zLatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    count += other.count;
+    totalNs += other.totalNs;
+    maxNs = maxNs > other.maxNs ? maxNs : other.maxNs;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+zLatencyHistogram::zLatencyHistogram() : m_count(0), m_totalNs(0), m_maxNs(0) {
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t zLatencyHistogram::getBucketIndex(uint64_t ns) {
+    uint64_t us = ns / 1000;
+    if (us == 0) {
+        return 0;
+    }
+    size_t index = 64 - __builtin_clzll(us);
+    return index < BUCKET_COUNT ? index : BUCKET_COUNT - 1;
+}
+
+uint64_t zLatencyHistogram::getBucketUpperNs(size_t index) {
+    if (index + 1 >= BUCKET_COUNT) {
+        return UINT64_MAX;
+    }
+    return (1ULL << index) * 1000;
+}
+
+void zLatencyHistogram::record(uint64_t ns) {
+    m_buckets[getBucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_totalNs.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t maxNs = m_maxNs.load(std::memory_order_relaxed);
+    while (ns > maxNs && !m_maxNs.compare_exchange_weak(maxNs, ns, std::memory_order_relaxed)) {
+    }
+}
+
+zLatencyHistogram::Snapshot zLatencyHistogram::getSnapshot() const {
+    Snapshot snapshot;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+    }
+    snapshot.count = m_count.load(std::memory_order_relaxed);
+    snapshot.totalNs = m_totalNs.load(std::memory_order_relaxed);
+    snapshot.maxNs = m_maxNs.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void zLatencyHistogram::reset() {
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_totalNs.store(0, std::memory_order_relaxed);
+    m_maxNs.store(0, std::memory_order_relaxed);
+}
+
+zTaskMetrics::zTaskMetrics() : m_recentNext(0) {
+}
+
+void zTaskMetrics::record(const TaskRecord& record) {
+    uint64_t waitNs = record.startNs > record.enqueueNs ? record.startNs - record.enqueueNs : 0;
+    uint64_t runNs = record.finishNs > record.startNs ? record.finishNs - record.startNs : 0;
+
+    bool recorded = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_entriesMutex);
+        std::map<string, std::unique_ptr<Entry>>::iterator it = m_entries.find(record.name);
+        if (it != m_entries.end()) {
+            it->second->wait.record(waitNs);
+            it->second->run.record(runNs);
+            recorded = true;
+        }
+    }
+    if (!recorded) {
+        std::unique_lock<std::shared_mutex> lock(m_entriesMutex);
+        std::unique_ptr<Entry>& entry = m_entries[record.name];
+        if (!entry) {
+            entry.reset(new Entry());
+        }
+        entry->wait.record(waitNs);
+        entry->run.record(runNs);
+    }
+
+    std::lock_guard<std::mutex> lock(m_recentMutex);
+    if (m_recent.size() < RECENT_CAPACITY) {
+        m_recent.push_back(record);
+    } else {
+        m_recent[m_recentNext] = record;
+    }
+    m_recentNext = (m_recentNext + 1) % RECENT_CAPACITY;
+}
+
+std::map<string, zTaskMetrics::TaskSummary> zTaskMetrics::getTaskSummaries() const {
+    std::map<string, TaskSummary> summaries;
+    std::shared_lock<std::shared_mutex> lock(m_entriesMutex);
+    for (const auto& item : m_entries) {
+        TaskSummary& summary = summaries[item.first];
+        summary.wait = item.second->wait.getSnapshot();
+        summary.run = item.second->run.getSnapshot();
+    }
+    return summaries;
+}
+
+bool zTaskMetrics::getTaskSummary(const string& name, TaskSummary& summary) const {
+    std::shared_lock<std::shared_mutex> lock(m_entriesMutex);
+    std::map<string, std::unique_ptr<Entry>>::const_iterator it = m_entries.find(name);
+    if (it == m_entries.end()) {
+        return false;
+    }
+    summary.wait = it->second->wait.getSnapshot();
+    summary.run = it->second->run.getSnapshot();
+    return true;
+}
+
+vector<zTaskMetrics::TaskRecord> zTaskMetrics::getRecentTasks() const {
+    std::lock_guard<std::mutex> lock(m_recentMutex);
+    if (m_recent.size() < RECENT_CAPACITY) {
+        return m_recent;
+    }
+    vector<TaskRecord> records(m_recent.begin() + m_recentNext, m_recent.end());
+    records.insert(records.end(), m_recent.begin(), m_recent.begin() + m_recentNext);
+    return records;
+}
+
+void zTaskMetrics::reset() {
+    {
+        std::unique_lock<std::shared_mutex> lock(m_entriesMutex);
+        m_entries.clear();
+    }
+    std::lock_guard<std::mutex> lock(m_recentMutex);
+    m_recent.clear();
+    m_recentNext = 0;
+}
+
+static double ns_to_us(uint64_t ns) {
+    return ns / 1000.0;
+}
+
+// 只输出非空的桶，le_us 为桶的上界，最后一个桶为 -1
+static zJson histogram_to_json(const zLatencyHistogram::Snapshot& snapshot) {
+    zJson json;
+    json["count"] = snapshot.count;
+    json["mean_us"] = ns_to_us(snapshot.getMeanNs());
+    json["max_us"] = ns_to_us(snapshot.maxNs);
+    json["p50_us"] = ns_to_us(snapshot.getPercentileNs(50));
+    json["p90_us"] = ns_to_us(snapshot.getPercentileNs(90));
+    json["p99_us"] = ns_to_us(snapshot.getPercentileNs(99));
+    zJson buckets = zJson::array();
+    for (size_t i = 0; i < zLatencyHistogram::BUCKET_COUNT; i++) {
+        if (snapshot.buckets[i] == 0) {
+            continue;
+        }
+        uint64_t upper = zLatencyHistogram::getBucketUpperNs(i);
+        zJson bucket;
+        bucket["le_us"] = upper == UINT64_MAX ? -1.0 : ns_to_us(upper);
+        bucket["count"] = snapshot.buckets[i];
+        buckets.push_back(bucket);
+    }
+    json["buckets"] = buckets;
+    return json;
+}
+
+string zThreadPoolMetrics::toJson(int indent) const {
+    zJson json;
+    json["enabled"] = enabled;
+    json["elapsed_us"] = ns_to_us(elapsedNs);
+    json["pending_tasks"] = pendingTasks;
+    json["peak_queue_depth"] = peakQueueDepth;
+    json["timed_out_tasks"] = timedOutTasks;
+    json["cancelled_tasks"] = cancelledTasks;
+
+    zJson workers_json = zJson::array();
+    for (const zWorkerMetrics& worker : workers) {
+        zJson worker_json;
+        worker_json["index"] = worker.index;
+        worker_json["executed"] = worker.executed;
+        worker_json["busy_us"] = ns_to_us(worker.busyNs);
+        worker_json["idle_us"] = ns_to_us(worker.idleNs);
+        worker_json["steals"] = worker.steals;
+        worker_json["parks"] = worker.parks;
+        worker_json["utilization"] = worker.utilization;
+        workers_json.push_back(worker_json);
+    }
+    json["workers"] = workers_json;
+
+    zJson tasks_json = zJson::object();
+    for (const auto& item : tasks) {
+        zJson task_json;
+        task_json["wait"] = histogram_to_json(item.second.wait);
+        task_json["run"] = histogram_to_json(item.second.run);
+        tasks_json[item.first] = task_json;
+    }
+    json["tasks"] = tasks_json;
+
+    json["total"]["wait"] = histogram_to_json(total.wait);
+    json["total"]["run"] = histogram_to_json(total.run);
+
+    zJson recent_json = zJson::array();
+    for (const zTaskMetrics::TaskRecord& record : recent) {
+        zJson record_json;
+        record_json["name"] = record.name;
+        record_json["id"] = record.id;
+        record_json["worker"] = record.worker;
+        record_json["enqueue_ns"] = record.enqueueNs;
+        record_json["start_ns"] = record.startNs;
+        record_json["finish_ns"] = record.finishNs;
+        recent_json.push_back(record_json);
+    }
+    json["recent"] = recent_json;
+
+    return json.dump(indent);
+}
@@ -0,0 +1,159 @@
+//
+// Created by lxz on 2025/12/03.
+// zTaskMetrics - 线程池任务的排队等待/执行时间直方图与最近任务记录
+//
+
+#ifndef OVERT_ZTASKMETRICS_H
+#define OVERT_ZTASKMETRICS_H
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <shared_mutex>
+
+#include "zLog.h"
+#include "zStd.h"
+
+/**
+ * 按 2 的幂分桶的耗时直方图
+ * 桶 0 为不足 1us，桶 i 为 [2^(i-1), 2^i) us，最后一个桶包含所有更大的值
+ * 记录只有几次 relaxed 原子加，可以在多个线程上并发记录
+ */
+class zLatencyHistogram {
+public:
+    static const size_t BUCKET_COUNT = 32;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+        uint64_t buckets[BUCKET_COUNT] = {};
+
+        uint64_t getMeanNs() const { return count ? totalNs / count : 0; }
+
+        /**
+         * 百分位数的估计值：所在桶的上界，不超过最大值
+         * @param percentile 0 ~ 100
+         */
+        uint64_t getPercentileNs(double percentile) const;
+
+        void merge(const Snapshot& other);
+    };
+
+private:
+    std::atomic<uint64_t> m_buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_totalNs;
+    std::atomic<uint64_t> m_maxNs;
+
+public:
+    zLatencyHistogram();
+
+    zLatencyHistogram(const zLatencyHistogram&) = delete;
+    zLatencyHistogram& operator=(const zLatencyHistogram&) = delete;
+
+    void record(uint64_t ns);
+
+    Snapshot getSnapshot() const;
+
+    void reset();
+
+    static size_t getBucketIndex(uint64_t ns);
+
+    // 桶的上界（不含），最后一个桶返回 UINT64_MAX
+    static uint64_t getBucketUpperNs(size_t index);
+};
+
+/**
+ * 线程池任务统计
+ * 按任务名称分别记录排队等待时间与执行时间的直方图，并保留最近 RECENT_CAPACITY 个任务的入队/开始/结束时间
+ */
+class zTaskMetrics {
+public:
+    static const size_t RECENT_CAPACITY = 256;
+
+    struct TaskRecord {
+        string name;
+        uint64_t id = 0;
+        size_t worker = 0;
+        uint64_t enqueueNs = 0;
+        uint64_t startNs = 0;
+        uint64_t finishNs = 0;
+    };
+
+    struct TaskSummary {
+        zLatencyHistogram::Snapshot wait;
+        zLatencyHistogram::Snapshot run;
+    };
+
+private:
+    struct Entry {
+        zLatencyHistogram wait;
+        zLatencyHistogram run;
+    };
+
+    // 已有名称只需要读锁，第一次出现的名称才加写锁
+    mutable std::shared_mutex m_entriesMutex;
+    std::map<string, std::unique_ptr<Entry>> m_entries;
+
+    mutable std::mutex m_recentMutex;
+    vector<TaskRecord> m_recent;
+    size_t m_recentNext;
+
+public:
+    zTaskMetrics();
+
+    zTaskMetrics(const zTaskMetrics&) = delete;
+    zTaskMetrics& operator=(const zTaskMetrics&) = delete;
+
+    void record(const TaskRecord& record);
+
+    // 按名称排序的所有任务统计
+    std::map<string, TaskSummary> getTaskSummaries() const;
+
+    bool getTaskSummary(const string& name, TaskSummary& summary) const;
+
+    // 最近执行的任务，按结束先后排列
+    vector<TaskRecord> getRecentTasks() const;
+
+    void reset();
+};
+
+/**
+ * 单个工作线程的统计
+ */
+struct zWorkerMetrics {
+    size_t index = 0;
+    uint64_t executed = 0;      // 执行的任务数
+    uint64_t busyNs = 0;        // 执行任务的总时间
+    uint64_t idleNs = 0;        // 在条件变量上休眠的总时间
+    uint64_t steals = 0;        // 从其它工作线程窃取到的任务数
+    uint64_t parks = 0;         // 休眠次数
+    double utilization = 0;     // busyNs / 统计时长
+};
+
+/**
+ * zThreadPool::getMetrics 的结果
+ */
+struct zThreadPoolMetrics {
+    bool enabled = false;
+    uint64_t elapsedNs = 0;             // 开始统计（开启或重置）到现在的时间
+    size_t pendingTasks = 0;            // 当前排队中的任务数
+    size_t peakQueueDepth = 0;          // 统计期间提交任务时观察到的最大排队数
+    uint64_t timedOutTasks = 0;
+    uint64_t cancelledTasks = 0;
+    vector<zWorkerMetrics> workers;
+    std::map<string, zTaskMetrics::TaskSummary> tasks;
+    zTaskMetrics::TaskSummary total;    // 所有任务合并
+    vector<zTaskMetrics::TaskRecord> recent;
+
+    /**
+     * 序列化为 JSON，耗时单位为 us
+     * @param indent 缩进，-1 为紧凑格式
+     */
+    string toJson(int indent = -1) const;
+};
+
+#endif //OVERT_ZTASKMETRICS_H
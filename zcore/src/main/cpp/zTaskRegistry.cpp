@@ -0,0 +1,93 @@
+//
+// Created by lxz on 2025/12/02.
+// zTaskRegistry 实现 - 线程池中排队与执行中任务的名称/ID 索引
+//
+
+#include "zTaskRegistry.h"
+
+bool zTaskRegistry::add(const string& name, uint64_t id, bool unique) {
+    {
+        Shard& shard = getNameShard(name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        NameEntry& entry = shard.names[name];
+        if (unique && entry.pending + entry.running > 0) {
+            return false;
+        }
+        entry.pending++;
+    }
+
+    Shard& shard = getIdShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.ids[id] = STATE_PENDING;
+    return true;
+}
+
+void zTaskRegistry::markRunning(const string& name, uint64_t id) {
+    {
+        Shard& shard = getNameShard(name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::unordered_map<string, NameEntry, NameHash>::iterator it = shard.names.find(name);
+        if (it != shard.names.end() && it->second.pending > 0) {
+            it->second.pending--;
+            it->second.running++;
+        }
+    }
+
+    Shard& shard = getIdShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::unordered_map<uint64_t, State>::iterator it = shard.ids.find(id);
+    if (it != shard.ids.end()) {
+        it->second = STATE_RUNNING;
+    }
+}
+
+void zTaskRegistry::remove(const string& name, uint64_t id, bool running) {
+    {
+        Shard& shard = getNameShard(name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::unordered_map<string, NameEntry, NameHash>::iterator it = shard.names.find(name);
+        if (it != shard.names.end()) {
+            size_t& count = running ? it->second.running : it->second.pending;
+            if (count > 0) {
+                count--;
+            }
+            if (it->second.pending + it->second.running == 0) {
+                shard.names.erase(it);
+            }
+        }
+    }
+
+    Shard& shard = getIdShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.ids.erase(id);
+}
+
+bool zTaskRegistry::hasName(const string& name) const {
+    return getNameCount(name) > 0;
+}
+
+size_t zTaskRegistry::getNameCount(const string& name) const {
+    const Shard& shard = getNameShard(name);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::unordered_map<string, NameEntry, NameHash>::const_iterator it = shard.names.find(name);
+    if (it == shard.names.end()) {
+        return 0;
+    }
+    return it->second.pending + it->second.running;
+}
+
+zTaskRegistry::State zTaskRegistry::getState(uint64_t id) const {
+    const Shard& shard = getIdShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::unordered_map<uint64_t, State>::const_iterator it = shard.ids.find(id);
+    return it == shard.ids.end() ? STATE_NONE : it->second;
+}
+
+size_t zTaskRegistry::size() const {
+    size_t count = 0;
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+        count += m_shards[i].ids.size();
+    }
+    return count;
+}
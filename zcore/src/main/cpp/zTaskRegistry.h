@@ -0,0 +1,102 @@
+//
+// Created by lxz on 2025/12/02.
+// zTaskRegistry - 线程池中排队与执行中任务的名称/ID 索引
+//
+
+#ifndef OVERT_ZTASKREGISTRY_H
+#define OVERT_ZTASKREGISTRY_H
+
+#include <stdint.h>
+#include <mutex>
+#include <unordered_map>
+
+#include "zLog.h"
+#include "zStd.h"
+
+/**
+ * 任务登记表
+ * 按名称与 ID 两个维度索引线程池中排队中与执行中的任务，查询为 O(1)
+ *
+ * 分成 SHARD_COUNT 个分片，每个分片一把锁，名称按哈希、ID 按取模落到分片上，
+ * 不同名称的任务并发提交、完成时基本不会争用同一把锁
+ *
+ * 唯一任务：登记时如果同名任务已经在排队或执行，登记失败，用于避免重复提交同一个检测
+ */
+class zTaskRegistry {
+public:
+    enum State {
+        STATE_NONE = 0,         // 不在线程池中（未提交或已结束）
+        STATE_PENDING = 1,      // 排队中
+        STATE_RUNNING = 2,      // 执行中
+    };
+
+    static const size_t SHARD_COUNT = 16;
+
+private:
+    struct NameEntry {
+        size_t pending = 0;
+        size_t running = 0;
+    };
+
+    // nonstd::string 没有 std::hash 特化，按 data()/size() 计算 FNV-1a；分片与分片内的表使用同一个哈希
+    struct NameHash {
+        size_t operator()(const string& name) const noexcept {
+            uint64_t hash = 14695981039346656037ULL;
+            const unsigned char* data = (const unsigned char*) name.data();
+            for (size_t i = 0; i < name.size(); i++) {
+                hash ^= data[i];
+                hash *= 1099511628211ULL;
+            }
+            return (size_t) hash;
+        }
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<string, NameEntry, NameHash> names;
+        std::unordered_map<uint64_t, State> ids;
+    };
+
+    Shard m_shards[SHARD_COUNT];
+
+    Shard& getNameShard(const string& name) { return m_shards[NameHash()(name) % SHARD_COUNT]; }
+    const Shard& getNameShard(const string& name) const { return m_shards[NameHash()(name) % SHARD_COUNT]; }
+    Shard& getIdShard(uint64_t id) { return m_shards[id % SHARD_COUNT]; }
+    const Shard& getIdShard(uint64_t id) const { return m_shards[id % SHARD_COUNT]; }
+
+public:
+    zTaskRegistry() {}
+
+    zTaskRegistry(const zTaskRegistry&) = delete;
+    zTaskRegistry& operator=(const zTaskRegistry&) = delete;
+
+    /**
+     * 登记一个排队中的任务
+     * @param unique 为 true 时，同名任务已在排队或执行则不登记
+     * @return 是否登记成功
+     */
+    bool add(const string& name, uint64_t id, bool unique = false);
+
+    /**
+     * 任务开始执行
+     */
+    void markRunning(const string& name, uint64_t id);
+
+    /**
+     * 任务结束（执行完、被跳过或被丢弃）
+     */
+    void remove(const string& name, uint64_t id, bool running);
+
+    // 是否有该名称的任务在排队或执行
+    bool hasName(const string& name) const;
+
+    // 该名称排队中与执行中的任务数
+    size_t getNameCount(const string& name) const;
+
+    State getState(uint64_t id) const;
+
+    // 登记的任务总数（遍历所有分片，近似值）
+    size_t size() const;
+};
+
+#endif //OVERT_ZTASKREGISTRY_H
@@ -33,6 +33,7 @@ zThread::zThread(size_t index, const string& name)
     , m_task(nullptr)                                        // 任务对象指针
     , m_isTaskRunning(false)                                 // 任务运行状态
     , m_isThreadRunning(false)                               // 线程运行状态
+    , m_taskCompletionCallback(nullptr)                      // 任务完成回调
 {
     // std::mutex 和 std::condition_variable 会自动初始化
     LOGI("zThread[%zu] '%s' created with RAII mutex and condition variable", m_threadIndex, m_threadName.c_str());
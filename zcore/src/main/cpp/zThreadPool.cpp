@@ -5,6 +5,8 @@
 #include <mutex>
 #include <thread>
 #include <cmath>
+#include <sched.h>
+#include <algorithm>
 
 #include "zLog.h"
 #include "zLibc.h"
@@ -19,14 +21,64 @@
 // 静态单例实例指针 - 用于实现单例模式
 zThreadPool* zThreadPool::instance = nullptr;
 
-// 静态任务队列互斥锁 - 使用 std::mutex（自动初始化）
-std::mutex zThreadPool::m_taskQueueMutex;
+// 当前线程所属的线程池与工作线程下标，非工作线程为 nullptr
+static thread_local zThreadPool* tls_current_pool = nullptr;
+static thread_local size_t tls_worker_index = 0;
+static thread_local uint32_t tls_worker_generation = 0;
+
+// 当前线程上 runTask 的嵌套层数，工作线程等待时协助执行的任务不重复计入忙碌时间
+static thread_local int tls_run_depth = 0;
+
+// 每执行这么多次调度，工作线程优先检查一次全局队列，避免本地队列持续有任务时全局队列饿死
+static const uint32_t INJECT_CHECK_INTERVAL = 61;
+
+// 休眠前的让出次数，短时间内有新任务时避免一次休眠/唤醒
+static const int IDLE_YIELD_ROUNDS = 16;
+
+// 一次从全局队列取走的最大任务数
+static const size_t INJECT_BATCH_SIZE = 32;
+
+// 低优先级任务排队超过这个时间后，不再等待普通任务全部执行完
+static const uint64_t LOW_PRIORITY_AGING_MS = 1000;
+
+// 任务超时并被取消后，再等待这么久仍不返回就替换工作线程
+static const uint64_t HUNG_TASK_GRACE_MS = 1000;
+
+// 类别队列的堆比较：返回 a 是否应该排在 b 后面（截止时间晚、没有截止时间、或截止时间相同但序号大）
+static bool task_runs_after(const zTask* a, const zTask* b) {
+    uint64_t deadline_a = a->hasDeadline() ? a->getDeadlineNs() : UINT64_MAX;
+    uint64_t deadline_b = b->hasDeadline() ? b->getDeadlineNs() : UINT64_MAX;
+    if (deadline_a != deadline_b) {
+        return deadline_a > deadline_b;
+    }
+    return a->getSequence() > b->getSequence();
+}
 
 /**
  * zThread构造函数
  * 初始化线程管理器，设置默认参数
  */
-zThreadPool::zThreadPool() : m_name("zThreadPool"), m_maxThreads(8), m_running(false) {
+zThreadPool::zThreadPool()
+    : m_name("zThreadPool")
+    , m_maxThreads(8)
+    , m_running(false)
+    , m_injectHead(0)
+    , m_injectSize(0)
+    , m_taskSequence(0)
+    , m_reservedWorkers(0)
+    , m_affinityPolicy(AFFINITY_NONE)
+    , m_affinityEpoch(0)
+    , m_idleWorkers(0)
+    , m_reservedIdleWorkers(0)
+    , m_metricsEnabled(false)
+    , m_metricsStartNs(zTask::getMonotonicNs())
+    , m_peakQueueDepth(0)
+    , m_nextWatchId(1)
+    , m_watchdogThread(nullptr)
+    , m_hungWorkers(0)
+    , m_timedOutTasks(0)
+    , m_cancelledTasks(0)
+{
     LOGI("zThread: Constructor - Thread pool manager initialized");
 }
 
@@ -69,11 +121,6 @@ zThreadPool* zThreadPool::getInstance() {
     return instance;
 }
 
-void zThreadPool::taskCompletionCallback(string taskName, void* data){
-    LOGI("zThread: taskCompletionCallback is call");
-    tryRunTask();
-}
-
 // 线程池管理实现 - 启动线程池
 bool zThreadPool::startThreadPool(size_t threadCount) {
     // 检查线程池是否已经在运行
@@ -87,6 +134,9 @@ bool zThreadPool::startThreadPool(size_t threadCount) {
 
     // 计算实际创建的线程数，不超过最大线程数限制
     size_t actualThreadCount = (threadCount < m_maxThreads) ? threadCount : m_maxThreads;
+    if (actualThreadCount == 0) {
+        actualThreadCount = 1;
+    }
     if (actualThreadCount != threadCount) {
         LOGW("startThreadPool: Thread count limited from %zu to %zu (max threads)",
              threadCount, actualThreadCount);
@@ -94,32 +144,37 @@ bool zThreadPool::startThreadPool(size_t threadCount) {
 
     m_running = true;  // 设置运行标志
 
-    // 创建 zThread 对象
+    // 先创建所有工作线程的本地队列，工作线程启动后会互相窃取
+    for (size_t i = 0; i < actualThreadCount; ++i) {
+        Worker* worker = new Worker();
+        worker->stealSeed = (uint32_t) (i * 2654435761u + 1);
+        m_workers.push_back(worker);
+    }
+
+    // 创建 zThread 对象，每个 zThread 上运行一个常驻的 workerLoop
     for (size_t i = 0; i < actualThreadCount; ++i) {
         string threadName = m_name + "_worker_" + to_string(i);
 
         LOGI("startThreadPool: Creating worker thread %zu with name '%s'", i, threadName.c_str());
 
-        // 创建工作线程对象（使用回调函数实现解耦）
-        zThread* worker = new zThread(i, threadName);
-
-        // 使用 std::function 版本的重载函数，可以直接传递成员函数
-        worker->setTaskCompletionCallback([this](string taskId, void* userData) {
-            this->taskCompletionCallback(taskId, userData);
-        });
+        zThread* thread = new zThread(i, threadName);
 
         // 启动线程
-        if (!worker->start()) {
+        if (!thread->start()) {
             LOGE("startThreadPool: Failed to start worker thread %zu", i);
-            delete worker;
+            delete thread;
             m_running = false;
             return false;
         }
+        m_workers[i]->thread = thread;
 
-        LOGI("startThreadPool: Worker thread %zu started successfully", i);
-
-        m_workerThreads.push_back(worker);
+        if (!thread->setExecuteFunction(std::function<void()>([this, i]() { workerLoop(i, 0); }))) {
+            LOGE("startThreadPool: Failed to run worker loop on thread %zu", i);
+            m_running = false;
+            return false;
+        }
 
+        LOGI("startThreadPool: Worker thread %zu started successfully", i);
     }
 
     LOGI("startThreadPool: Thread pool started successfully with %zu worker threads", actualThreadCount);
@@ -132,101 +187,866 @@ bool zThreadPool::startThreadPool(size_t threadCount) {
  */
 zThreadPool::~zThreadPool() {
     LOGI("zThread: Destructor called");
-    
-    // 停止线程池
-    if (m_running) {
-        // 清理工作线程
-        for (auto* worker : m_workerThreads) {
-            if (worker) {
-                worker->stop();
-                delete worker;
-            }
+
+    // 停止线程池，唤醒所有休眠的工作线程让 workerLoop 退出
+    m_running = false;
+    {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        m_idleCV.notify_all();
+        m_reservedIdleCV.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_watchMutex);
+        m_watchCV.notify_all();
+    }
+    if (m_watchdogThread) {
+        m_watchdogThread->stop();
+        delete m_watchdogThread;
+        m_watchdogThread = nullptr;
+    }
+
+    // 清理工作线程
+    for (Worker* worker : m_workers) {
+        if (worker->thread) {
+            worker->thread->stop();
+            delete worker->thread;
+            worker->thread = nullptr;
+        }
+    }
+
+    // 被替换的线程：任务都已返回时可以 join，否则只能放弃（join 会一直阻塞）
+    if (m_hungWorkers.load() == 0) {
+        for (zThread* thread : m_abandonedThreads) {
+            thread->stop();
+            delete thread;
+        }
+    } else {
+        LOGW("zThread: Destructor leaks %zu replaced worker threads, %zu still running hung tasks",
+             m_abandonedThreads.size(), m_hungWorkers.load());
+    }
+    m_abandonedThreads.clear();
+
+    // 工作线程都已退出，释放还没有执行的任务
+    size_t droppedCount = 0;
+    for (Worker* worker : m_workers) {
+        while (zTask* task = worker->deque.pop()) {
+            delete task;
+            droppedCount++;
         }
-        m_workerThreads.clear();
-        m_running = false;
+        delete worker;
+    }
+    m_workers.clear();
+
+    for (size_t i = m_injectHead; i < m_injectQueue.size(); i++) {
+        delete m_injectQueue[i];
+        droppedCount++;
+    }
+    m_injectQueue.clear();
+    m_injectHead = 0;
+    m_injectSize = 0;
+
+    for (int priority = 0; priority < zTask::PRIORITY_COUNT; priority++) {
+        ClassQueue& queue = m_classQueues[priority];
+        for (size_t i = 0; i < queue.heap.size(); i++) {
+            delete queue.heap[i];
+            droppedCount++;
+        }
+        queue.heap.clear();
+        queue.size = 0;
+    }
+
+    if (droppedCount > 0) {
+        LOGW("zThread: Destructor dropped %zu pending tasks", droppedCount);
     }
 
     LOGI("zThread: Destructor completed");
 }
 
+bool zThreadPool::addTask(zTask* task) {
+    if (task == nullptr) {
+        LOGE("zThread: addTask - null task");
+        return false;
+    }
 
-void zThreadPool::tryRunTask(){
-    LOGI("zThread: tryRunTask called, queue size: %zu, worker threads: %zu", 
-         m_tasks.size(), m_workerThreads.size());
+    LOGD("zThread: addTask called with task name '%s'", task->getTaskName().c_str());
 
-    // 使用专门的 tryRunTask 互斥锁，避免与任务队列锁冲突
-    static std::mutex try_run_task_mutex;
-    
-    std::lock_guard<std::mutex> lock(try_run_task_mutex);
-    LOGI("zThread: tryRunTask acquired try_run_task lock");
-    
-    if(this->m_tasks.empty()){
-        LOGI("zThread: tryRunTask - No tasks in queue");
-        return;
+    if (!task->isValid()) {
+        LOGE("zThread: addTask - Failed to create valid default task '%s'", task->getTaskName().c_str());
+        delete task;
+        return false;
     }
-    
-    if(this->m_workerThreads.empty()){
-        LOGE("zThread: tryRunTask - No worker threads available");
-        return;
+
+    if (!m_running) {
+        LOGE("zThread: addTask - Thread pool is not running, drop task '%s'", task->getTaskName().c_str());
+        delete task;
+        return false;
     }
-    
-    // 直接为每个任务分配一个工作线程
-    int successfulAssignments = 0;
-    while(!this->m_tasks.empty()) {
-        bool foundAvailableWorker = false;
-        
-        for(size_t i = 0; i < this->m_workerThreads.size(); i++){
-            zThread* m_workerThread = m_workerThreads[i];
-            
-            // 检查工作线程是否可用（不在执行任务）
-            if(m_workerThread->isTaskRunning()) {
-                LOGI("zThread: tryRunTask - Worker %zu is busy, skipping", i);
-                continue; // 跳过忙碌的线程，尝试下一个
+
+    // 唯一任务在同名任务排队或执行时丢弃
+    if (!m_taskRegistry.add(task->getTaskName(), task->getId(), task->isUnique())) {
+        LOGD("zThread: addTask - task '%s' is already queued or running, drop duplicate", task->getTaskName().c_str());
+        delete task;
+        return false;
+    }
+
+    // 超时需要通过令牌通知任务，没有令牌时创建一个
+    if (task->getTimeoutMs() > 0) {
+        if (!task->getCancelToken().isValid()) {
+            task->setCancelToken(zCancelToken::create());
+        }
+        startWatchdog();
+    }
+
+    zTask::Priority priority = task->getPriority();
+    task->setEnqueueNs(zTask::getMonotonicNs());
+    task->setSequence(m_taskSequence.fetch_add(1, std::memory_order_relaxed));
+    m_classStats[priority].submitted.fetch_add(1, std::memory_order_relaxed);
+    if (m_metricsEnabled.load(std::memory_order_relaxed)) {
+        updatePeakQueueDepth();
+    }
+
+    if (priority != zTask::PRIORITY_NORMAL || task->hasDeadline()) {
+        pushClassQueue(task);
+    } else if (!isReservedWorker(tls_worker_index) && enterLocalQueue()) {
+        // 工作线程内提交的任务放入自己的本地队列，不需要加锁
+        m_workers[tls_worker_index]->deque.push(task);
+        leaveLocalQueue();
+    } else {
+        std::lock_guard<std::mutex> lock(m_injectMutex);
+        m_injectQueue.push_back(task);
+        m_injectSize.store(m_injectQueue.size() - m_injectHead, std::memory_order_release);
+    }
+
+    wakeIdleWorker(priority == zTask::PRIORITY_HIGH);
+    return true;
+}
+
+bool zThreadPool::addTask(const string& taskName, std::function<void()> taskFunction, zTask::Priority priority,
+                          uint64_t deadlineMs, uint64_t timeoutMs) {
+    LOGD("zThread: addTask called with task name '%s' priority %d deadline %llu ms timeout %llu ms",
+         taskName.c_str(), priority, (unsigned long long) deadlineMs, (unsigned long long) timeoutMs);
+
+    if (!taskFunction) {
+        LOGE("zThread: addTask - Invalid task function for task '%s'", taskName.c_str());
+        return false;
+    }
+
+    zTask* task = new zTask(taskName, taskFunction);
+    task->setPriority(priority)->setDeadlineMs(deadlineMs)->setTimeoutMs(timeoutMs);
+    return addTask(task);
+}
+
+bool zThreadPool::addUniqueTask(const string& taskName, std::function<void()> taskFunction, zTask::Priority priority) {
+    if (!taskFunction) {
+        LOGE("zThread: addUniqueTask - Invalid task function for task '%s'", taskName.c_str());
+        return false;
+    }
+
+    zTask* task = new zTask(taskName, taskFunction);
+    task->setPriority(priority)->setUnique(true);
+    return addTask(task);
+}
+
+zTaskFuture zThreadPool::addTaskFuture(const string& taskName, std::function<void()> taskFunction) {
+    return addTaskFuture(taskName, taskFunction, zTask::PRIORITY_NORMAL);
+}
+
+zTaskFuture zThreadPool::addTaskFuture(const string& taskName, std::function<void()> taskFunction, zTask::Priority priority,
+                                       uint64_t deadlineMs, uint64_t timeoutMs) {
+    LOGD("zThread: addTaskFuture called with task name '%s'", taskName.c_str());
+
+    if (!taskFunction) {
+        LOGE("zThread: addTaskFuture - Invalid task function for task '%s'", taskName.c_str());
+        return zTaskFuture::makeReady(false);
+    }
+
+    // 任务正常结束时设置成功；抛出异常或被丢弃时 promise 随任务析构，句柄以失败完成
+    std::shared_ptr<zTaskPromise> promise = std::make_shared<zTaskPromise>();
+    zCancelToken token = zCancelToken::create();
+    promise->setCancelToken(token);
+    zTaskFuture future = promise->getFuture();
+
+    // 取消或超时时句柄立即以失败完成，不等待任务函数返回
+    // 回调只持有弱引用，避免 令牌 -> 回调 -> promise -> 句柄 -> 令牌 的循环引用
+    std::weak_ptr<zTaskPromise> weakPromise = promise;
+    token.registerCallback([weakPromise]() {
+        std::shared_ptr<zTaskPromise> cancelledPromise = weakPromise.lock();
+        if (cancelledPromise) {
+            cancelledPromise->setResult(false);
+        }
+    });
+
+    // 任务函数响应取消后正常返回时，取消回调可能还没执行，这里也按失败处理
+    zTask* task = new zTask(taskName, [taskFunction, promise]() {
+        taskFunction();
+        promise->setResult(!zCancelToken::isCurrentCancelled());
+    });
+    task->setPriority(priority)->setDeadlineMs(deadlineMs)->setTimeoutMs(timeoutMs)->setCancelToken(token);
+    addTask(task);
+    return future;
+}
+
+bool zThreadPool::setReservedWorkers(size_t count) {
+    if (count >= m_workers.size()) {
+        LOGE("setReservedWorkers: %zu reserved workers requested, only %zu workers", count, m_workers.size());
+        return false;
+    }
+    m_reservedWorkers.store(count);
+    LOGI("setReservedWorkers: %zu of %zu workers reserved for high priority tasks", count, m_workers.size());
+
+    // 唤醒所有休眠的工作线程，按新的角色重新检查队列
+    std::lock_guard<std::mutex> lock(m_idleMutex);
+    m_idleCV.notify_all();
+    m_reservedIdleCV.notify_all();
+    return true;
+}
+
+void zThreadPool::setAffinityPolicy(AffinityPolicy policy) {
+    m_affinityPolicy.store(policy);
+    m_affinityEpoch.fetch_add(1, std::memory_order_acq_rel);
+    LOGI("setAffinityPolicy: policy %d for %zu workers", policy, m_workers.size());
+
+    // 唤醒休眠的工作线程，立即按新策略绑定
+    std::lock_guard<std::mutex> lock(m_idleMutex);
+    m_idleCV.notify_all();
+    m_reservedIdleCV.notify_all();
+}
+
+void zThreadPool::applyWorkerAffinity(size_t index) {
+    const zCpuTopology* topology = zCpuTopology::getInstance();
+    vector<int> cpus;
+    switch (getAffinityPolicy()) {
+        case AFFINITY_BIG_ONLY:
+            cpus = topology->getCpus(zCpuTopology::CORE_BIG);
+            break;
+        case AFFINITY_LITTLE_ONLY:
+            cpus = topology->getCpus(zCpuTopology::CORE_LITTLE);
+            break;
+        case AFFINITY_SPREAD: {
+            vector<int> order = topology->getSpreadOrder();
+            if (!order.empty()) {
+                cpus.push_back(order[index % order.size()]);
             }
-            
-            // 使用 RAII 锁保护队列操作
-            zTask* task = nullptr;
-            {
-                std::lock_guard<std::mutex> queueLock(m_taskQueueMutex);
-                
-                // 从队列头部取任务
-                task = m_tasks.front();
-                m_tasks.erase(m_tasks.begin());
+            break;
+        }
+        default:
+            cpus = topology->getCpus(zCpuTopology::CORE_ANY);
+            break;
+    }
+    if (zCpuTopology::bindCurrentThread(cpus)) {
+        LOGD("zThreadPool: worker %zu bound to %zu cpus starting at cpu%d", index, cpus.size(), cpus[0]);
+    }
+}
+
+zTaskClassStats zThreadPool::getClassStats(zTask::Priority priority) {
+    zTaskClassStats stats;
+    if (priority < zTask::PRIORITY_HIGH || priority >= zTask::PRIORITY_COUNT) {
+        return stats;
+    }
+    ClassStats& classStats = m_classStats[priority];
+    stats.submitted = classStats.submitted.load();
+    stats.started = classStats.started.load();
+    stats.waitCount = classStats.waitCount.load();
+    stats.waitTotalNs = classStats.waitTotalNs.load();
+    stats.waitMaxNs = classStats.waitMaxNs.load();
+    stats.deadlineMissed = classStats.deadlineMissed.load();
+    stats.queueDepth = stats.submitted > stats.started ? stats.submitted - stats.started : 0;
+    return stats;
+}
+
+void zThreadPool::resetClassStats() {
+    // 提交与开始计数不清零，否则排队中的任务会让队列深度出错
+    for (int priority = 0; priority < zTask::PRIORITY_COUNT; priority++) {
+        m_classStats[priority].waitCount = 0;
+        m_classStats[priority].waitTotalNs = 0;
+        m_classStats[priority].waitMaxNs = 0;
+        m_classStats[priority].deadlineMissed = 0;
+    }
+}
+
+zThreadPool* zThreadPool::getCurrentPool() {
+    return tls_current_pool;
+}
+
+bool zThreadPool::runPendingTask() {
+    if (!enterLocalQueue()) {
+        return false;
+    }
+    zTask* task = findTask(tls_worker_index);
+    leaveLocalQueue();
+    if (task == nullptr) {
+        return false;
+    }
+    runTask(task);
+    return true;
+}
+
+// 工作线程主循环，generation 为启动时工作线程的代数，被替换后退出
+void zThreadPool::workerLoop(size_t index, uint32_t generation) {
+    tls_current_pool = this;
+    tls_worker_index = index;
+    tls_worker_generation = generation;
+    Worker* worker = m_workers[index];
+    LOGI("zThreadPool: worker %zu loop started (generation %u)", index, generation);
+
+    // 被替换的旧线程可能刚通过代数检查、仍在访问本地队列，等它离开后再接管
+    while (worker->queueUsers.load() != 0) {
+        sched_yield();
+    }
+
+    int idleRounds = 0;
+    uint32_t affinityEpoch = 0;
+    while (m_running.load(std::memory_order_acquire)) {
+        uint32_t currentEpoch = m_affinityEpoch.load(std::memory_order_acquire);
+        if (currentEpoch != affinityEpoch) {
+            affinityEpoch = currentEpoch;
+            applyWorkerAffinity(index);
+        }
+
+        zTask* task = findTask(index);
+        if (task != nullptr) {
+            idleRounds = 0;
+            runTask(task);
+            if (worker->generation.load(std::memory_order_acquire) != generation) {
+                // 任务超时后本线程已被替换，本地队列归新线程所有
+                m_hungWorkers.fetch_sub(1);
+                LOGW("zThreadPool: replaced worker %zu (generation %u) returned from hung task, exiting", index, generation);
+                break;
             }
-            
-            // 直接调用 setExecuteTask 分配任务
-            bool success = m_workerThread->setExecuteTask(task);
-            if(success) {
-                successfulAssignments++;
-                LOGI("zThread: tryRunTask - Successfully assigned task '%s' (ID: %s) to worker %zu, remaining tasks: %zu", 
-                     task->getTaskName().c_str(), task->getTaskId().c_str(), i, m_tasks.size());
-                
-                // 验证任务是否真的被设置
-                if (!m_workerThread->isTaskRunning()) {
-                    LOGW("zThread: tryRunTask - Task assigned to worker %zu but isTaskRunning is false", i);
-                }
-            } else {
-                LOGW("zThread: tryRunTask - Failed to assign task '%s' to worker %zu", 
-                     task->getTaskName().c_str(), i);
-                
-                // 如果分配失败，需要把任务放回队列
-                {
-                    std::lock_guard<std::mutex> queueLock(m_taskQueueMutex);
-                    m_tasks.insert(m_tasks.begin(), task);
+            continue;
+        }
+
+        // 先让出几次 CPU，仍然没有任务再休眠
+        if (idleRounds < IDLE_YIELD_ROUNDS) {
+            idleRounds++;
+            sched_yield();
+            continue;
+        }
+        idleRounds = 0;
+        parkWorker(index);
+    }
+
+    tls_current_pool = nullptr;
+    LOGI("zThreadPool: worker %zu loop stopped", index);
+}
+
+bool zThreadPool::enterLocalQueue() {
+    if (tls_current_pool != this) {
+        return false;
+    }
+    Worker* worker = m_workers[tls_worker_index];
+    // 两处都是顺序一致的原子操作，与看门狗修改代数、替换线程读取 queueUsers 构成全序
+    worker->queueUsers.fetch_add(1);
+    if (worker->generation.load() != tls_worker_generation) {
+        worker->queueUsers.fetch_sub(1);
+        return false;
+    }
+    return true;
+}
+
+void zThreadPool::leaveLocalQueue() {
+    m_workers[tls_worker_index]->queueUsers.fetch_sub(1, std::memory_order_release);
+}
+
+zTask* zThreadPool::findTask(size_t index) {
+    Worker* worker = m_workers[index];
+
+    // 高优先级任务总是最先执行，预留线程只执行高优先级任务
+    zTask* task = popClassQueue(zTask::PRIORITY_HIGH);
+    if (task != nullptr || isReservedWorker(index)) {
+        return task;
+    }
+
+    if (++worker->tick % INJECT_CHECK_INTERVAL == 0) {
+        task = popInjectQueue(index);
+        if (task == nullptr) {
+            task = popAgedLowTask();
+        }
+    }
+    if (task == nullptr) {
+        task = popClassQueue(zTask::PRIORITY_NORMAL);
+    }
+    if (task == nullptr) {
+        task = worker->deque.pop();
+    }
+    if (task == nullptr) {
+        task = popInjectQueue(index);
+    }
+    if (task == nullptr) {
+        task = stealTask(index);
+        if (task != nullptr && m_metricsEnabled.load(std::memory_order_relaxed)) {
+            worker->steals.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (task == nullptr) {
+        task = popClassQueue(zTask::PRIORITY_LOW);
+    }
+    return task;
+}
+
+void zThreadPool::pushClassQueue(zTask* task) {
+    ClassQueue& queue = m_classQueues[task->getPriority()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.heap.push_back(task);
+    std::push_heap(queue.heap.begin(), queue.heap.end(), task_runs_after);
+    queue.size.store(queue.heap.size(), std::memory_order_release);
+}
+
+zTask* zThreadPool::popClassQueue(zTask::Priority priority) {
+    ClassQueue& queue = m_classQueues[priority];
+    if (queue.size.load(std::memory_order_acquire) == 0) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.heap.empty()) {
+        return nullptr;
+    }
+    std::pop_heap(queue.heap.begin(), queue.heap.end(), task_runs_after);
+    zTask* task = queue.heap.back();
+    queue.heap.pop_back();
+    queue.size.store(queue.heap.size(), std::memory_order_release);
+    return task;
+}
+
+zTask* zThreadPool::popAgedLowTask() {
+    ClassQueue& queue = m_classQueues[zTask::PRIORITY_LOW];
+    if (queue.size.load(std::memory_order_acquire) == 0) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.heap.empty()
+        || queue.heap.front()->getEnqueueNs() + LOW_PRIORITY_AGING_MS * 1000000ULL > zTask::getMonotonicNs()) {
+        return nullptr;
+    }
+    std::pop_heap(queue.heap.begin(), queue.heap.end(), task_runs_after);
+    zTask* task = queue.heap.back();
+    queue.heap.pop_back();
+    queue.size.store(queue.heap.size(), std::memory_order_release);
+    return task;
+}
+
+bool zThreadPool::isReservedWorker(size_t index) const {
+    return index + m_reservedWorkers.load(std::memory_order_relaxed) >= m_workers.size();
+}
+
+/**
+ * 从全局队列取任务
+ * 一次取走一批，第一个直接返回，其余放入本地队列，减少全局锁的竞争，其它工作线程也可以从本地队列窃取
+ */
+zTask* zThreadPool::popInjectQueue(size_t index) {
+    if (m_injectSize.load(std::memory_order_acquire) == 0) {
+        return nullptr;
+    }
+
+    zTask* batch[INJECT_BATCH_SIZE];
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_injectMutex);
+        size_t remaining = m_injectQueue.size() - m_injectHead;
+        if (remaining == 0) {
+            return nullptr;
+        }
+
+        // 按工作线程数平分，避免一个线程取走全部任务
+        count = remaining / m_workers.size() + 1;
+        if (count > INJECT_BATCH_SIZE) {
+            count = INJECT_BATCH_SIZE;
+        }
+        if (count > remaining) {
+            count = remaining;
+        }
+        for (size_t i = 0; i < count; i++) {
+            batch[i] = m_injectQueue[m_injectHead++];
+        }
+
+        // 头部已取走的元素达到一半时再整体前移，出队均摊 O(1)
+        if (m_injectHead == m_injectQueue.size()) {
+            m_injectQueue.clear();
+            m_injectHead = 0;
+        } else if (m_injectHead >= 1024 && m_injectHead * 2 >= m_injectQueue.size()) {
+            m_injectQueue.erase(m_injectQueue.begin(), m_injectQueue.begin() + m_injectHead);
+            m_injectHead = 0;
+        }
+        m_injectSize.store(m_injectQueue.size() - m_injectHead, std::memory_order_release);
+    }
+
+    Worker* worker = m_workers[index];
+    for (size_t i = count - 1; i > 0; i--) {
+        worker->deque.push(batch[i]);
+    }
+    if (count > 1) {
+        wakeIdleWorker();
+    }
+    return batch[0];
+}
+
+// 从其它工作线程的队列顶部窃取，起点随机，避免所有空闲线程争抢同一个队列
+zTask* zThreadPool::stealTask(size_t index) {
+    size_t workerCount = m_workers.size();
+    if (workerCount <= 1) {
+        return nullptr;
+    }
+
+    Worker* worker = m_workers[index];
+    uint32_t seed = worker->stealSeed;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    worker->stealSeed = seed;
+
+    size_t start = seed % workerCount;
+    for (size_t i = 0; i < workerCount; i++) {
+        size_t victim = (start + i) % workerCount;
+        if (victim == index) {
+            continue;
+        }
+        zTask* task = m_workers[victim]->deque.steal();
+        if (task != nullptr) {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+bool zThreadPool::hasPendingTask(size_t index) {
+    if (m_classQueues[zTask::PRIORITY_HIGH].size.load(std::memory_order_acquire) > 0) {
+        return true;
+    }
+    if (isReservedWorker(index)) {
+        return false;
+    }
+    if (m_classQueues[zTask::PRIORITY_NORMAL].size.load(std::memory_order_acquire) > 0
+        || m_classQueues[zTask::PRIORITY_LOW].size.load(std::memory_order_acquire) > 0
+        || m_injectSize.load(std::memory_order_acquire) > 0) {
+        return true;
+    }
+    for (Worker* worker : m_workers) {
+        if (!worker->deque.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void zThreadPool::runTask(zTask* task) {
+    LOGD("zThreadPool: worker %zu executing task '%s' (ID: %s)",
+         tls_worker_index, task->getTaskName().c_str(), task->getTaskId().c_str());
+
+    uint64_t now = zTask::getMonotonicNs();
+    uint64_t waitNs = now > task->getEnqueueNs() ? now - task->getEnqueueNs() : 0;
+    ClassStats& stats = m_classStats[task->getPriority()];
+    stats.started.fetch_add(1, std::memory_order_relaxed);
+    stats.waitCount.fetch_add(1, std::memory_order_relaxed);
+    stats.waitTotalNs.fetch_add(waitNs, std::memory_order_relaxed);
+    uint64_t waitMaxNs = stats.waitMaxNs.load(std::memory_order_relaxed);
+    while (waitNs > waitMaxNs && !stats.waitMaxNs.compare_exchange_weak(waitMaxNs, waitNs, std::memory_order_relaxed)) {
+    }
+    if (task->hasDeadline() && now > task->getDeadlineNs()) {
+        stats.deadlineMissed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    m_taskRegistry.markRunning(task->getTaskName(), task->getId());
+    task->setStartNs(now);
+    bool metrics = m_metricsEnabled.load(std::memory_order_relaxed);
+
+    const zCancelToken& token = task->getCancelToken();
+    if (token.isCancelled()) {
+        LOGW("zThreadPool: task '%s' (ID: %s) cancelled before start (%s), skipped",
+             task->getTaskName().c_str(), task->getTaskId().c_str(), token.getReason().c_str());
+        m_cancelledTasks.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // 执行期间任务的令牌作为当前线程的令牌，zcore 中的阻塞调用据此响应取消
+        zCancelScope scope(token);
+        uint64_t watchId = task->getTimeoutMs() > 0 ? watchTask(task) : 0;
+        tls_run_depth++;
+        if (task->getCoreClass() != zCpuTopology::CORE_ANY) {
+            zCpuAffinityScope affinity(task->getCoreClass());
+            task->execute();
+        } else {
+            task->execute();
+        }
+        tls_run_depth--;
+        if (watchId != 0) {
+            unwatchTask(watchId);
+        }
+        if (metrics) {
+            task->setFinishNs(zTask::getMonotonicNs());
+            recordTaskMetrics(task);
+        }
+    }
+
+    m_taskRegistry.remove(task->getTaskName(), task->getId(), true);
+    delete task;
+}
+
+/**
+ * 空闲休眠
+ * 先登记为空闲再检查队列，与 wakeIdleWorker 中"先入队再检查空闲数"配合，两边至少有一边能看到对方，不会丢失唤醒
+ */
+void zThreadPool::parkWorker(size_t index) {
+    bool reserved = isReservedWorker(index);
+    std::atomic<int>& idleWorkers = reserved ? m_reservedIdleWorkers : m_idleWorkers;
+    std::condition_variable& idleCV = reserved ? m_reservedIdleCV : m_idleCV;
+
+    std::unique_lock<std::mutex> lock(m_idleMutex);
+    idleWorkers.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_running.load(std::memory_order_acquire) && !hasPendingTask(index)) {
+        if (m_metricsEnabled.load(std::memory_order_relaxed)) {
+            Worker* worker = m_workers[index];
+            uint64_t start = zTask::getMonotonicNs();
+            idleCV.wait_for(lock, std::chrono::seconds(1));
+            worker->parks.fetch_add(1, std::memory_order_relaxed);
+            worker->idleNs.fetch_add(zTask::getMonotonicNs() - start, std::memory_order_relaxed);
+        } else {
+            idleCV.wait_for(lock, std::chrono::seconds(1));
+        }
+    }
+    idleWorkers.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+// 高优先级任务优先唤醒预留线程，没有空闲的预留线程时唤醒普通工作线程
+void zThreadPool::wakeIdleWorker(bool highPriority) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (highPriority && m_reservedIdleWorkers.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        m_reservedIdleCV.notify_one();
+        return;
+    }
+    if (m_idleWorkers.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        m_idleCV.notify_one();
+    }
+}
+
+void zThreadPool::startWatchdog() {
+    std::call_once(m_watchdogOnce, [this]() {
+        zThread* thread = new zThread(m_workers.size(), m_name + "_watchdog");
+        if (!thread->start()) {
+            LOGE("zThreadPool: Failed to start watchdog thread, task timeouts disabled");
+            delete thread;
+            return;
+        }
+        if (!thread->setExecuteFunction(std::function<void()>([this]() { watchdogLoop(); }))) {
+            LOGE("zThreadPool: Failed to run watchdog loop, task timeouts disabled");
+        }
+        m_watchdogThread = thread;
+    });
+}
+
+uint64_t zThreadPool::watchTask(zTask* task) {
+    WatchEntry entry;
+    entry.workerIndex = tls_worker_index;
+    entry.generation = tls_worker_generation;
+    entry.deadlineNs = zTask::getMonotonicNs() + task->getTimeoutMs() * 1000000ULL;
+    entry.cancelled = false;
+    entry.token = task->getCancelToken();
+    entry.taskName = task->getTaskName();
+
+    std::lock_guard<std::mutex> lock(m_watchMutex);
+    entry.id = m_nextWatchId++;
+    m_watchEntries.push_back(entry);
+    m_watchCV.notify_one();
+    return entry.id;
+}
+
+void zThreadPool::unwatchTask(uint64_t watchId) {
+    std::lock_guard<std::mutex> lock(m_watchMutex);
+    for (size_t i = 0; i < m_watchEntries.size(); i++) {
+        if (m_watchEntries[i].id == watchId) {
+            m_watchEntries[i] = m_watchEntries.back();
+            m_watchEntries.pop_back();
+            return;
+        }
+    }
+}
+
+/**
+ * 看门狗主循环
+ * 休眠到最早的截止时间：超时的任务取消令牌并进入宽限期，宽限期结束仍未返回则替换工作线程
+ * 令牌回调与线程替换都在锁外执行
+ */
+void zThreadPool::watchdogLoop() {
+    LOGI("zThreadPool: watchdog started");
+    std::unique_lock<std::mutex> lock(m_watchMutex);
+    while (m_running.load(std::memory_order_acquire)) {
+        uint64_t now = zTask::getMonotonicNs();
+        uint64_t nextWakeNs = now + 1000000000ULL;
+        vector<WatchEntry> timedOut;
+        vector<WatchEntry> hung;
+
+        for (size_t i = 0; i < m_watchEntries.size();) {
+            WatchEntry& entry = m_watchEntries[i];
+            if (now >= entry.deadlineNs) {
+                if (!entry.cancelled) {
+                    entry.cancelled = true;
+                    entry.deadlineNs = now + HUNG_TASK_GRACE_MS * 1000000ULL;
+                    timedOut.push_back(entry);
+                } else {
+                    // 在锁内增加代数：工作线程从任务返回后在同一把锁下注销，之后检查代数一定能看到变化，
+                    // 不会出现新旧两个线程同时使用本地队列
+                    uint32_t expected = entry.generation;
+                    if (m_running.load(std::memory_order_acquire)
+                        && m_workers[entry.workerIndex]->generation.compare_exchange_strong(expected, entry.generation + 1)) {
+                        m_hungWorkers.fetch_add(1);
+                        hung.push_back(entry);
+                    }
+                    m_watchEntries[i] = m_watchEntries.back();
+                    m_watchEntries.pop_back();
+                    continue;
                 }
             }
-            
-            foundAvailableWorker = true;
-            break; // 分配一个任务后跳出内层循环，重新开始查找
+            if (entry.deadlineNs < nextWakeNs) {
+                nextWakeNs = entry.deadlineNs;
+            }
+            i++;
         }
-        
-        if(!foundAvailableWorker) {
-            LOGI("zThread: tryRunTask - No more worker threads available, stopping assignment");
-            break;
+
+        if (!timedOut.empty() || !hung.empty()) {
+            lock.unlock();
+            for (size_t i = 0; i < timedOut.size(); i++) {
+                LOGW("zThreadPool: task '%s' on worker %zu timed out, cancelling",
+                     timedOut[i].taskName.c_str(), timedOut[i].workerIndex);
+                m_timedOutTasks.fetch_add(1);
+                timedOut[i].token.cancel("timeout");
+            }
+            for (size_t i = 0; i < hung.size(); i++) {
+                LOGE("zThreadPool: task '%s' ignored cancellation for %llu ms, replacing worker %zu",
+                     hung[i].taskName.c_str(), (unsigned long long) HUNG_TASK_GRACE_MS, hung[i].workerIndex);
+                replaceWorker(hung[i].workerIndex, hung[i].generation + 1);
+            }
+            lock.lock();
+            continue;
         }
+
+        m_watchCV.wait_for(lock, std::chrono::nanoseconds(nextWakeNs - now));
+    }
+    LOGI("zThreadPool: watchdog stopped");
+}
+
+/**
+ * 替换工作线程
+ * 调用前看门狗已经把代数改为 generation：旧线程仍在执行任务，返回后发现代数变化并退出，新线程接管本地队列
+ */
+void zThreadPool::replaceWorker(size_t index, uint32_t generation) {
+    Worker* worker = m_workers[index];
+    string threadName = m_name + "_worker_" + to_string(index) + "_" + to_string(generation);
+    zThread* thread = new zThread(index, threadName);
+    if (!thread->start()) {
+        // 本地队列中的任务仍可以被其它工作线程窃取
+        LOGE("zThreadPool: Failed to start replacement thread for worker %zu", index);
+        delete thread;
+        return;
+    }
+    if (!thread->setExecuteFunction(std::function<void()>([this, index, generation]() { workerLoop(index, generation); }))) {
+        LOGE("zThreadPool: Failed to run worker loop on replacement thread for worker %zu", index);
     }
 
-    LOGI("zThread: tryRunTask completed, assigned %d tasks successfully, remaining tasks: %zu", successfulAssignments, m_tasks.size());
+    // 只有看门狗线程修改 thread 与 m_abandonedThreads，析构时看门狗已经停止
+    m_abandonedThreads.push_back(worker->thread);
+    worker->thread = thread;
+    LOGW("zThreadPool: worker %zu replaced by '%s', %zu hung workers", index, threadName.c_str(), m_hungWorkers.load());
+}
+
+void zThreadPool::recordTaskMetrics(zTask* task) {
+    uint64_t runNs = task->getFinishNs() > task->getStartNs() ? task->getFinishNs() - task->getStartNs() : 0;
+    Worker* worker = m_workers[tls_worker_index];
+    worker->executed.fetch_add(1, std::memory_order_relaxed);
+    if (tls_run_depth == 0) {
+        worker->busyNs.fetch_add(runNs, std::memory_order_relaxed);
+    }
+
+    zTaskMetrics::TaskRecord record;
+    record.name = task->getTaskName();
+    record.id = task->getId();
+    record.worker = tls_worker_index;
+    record.enqueueNs = task->getEnqueueNs();
+    record.startNs = task->getStartNs();
+    record.finishNs = task->getFinishNs();
+    m_taskMetrics.record(record);
+}
+
+void zThreadPool::updatePeakQueueDepth() {
+    size_t depth = 0;
+    for (int priority = 0; priority < zTask::PRIORITY_COUNT; priority++) {
+        uint64_t submitted = m_classStats[priority].submitted.load(std::memory_order_relaxed);
+        uint64_t started = m_classStats[priority].started.load(std::memory_order_relaxed);
+        depth += submitted > started ? submitted - started : 0;
+    }
+    size_t peak = m_peakQueueDepth.load(std::memory_order_relaxed);
+    while (depth > peak && !m_peakQueueDepth.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {
+    }
+}
+
+void zThreadPool::setMetricsEnabled(bool enabled) {
+    if (enabled && !m_metricsEnabled.load()) {
+        resetMetrics();
+    }
+    m_metricsEnabled.store(enabled);
+    LOGI("zThreadPool: metrics %s", enabled ? "enabled" : "disabled");
+}
+
+void zThreadPool::resetMetrics() {
+    for (Worker* worker : m_workers) {
+        worker->executed = 0;
+        worker->busyNs = 0;
+        worker->idleNs = 0;
+        worker->steals = 0;
+        worker->parks = 0;
+    }
+    m_taskMetrics.reset();
+    m_peakQueueDepth = 0;
+    m_metricsStartNs = zTask::getMonotonicNs();
+}
+
+zThreadPoolMetrics zThreadPool::getMetrics() {
+    zThreadPoolMetrics metrics;
+    metrics.enabled = m_metricsEnabled.load();
+    uint64_t now = zTask::getMonotonicNs();
+    uint64_t start = m_metricsStartNs.load();
+    metrics.elapsedNs = now > start ? now - start : 0;
+    metrics.pendingTasks = getPendingTaskCount();
+    metrics.peakQueueDepth = m_peakQueueDepth.load();
+    metrics.timedOutTasks = m_timedOutTasks.load();
+    metrics.cancelledTasks = m_cancelledTasks.load();
+
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        Worker* worker = m_workers[i];
+        zWorkerMetrics workerMetrics;
+        workerMetrics.index = i;
+        workerMetrics.executed = worker->executed.load(std::memory_order_relaxed);
+        workerMetrics.busyNs = worker->busyNs.load(std::memory_order_relaxed);
+        workerMetrics.idleNs = worker->idleNs.load(std::memory_order_relaxed);
+        workerMetrics.steals = worker->steals.load(std::memory_order_relaxed);
+        workerMetrics.parks = worker->parks.load(std::memory_order_relaxed);
+        workerMetrics.utilization = metrics.elapsedNs ? (double) workerMetrics.busyNs / metrics.elapsedNs : 0;
+        metrics.workers.push_back(workerMetrics);
+    }
+
+    metrics.tasks = m_taskMetrics.getTaskSummaries();
+    for (const auto& item : metrics.tasks) {
+        metrics.total.wait.merge(item.second.wait);
+        metrics.total.run.merge(item.second.run);
+    }
+    metrics.recent = m_taskMetrics.getRecentTasks();
+    return metrics;
+}
+
+// 检查线程池中是否存在该名称的任务
+bool zThreadPool::hasTaskName(const string& taskName) {
+    LOGD("hasTaskName is called");
+    return m_taskRegistry.hasName(taskName);
+}
+
+size_t zThreadPool::getPendingTaskCount() {
+    size_t count = m_injectSize.load(std::memory_order_acquire);
+    for (int priority = 0; priority < zTask::PRIORITY_COUNT; priority++) {
+        count += m_classQueues[priority].size.load(std::memory_order_acquire);
+    }
+    for (Worker* worker : m_workers) {
+        count += worker->deque.size();
+    }
+    return count;
 }
 
 int zThreadPool::get_cpu_max_freq() {
@@ -12,10 +12,47 @@
 #include "zStd.h"
 #include "zStdUtil.h"
 #include "zThread.h"
+#include "zTaskDeque.h"
+#include "zTaskFuture.h"
+#include "zTaskRegistry.h"
+#include "zTaskMetrics.h"
 #include <shared_mutex>
 #include <mutex>
 #include <memory>
+#include <atomic>
+#include <condition_variable>
 
+/**
+ * 单个优先级类别的统计
+ */
+struct zTaskClassStats {
+    size_t queueDepth = 0;          // 排队中（已提交未开始）的任务数
+    uint64_t submitted = 0;         // 提交总数
+    uint64_t started = 0;           // 开始执行总数
+    uint64_t waitCount = 0;         // 统计了等待时间的任务数（resetClassStats 后重新计数）
+    uint64_t waitTotalNs = 0;       // 排队等待总时间
+    uint64_t waitMaxNs = 0;         // 最长排队等待时间
+    uint64_t deadlineMissed = 0;    // 开始执行时已经超过截止时间的任务数
+};
+
+/**
+ * 工作窃取线程池
+ * 每个工作线程有一个 Chase-Lev 本地队列，工作线程内提交的任务进入本地队列，其它线程提交的任务进入全局注入队列，
+ * 工作线程空闲时先取本地队列，再取全局队列，最后从其它工作线程的队列窃取，都没有任务时在条件变量上休眠
+ *
+ * 优先级：高优先级、低优先级以及带截止时间的任务进入各自类别的全局队列，类别内按截止时间排序（EDF），
+ * 没有截止时间的排在后面并保持先进先出。取任务顺序为 高 → 普通 → 低，低优先级任务排队过久时提前执行避免饿死。
+ * 可以预留若干工作线程只执行高优先级任务，高优先级任务不会排在批量任务后面
+ *
+ * 取消与超时：任务开始执行前令牌已被取消则跳过；设置了超时的任务由看门狗线程在超时后取消令牌，
+ * 任务在宽限时间内仍不返回时，看门狗启动新线程接管该工作线程的队列，被占住的线程在任务返回后退出
+ *
+ * 绑核：按 zCpuTopology 的大小核簇设置工作线程的 CPU 亲和性（只用大核、只用小核、每个线程分散绑定一个核），
+ * 单个任务也可以指定核心类别，执行期间临时绑定
+ *
+ * 统计：开启后记录每个任务名称的排队等待/执行时间直方图、工作线程的利用率、窃取与休眠次数，可以导出为 JSON；
+ * 默认关闭，关闭时每个任务只多一次 relaxed 原子读
+ */
 class zThreadPool {
 private:
     // 私有构造函数，防止外部实例化
@@ -37,14 +74,181 @@ private:
     size_t m_maxThreads;
 
     // 线程池运行状态
-    bool m_running;
+    std::atomic<bool> m_running;
+
+    /**
+     * 工作线程：zThread 上运行 workerLoop，每个工作线程拥有一个本地工作窃取队列
+     */
+    struct Worker {
+        zThread* thread = nullptr;
+        zTaskDeque<zTask*> deque;
+        uint32_t stealSeed = 0;     // 选择窃取目标的随机数种子
+        uint32_t tick = 0;          // 调度计数，定期优先检查全局队列
+
+        // 工作线程被替换时加一，旧线程发现与自己的代数不同后退出，不再访问本地队列
+        std::atomic<uint32_t> generation{0};
+
+        // 正在访问本地队列的线程数（见 enterLocalQueue），替换线程等它归零后才接管本地队列
+        std::atomic<uint32_t> queueUsers{0};
+
+        // 统计，只在开启统计时更新
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> busyNs{0};
+        std::atomic<uint64_t> idleNs{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<uint64_t> parks{0};
+    };
+
+    vector<Worker*> m_workers;
+
+    // 全局注入队列：非工作线程提交的任务，m_injectHead 之前的元素已被取走
+    vector<zTask*> m_injectQueue;
+    size_t m_injectHead;
+    std::atomic<size_t> m_injectSize;
+    std::mutex m_injectMutex;
+
+    /**
+     * 优先级类别队列：按截止时间、序号排序的堆
+     */
+    struct ClassQueue {
+        std::mutex mutex;
+        vector<zTask*> heap;
+        std::atomic<size_t> size{0};
+    };
 
-    vector<zThread*> m_workerThreads;
+    struct ClassStats {
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> started{0};
+        std::atomic<uint64_t> waitCount{0};
+        std::atomic<uint64_t> waitTotalNs{0};
+        std::atomic<uint64_t> waitMaxNs{0};
+        std::atomic<uint64_t> deadlineMissed{0};
+    };
 
-    // 添加互斥锁来保护任务队列
-    static std::mutex m_taskQueueMutex;
+    // 高、普通（带截止时间）、低三个类别的队列，普通类别没有截止时间的任务走本地队列与全局注入队列
+    ClassQueue m_classQueues[zTask::PRIORITY_COUNT];
+    ClassStats m_classStats[zTask::PRIORITY_COUNT];
+    std::atomic<uint64_t> m_taskSequence;
+
+    // 预留给高优先级任务的工作线程数，下标最大的几个工作线程
+    std::atomic<size_t> m_reservedWorkers;
+
+    // 工作线程绑核策略，修改时 m_affinityEpoch 加一，工作线程发现变化后重新绑定自己
+    std::atomic<int> m_affinityPolicy;
+    std::atomic<uint32_t> m_affinityEpoch;
+
+    // 空闲工作线程在条件变量上休眠，提交任务时只有存在空闲线程才需要唤醒
+    // 预留线程单独休眠，只被高优先级任务唤醒
+    std::mutex m_idleMutex;
+    std::condition_variable m_idleCV;
+    std::atomic<int> m_idleWorkers;
+    std::condition_variable m_reservedIdleCV;
+    std::atomic<int> m_reservedIdleWorkers;
+
+    // 排队中与执行中的任务，按名称与 ID 索引，供 hasTaskName / getTaskState 查询与唯一任务去重
+    zTaskRegistry m_taskRegistry;
+
+    // 统计开关、开始统计的时间与统计期间的最大排队数
+    std::atomic<bool> m_metricsEnabled;
+    std::atomic<uint64_t> m_metricsStartNs;
+    std::atomic<size_t> m_peakQueueDepth;
+    zTaskMetrics m_taskMetrics;
+
+    /**
+     * 看门狗：执行中且设置了超时的任务
+     * 超时后取消令牌，deadlineNs 改为宽限期结束时间；宽限期结束仍未返回则替换工作线程
+     */
+    struct WatchEntry {
+        uint64_t id;
+        size_t workerIndex;
+        uint32_t generation;
+        uint64_t deadlineNs;
+        bool cancelled;
+        zCancelToken token;
+        string taskName;
+    };
+
+    vector<WatchEntry> m_watchEntries;
+    uint64_t m_nextWatchId;
+    std::mutex m_watchMutex;
+    std::condition_variable m_watchCV;
+    zThread* m_watchdogThread;
+    std::once_flag m_watchdogOnce;
+
+    // 被替换的工作线程，任务返回前不能 join
+    vector<zThread*> m_abandonedThreads;
+    std::atomic<size_t> m_hungWorkers;
+    std::atomic<uint64_t> m_timedOutTasks;
+    std::atomic<uint64_t> m_cancelledTasks;
+
+    void workerLoop(size_t index, uint32_t generation);
+
+    /**
+     * 当前线程是本线程池仍在职的工作线程时进入本地队列访问区，返回 true 后必须调用 leaveLocalQueue
+     * 先登记再检查代数：旧线程通过检查后看门狗才改代数时，替换线程会等它离开；
+     * 代数已经改变的旧线程返回 false，由调用方改走全局队列
+     */
+    bool enterLocalQueue();
+
+    void leaveLocalQueue();
+
+    // 依次从本地队列、全局队列、其它工作线程的队列获取任务
+    zTask* findTask(size_t index);
+
+    zTask* popInjectQueue(size_t index);
+
+    zTask* stealTask(size_t index);
+
+    void pushClassQueue(zTask* task);
+
+    zTask* popClassQueue(zTask::Priority priority);
+
+    // 低优先级队列头部的任务排队超过 LOW_PRIORITY_AGING_MS 时取出
+    zTask* popAgedLowTask();
+
+    bool isReservedWorker(size_t index) const;
+
+    // 按当前绑核策略绑定第 index 个工作线程（在该工作线程上调用）
+    void applyWorkerAffinity(size_t index);
+
+    // 指定工作线程是否还有可以执行的任务
+    bool hasPendingTask(size_t index);
+
+    void runTask(zTask* task);
+
+    // 执行结束后记录任务与工作线程的统计
+    void recordTaskMetrics(zTask* task);
+
+    // 提交任务时更新最大排队数
+    void updatePeakQueueDepth();
+
+    // 没有任务时休眠，直到有新任务或线程池停止
+    void parkWorker(size_t index);
+
+    void wakeIdleWorker(bool highPriority = false);
+
+    void startWatchdog();
+
+    void watchdogLoop();
+
+    uint64_t watchTask(zTask* task);
+
+    void unwatchTask(uint64_t watchId);
+
+    // 启动代数为 generation 的新线程，替换被占住的工作线程
+    void replaceWorker(size_t index, uint32_t generation);
 
 public:
+    /**
+     * 工作线程绑核策略
+     */
+    enum AffinityPolicy {
+        AFFINITY_NONE = 0,          // 不绑定，由系统调度
+        AFFINITY_BIG_ONLY = 1,      // 只在大核簇上运行
+        AFFINITY_LITTLE_ONLY = 2,   // 只在小核簇上运行
+        AFFINITY_SPREAD = 3,        // 每个工作线程绑定一个核，从大核开始在各簇之间轮流分配
+    };
+
     /**
      * 获取单例实例
      * @return zThread单例指针
@@ -78,11 +282,9 @@ public:
     static int get_cpu_max_freq();
     static int suggest_thread_count(uint32_t maxFreq);
 
-    vector<zTask*> m_tasks;
-
     template<typename Obj, typename RetType, typename... FuncArgs, typename... Args>
     bool addTask(Obj* obj, RetType (Obj::*memberFunc)(FuncArgs...), Args&&... args) {
-        LOGI("zThread: addTask called with object %p", obj);
+        LOGD("zThread: addTask called with object %p", obj);
         
         // 检查对象和函数指针是否有效
         if (!obj || !memberFunc) {
@@ -92,7 +294,7 @@ public:
         
         // 创建包装 lambda 来调用成员函数
         std::function<void()> taskFunction = [obj, memberFunc, args...]() {
-            LOGI("zThread: Executing member function task");
+            LOGD("zThread: Executing member function task");
             (obj->*memberFunc)(args...); // 调用成员函数
         };
         
@@ -104,7 +306,7 @@ public:
 
     // 重载：直接添加 std::function
     bool addTask(std::function<void()> taskFunction) {
-        LOGI("zThread: addTask(std::function) called");
+        LOGD("zThread: addTask(std::function) called");
         
         if (!taskFunction) {
             LOGE("zThread: addTask - Invalid task function");
@@ -120,7 +322,7 @@ public:
     // 重载：带任务名的成员函数版本
     template<typename Obj, typename RetType, typename... FuncArgs, typename... Args>
     bool addTask(const string& taskName, Obj* obj, RetType (Obj::*memberFunc)(FuncArgs...), Args&&... args) {
-        LOGI("zThread: addTask called with task name '%s' and object %p", taskName.c_str(), obj);
+        LOGD("zThread: addTask called with task name '%s' and object %p", taskName.c_str(), obj);
         
         // 检查对象和函数指针是否有效
         if (!obj || !memberFunc) {
@@ -136,7 +338,7 @@ public:
     
     // 重载：带任务名的 std::function 版本
     bool addTask(const string& taskName, std::function<void()> taskFunction) {
-        LOGI("zThread: addTask called with task name '%s'", taskName.c_str());
+        LOGD("zThread: addTask called with task name '%s'", taskName.c_str());
         
         if (!taskFunction) {
             LOGE("zThread: addTask - Invalid task function for task '%s'", taskName.c_str());
@@ -151,53 +353,121 @@ public:
     
     // 重载：带任务名的默认任务版本
     bool addTask(const string& taskName) {
-        LOGI("zThread: addTask called with task name '%s' (using default task)", taskName.c_str());
+        LOGD("zThread: addTask called with task name '%s' (using default task)", taskName.c_str());
         // 创建带默认任务函数的 zTask 对象
         zTask* task = new zTask(taskName);
         return addTask(task);
     }
 
-    bool addTask(zTask* task) {
-        LOGI("zThread: addTask called with task name '%s' (using default task)", task->getTaskName().c_str());
+    bool addTask(zTask* task);
 
-        if (!task->isValid()) {
-            LOGE("zThread: addTask - Failed to create valid default task '%s'", task->getTaskName().c_str());
-            delete task;
-            return false;
-        }
+    // 返回完成句柄的版本：任务结束（包括抛出异常、被丢弃）时句柄完成
+    zTaskFuture addTaskFuture(const string& taskName, std::function<void()> taskFunction);
 
-        // 使用 RAII 锁保护任务队列
-        {
-            std::lock_guard<std::mutex> lock(m_taskQueueMutex);
-            m_tasks.push_back(task);
-            LOGI("zThread: Default task '%s' (ID: %s) added to queue, current queue size: %zu",
-                 task->getTaskName().c_str(), task->getTaskId().c_str(), m_tasks.size());
+    template<typename Obj, typename RetType, typename... FuncArgs, typename... Args>
+    zTaskFuture addTaskFuture(const string& taskName, Obj* obj, RetType (Obj::*memberFunc)(FuncArgs...), Args&&... args) {
+        if (!obj || !memberFunc) {
+            LOGE("zThread: addTaskFuture - Invalid object or member function pointer for task '%s'", taskName.c_str());
+            return zTaskFuture::makeReady(false);
         }
-        // 尝试运行任务（在锁外调用，避免死锁）
-        tryRunTask();
-        return true;
+        return addTaskFuture(taskName, std::function<void()>([obj, memberFunc, args...]() {
+            (obj->*memberFunc)(args...);
+        }));
     }
 
-    void taskCompletionCallback(string taskName, void* data);
+    /**
+     * 提交唯一任务：同名任务已在排队或执行时不提交
+     * 检查与登记在同一把锁内完成，多个线程同时提交同名任务只有一个成功
+     * @return 是否提交成功
+     */
+    bool addUniqueTask(const string& taskName, std::function<void()> taskFunction,
+                       zTask::Priority priority = zTask::PRIORITY_NORMAL);
 
-    void tryRunTask();
+    // 带优先级、截止时间与超时的版本，deadlineMs 为距离现在的毫秒数，timeoutMs 从开始执行算起，0 表示不限制
+    bool addTask(const string& taskName, std::function<void()> taskFunction, zTask::Priority priority,
+                 uint64_t deadlineMs = 0, uint64_t timeoutMs = 0);
 
-    // 检查线程池中是否存在该名称的任务
-    bool hasTaskName(string taskName){
-        // 使用 RAII 锁保护队列操作
-        LOGD("hasTaskName is called");
-        std::lock_guard<std::mutex> lock(m_taskQueueMutex);
-        bool hasTask = false;
+    // 句柄的 cancel 可以取消任务，超时或取消时句柄立即以失败完成
+    zTaskFuture addTaskFuture(const string& taskName, std::function<void()> taskFunction, zTask::Priority priority,
+                              uint64_t deadlineMs = 0, uint64_t timeoutMs = 0);
 
-        for(zThread* m_workerThread : m_workerThreads){
-            LOGD("m_workerThread->getThreadName() %s", m_workerThread->getName().c_str());
-            if (m_workerThread->getTaskName() == taskName){
-                hasTask = true;
-                break;
-            }
-        }
-        return hasTask;
-    }
+    /**
+     * 预留 count 个工作线程只执行高优先级任务，至少保留一个工作线程执行其它任务
+     * @return count 不小于工作线程数时返回false
+     */
+    bool setReservedWorkers(size_t count);
+
+    size_t getReservedWorkers() const { return m_reservedWorkers.load(); }
+
+    /**
+     * 设置工作线程绑核策略，工作线程在取下一个任务前重新绑定自己
+     * 同构设备上 AFFINITY_BIG_ONLY / AFFINITY_LITTLE_ONLY 都是全部核心
+     */
+    void setAffinityPolicy(AffinityPolicy policy);
+
+    AffinityPolicy getAffinityPolicy() const { return (AffinityPolicy) m_affinityPolicy.load(); }
+
+    /**
+     * 获取优先级类别的队列深度与等待时间统计
+     */
+    zTaskClassStats getClassStats(zTask::Priority priority);
+
+    void resetClassStats();
+
+    /**
+     * 当前线程所属的线程池，非工作线程返回 nullptr
+     */
+    static zThreadPool* getCurrentPool();
+
+    /**
+     * 在当前工作线程上执行一个待执行的任务，用于工作线程内等待时协助执行
+     * @return 非本线程池的工作线程或没有待执行任务时返回false
+     */
+    bool runPendingTask();
+
+    // 检查线程池中是否存在该名称的任务（排队中或执行中）
+    bool hasTaskName(const string& taskName);
+
+    /**
+     * 任务的状态（排队中、执行中），已结束或不存在时返回 STATE_NONE
+     * @param taskId zTask::getId
+     */
+    zTaskRegistry::State getTaskState(uint64_t taskId) const { return m_taskRegistry.getState(taskId); }
+
+    // 工作线程数量
+    size_t getWorkerCount() const { return m_workers.size(); }
+
+    // 排队中的任务数量（近似值）
+    size_t getPendingTaskCount();
+
+    // 超时后被取消的任务数
+    uint64_t getTimedOutTaskCount() const { return m_timedOutTasks.load(); }
+
+    // 开始执行前已取消、被跳过的任务数
+    uint64_t getCancelledTaskCount() const { return m_cancelledTasks.load(); }
+
+    // 被超时任务占住、已经替换掉但还没退出的工作线程数
+    size_t getHungWorkerCount() const { return m_hungWorkers.load(); }
+
+    /**
+     * 开启或关闭统计，从关闭变为开启时清空之前的统计
+     */
+    void setMetricsEnabled(bool enabled);
+
+    bool isMetricsEnabled() const { return m_metricsEnabled.load(std::memory_order_relaxed); }
+
+    /**
+     * 清空统计并从现在开始重新计时
+     */
+    void resetMetrics();
+
+    /**
+     * 获取统计：各任务名称的排队等待/执行时间直方图、各工作线程的利用率与窃取/休眠次数、最近执行的任务
+     */
+    zThreadPoolMetrics getMetrics();
+
+    // getMetrics 的 JSON 形式
+    string dumpMetricsJson(int indent = -1) { return getMetrics().toJson(indent); }
 };
 
 
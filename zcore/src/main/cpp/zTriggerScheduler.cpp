@@ -0,0 +1,632 @@
+//
+// Created by lxz on 2025/12/04.
+// zTriggerScheduler 实现 - 按变化触发的检测调度
+//
+
+#include <poll.h>
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#ifdef __ANDROID__
+#include <sys/system_properties.h>
+#endif
+
+#include "zFile.h"
+#include "zTask.h"
+#include "zTriggerScheduler.h"
+
+// inotify 关心的事件：内容、属性修改，目录内文件的增删改名，被监听对象本身被删除或移动
+static const uint32_t WATCH_MASK = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE
+                                   | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+static const uint64_t NS_PER_MS = 1000000ULL;
+
+zTriggerScheduler::zTriggerScheduler()
+    : m_busyProbe(nullptr)
+    , m_propertyProbe(readPropertySerial)
+    , m_mapsProbe(readMapsFingerprint)
+    , m_pollIntervalMs(1000)
+    , m_mapsPollIntervalMs(5000)
+    , m_budgetNs(0)
+    , m_budgetWindowMs(60000)
+    , m_deferrals(0)
+    , m_running(false)
+    , m_inotifyFd(-1)
+    , m_netlinkFd(-1)
+    , m_wakeFd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+    , m_rewatch(false)
+{
+    if (m_wakeFd < 0) {
+        LOGW("zTriggerScheduler: eventfd failed (errno: %d: %s), trigger() waits for the next poll", errno, strerror(errno));
+    }
+}
+
+zTriggerScheduler::~zTriggerScheduler() {
+    stop();
+    closeFds();
+    if (m_wakeFd >= 0) {
+        close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+}
+
+bool zTriggerScheduler::addDetector(const string& name, const Triggers& triggers) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Detector& detector : m_detectors) {
+        if (detector.name == name) {
+            LOGE("zTriggerScheduler: duplicate detector '%s'", name.c_str());
+            return false;
+        }
+    }
+    Detector detector;
+    detector.name = name;
+    detector.triggers = triggers;
+    detector.stats.effectiveStaleMs = triggers.maxStaleMs;
+    m_detectors.push_back(detector);
+    return true;
+}
+
+void zTriggerScheduler::markLocked(uint32_t reason, const std::function<bool(const Detector&)>& match) {
+    for (Detector& detector : m_detectors) {
+        if (match(detector)) {
+            detector.stats.pendingReasons |= reason;
+        }
+    }
+}
+
+void zTriggerScheduler::wake() {
+    if (m_wakeFd >= 0) {
+        uint64_t value = 1;
+        ssize_t ret = write(m_wakeFd, &value, sizeof(value));
+        (void) ret;
+    }
+}
+
+void zTriggerScheduler::trigger(const string& name, TriggerType reason) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        markLocked(reason, [&name](const Detector& detector) {
+            return name.empty() || detector.name == name;
+        });
+    }
+    wake();
+}
+
+void zTriggerScheduler::notify(TriggerType reason) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        markLocked(reason, [reason](const Detector& detector) {
+            switch (reason) {
+                case TRIGGER_FILE:
+                    return !detector.triggers.paths.empty();
+                case TRIGGER_NETWORK:
+                    return detector.triggers.network;
+                case TRIGGER_PROPERTY:
+                    return detector.triggers.property;
+                case TRIGGER_MAPS:
+                    return detector.triggers.maps;
+                default:
+                    return true;
+            }
+        });
+    }
+    wake();
+}
+
+void zTriggerScheduler::setCpuBudget(uint64_t budgetNs, uint64_t windowMs) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_budgetNs = budgetNs;
+        m_budgetWindowMs = windowMs ? windowMs : 1;
+    }
+    wake();
+}
+
+void zTriggerScheduler::reportResult(const string& name, bool changed, uint64_t cpuNs) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t now = zTask::getMonotonicNs();
+        pruneCostWindowLocked(now);
+        CostEntry entry;
+        entry.timeNs = now;
+        entry.costNs = cpuNs;
+        m_costWindow.push_back(entry);
+
+        for (Detector& detector : m_detectors) {
+            if (detector.name != name) {
+                continue;
+            }
+            DetectorStats& stats = detector.stats;
+            const Triggers& triggers = detector.triggers;
+            detector.inFlight = false;
+            // 第一次直接使用，之后按 1/4 的权重滑动平均，单次波动不会让估计值大起大落
+            stats.costNs = stats.costNs == 0 ? cpuNs : (stats.costNs * 3 + cpuNs) / 4;
+            if (changed) {
+                stats.changes++;
+                stats.stableRuns = 0;
+                stats.effectiveStaleMs = triggers.maxStaleMs;
+            } else {
+                stats.stableRuns++;
+                if (triggers.maxBackoffMs > triggers.maxStaleMs && stats.effectiveStaleMs != 0) {
+                    uint64_t next = (uint64_t) (stats.effectiveStaleMs * triggers.backoffFactor);
+                    next = next > stats.effectiveStaleMs ? next : stats.effectiveStaleMs;
+                    stats.effectiveStaleMs = next < triggers.maxBackoffMs ? next : triggers.maxBackoffMs;
+                }
+            }
+            break;
+        }
+    }
+    // 最长间隔可能缩短、预算可能释放，让 run 重新计算
+    wake();
+}
+
+void zTriggerScheduler::reportFailure(const string& name, uint64_t cpuNs) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t now = zTask::getMonotonicNs();
+        pruneCostWindowLocked(now);
+        if (cpuNs != 0) {
+            CostEntry entry;
+            entry.timeNs = now;
+            entry.costNs = cpuNs;
+            m_costWindow.push_back(entry);
+        }
+
+        for (Detector& detector : m_detectors) {
+            if (detector.name != name) {
+                continue;
+            }
+            // 失败时不知道结果是否稳定，不拉长间隔；失败的耗时不代表正常执行，不更新估计值
+            detector.inFlight = false;
+            detector.stats.failures++;
+            detector.stats.stableRuns = 0;
+            detector.stats.effectiveStaleMs = detector.triggers.maxStaleMs;
+            break;
+        }
+    }
+    wake();
+}
+
+void zTriggerScheduler::pruneCostWindowLocked(uint64_t now) {
+    uint64_t windowNs = m_budgetWindowMs * NS_PER_MS;
+    while (!m_costWindow.empty() && now - m_costWindow.front().timeNs >= windowNs) {
+        m_costWindow.pop_front();
+    }
+}
+
+uint64_t zTriggerScheduler::getBudgetUsedLocked(uint64_t now, uint64_t& inFlightNs) const {
+    uint64_t windowNs = m_budgetWindowMs * NS_PER_MS;
+    uint64_t usedNs = 0;
+    for (const CostEntry& entry : m_costWindow) {
+        if (now - entry.timeNs < windowNs) {
+            usedNs += entry.costNs;
+        }
+    }
+    inFlightNs = 0;
+    for (const Detector& detector : m_detectors) {
+        if (detector.inFlight && now - detector.dispatchNs < windowNs) {
+            inFlightNs += detector.stats.costNs;
+        }
+    }
+    return usedNs;
+}
+
+vector<string> zTriggerScheduler::collectReadyLocked(uint64_t now, uint64_t& wakeNs) {
+    vector<Detector*> candidates;
+    for (Detector& detector : m_detectors) {
+        DetectorStats& stats = detector.stats;
+        uint64_t staleNs = stats.effectiveStaleMs * NS_PER_MS;
+        if (staleNs != 0 && stats.lastRunNs != 0 && now - stats.lastRunNs >= staleNs) {
+            stats.pendingReasons |= TRIGGER_STALE;
+        }
+        if (stats.pendingReasons == TRIGGER_NONE) {
+            if (staleNs != 0 && stats.lastRunNs + staleNs < wakeNs) {
+                wakeNs = stats.lastRunNs + staleNs;
+            }
+            continue;
+        }
+        uint64_t readyNs = stats.lastRunNs + detector.triggers.minIntervalMs * NS_PER_MS;
+        if (stats.lastRunNs != 0 && now < readyNs) {
+            wakeNs = readyNs < wakeNs ? readyNs : wakeNs;
+            continue;
+        }
+        // 仍在执行的检测保持待执行状态，按 pollIntervalMs 重试
+        if (m_busyProbe && m_busyProbe(detector.name)) {
+            continue;
+        }
+        candidates.push_back(&detector);
+    }
+
+    uint64_t usedNs = 0;
+    uint64_t windowNs = m_budgetWindowMs * NS_PER_MS;
+    if (m_budgetNs != 0 && !candidates.empty()) {
+        pruneCostWindowLocked(now);
+        uint64_t inFlightNs = 0;
+        usedNs = getBudgetUsedLocked(now, inFlightNs) + inFlightNs;
+        // 推迟超过一个窗口的检测排在最前，其余按估计消耗从小到大，预算不足时推迟的是最贵的检测
+        std::stable_sort(candidates.begin(), candidates.end(), [now, windowNs](const Detector* a, const Detector* b) {
+            bool starvedA = a->deferredSinceNs != 0 && now - a->deferredSinceNs >= windowNs;
+            bool starvedB = b->deferredSinceNs != 0 && now - b->deferredSinceNs >= windowNs;
+            if (starvedA != starvedB) {
+                return starvedA;
+            }
+            return a->stats.costNs < b->stats.costNs;
+        });
+    }
+
+    vector<string> ready;
+    bool blocked = false;
+    bool deferred = false;
+    for (Detector* detector : candidates) {
+        DetectorStats& stats = detector->stats;
+        if (m_budgetNs != 0) {
+            // 预算全部空闲时总是允许执行，估计值超过整个预算的检测也不会一直等下去
+            bool fits = usedNs == 0 || usedNs + stats.costNs <= m_budgetNs;
+            if (blocked || !fits) {
+                bool starved = detector->deferredSinceNs != 0 && now - detector->deferredSinceNs >= windowNs;
+                if (starved) {
+                    // 为推迟太久的检测留出预算，之后的检测都等它执行后再说
+                    blocked = true;
+                }
+                if (detector->deferredSinceNs == 0) {
+                    detector->deferredSinceNs = now;
+                    stats.deferrals++;
+                    m_deferrals++;
+                }
+                deferred = true;
+                continue;
+            }
+            usedNs += stats.costNs;
+        }
+        ready.push_back(detector->name);
+        stats.lastReasons = stats.pendingReasons;
+        stats.pendingReasons = TRIGGER_NONE;
+        stats.lastRunNs = now;
+        stats.runs++;
+        detector->inFlight = true;
+        detector->dispatchNs = now;
+        detector->deferredSinceNs = 0;
+        uint64_t staleNs = stats.effectiveStaleMs * NS_PER_MS;
+        if (staleNs != 0 && now + staleNs < wakeNs) {
+            wakeNs = now + staleNs;
+        }
+    }
+
+    // 有检测被推迟时，在最早的一笔消耗或派发移出窗口时重新检查（reportResult 也会唤醒）
+    if (deferred) {
+        uint64_t oldestNs = now;
+        if (!m_costWindow.empty() && m_costWindow.front().timeNs < oldestNs) {
+            oldestNs = m_costWindow.front().timeNs;
+        }
+        for (const Detector& detector : m_detectors) {
+            if (detector.inFlight && detector.dispatchNs < oldestNs) {
+                oldestNs = detector.dispatchNs;
+            }
+        }
+        if (oldestNs + windowNs < wakeNs) {
+            wakeNs = oldestNs + windowNs;
+        }
+    }
+    return ready;
+}
+
+void zTriggerScheduler::fillScheduleLocked(const Detector& detector, DetectorStats& stats) const {
+    stats = detector.stats;
+    stats.nextDueNs = stats.effectiveStaleMs != 0 && stats.lastRunNs != 0
+                      ? stats.lastRunNs + stats.effectiveStaleMs * NS_PER_MS : 0;
+}
+
+void zTriggerScheduler::addWatch(size_t detector, const string& path) {
+    Watch watch;
+    watch.detector = detector;
+    watch.path = path;
+    watch.wd = -1;
+    m_watches.push_back(watch);
+}
+
+// 文件存在时直接监听，不存在时监听所在目录并只关心这个文件名（之后文件被创建、修改也通过目录的事件得知）
+void zTriggerScheduler::setupWatches() {
+    m_rewatch = false;
+    for (Watch& watch : m_watches) {
+        if (watch.wd >= 0) {
+            continue;
+        }
+        watch.fileName.clear();
+        watch.wd = inotify_add_watch(m_inotifyFd, watch.path.c_str(), WATCH_MASK);
+        if (watch.wd >= 0) {
+            continue;
+        }
+        size_t slash = watch.path.find_last_of('/');
+        if (slash == string::npos || slash + 1 >= watch.path.size()) {
+            LOGW("zTriggerScheduler: watch '%s' failed (errno: %d: %s)", watch.path.c_str(), errno, strerror(errno));
+            continue;
+        }
+        string parent = slash == 0 ? "/" : watch.path.substr(0, slash);
+        watch.wd = inotify_add_watch(m_inotifyFd, parent.c_str(), WATCH_MASK);
+        if (watch.wd < 0) {
+            LOGW("zTriggerScheduler: watch '%s' and its directory failed (errno: %d: %s)",
+                 watch.path.c_str(), errno, strerror(errno));
+            continue;
+        }
+        watch.fileName = watch.path.substr(slash + 1);
+    }
+}
+
+void zTriggerScheduler::readInotifyEvents() {
+    // inotify_event 需要按其成员对齐
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (true) {
+        ssize_t len = read(m_inotifyFd, buffer, sizeof(buffer));
+        if (len <= 0) {
+            break;
+        }
+        for (char* p = buffer; p < buffer + len; ) {
+            const struct inotify_event* event = (const struct inotify_event*) p;
+            p += sizeof(struct inotify_event) + event->len;
+            for (Watch& watch : m_watches) {
+                if (watch.wd != event->wd) {
+                    continue;
+                }
+                if (event->mask & IN_IGNORED) {
+                    // 被监听的文件已删除或移走，下次检查时重新监听（文件不在时改为监听所在目录）
+                    watch.wd = -1;
+                    m_rewatch = true;
+                }
+                if (!watch.fileName.empty() && (event->len == 0 || watch.fileName != event->name)) {
+                    continue;
+                }
+                m_detectors[watch.detector].stats.pendingReasons |= TRIGGER_FILE;
+            }
+        }
+    }
+}
+
+void zTriggerScheduler::readNetlinkEvents() {
+    char buffer[8192];
+    bool changed = false;
+    while (recv(m_netlinkFd, buffer, sizeof(buffer), MSG_DONTWAIT) > 0) {
+        changed = true;
+    }
+    if (changed) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        markLocked(TRIGGER_NETWORK, [](const Detector& detector) {
+            return detector.triggers.network;
+        });
+    }
+}
+
+void zTriggerScheduler::closeFds() {
+    if (m_inotifyFd >= 0) {
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+    if (m_netlinkFd >= 0) {
+        close(m_netlinkFd);
+        m_netlinkFd = -1;
+    }
+    m_watches.clear();
+}
+
+bool zTriggerScheduler::run() {
+    bool expected = false;
+    if (!m_running.compare_exchange_strong(expected, true)) {
+        LOGW("zTriggerScheduler: run - already running");
+        return false;
+    }
+
+    bool needNetwork = false;
+    bool needProperty = false;
+    bool needMaps = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < m_detectors.size(); i++) {
+            Detector& detector = m_detectors[i];
+            for (const string& path : detector.triggers.paths) {
+                addWatch(i, path);
+            }
+            needNetwork |= detector.triggers.network;
+            needProperty |= detector.triggers.property;
+            needMaps |= detector.triggers.maps;
+            detector.stats.pendingReasons |= TRIGGER_INITIAL;
+        }
+        LOGI("zTriggerScheduler: %zu detectors, %zu watches, network %d, property %d, maps %d",
+             m_detectors.size(), m_watches.size(), needNetwork, needProperty, needMaps);
+    }
+
+    if (!m_watches.empty()) {
+        m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_inotifyFd < 0) {
+            LOGW("zTriggerScheduler: inotify_init1 failed (errno: %d: %s), file triggers fall back to max staleness",
+                 errno, strerror(errno));
+        } else {
+            setupWatches();
+        }
+    }
+
+    if (needNetwork) {
+        m_netlinkFd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+        struct sockaddr_nl addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.nl_family = AF_NETLINK;
+        addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR | RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE;
+        if (m_netlinkFd < 0 || bind(m_netlinkFd, (struct sockaddr*) &addr, sizeof(addr)) != 0) {
+            // 高版本系统不允许普通应用绑定 NETLINK_ROUTE，网络检测只能依靠最长间隔
+            LOGW("zTriggerScheduler: netlink unavailable (errno: %d: %s), network triggers fall back to max staleness",
+                 errno, strerror(errno));
+            if (m_netlinkFd >= 0) {
+                close(m_netlinkFd);
+                m_netlinkFd = -1;
+            }
+        }
+    }
+
+    uint32_t propertySerial = needProperty ? m_propertyProbe() : 0;
+    uint64_t mapsFingerprint = needMaps ? m_mapsProbe() : 0;
+    uint64_t now = zTask::getMonotonicNs();
+    uint64_t nextPollNs = now + m_pollIntervalMs * NS_PER_MS;
+    uint64_t nextMapsPollNs = now + m_mapsPollIntervalMs * NS_PER_MS;
+
+    while (m_running.load()) {
+        now = zTask::getMonotonicNs();
+        if (now >= nextPollNs) {
+            nextPollNs = now + m_pollIntervalMs * NS_PER_MS;
+            if (needProperty) {
+                uint32_t serial = m_propertyProbe();
+                if (serial != propertySerial) {
+                    propertySerial = serial;
+                    notify(TRIGGER_PROPERTY);
+                }
+            }
+            if (m_rewatch && m_inotifyFd >= 0) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                setupWatches();
+            }
+        }
+        if (needMaps && now >= nextMapsPollNs) {
+            nextMapsPollNs = now + m_mapsPollIntervalMs * NS_PER_MS;
+            uint64_t fingerprint = m_mapsProbe();
+            if (fingerprint != mapsFingerprint) {
+                mapsFingerprint = fingerprint;
+                notify(TRIGGER_MAPS);
+            }
+        }
+
+        // 收集到期的检测，并计算下一次需要醒来的时间
+        vector<string> ready;
+        uint64_t wakeNs = nextPollNs;
+        if (needMaps && nextMapsPollNs < wakeNs) {
+            wakeNs = nextMapsPollNs;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ready = collectReadyLocked(now, wakeNs);
+        }
+        if (!ready.empty()) {
+            LOGD("zTriggerScheduler: dispatch %zu detectors", ready.size());
+            try {
+                if (m_dispatcher) {
+                    m_dispatcher(ready);
+                }
+            } catch (const std::exception& e) {
+                LOGE("zTriggerScheduler: dispatcher exception: %s", e.what());
+            } catch (...) {
+                LOGE("zTriggerScheduler: dispatcher unknown exception");
+            }
+        }
+
+        struct pollfd fds[3];
+        nfds_t nfds = 0;
+        if (m_wakeFd >= 0) {
+            fds[nfds].fd = m_wakeFd;
+            fds[nfds++].events = POLLIN;
+        }
+        if (m_inotifyFd >= 0) {
+            fds[nfds].fd = m_inotifyFd;
+            fds[nfds++].events = POLLIN;
+        }
+        if (m_netlinkFd >= 0) {
+            fds[nfds].fd = m_netlinkFd;
+            fds[nfds++].events = POLLIN;
+        }
+        now = zTask::getMonotonicNs();
+        int timeoutMs = wakeNs > now ? (int) ((wakeNs - now + NS_PER_MS - 1) / NS_PER_MS) : 0;
+        int ret = poll(fds, nfds, timeoutMs);
+        if (ret <= 0) {
+            if (ret < 0 && errno != EINTR) {
+                LOGW("zTriggerScheduler: poll failed (errno: %d: %s)", errno, strerror(errno));
+                usleep(timeoutMs * 1000);
+            }
+            continue;
+        }
+        for (nfds_t i = 0; i < nfds; i++) {
+            if (!(fds[i].revents & POLLIN)) {
+                continue;
+            }
+            if (fds[i].fd == m_wakeFd) {
+                uint64_t value;
+                ssize_t len = read(m_wakeFd, &value, sizeof(value));
+                (void) len;
+            } else if (fds[i].fd == m_inotifyFd) {
+                readInotifyEvents();
+            } else if (fds[i].fd == m_netlinkFd) {
+                readNetlinkEvents();
+            }
+        }
+    }
+
+    closeFds();
+    LOGI("zTriggerScheduler: stopped");
+    return true;
+}
+
+void zTriggerScheduler::stop() {
+    m_running.store(false);
+    wake();
+}
+
+bool zTriggerScheduler::getStats(const string& name, DetectorStats& stats) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Detector& detector : m_detectors) {
+        if (detector.name == name) {
+            fillScheduleLocked(detector, stats);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::map<string, zTriggerScheduler::DetectorStats> zTriggerScheduler::getSchedule() const {
+    std::map<string, DetectorStats> schedule;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Detector& detector : m_detectors) {
+        fillScheduleLocked(detector, schedule[detector.name]);
+    }
+    return schedule;
+}
+
+zTriggerScheduler::BudgetUsage zTriggerScheduler::getBudgetUsage() const {
+    BudgetUsage usage;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    usage.budgetNs = m_budgetNs;
+    usage.windowMs = m_budgetWindowMs;
+    usage.usedNs = getBudgetUsedLocked(zTask::getMonotonicNs(), usage.inFlightNs);
+    usage.deferrals = m_deferrals;
+    return usage;
+}
+
+size_t zTriggerScheduler::getDetectorCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_detectors.size();
+}
+
+uint32_t zTriggerScheduler::readPropertySerial() {
+#ifdef __ANDROID__
+    return __system_property_area_serial();
+#else
+    return 0;
+#endif
+}
+
+// 只统计文件映射（加载的 so、dex、oat 等），匿名内存与 /dev、memfd 映射随内存分配频繁变化，不计入
+uint64_t zTriggerScheduler::readMapsFingerprint() {
+    vector<string> lines = zFile("/proc/self/maps").readAllLines();
+    uint64_t hash = 1469598103934665603ULL;
+    for (const string& line : lines) {
+        size_t path = line.find(" /");
+        if (path == string::npos || line.compare(path + 1, 5, "/dev/") == 0 || line.compare(path + 1, 7, "/memfd:") == 0) {
+            continue;
+        }
+        for (char c : line) {
+            hash ^= (uint8_t) c;
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
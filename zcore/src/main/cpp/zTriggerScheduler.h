@@ -0,0 +1,264 @@
+//
+// Created by lxz on 2025/12/04.
+// zTriggerScheduler - 按变化触发的检测调度
+//
+
+#ifndef OVERT_ZTRIGGERSCHEDULER_H
+#define OVERT_ZTRIGGERSCHEDULER_H
+
+#include <stdint.h>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+#include "zLog.h"
+#include "zStd.h"
+
+/**
+ * 按变化触发的检测调度器
+ * 每个检测声明自己关心的变化（文件、网络、系统属性、maps），只有发生变化或超过最长间隔时才执行，
+ * 取代每隔固定时间把所有检测都执行一遍的轮询
+ *
+ * 变化来源：
+ * - 文件：inotify 监听文件或目录，文件不存在时监听其所在目录，等文件出现
+ * - 网络：NETLINK_ROUTE 的接口、地址、路由变化
+ * - 系统属性：属性区域的序号（__system_property_area_serial），任意属性修改后递增
+ * - maps：/proc/self/maps 中文件映射的指纹，加载或卸载 so、dex 后变化
+ * 属性与 maps 没有事件通知，按 pollIntervalMs / mapsPollIntervalMs 检查
+ *
+ * run 在调用线程上阻塞，用 poll 等待事件或下一个到期时间，没有变化时不占用 CPU；
+ * 到期的检测一起交给 dispatcher 执行（zManager 用它们组成一轮任务图）
+ *
+ * 自适应间隔：检测执行后通过 reportResult 报告结果是否变化与消耗的 CPU 时间，
+ * 结果连续不变时最长间隔按 backoffFactor 逐步拉长到 maxBackoffMs，结果变化后恢复为 maxStaleMs；
+ * 检测失败时通过 reportFailure 报告，不算作结果不变，最长间隔同样恢复为 maxStaleMs
+ *
+ * CPU 预算：setCpuBudget 设置每个时间窗口内检测可以消耗的 CPU 时间（已报告的消耗加上已派发未报告的估计值），
+ * 预算不足时按估计消耗从小到大派发，推迟最贵的检测；推迟超过一个窗口的检测优先派发，避免一直被便宜的检测挤掉
+ */
+class zTriggerScheduler {
+public:
+    /**
+     * 触发原因，可以按位组合
+     */
+    enum TriggerType {
+        TRIGGER_NONE = 0,
+        TRIGGER_INITIAL = 1 << 0,     // 启动后第一次执行
+        TRIGGER_FILE = 1 << 1,
+        TRIGGER_NETWORK = 1 << 2,
+        TRIGGER_PROPERTY = 1 << 3,
+        TRIGGER_MAPS = 1 << 4,
+        TRIGGER_STALE = 1 << 5,       // 超过最长间隔
+        TRIGGER_MANUAL = 1 << 6,      // trigger 手动触发
+    };
+
+    /**
+     * 检测关心的变化
+     */
+    struct Triggers {
+        vector<string> paths;           // 文件或目录，inotify 监听
+        bool network = false;
+        bool property = false;
+        bool maps = false;
+        uint64_t minIntervalMs = 0;     // 两次执行的最小间隔，期间的触发合并到间隔结束后执行一次
+        uint64_t maxStaleMs = 0;        // 距离上次执行超过这个时间就执行，0 表示只在变化时执行
+        uint64_t maxBackoffMs = 0;      // 结果稳定时最长间隔可以拉长到的上限，不大于 maxStaleMs 时不拉长
+        double backoffFactor = 2.0;     // 每次结果不变时最长间隔乘以这个系数
+    };
+
+    struct DetectorStats {
+        uint64_t runs = 0;
+        uint64_t lastRunNs = 0;         // CLOCK_MONOTONIC
+        uint32_t lastReasons = 0;       // 最近一次执行的触发原因
+        uint32_t pendingReasons = 0;    // 已触发、还没执行的原因
+
+        uint64_t effectiveStaleMs = 0;  // 当前生效的最长间隔（自适应调整后）
+        uint64_t nextDueNs = 0;         // 按当前最长间隔下一次到期的时间，0 表示只在变化时执行
+        uint64_t costNs = 0;            // 每次执行 CPU 时间的估计值（最近几次的滑动平均）
+        uint32_t stableRuns = 0;        // 结果连续不变的次数
+        uint64_t changes = 0;           // 结果变化的次数
+        uint64_t deferrals = 0;         // 因 CPU 预算不足被推迟的次数，连续推迟只算一次
+        uint64_t failures = 0;          // 执行失败（抛出异常、没有执行）的次数
+    };
+
+    struct BudgetUsage {
+        uint64_t budgetNs = 0;          // 0 表示不限制
+        uint64_t windowMs = 0;
+        uint64_t usedNs = 0;            // 窗口内已报告的 CPU 时间
+        uint64_t inFlightNs = 0;        // 已派发、还没报告的检测的估计值
+        uint64_t deferrals = 0;         // 推迟总次数
+    };
+
+    // 参数为本次到期的检测名称
+    typedef std::function<void(const vector<string>& names)> Dispatcher;
+
+private:
+    struct Detector {
+        string name;
+        Triggers triggers;
+        DetectorStats stats;
+        bool inFlight = false;          // 已派发，还没有 reportResult / reportFailure
+        uint64_t dispatchNs = 0;
+        uint64_t deferredSinceNs = 0;   // 开始被预算推迟的时间，0 表示没有被推迟
+    };
+
+    // 预算窗口内已报告的消耗
+    struct CostEntry {
+        uint64_t timeNs;
+        uint64_t costNs;
+    };
+
+    // inotify 监听：wd -> 检测下标与文件名（监听的是所在目录时只关心这个文件名，为空表示目录内任意变化）
+    struct Watch {
+        size_t detector;
+        string path;
+        string fileName;
+        int wd;
+    };
+
+    vector<Detector> m_detectors;
+    vector<Watch> m_watches;
+    mutable std::mutex m_mutex;
+
+    Dispatcher m_dispatcher;
+    std::function<bool(const string&)> m_busyProbe;
+    std::function<uint32_t()> m_propertyProbe;
+    std::function<uint64_t()> m_mapsProbe;
+
+    uint64_t m_pollIntervalMs;
+    uint64_t m_mapsPollIntervalMs;
+
+    uint64_t m_budgetNs;
+    uint64_t m_budgetWindowMs;
+    std::deque<CostEntry> m_costWindow;   // 按报告时间排列
+    uint64_t m_deferrals;
+
+    std::atomic<bool> m_running;
+    int m_inotifyFd;
+    int m_netlinkFd;
+    int m_wakeFd;
+    bool m_rewatch;
+
+    void markLocked(uint32_t reason, const std::function<bool(const Detector&)>& match);
+
+    /**
+     * 取出到期并且预算允许的检测，标记为已派发
+     * @param wakeNs 传入下一次需要醒来的时间，按各检测的到期时间、预算释放时间调整
+     */
+    vector<string> collectReadyLocked(uint64_t now, uint64_t& wakeNs);
+
+    // 丢弃预算窗口外的消耗记录
+    void pruneCostWindowLocked(uint64_t now);
+
+    // 窗口内已报告的消耗，inFlightNs 返回已派发未报告的估计值（派发超过一个窗口仍未报告的不再计入）
+    uint64_t getBudgetUsedLocked(uint64_t now, uint64_t& inFlightNs) const;
+
+    void fillScheduleLocked(const Detector& detector, DetectorStats& stats) const;
+
+    void setupWatches();
+
+    void addWatch(size_t detector, const string& path);
+
+    void readInotifyEvents();
+
+    void readNetlinkEvents();
+
+    void closeFds();
+
+    void wake();
+
+public:
+    zTriggerScheduler();
+
+    ~zTriggerScheduler();
+
+    zTriggerScheduler(const zTriggerScheduler&) = delete;
+    zTriggerScheduler& operator=(const zTriggerScheduler&) = delete;
+
+    /**
+     * 注册检测，run 之前调用
+     * @return 名称重复时返回false
+     */
+    bool addDetector(const string& name, const Triggers& triggers);
+
+    void setDispatcher(Dispatcher dispatcher) { m_dispatcher = dispatcher; }
+
+    /**
+     * 检测是否仍在执行，执行中的检测即使到期也先不派发，保持待执行状态，下次检查时再派发
+     */
+    void setBusyProbe(std::function<bool(const string&)> probe) { m_busyProbe = probe; }
+
+    /**
+     * 替换属性序号、maps 指纹的读取方式，测试时用来模拟变化
+     */
+    void setPropertyProbe(std::function<uint32_t()> probe) { m_propertyProbe = probe; }
+    void setMapsProbe(std::function<uint64_t()> probe) { m_mapsProbe = probe; }
+
+    // 属性序号的检查间隔，同时是忙碌检测的重试间隔
+    void setPollIntervalMs(uint64_t intervalMs) { m_pollIntervalMs = intervalMs ? intervalMs : 1; }
+
+    // maps 指纹的检查间隔，读取 maps 比读取属性序号贵得多
+    void setMapsPollIntervalMs(uint64_t intervalMs) { m_mapsPollIntervalMs = intervalMs ? intervalMs : 1; }
+
+    /**
+     * 设置 CPU 预算
+     * @param budgetNs 每个窗口内检测可以消耗的 CPU 时间，0 表示不限制
+     * @param windowMs 滑动窗口长度，默认一分钟
+     */
+    void setCpuBudget(uint64_t budgetNs, uint64_t windowMs = 60000);
+
+    /**
+     * 检测执行结束后报告结果，可以在任意线程调用
+     * @param changed 结果与上次相比是否变化，决定最长间隔拉长还是恢复
+     * @param cpuNs 本次执行消耗的 CPU 时间，计入预算并更新估计值
+     */
+    void reportResult(const string& name, bool changed, uint64_t cpuNs);
+
+    /**
+     * 检测执行失败（抛出异常、派发后没有执行）时报告，可以在任意线程调用
+     * 结束在途状态，不算作结果不变：连续不变的次数清零，最长间隔恢复为 maxStaleMs
+     * @param cpuNs 失败之前消耗的 CPU 时间，计入预算，不更新估计值
+     */
+    void reportFailure(const string& name, uint64_t cpuNs = 0);
+
+    /**
+     * 手动触发检测，可以在任意线程调用
+     * @param name 为空时触发所有检测
+     */
+    void trigger(const string& name = "", TriggerType reason = TRIGGER_MANUAL);
+
+    /**
+     * 按变化类型触发关心该变化的检测，用于模拟事件或由外部事件源转发
+     */
+    void notify(TriggerType reason);
+
+    /**
+     * 事件循环，阻塞直到 stop
+     * @return 已经在运行时返回false
+     */
+    bool run();
+
+    // 可以在任意线程调用，run 在处理完当前事件后返回
+    void stop();
+
+    bool isRunning() const { return m_running.load(); }
+
+    bool getStats(const string& name, DetectorStats& stats) const;
+
+    /**
+     * 所有检测当前的调度：生效的最长间隔、下一次到期时间、估计消耗、推迟次数等
+     */
+    std::map<string, DetectorStats> getSchedule() const;
+
+    BudgetUsage getBudgetUsage() const;
+
+    size_t getDetectorCount() const;
+
+    // 默认的属性序号与 maps 指纹
+    static uint32_t readPropertySerial();
+    static uint64_t readMapsFingerprint();
+};
+
+#endif //OVERT_ZTRIGGERSCHEDULER_H
@@ -11,6 +11,7 @@
 #include "zLog.h"
 #include "zFile.h"
 #include "zJavaVm.h"
+#include "zJniCache.h"
 #include "zTeeCert.h"
 
 namespace {
@@ -74,19 +75,15 @@ string get_android_id(JNIEnv* env, jobject context) {
         return "";
     }
 
-    jclass clsSecure = env->FindClass("android/provider/Settings$Secure");
-    if (!clsSecure || env->ExceptionCheck()) {
-        env->ExceptionClear();
-        return "";
-    }
-
-    jmethodID midGetString = env->GetStaticMethodID(
-            clsSecure,
+    // 全局引用，由 zJniCache 持有
+    jclass clsSecure = zJniCache::getInstance()->getClass(env, "android/provider/Settings$Secure");
+    jmethodID midGetString = zJniCache::getInstance()->getStaticMethodId(
+            env,
+            "android/provider/Settings$Secure",
             "getString",
             "(Landroid/content/ContentResolver;Ljava/lang/String;)Ljava/lang/String;"
     );
-    if (!midGetString || env->ExceptionCheck()) {
-        env->ExceptionClear();
+    if (!clsSecure || !midGetString) {
         return "";
     }
 
@@ -9,6 +9,7 @@
 #include "zLinker.h"
 #include "zJavaVm.h"
 #include "zJson.h"
+#include "zJsonWriter.h"
 #include "zBroadCast.h"
 
 #include "zLocalNetworkInfo.h"
@@ -162,9 +163,10 @@ std::string fdListenerCallback(std::string msg){
 
         map<string, map<string, string>> info = get_proc_info();
 
-        zJson json = info;
+        // 直接序列化，不构造 zJson 的 DOM；消息循环在一个线程上，缓冲区反复使用
+        static zJsonWriter writer;
 
-        return json.dump().c_str();
+        return writer.dumpInfo(info).c_str();
     }
     return "";
 }
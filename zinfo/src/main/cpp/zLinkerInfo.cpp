@@ -11,6 +11,7 @@
 #include "zLibcUtil.h"
 
 #include "zLinker.h"
+#include "zElfCache.h"
 #include "zLinkerInfo.h"
 
 /**
@@ -30,6 +31,16 @@ map<string, map<string, string>> get_linker_info(){
         return info;
     }
 
+    // 每轮取走一次自上一轮以来新加载和已卸载的库
+    SoinfoDiff soinfo_diff = linker->update_soinfo_snapshot();
+
+    // 有库被卸载时释放缓存中对应的解析结果与文件映射
+    if (!soinfo_diff.unloaded.empty()) {
+        zElfCache* cache = zElfCache::getInstance();
+        size_t evicted = cache == nullptr ? 0 : cache->evict_unmapped();
+        LOGI("get_linker_info: %zu libraries unloaded, evicted %zu cache entries", soinfo_diff.unloaded.size(), evicted);
+    }
+
     // 获取所有已加载共享库的路径列表
     vector<string> libpath_list = linker->get_libpath_list();
     
@@ -82,5 +93,30 @@ map<string, map<string, string>> get_linker_info(){
         }
     }
 
+    // 上一轮之后新加载的库立即做完整性检查，不必等它出现在关键库列表中
+    // 首轮的 loaded 是启动时已加载的全部库，不在这里全量扫描
+    if (!soinfo_diff.initial && !soinfo_diff.loaded.empty()) {
+        vector<LibCrcTarget> targets;
+        for (size_t i = 0; i < soinfo_diff.loaded.size(); i++) {
+            const SoinfoEntry& entry = soinfo_diff.loaded[i];
+            if (entry.realpath.empty() || entry.realpath[0] != '/' || entry.base == nullptr) {
+                continue;
+            }
+            LibCrcTarget target;
+            target.path = entry.realpath;
+            target.mem_base = entry.base;
+            targets.push_back(target);
+        }
+        LOGI("get_linker_info: checking %zu newly loaded libraries", targets.size());
+        vector<LibCrcResult> results = zLinker::check_libs_crc(targets);
+        for (size_t i = 0; i < results.size(); i++) {
+            if (results[i].crc_mismatch) {
+                LOGW("CRC check failed for newly loaded library: %s", results[i].path.c_str());
+                info[results[i].path]["risk"] = "error";
+                info[results[i].path]["explain"] = "check_lib_crc error";
+            }
+        }
+    }
+
     return info;
 }
@@ -12,6 +12,7 @@
 #include "zProcInfo.h"
 #include "zStdUtil.h"
 #include "zProcMaps.h"
+#include "zResultRecord.h"
 
 inline size_t findBytes(const vector<uint8_t>& haystack,
                              const string& needle)
@@ -72,13 +73,12 @@ string get_app_specific_dir_path2() {
  * 获取内存映射信息
  * 分析/proc/self/maps文件，检测关键系统库是否被篡改
  * 主要检测libart.so和libc.so等关键库的映射数量和权限是否正确
- * @return 包含检测结果的Map，格式：{库名 -> {风险等级, 说明}}
+ * @param record 追加检测结果，格式：{库名 -> {风险等级, 说明}}
  */
-map<string, map<string, string>> get_maps_info() {
+void get_maps_info(zResultRecord& record) {
     LOGD("get_maps_info called");
-    map<string, map<string, string>> info;
 
-    zProcMaps maps = zProcMaps();
+    std::shared_ptr<zProcMaps> maps = zProcMaps::get_round_snapshot();
 
     // 定义需要检查的关键库列表
     vector<string> check_lib_list = {
@@ -88,33 +88,30 @@ map<string, map<string, string>> get_maps_info() {
     };
 
     for (string lib_name: check_lib_list) {
-        LibraryMapping* library = maps.find_so_by_name(lib_name);
+        LibraryMapping* library = maps->find_so_by_name(lib_name);
         if(library == nullptr) continue;
         // 检查映射数量是否正确（正常情况下应该有4个映射）
         if(library->segments.size() != 4) {
-            info[lib_name]["risk"] = "error";
-            info[lib_name]["explain"] = "reference count error";
+            record.addItem(lib_name, zResultRecord::RISK_ERROR, "reference count error");
         }
         // 检查权限是否正确（正常情况下应该是r--p, r-xp, r--p, rw-p）
         else if (library->segments[0].permissions != "r--p" ||
                  (library->segments[1].permissions != "r-xp" && library->segments[1].permissions != "--xp") ||
                  (library->segments[2].permissions != "r--p" && library->segments[2].permissions != "rw-p") ||
                  (library->segments[3].permissions != "rw-p" && library->segments[3].permissions != "r--p")) {
-            info[lib_name]["risk"] = "error";
-            info[lib_name]["explain"] = "permissions error";
+            record.addItem(lib_name, zResultRecord::RISK_ERROR, "permissions error");
         }
     }
 
     string base_odex_path = "";
 
-    LibraryMapping* library = maps.find_so_by_name("/oat/arm64/base.odex");
+    LibraryMapping* library = maps->find_so_by_name("/oat/arm64/base.odex");
     if(library != nullptr){
         LOGE("base.odex: %s", library->file_path.c_str());
         base_odex_path = library->file_path;
     }else{
         LOGE("base.odex load failed");
-        info["base.odex"]["risk"] = "error";
-        info["base.odex"]["explain"] = "base.odex is not loaded";
+        record.addItem("base.odex", zResultRecord::RISK_ERROR).setExplain("base.odex is not loaded");
         base_odex_path = get_app_specific_dir_path2() + "/oat/arm64/base.odex";
     }
 
@@ -124,26 +121,21 @@ map<string, map<string, string>> get_maps_info() {
         size_t pos = findBytes(bytes, "--inline-max-code-units=0");
         if (pos != string::npos){
             LOGE("find black str --inline-max-code-units=0");
-            info["--inline-max-code-units=0"]["risk"] = "error";
-            info["--inline-max-code-units=0"]["explain"] = "black string but find in base.odex";
+            record.addItem("--inline-max-code-units=0", zResultRecord::RISK_ERROR).setExplain("black string but find in base.odex");
         }
     }else{
-        info["base.odex"]["risk"] = "error";
-        info["base.odex"]["explain"] = "base.odex is not exists";
+        record.addItem("base.odex", zResultRecord::RISK_ERROR).setExplain("base.odex is not exists");
     }
-
-    return info;
 }
 
 /**
  * 获取挂载点信息
  * 检测/proc/self/mounts文件中的异常挂载点
  * 主要用于检测系统被修改的痕迹，如overlay挂载、可疑模块等
- * @return 包含检测结果的Map，格式：{挂载点信息 -> {风险等级, 说明}}
+ * @param record 追加检测结果，格式：{挂载点信息 -> {风险等级, 说明}}
  */
-map<string, map<string, string>> get_mounts_info() {
+void get_mounts_info(zResultRecord& record) {
     LOGI("get_mounts_info called");
-    map<string, map<string, string>> info;
 
     // 定义需要检测的异常挂载点名称
     const char *paths[] = {
@@ -165,8 +157,7 @@ map<string, map<string, string>> get_mounts_info() {
         for (const char *path: paths) {
             if (strstr(mounts_lines[i].c_str(), path) != nullptr) {
                 LOGE("check_mounts error %d %s", i, mounts_lines[i].c_str());
-                info[mounts_lines[i].c_str()]["risk"] = "error";
-                info[mounts_lines[i].c_str()]["explain"] = "black name but in system path";
+                record.addItem(mounts_lines[i], zResultRecord::RISK_ERROR, "black name but in system path");
             }
         }
 
@@ -174,23 +165,19 @@ map<string, map<string, string>> get_mounts_info() {
         if (strstr(mounts_lines[i].c_str(), "/system ") != nullptr &&
             strstr(mounts_lines[i].c_str(), "overlay") != nullptr) {
             LOGE("check_mounts error %d %s", i, mounts_lines[i].c_str());
-            info[mounts_lines[i].c_str()]["risk"] = "error";
-            info[mounts_lines[i].c_str()]["explain"] = "black name but in system path";
+            record.addItem(mounts_lines[i], zResultRecord::RISK_ERROR, "black name but in system path");
         }
     }
-
-    return info;
 }
 
 /**
  * 获取任务信息
  * 检测当前进程的所有线程，查找Frida等调试工具注入的痕迹
  * 通过分析/proc/self/task目录下的线程状态信息进行检测
- * @return 包含检测结果的Map，格式：{线程信息 -> {风险等级, 说明}}
+ * @param record 追加检测结果，格式：{线程信息 -> {风险等级, 说明}}
  */
-map<string, map<string, string>> get_task_info() {
+void get_task_info(zResultRecord& record) {
     LOGD("get_task_info called");
-    map<string, map<string, string>> info;
 
     // 获取当前进程的所有任务目录列表
     vector<string> task_dir_list = zFile("/proc/self/task").listDirectories();
@@ -213,19 +200,16 @@ map<string, map<string, string>> get_task_info() {
             // 检测Frida注入的gmain线程
             if (strstr(stat_line.c_str(), "gamin") != nullptr) {
                 LOGE("gmain is found in stat line");
-                info[stat_line.c_str()]["risk"] = "error";
-                info[stat_line.c_str()]["explain"] = "frida hooked this process";
+                record.addItem(stat_line, zResultRecord::RISK_ERROR, "frida hooked this process");
             }
 
             // 检测Frida注入的pool-frida线程
             if (strstr(stat_line.c_str(), "pool-frida") != nullptr) {
                 LOGE("pool-frida is found in stat line");
-                info[stat_line.c_str()]["risk"] = "error";
-                info[stat_line.c_str()]["explain"] = "frida hooked this process";
+                record.addItem(stat_line, zResultRecord::RISK_ERROR, "frida hooked this process");
             }
         }
     }
-    return info;
 }
 
 
@@ -233,11 +217,10 @@ map<string, map<string, string>> get_task_info() {
  * 获取进程属性信息
  * 检测/proc/self/attr/prev文件中的进程属性信息
  * 主要用于检测Magisk等Root框架的痕迹
- * @return 包含检测结果的Map，格式：{属性信息 -> {风险等级, 说明}}
+ * @param record 追加检测结果，格式：{属性信息 -> {风险等级, 说明}}
  */
-map<string, map<string, string>> get_attr_prev_info() {
+void get_attr_prev_info(zResultRecord& record) {
     LOGI("get_attr_prev_info called");
-    map<string, map<string, string>> info;
 
     vector<string> lines = zFile("/proc/self/attr/prev").readAllLines();
 
@@ -247,23 +230,19 @@ map<string, map<string, string>> get_attr_prev_info() {
         // 检测Frida注入的pool-frida线程
         if (strstr(line.c_str(), "zygote") != nullptr) {
             LOGE("magisk is found in prev line");
-            info[line.c_str()]["risk"] = "error";
-            info[line.c_str()]["explain"] = "magisk is found in prev";
+            record.addItem(line, zResultRecord::RISK_ERROR, "magisk is found in prev");
         }
     }
-
-    return info;
 }
 
 /**
  * 获取网络TCP信息
  * 检测/proc/self/net/tcp文件中的网络连接信息
  * 主要用于检测Frida、IDA等调试工具的端口使用情况
- * @return 包含检测结果的Map，格式：{网络连接信息 -> {风险等级, 说明}}
+ * @param record 追加检测结果，格式：{网络连接信息 -> {风险等级, 说明}}
  */
-map<string, map<string, string>> get_net_tcp_info() {
+void get_net_tcp_info(zResultRecord& record) {
     LOGI("get_net_tcp_info called");
-    map<string, map<string, string>> info;
 
     // android7 之后没权限
     vector<string> lines = zFile("/proc/self/net/tcp").readAllLines();
@@ -274,52 +253,56 @@ map<string, map<string, string>> get_net_tcp_info() {
 
         if (strstr(line.c_str(), ":69A2") != nullptr || strstr(line.c_str(), ":69A3") != nullptr) {
             LOGE("black port is found in tcp line");
-            info[line.c_str()]["risk"] = "error";
-            info[line.c_str()]["explain"] = "find frida port";
+            record.addItem(line, zResultRecord::RISK_ERROR, "find frida port");
         }
         if (strstr(line.c_str(), ":5D8A") != nullptr) {
             LOGE("black port is found in tcp line");
-            info[line.c_str()]["risk"] = "error";
-            info[line.c_str()]["explain"] = "find ida port";
+            record.addItem(line, zResultRecord::RISK_ERROR, "find ida port");
         }
     }
+}
 
-    return info;
+/**
+ * 与原来逐项 info.insert 的合并方式相同：各项检查之间先写入的条目优先，
+ * 同一项检查内同名条目后写覆盖（zResultRecord::toInfo 的语义）
+ * 记录在各项检查之间复用，clear 保留容量
+ */
+static void insert_record(map<string, map<string, string>>& info, zResultRecord& record) {
+    map<string, map<string, string>> part = record.toInfo();
+    info.insert(part.begin(), part.end());
+    record.clear();
 }
 
 /**
  * 获取进程信息的主函数
  * 整合所有进程相关的检测功能，包括内存映射、挂载点、任务状态等
  * 通过多种检测手段综合分析进程的安全状态
+ * 各项检测依次写入同一个 zResultRecord，每项结束后按 insert 合并到结果中
  * @return 包含所有检测结果的Map，格式：{检测项目 -> {风险等级, 说明}}
  */
 map<string, map<string, string>> get_proc_info() {
     map<string, map<string, string>> info;
+    zResultRecord record;
 
     LOGI("get_maps_info is called");
-    map<string, map<string, string>> maps_info = get_maps_info();
-    LOGI("get_maps_info insert is called");
-    info.insert(maps_info.begin(), maps_info.end());
+    get_maps_info(record);
+    insert_record(info, record);
 
     LOGI("get_mounts_info is called");
-    map<string, map<string, string>> mounts_info = get_mounts_info();
-    LOGI("get_mounts_info insert is called");
-    info.insert(mounts_info.begin(), mounts_info.end());
+    get_mounts_info(record);
+    insert_record(info, record);
 
     LOGI("get_task_info is called");
-    map<string, map<string, string>> task_info = get_task_info();
-    LOGI("get_task_info insert is called");
-    info.insert(task_info.begin(), task_info.end());
+    get_task_info(record);
+    insert_record(info, record);
 
     LOGI("get_attr_prev_info is called");
-    map<string, map<string, string>> attr_prev_info = get_attr_prev_info();
-    LOGI("get_attr_prev_info insert is called");
-    info.insert(attr_prev_info.begin(), attr_prev_info.end());
+    get_attr_prev_info(record);
+    insert_record(info, record);
 
     LOGI("get_net_tcp_info is called");
-    map<string, map<string, string>> net_tcp_info = get_net_tcp_info();
-    LOGI("get_net_tcp_info insert is called");
-    info.insert(net_tcp_info.begin(), net_tcp_info.end());
+    get_net_tcp_info(record);
+    insert_record(info, record);
 
     return info;
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "zSideChannelInfo.h"
 #include "zLog.h"
 #include "zStdUtil.h"
+#include "zCpuTopology.h"
 
 /**
  * 获取当前时间（纳秒）
@@ -35,19 +36,20 @@ static inline uint64_t raw_ns(void)
 map<string, map<string, string>> get_side_channel_info(){
     map<string, map<string, string>> info;
 
-    // 绑定到高性能核心以稳定测量（根据实际测试情况来看，这一步非常有必要）
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(0, &mask); // 绑定到 CPU0，一般来讲，CPU0 都是大核
+    // 绑定到一个大核以稳定测量（根据实际测试情况来看，这一步非常有必要）
+    // CPU0 通常是小核，按 cpu_capacity / 最大频率识别大核；函数返回时恢复工作线程原来的绑定
+    vector<int> big_cores = zCpuTopology::getInstance()->getCpus(zCpuTopology::CORE_BIG);
+    int bind_cpu = big_cores.empty() ? 0 : big_cores.back();
+    vector<int> bind_cpus;
+    bind_cpus.push_back(bind_cpu);
+    zCpuAffinityScope affinity(bind_cpus);
 
     pid_t tid = syscall(SYS_gettid); // 当前线程的 TID
-    int result = sched_setaffinity(tid, sizeof(mask), &mask);
-
-    if (result != 0) {
-        int err = errno;
-        LOGE("sched_setaffinity failed, errno=%d (%s)", err, strerror(err));
+    if (!affinity.isBound()) {
+        LOGE("bind thread %d to CPU%d failed", tid, bind_cpu);
+    } else {
+        LOGI("Thread %d successfully bound to CPU%d", tid, bind_cpu);
     }
-    LOGI("Thread %d successfully bound to CPU0", tid);
 
 
     uint64_t times1[10000] = {0};  // 存储faccessat系统调用的执行时间
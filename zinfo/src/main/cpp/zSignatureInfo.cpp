@@ -9,6 +9,7 @@
 #include "zFile.h"
 #include "zZip.h"
 #include "zSha256.h"
+#include "zSha256Cache.h"
 #include "zSignatureInfo.h"
 
 // 获取应用私有目录路径
@@ -40,13 +41,11 @@ string memory_to_hex_string(char *ptr, size_t size) {
     return ret;
 }
 
-string getSha256byBaseApk() {
-    string app_specific_dir_path = get_app_specific_dir_path();
-    LOGE("get_app_specific_dir_path %s", app_specific_dir_path.c_str());
-
-    string base_apk_path = app_specific_dir_path.append("/base.apk");
-    LOGE("get_base_apk_path %s", base_apk_path.c_str());
-
+/**
+ * 解压 base.apk 中 META-INF 下的 .RSA 文件，计算其中签名数据的 SHA-256
+ * @return 没有找到签名文件时返回false
+ */
+static bool compute_rsa_sha256(const string& base_apk_path, uint8_t* hash) {
     mz_bool status = 0;
     mz_zip_archive zip_archive = {};
     size_t uncomp_size = 0;
@@ -57,10 +56,10 @@ string getSha256byBaseApk() {
 
     if(status == 0) {
         LOGE("open zip failed %s", base_apk_path.c_str());
-        return "";
+        return false;
     }
 
-    string sha256byBaseApk;
+    bool found_rsa = false;
     for (mz_uint i = 0; i < mz_zip_reader_get_num_files(&zip_archive); i++)
     {
         mz_zip_archive_file_stat file_stat;
@@ -109,20 +108,36 @@ string getSha256byBaseApk() {
         LOGE("rsa_addr %p", file_stat.m_filename);
         LOGE("rsa_size 0x%zx", rsa_size);
 
-        unsigned char hash[SHA256_SIZE_BYTES] = {0};
         sha256((const void *) rsa_addr, rsa_size, hash);
-
-        sha256byBaseApk = memory_to_hex_string((char *) hash, SHA256_SIZE_BYTES);
-
-        LOGE("RSA_hash %s", sha256byBaseApk.c_str());
+        found_rsa = true;
 
         mz_free(p_file);
         break;
     }
 
     mz_zip_reader_end(&zip_archive);
-    return sha256byBaseApk;
+    return found_rsa;
+}
 
+string getSha256byBaseApk() {
+    string app_specific_dir_path = get_app_specific_dir_path();
+    LOGE("get_app_specific_dir_path %s", app_specific_dir_path.c_str());
+
+    string base_apk_path = app_specific_dir_path.append("/base.apk");
+    LOGE("get_base_apk_path %s", base_apk_path.c_str());
+
+    // base.apk 没有变化时直接使用缓存的摘要，不再读取和解压整个 APK
+    unsigned char hash[SHA256_SIZE_BYTES] = {0};
+    bool found = zSha256Cache::getInstance()->get_derived_digest(base_apk_path, "META-INF/*.RSA", [&base_apk_path](uint8_t* digest) {
+        return compute_rsa_sha256(base_apk_path, digest);
+    }, hash);
+    if (!found) {
+        return "";
+    }
+
+    string sha256byBaseApk = memory_to_hex_string((char *) hash, SHA256_SIZE_BYTES);
+    LOGE("RSA_hash %s", sha256byBaseApk.c_str());
+    return sha256byBaseApk;
 }
 
 map<string, map<string, string>> get_signature_info(){
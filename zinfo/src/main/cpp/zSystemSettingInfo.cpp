@@ -9,6 +9,7 @@
 #include "zLog.h"
 #include "zLibc.h"
 #include "zJavaVm.h"
+#include "zJniCache.h"
 
 #include "zSystemSettingInfo.h"
 
@@ -24,14 +25,23 @@ bool isCharging(JNIEnv *env, jobject context) {
         return JNI_FALSE;
     }
 
+    // 类与方法、字段 ID 从缓存获取，只在第一次检测时解析
+    zJniCache* cache = zJniCache::getInstance();
+
     // 获取 Intent.ACTION_BATTERY_CHANGED
-    jclass intentClass = env->FindClass("android/content/Intent");
-    jfieldID actionBatteryChangedField = env->GetStaticFieldID(intentClass, "ACTION_BATTERY_CHANGED", "Ljava/lang/String;");
+    jclass intentClass = cache->getClass(env, "android/content/Intent");
+    jfieldID actionBatteryChangedField = cache->getStaticFieldId(env, "android/content/Intent", "ACTION_BATTERY_CHANGED", "Ljava/lang/String;");
+    if (intentClass == nullptr || actionBatteryChangedField == nullptr) {
+        return JNI_FALSE;
+    }
     jobject actionBatteryChanged = env->GetStaticObjectField(intentClass, actionBatteryChangedField);
 
     // 创建 IntentFilter 对象
-    jclass intentFilterClass = env->FindClass("android/content/IntentFilter");
-    jmethodID intentFilterConstructor = env->GetMethodID(intentFilterClass, "<init>", "(Ljava/lang/String;)V");
+    jclass intentFilterClass = cache->getClass(env, "android/content/IntentFilter");
+    jmethodID intentFilterConstructor = cache->getMethodId(env, "android/content/IntentFilter", "<init>", "(Ljava/lang/String;)V");
+    if (intentFilterClass == nullptr || intentFilterConstructor == nullptr) {
+        return JNI_FALSE;
+    }
     jobject intentFilter = env->NewObject(intentFilterClass, intentFilterConstructor, actionBatteryChanged);
 
     // 调用 context.registerReceiver(null, intentFilter)
@@ -45,17 +55,21 @@ bool isCharging(JNIEnv *env, jobject context) {
     }
 
     // 获取 BatteryManager.EXTRA_STATUS 常量
-    jclass batteryManagerClass = env->FindClass("android/os/BatteryManager");
-    jfieldID extraStatusField = env->GetStaticFieldID(batteryManagerClass, "EXTRA_STATUS", "Ljava/lang/String;");
+    jclass batteryManagerClass = cache->getClass(env, "android/os/BatteryManager");
+    jfieldID extraStatusField = cache->getStaticFieldId(env, "android/os/BatteryManager", "EXTRA_STATUS", "Ljava/lang/String;");
+    jmethodID getIntExtraMethod = cache->getMethodId(env, "android/content/Intent", "getIntExtra", "(Ljava/lang/String;I)I");
+    jfieldID chargingField = cache->getStaticFieldId(env, "android/os/BatteryManager", "BATTERY_STATUS_CHARGING", "I");
+    jfieldID fullField = cache->getStaticFieldId(env, "android/os/BatteryManager", "BATTERY_STATUS_FULL", "I");
+    if (batteryManagerClass == nullptr || extraStatusField == nullptr || getIntExtraMethod == nullptr
+        || chargingField == nullptr || fullField == nullptr) {
+        return JNI_FALSE;
+    }
     jobject extraStatusStr = env->GetStaticObjectField(batteryManagerClass, extraStatusField);
 
     // 调用 batteryStatusIntent.getIntExtra
-    jmethodID getIntExtraMethod = env->GetMethodID(intentClass, "getIntExtra", "(Ljava/lang/String;I)I");
     jint status = env->CallIntMethod(batteryStatusIntent, getIntExtraMethod, extraStatusStr, -1);
 
     // 获取 BATTERY_STATUS_CHARGING 和 BATTERY_STATUS_FULL 值
-    jfieldID chargingField = env->GetStaticFieldID(batteryManagerClass, "BATTERY_STATUS_CHARGING", "I");
-    jfieldID fullField = env->GetStaticFieldID(batteryManagerClass, "BATTERY_STATUS_FULL", "I");
     jint BATTERY_STATUS_CHARGING = env->GetStaticIntField(batteryManagerClass, chargingField);
     jint BATTERY_STATUS_FULL = env->GetStaticIntField(batteryManagerClass, fullField);
 
@@ -187,12 +201,15 @@ bool isSimExist(JNIEnv *env, jobject context) {
 
 // 获取开发者选项是否开启
 bool isDeveloperModeEnabled(JNIEnv *env, jobject context) {
-    jclass settingsClass = env->FindClass("android/provider/Settings$Global");
-    jmethodID getInt = env->GetStaticMethodID(settingsClass, "getInt",
-                                              "(Landroid/content/ContentResolver;Ljava/lang/String;I)I");
-
-    jclass contextCls = env->GetObjectClass(context);
-    jmethodID getContentResolver = env->GetMethodID(contextCls, "getContentResolver", "()Landroid/content/ContentResolver;");
+    zJniCache* cache = zJniCache::getInstance();
+    jclass settingsClass = cache->getClass(env, "android/provider/Settings$Global");
+    jmethodID getInt = cache->getStaticMethodId(env, "android/provider/Settings$Global", "getInt",
+                                                "(Landroid/content/ContentResolver;Ljava/lang/String;I)I");
+    jmethodID getContentResolver = cache->getMethodId(env, "android/content/Context", "getContentResolver",
+                                                      "()Landroid/content/ContentResolver;");
+    if (settingsClass == nullptr || getInt == nullptr || getContentResolver == nullptr) {
+        return JNI_FALSE;
+    }
     jobject resolver = env->CallObjectMethod(context, getContentResolver);
 
     jstring key = env->NewStringUTF("development_settings_enabled");
@@ -203,12 +220,15 @@ bool isDeveloperModeEnabled(JNIEnv *env, jobject context) {
 
 // USB调试是否开启
 bool isUsbDebugEnabled(JNIEnv *env, jobject context) {
-    jclass settingsClass = env->FindClass("android/provider/Settings$Global");
-    jmethodID getInt = env->GetStaticMethodID(settingsClass, "getInt",
-                                              "(Landroid/content/ContentResolver;Ljava/lang/String;I)I");
-
-    jclass contextCls = env->GetObjectClass(context);
-    jmethodID getContentResolver = env->GetMethodID(contextCls, "getContentResolver", "()Landroid/content/ContentResolver;");
+    zJniCache* cache = zJniCache::getInstance();
+    jclass settingsClass = cache->getClass(env, "android/provider/Settings$Global");
+    jmethodID getInt = cache->getStaticMethodId(env, "android/provider/Settings$Global", "getInt",
+                                                "(Landroid/content/ContentResolver;Ljava/lang/String;I)I");
+    jmethodID getContentResolver = cache->getMethodId(env, "android/content/Context", "getContentResolver",
+                                                      "()Landroid/content/ContentResolver;");
+    if (settingsClass == nullptr || getInt == nullptr || getContentResolver == nullptr) {
+        return JNI_FALSE;
+    }
     jobject resolver = env->CallObjectMethod(context, getContentResolver);
 
     jstring key = env->NewStringUTF("adb_enabled");
@@ -220,11 +240,12 @@ bool isUsbDebugEnabled(JNIEnv *env, jobject context) {
 
 // 系统是否配置了代理
 bool isProxyEnabled(JNIEnv *env, jobject context) {
-    jclass sysCls = env->FindClass("java/lang/System");
+    // 缓存中的类是全局引用，不需要释放
+    jclass sysCls = zJniCache::getInstance()->getClass(env, "java/lang/System");
     if (sysCls == nullptr) return JNI_FALSE;
-    jmethodID getProp = env->GetStaticMethodID(sysCls, "getProperty", "(Ljava/lang/String;)Ljava/lang/String;");
+    jmethodID getProp = zJniCache::getInstance()->getStaticMethodId(env, "java/lang/System", "getProperty",
+                                                                    "(Ljava/lang/String;)Ljava/lang/String;");
     if (getProp == nullptr) {
-        delete_local_ref(env, sysCls);
         return JNI_FALSE;
     }
 
@@ -233,7 +254,6 @@ bool isProxyEnabled(JNIEnv *env, jobject context) {
     if (hostKey == nullptr || portKey == nullptr) {
         delete_local_ref(env, hostKey);
         delete_local_ref(env, portKey);
-        delete_local_ref(env, sysCls);
         return JNI_FALSE;
     }
 
@@ -246,7 +266,6 @@ bool isProxyEnabled(JNIEnv *env, jobject context) {
     if (host == nullptr || port == nullptr) {
         delete_local_ref(env, host);
         delete_local_ref(env, port);
-        delete_local_ref(env, sysCls);
         return JNI_FALSE;
     }
 
@@ -261,7 +280,6 @@ bool isProxyEnabled(JNIEnv *env, jobject context) {
         }
         delete_local_ref(env, host);
         delete_local_ref(env, port);
-        delete_local_ref(env, sysCls);
         return JNI_FALSE;
     }
 
@@ -270,7 +288,6 @@ bool isProxyEnabled(JNIEnv *env, jobject context) {
     env->ReleaseStringUTFChars(port, portChars);
     delete_local_ref(env, host);
     delete_local_ref(env, port);
-    delete_local_ref(env, sysCls);
     return result ? JNI_TRUE : JNI_FALSE;
 }
 
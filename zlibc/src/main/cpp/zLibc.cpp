@@ -17,10 +17,18 @@
 
 // ==================== 系统调用函数 ====================
 
+// 当前线程的系统调用次数，用于统计检测的开销
+static thread_local uint64_t tls_syscall_count = 0;
+
+uint64_t get_thread_syscall_count() {
+    return tls_syscall_count;
+}
+
 // 内联汇编实现的 syscall 函数
 // ARM64 调用约定：x0-x7 用于参数传递，x8 用于系统调用号
 long syscall(long __number, ...) {
     long result;
+    tls_syscall_count++;
     long arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8;
     
     va_list args;
@@ -1087,6 +1095,11 @@ FILE* popen(const char* cmd, const char* mode) {
     return fp;
 }
 
+#else
+
+uint64_t get_thread_syscall_count() {
+    return 0;
+}
 
 #endif
 
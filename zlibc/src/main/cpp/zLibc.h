@@ -25,6 +25,7 @@
 
 #include <sys/syscall.h>
 #include <sys/types.h>
+#include <stdint.h>
 
 // ==================== 系统调用相关结束 ====================
 
@@ -138,4 +139,12 @@ extern "C" {
     int execve(const char* __file, char* const* __argv, char* const* __envp);
 }
 
+// ==================== 统计函数 ====================
+/**
+ * 当前线程通过 syscall 发起的系统调用次数
+ * 只统计经过 zLibc 的调用（文件、网络等函数都通过 syscall 实现），不包括系统 libc 内部的调用，
+ * 未启用自定义实现时返回 0
+ */
+uint64_t get_thread_syscall_count();
+
 #endif //Z_LIBC_H
\ No newline at end of file